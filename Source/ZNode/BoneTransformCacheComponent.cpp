@@ -0,0 +1,164 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "BoneTransformCacheComponent.h"
+#include "ServerAnimation.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "GameFramework/Character.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bone Cache Hits"), STAT_BoneCacheHits, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bone Cache Misses"), STAT_BoneCacheMisses, STATGROUP_Game);
+
+UBoneTransformCacheComponent::UBoneTransformCacheComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+int32 UBoneTransformCacheComponent::FindSlot(FName SocketName)
+{
+	// slots are few, so a linear search on the name is cheapest
+	const int32 Existing = Sockets.IndexOfByPredicate([SocketName](const FCachedSocket& Socket) { return Socket.Name == SocketName; });
+
+	if (Existing != INDEX_NONE)
+	{
+		return Existing;
+	}
+
+	FCachedSocket& Socket = Sockets.AddDefaulted_GetRef();
+	Socket.Name = SocketName;
+
+	if (EnsureResolved())
+	{
+		ResolveSocket(Socket);
+	}
+
+	return Sockets.Num() - 1;
+}
+
+bool UBoneTransformCacheComponent::GetComponentSpaceTransform(int32 Slot, FTransform& OutTransform)
+{
+	if (!Sockets.IsValidIndex(Slot) || !EnsureResolved())
+	{
+		return false;
+	}
+
+	FCachedSocket& Socket = Sockets[Slot];
+
+	if (Socket.BoneIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// read the bone at most once per frame
+	if (Socket.Frame != GFrameCounter)
+	{
+		Socket.Frame = GFrameCounter;
+
+		// servers may be skipping our pose, so make sure the bones are up to date
+		ServerAnimation::EnsurePose(Mesh);
+
+		Socket.ComponentTransform = Socket.LocalTransform * Mesh->GetBoneTransform(Socket.BoneIndex, FTransform::Identity);
+
+		INC_DWORD_STAT(STAT_BoneCacheMisses);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_BoneCacheHits);
+	}
+
+	OutTransform = Socket.ComponentTransform;
+	return true;
+}
+
+bool UBoneTransformCacheComponent::GetSocketLocation(int32 Slot, FVector& OutLocation)
+{
+	FTransform ComponentTransform;
+
+	if (!GetComponentSpaceTransform(Slot, ComponentTransform))
+	{
+		return false;
+	}
+
+	// the component may have moved since the bones were cached, so always use its current transform
+	OutLocation = Mesh->GetComponentTransform().TransformPosition(ComponentTransform.GetLocation());
+	return true;
+}
+
+bool UBoneTransformCacheComponent::FindSocketLocation(const AActor* Actor, FName SocketName, FVector& OutLocation)
+{
+	if (!Actor)
+	{
+		return false;
+	}
+
+	if (UBoneTransformCacheComponent* Cache = Actor->FindComponentByClass<UBoneTransformCacheComponent>())
+	{
+		return Cache->GetSocketLocation(SocketName, OutLocation);
+	}
+
+	// no cache, look the socket up on the mesh
+	const ACharacter* Character = Cast<ACharacter>(Actor);
+	const USkeletalMeshComponent* SkeletalMesh = Character ? Character->GetMesh() : Actor->FindComponentByClass<USkeletalMeshComponent>();
+
+	if (!SkeletalMesh || !SkeletalMesh->DoesSocketExist(SocketName))
+	{
+		return false;
+	}
+
+	OutLocation = SkeletalMesh->GetSocketLocation(SocketName);
+	return true;
+}
+
+bool UBoneTransformCacheComponent::EnsureResolved()
+{
+	// find the character's mesh
+	if (!Mesh)
+	{
+		if (const ACharacter* Character = Cast<ACharacter>(GetOwner()))
+		{
+			Mesh = Character->GetMesh();
+		}
+		else
+		{
+			Mesh = GetOwner()->FindComponentByClass<USkeletalMeshComponent>();
+		}
+
+		if (!Mesh)
+		{
+			return false;
+		}
+	}
+
+	// resolve every slot again if the mesh asset changed
+	const UObject* Asset = Mesh->GetSkinnedAsset();
+
+	if (Asset != ResolvedAsset)
+	{
+		ResolvedAsset = Asset;
+
+		for (FCachedSocket& Socket : Sockets)
+		{
+			ResolveSocket(Socket);
+		}
+	}
+
+	return true;
+}
+
+void UBoneTransformCacheComponent::ResolveSocket(FCachedSocket& Socket) const
+{
+	Socket.Frame = MAX_uint64;
+
+	// sockets are offsets from a bone
+	if (const USkeletalMeshSocket* MeshSocket = Mesh->GetSocketByName(Socket.Name))
+	{
+		Socket.BoneIndex = Mesh->GetBoneIndex(MeshSocket->BoneName);
+		Socket.LocalTransform = MeshSocket->GetSocketLocalTransform();
+		return;
+	}
+
+	// otherwise the name may be a bone
+	Socket.BoneIndex = Mesh->GetBoneIndex(Socket.Name);
+	Socket.LocalTransform = FTransform::Identity;
+}
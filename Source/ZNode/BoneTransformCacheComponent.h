@@ -0,0 +1,84 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "BoneTransformCacheComponent.generated.h"
+
+class USkeletalMeshComponent;
+
+/**
+ *  Caches socket and bone transforms for a character's mesh.
+ *  Each socket name is resolved to a slot holding its bone index and local offset once, the first time it's asked for.
+ *  Its component space transform is then read at most once per frame, so repeated lookups in the same frame are array reads.
+ *  Callers that look up the same socket on every shot can keep the slot returned by FindSlot and skip the name search.
+ *  Slots are resolved again if the mesh asset changes.
+ */
+UCLASS(ClassGroup = (Combat), meta = (BlueprintSpawnableComponent))
+class UBoneTransformCacheComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** A resolved socket and its cached transform */
+	struct FCachedSocket
+	{
+		/** Socket or bone name */
+		FName Name;
+
+		/** Bone the socket is attached to, or INDEX_NONE if it's missing from the mesh */
+		int32 BoneIndex = INDEX_NONE;
+
+		/** Socket offset relative to its bone */
+		FTransform LocalTransform;
+
+		/** Cached socket transform, in component space */
+		FTransform ComponentTransform;
+
+		/** Frame the component space transform was cached on */
+		uint64 Frame = MAX_uint64;
+	};
+
+	/** Mesh the sockets belong to */
+	UPROPERTY(Transient)
+	USkeletalMeshComponent* Mesh = nullptr;
+
+	/** Mesh asset the slots were resolved for. Only compared, never dereferenced */
+	const UObject* ResolvedAsset = nullptr;
+
+	/** Resolved sockets */
+	TArray<FCachedSocket> Sockets;
+
+public:
+
+	/** Constructor */
+	UBoneTransformCacheComponent();
+
+	/** Returns the slot for a socket or bone name, resolving it the first time it's asked for */
+	int32 FindSlot(FName SocketName);
+
+	/** Returns the socket transform for a slot in component space. Returns false if the socket is missing from the mesh */
+	bool GetComponentSpaceTransform(int32 Slot, FTransform& OutTransform);
+
+	/** Returns the socket location for a slot in world space. Returns false if the socket is missing from the mesh */
+	bool GetSocketLocation(int32 Slot, FVector& OutLocation);
+
+	/** Returns the location of a socket or bone in world space. Returns false if the socket is missing from the mesh */
+	bool GetSocketLocation(FName SocketName, FVector& OutLocation) { return GetSocketLocation(FindSlot(SocketName), OutLocation); }
+
+	/**
+	 *  Returns the location of a socket on an actor's mesh.
+	 *  Uses the actor's cache component if it has one, or looks the socket up on the mesh directly if it doesn't.
+	 */
+	static bool FindSocketLocation(const AActor* Actor, FName SocketName, FVector& OutLocation);
+
+protected:
+
+	/** Finds the mesh and resolves the slots again if the mesh asset changed. Returns false if there's no mesh */
+	bool EnsureResolved();
+
+	/** Resolves a slot's bone index and local offset from its name */
+	void ResolveSocket(FCachedSocket& Socket) const;
+};
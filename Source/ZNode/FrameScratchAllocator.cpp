@@ -0,0 +1,153 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "FrameScratchAllocator.h"
+#include "Engine/HitResult.h"
+#include "Misc/CoreDelegates.h"
+#include "Templates/UniquePtr.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Scratch Peak Bytes"), STAT_FrameScratchPeakBytes, STATGROUP_FrameScratch);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Scratch Reserved Bytes"), STAT_FrameScratchReservedBytes, STATGROUP_FrameScratch);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Scratch Allocations"), STAT_FrameScratchAllocations, STATGROUP_FrameScratch);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Heap Allocations Avoided"), STAT_FrameScratchAvoided, STATGROUP_FrameScratch);
+
+namespace FrameScratch
+{
+	/** Hit result arrays waiting to be lent */
+	static TArray<TUniquePtr<TArray<FHitResult>>> FreeHitArrays;
+}
+
+FFrameScratchArena& FFrameScratchArena::Get()
+{
+	check(IsInGameThread());
+
+	// the arena lives until the process exits, so it never outlives the begin frame delegate
+	static FFrameScratchArena* Arena = new FFrameScratchArena();
+	return *Arena;
+}
+
+FFrameScratchArena::FFrameScratchArena()
+{
+	// reset the arena at the start of every frame
+	FCoreDelegates::OnBeginFrame.AddRaw(this, &FFrameScratchArena::Reset);
+}
+
+void* FFrameScratchArena::Allocate(SIZE_T Size, SIZE_T Alignment)
+{
+	if (Size == 0)
+	{
+		return nullptr;
+	}
+
+	// find a block with room for the allocation, starting with the current one
+	while (CurrentBlock < Blocks.Num())
+	{
+		const FBlock& Block = Blocks[CurrentBlock];
+		const SIZE_T Offset = Align(CurrentOffset, Alignment);
+
+		if (Offset + Size <= Block.Size)
+		{
+			LastAllocation = Block.Memory + Offset;
+			CurrentOffset = Offset + Size;
+			FrameBytes += Size;
+			++FrameAllocations;
+
+			return LastAllocation;
+		}
+
+		++CurrentBlock;
+		CurrentOffset = 0;
+	}
+
+	// out of blocks, so add a new one. Oversized allocations get a block of their own size
+	FBlock& NewBlock = Blocks.AddDefaulted_GetRef();
+	NewBlock.Size = FMath::Max(BlockSize, Align(Size, Alignment));
+	NewBlock.Memory = static_cast<uint8*>(FMemory::Malloc(NewBlock.Size, FMath::Max<SIZE_T>(Alignment, 16)));
+
+	INC_DWORD_STAT_BY(STAT_FrameScratchReservedBytes, NewBlock.Size);
+
+	CurrentBlock = Blocks.Num() - 1;
+	CurrentOffset = Size;
+	LastAllocation = NewBlock.Memory;
+	FrameBytes += Size;
+	++FrameAllocations;
+
+	return LastAllocation;
+}
+
+void* FFrameScratchArena::Reallocate(void* Ptr, SIZE_T OldSize, SIZE_T NewSize, SIZE_T Alignment)
+{
+	if (!Ptr)
+	{
+		return Allocate(NewSize, Alignment);
+	}
+
+	// grow or shrink the last allocation in place if it still fits in its block
+	if (Ptr == LastAllocation)
+	{
+		const FBlock& Block = Blocks[CurrentBlock];
+		const SIZE_T Offset = LastAllocation - Block.Memory;
+
+		if (Offset + NewSize <= Block.Size)
+		{
+			CurrentOffset = Offset + NewSize;
+			FrameBytes += NewSize > OldSize ? NewSize - OldSize : 0;
+
+			return Ptr;
+		}
+	}
+
+	// move to a new allocation. The old memory is reclaimed when the arena resets
+	void* NewPtr = Allocate(NewSize, Alignment);
+
+	if (NewPtr)
+	{
+		FMemory::Memcpy(NewPtr, Ptr, FMath::Min(OldSize, NewSize));
+	}
+
+	return NewPtr;
+}
+
+void FFrameScratchArena::Reset()
+{
+	// publish the totals for the frame that just ended
+	SET_DWORD_STAT(STAT_FrameScratchPeakBytes, FrameBytes);
+	SET_DWORD_STAT(STAT_FrameScratchAllocations, FrameAllocations);
+	SET_DWORD_STAT(STAT_FrameScratchAvoided, FrameAvoidedAllocations);
+
+	CurrentBlock = 0;
+	CurrentOffset = 0;
+	LastAllocation = nullptr;
+	FrameBytes = 0;
+	FrameAllocations = 0;
+	FrameAvoidedAllocations = 0;
+
+	++FrameNumber;
+}
+
+FScopedHitResults::FScopedHitResults()
+{
+	FFrameScratchArena& Arena = FFrameScratchArena::Get();
+
+	// reuse a pooled array if we have one
+	if (FrameScratch::FreeHitArrays.Num() > 0)
+	{
+		Hits = FrameScratch::FreeHitArrays.Pop(EAllowShrinking::No).Release();
+
+		if (Hits->Max() > 0)
+		{
+			Arena.CountAvoidedAllocation();
+		}
+	}
+	else
+	{
+		Hits = new TArray<FHitResult>();
+	}
+}
+
+FScopedHitResults::~FScopedHitResults()
+{
+	// give the array back, keeping its capacity
+	Hits->Reset();
+	FrameScratch::FreeHitArrays.Emplace(Hits);
+}
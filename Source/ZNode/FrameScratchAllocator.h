@@ -0,0 +1,232 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+struct FHitResult;
+
+DECLARE_STATS_GROUP(TEXT("Frame Scratch"), STATGROUP_FrameScratch, STATCAT_Advanced);
+
+/**
+ *  Linear arena for transient gameplay data that only lives until the end of the frame.
+ *  Allocations bump a pointer inside a few large blocks, and the whole arena is reset when the next frame begins,
+ *  so there's nothing to free. Blocks are kept between frames, so after warming up the arena doesn't touch the heap.
+ *  Growing the most recent allocation is done in place when there's room, which covers the usual TArray growth pattern.
+ *  Game thread only.
+ */
+class FFrameScratchArena
+{
+public:
+
+	/** Size of each arena block */
+	static constexpr SIZE_T BlockSize = 64 * 1024;
+
+	/** Returns the arena for the game thread */
+	static FFrameScratchArena& Get();
+
+	/** Allocates memory that stays valid until the end of the frame */
+	void* Allocate(SIZE_T Size, SIZE_T Alignment = 16);
+
+	/** Grows or shrinks an allocation, moving it if it can't be resized in place */
+	void* Reallocate(void* Ptr, SIZE_T OldSize, SIZE_T NewSize, SIZE_T Alignment = 16);
+
+	/** Counts a heap allocation removed by reusing scratch memory */
+	void CountAvoidedAllocation() { ++FrameAvoidedAllocations; }
+
+	/** Returns the number of frames the arena has been reset for. Used to catch scratch memory kept past its frame */
+	uint64 GetFrameNumber() const { return FrameNumber; }
+
+protected:
+
+	FFrameScratchArena();
+
+	/** Releases everything allocated this frame and publishes the frame stats */
+	void Reset();
+
+	/** A block of arena memory */
+	struct FBlock
+	{
+		uint8* Memory = nullptr;
+		SIZE_T Size = 0;
+	};
+
+	/** All the blocks owned by the arena */
+	TArray<FBlock> Blocks;
+
+	/** Block currently being allocated from */
+	int32 CurrentBlock = 0;
+
+	/** Offset of the next allocation in the current block */
+	SIZE_T CurrentOffset = 0;
+
+	/** Last allocation, which can be grown in place */
+	uint8* LastAllocation = nullptr;
+
+	/** Bytes allocated this frame */
+	SIZE_T FrameBytes = 0;
+
+	/** Number of allocations served this frame */
+	uint32 FrameAllocations = 0;
+
+	/** Number of heap allocations removed this frame */
+	uint32 FrameAvoidedAllocations = 0;
+
+	/** Frame counter */
+	uint64 FrameNumber = 0;
+};
+
+/**
+ *  TArray allocator policy that places the elements in the frame scratch arena.
+ *  Arrays using it must not outlive the frame they were filled in, so only use it for locals.
+ *
+ *  Usage:
+ *    TArray<FOverlapResult, FFrameScratchAllocator> Overlaps;
+ */
+class FFrameScratchAllocator
+{
+public:
+
+	using SizeType = int32;
+
+	enum { NeedsElementType = false };
+	enum { RequireRangeCheck = true };
+
+	class ForAnyElementType
+	{
+	public:
+
+		ForAnyElementType() = default;
+
+		/** Takes the allocation from another allocator. Arena memory is never freed, so there's nothing to release first */
+		void MoveToEmpty(ForAnyElementType& Other)
+		{
+			check(this != &Other);
+
+			Data = Other.Data;
+			AllocatedBytes = Other.AllocatedBytes;
+			FrameNumber = Other.FrameNumber;
+
+			Other.Data = nullptr;
+			Other.AllocatedBytes = 0;
+		}
+
+		FScriptContainerElement* GetAllocation() const
+		{
+			return Data;
+		}
+
+		void ResizeAllocation(SizeType CurrentNum, SizeType NewMax, SIZE_T NumBytesPerElement)
+		{
+			ResizeAllocation(CurrentNum, NewMax, NumBytesPerElement, 16);
+		}
+
+		void ResizeAllocation(SizeType CurrentNum, SizeType NewMax, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement)
+		{
+			FFrameScratchArena& Arena = FFrameScratchArena::Get();
+
+			// memory from a previous frame has already been handed out again
+			checkf(!Data || FrameNumber == Arena.GetFrameNumber(), TEXT("Frame scratch array kept past the end of its frame"));
+
+			const SIZE_T NewBytes = static_cast<SIZE_T>(NewMax) * NumBytesPerElement;
+
+			Data = static_cast<FScriptContainerElement*>(Arena.Reallocate(Data, AllocatedBytes, NewBytes, FMath::Max<SIZE_T>(AlignmentOfElement, 16)));
+			AllocatedBytes = NewBytes;
+			FrameNumber = Arena.GetFrameNumber();
+		}
+
+		SizeType CalculateSlackReserve(SizeType NewMax, SIZE_T NumBytesPerElement) const
+		{
+			return NewMax;
+		}
+
+		SizeType CalculateSlackShrink(SizeType NewMax, SizeType CurrentMax, SIZE_T NumBytesPerElement) const
+		{
+			// there's nothing to gain from shrinking arena memory
+			return CurrentMax;
+		}
+
+		SizeType CalculateSlackGrow(SizeType NewMax, SizeType CurrentMax, SIZE_T NumBytesPerElement) const
+		{
+			// double the capacity, starting with room for a few elements
+			return FMath::Max3(NewMax, CurrentMax * 2, static_cast<SizeType>(8));
+		}
+
+		SIZE_T GetAllocatedSize(SizeType CurrentMax, SIZE_T NumBytesPerElement) const
+		{
+			return AllocatedBytes;
+		}
+
+		bool HasAllocation() const
+		{
+			return Data != nullptr;
+		}
+
+		SizeType GetInitialCapacity() const
+		{
+			return 0;
+		}
+
+	private:
+
+		ForAnyElementType(const ForAnyElementType&) = delete;
+		ForAnyElementType& operator=(const ForAnyElementType&) = delete;
+
+		/** Elements, in arena memory */
+		FScriptContainerElement* Data = nullptr;
+
+		/** Size of the allocation */
+		SIZE_T AllocatedBytes = 0;
+
+		/** Frame the allocation was made in */
+		uint64 FrameNumber = 0;
+	};
+
+	template<typename ElementType>
+	class ForElementType : public ForAnyElementType
+	{
+	public:
+
+		ElementType* GetAllocation() const
+		{
+			return reinterpret_cast<ElementType*>(ForAnyElementType::GetAllocation());
+		}
+	};
+};
+
+template <>
+struct TAllocatorTraits<FFrameScratchAllocator> : TAllocatorTraitsBase<FFrameScratchAllocator>
+{
+	enum { SupportsMove = true };
+	enum { SupportsElementAlignment = true };
+};
+
+/**
+ *  Lends a reusable hit result array for the duration of a scope.
+ *  Engine queries only accept heap allocated hit arrays, so instead of allocating a fresh one for each query,
+ *  the arrays are pooled and keep their capacity between uses. Scopes can be nested.
+ *
+ *  Usage:
+ *    FScopedHitResults ScopedHits;
+ *    TArray<FHitResult>& Hits = ScopedHits.Get();
+ *    GetWorld()->LineTraceMultiByChannel(Hits, Start, End, ECC_Visibility, Params);
+ */
+class FScopedHitResults
+{
+public:
+
+	FScopedHitResults();
+	~FScopedHitResults();
+
+	/** Returns the lent array, which starts empty */
+	TArray<FHitResult>& Get() { return *Hits; }
+
+private:
+
+	FScopedHitResults(const FScopedHitResults&) = delete;
+	FScopedHitResults& operator=(const FScopedHitResults&) = delete;
+
+	/** Lent array */
+	TArray<FHitResult>* Hits = nullptr;
+};
@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "GameplayRandomSubsystem.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Crc.h"
+#include "HAL/PlatformTime.h"
+#include "GameFramework/Actor.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGameplayRandom, Log, All);
+
+bool UGameplayRandomSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGameplayRandomSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// use the seed from the command line if provided
+	uint64 CommandLineSeed = 0;
+
+	if (FParse::Value(FCommandLine::Get(), TEXT("GameplaySeed="), CommandLineSeed))
+	{
+		SetSeed(CommandLineSeed);
+	}
+	else
+	{
+		SetSeed(GameplayRandom::Mix(FPlatformTime::Cycles64()));
+	}
+}
+
+void UGameplayRandomSubsystem::SetSeed(uint64 InSeed)
+{
+	Seed = InSeed;
+
+	UE_LOG(LogGameplayRandom, Verbose, TEXT("Gameplay seed set to %llu"), Seed);
+}
+
+FGameplayRandomStream UGameplayRandomSubsystem::MakeStream(FName StreamName) const
+{
+	// hash the plain string, since name indices are not stable across runs
+	return MakeStream(static_cast<uint64>(FCrc::StrCrc32(*StreamName.ToString())));
+}
+
+FGameplayRandomStream UGameplayRandomSubsystem::MakeActorStream(const AActor* Actor)
+{
+	check(Actor);
+
+	// actors loaded with the level keep the name they were saved with
+	if (Actor->IsNetStartupActor())
+	{
+		return MakeStream(Actor->GetFName());
+	}
+
+	// spawned actor names come from a process wide counter, so key on who spawned us and what we are instead
+	const AActor* Owner = Actor->GetOwner();
+	const FString OwnerName = !Owner ? TEXT("None") : Owner->IsNetStartupActor() ? Owner->GetName() : Owner->GetClass()->GetName();
+	const uint32 SpawnKey = FCrc::StrCrc32(*FString::Printf(TEXT("%s.%s"), *OwnerName, *Actor->GetClass()->GetName()));
+
+	// tell apart the actors spawned for the same key by the order they asked for a stream
+	uint32& SpawnIndex = SpawnCounters.FindOrAdd(SpawnKey);
+
+	return MakeStream(GameplayRandom::MakeKey(SpawnKey, SpawnIndex++));
+}
@@ -0,0 +1,155 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameplayRandomSubsystem.generated.h"
+
+class AActor;
+
+/**
+ *  Counter-based random numbers.
+ *  Every value is a SplitMix64 hash of the session seed, a stream ID and a counter, so there's no shared state to lock,
+ *  and the same seed, stream and counter always produce the same value regardless of thread or call order.
+ */
+namespace GameplayRandom
+{
+	/** SplitMix64 finalizer */
+	inline uint64 Mix(uint64 Value)
+	{
+		Value += 0x9E3779B97F4A7C15ull;
+		Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+		return Value ^ (Value >> 31);
+	}
+
+	/** Returns the key for a stream in the provided session */
+	inline uint64 MakeKey(uint64 Seed, uint64 StreamId)
+	{
+		return Mix(Seed ^ Mix(StreamId));
+	}
+
+	/** Returns the random value at the provided position of a stream */
+	inline uint64 Hash(uint64 Key, uint64 Counter)
+	{
+		return Mix(Key + Counter * 0x9E3779B97F4A7C15ull);
+	}
+
+	/** Returns a float in [0, 1) from the top bits of a random value */
+	inline float ToFraction(uint64 Value)
+	{
+		return static_cast<float>(Value >> 40) * (1.0f / 16777216.0f);
+	}
+
+	/** Returns an integer in [Min, Max] from a random value */
+	inline int32 ToRange(uint64 Value, int32 Min, int32 Max)
+	{
+		const uint64 Range = static_cast<uint64>(static_cast<int64>(Max) - Min) + 1;
+		return Max > Min ? Min + static_cast<int32>(((Value >> 32) * Range) >> 32) : Min;
+	}
+}
+
+/**
+ *  A random stream owned by a single entity.
+ *  Draws only advance the stream's own counter, so entities can draw from parallel updates without locks,
+ *  and each entity sees the same sequence for the same session seed no matter how the others are scheduled.
+ */
+struct FGameplayRandomStream
+{
+protected:
+
+	/** Stream key, derived from the session seed and the stream ID */
+	uint64 Key = 0;
+
+	/** Number of values drawn so far */
+	uint64 Counter = 0;
+
+public:
+
+	FGameplayRandomStream() = default;
+
+	FGameplayRandomStream(uint64 Seed, uint64 StreamId)
+		: Key(GameplayRandom::MakeKey(Seed, StreamId))
+	{}
+
+	/** Returns the next raw value */
+	uint64 Next() { return GameplayRandom::Hash(Key, Counter++); }
+
+	/** Returns an integer in [Min, Max] */
+	int32 RandRange(int32 Min, int32 Max) { return GameplayRandom::ToRange(Next(), Min, Max); }
+
+	/** Returns a float in [0, 1) */
+	float FRand() { return GameplayRandom::ToFraction(Next()); }
+
+	/** Returns a float in [Min, Max) */
+	float FRandRange(float Min, float Max) { return Min + (Max - Min) * FRand(); }
+
+	/** Returns a unit vector uniformly distributed inside a cone around Direction */
+	FVector VRandCone(const FVector& Direction, float HalfAngle)
+	{
+		const float CosTheta = FMath::Lerp(1.0f, FMath::Cos(HalfAngle), FRand());
+		const float SinTheta = FMath::Sqrt(1.0f - CosTheta * CosTheta);
+		const float Phi = FRand() * UE_TWO_PI;
+
+		FVector AxisY, AxisZ;
+		Direction.FindBestAxisVectors(AxisY, AxisZ);
+
+		return Direction * CosTheta + (AxisY * FMath::Cos(Phi) + AxisZ * FMath::Sin(Phi)) * SinTheta;
+	}
+
+	/** Returns the number of values drawn so far */
+	uint64 GetCounter() const { return Counter; }
+};
+
+/**
+ *  Owns the random seed for the gameplay session and hands out per-entity streams.
+ *  The seed is picked at random when the world starts, unless it's provided with -GameplaySeed=,
+ *  or set by the combat replay so playback makes the same rolls as the recording.
+ *  Actors placed in the level key their streams on their saved names. Spawned actors key them on their owner and class,
+ *  plus a spawn counter kept by this subsystem, since runtime actor names depend on how many objects the process has created.
+ *
+ *  Usage:
+ *    RandomStream = GetWorld()->GetSubsystem<UGameplayRandomSubsystem>()->MakeActorStream(this);
+ *    const int32 Roll = RandomStream.RandRange(1, 3);
+ */
+UCLASS()
+class UGameplayRandomSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Session seed */
+	uint64 Seed = 0;
+
+	/** Number of actor streams made so far for each spawn key */
+	TMap<uint32, uint32> SpawnCounters;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Picks the session seed */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Sets the session seed. Streams made before this keep their old seed */
+	void SetSeed(uint64 InSeed);
+
+	/** Returns the session seed */
+	uint64 GetSeed() const { return Seed; }
+
+	/** Makes a stream for the provided ID */
+	FGameplayRandomStream MakeStream(uint64 StreamId) const { return FGameplayRandomStream(Seed, StreamId); }
+
+	/** Makes a stream identified by a name that's stable across runs */
+	FGameplayRandomStream MakeStream(FName StreamName) const;
+
+	/**
+	 *  Makes a stream for an actor.
+	 *  Level actors use their saved name. Spawned actors use their owner's name and their class, plus how many streams
+	 *  were made for that pair this session, so they get the same stream as long as each owner spawns them in the same order.
+	 */
+	FGameplayRandomStream MakeActorStream(const AActor* Actor);
+};
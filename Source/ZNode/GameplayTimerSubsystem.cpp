@@ -0,0 +1,367 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "GameplayTimerSubsystem.h"
+#include "Engine/World.h"
+#include "Algo/Reverse.h"
+
+DECLARE_CYCLE_STAT(TEXT("Timer Wheel Advance"), STAT_GameplayTimerAdvance, STATGROUP_GameplayTimers);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pending Timers"), STAT_GameplayTimersPending, STATGROUP_GameplayTimers);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fired Timers"), STAT_GameplayTimersFired, STATGROUP_GameplayTimers);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Cascaded Timers"), STAT_GameplayTimersCascaded, STATGROUP_GameplayTimers);
+
+UGameplayTimerSubsystem::UGameplayTimerSubsystem()
+{
+	// start with every slot empty
+	for (int32 Level = 0; Level < NumLevels; ++Level)
+	{
+		for (int32 Slot = 0; Slot < SlotsPerLevel; ++Slot)
+		{
+			Slots[Level][Slot] = INDEX_NONE;
+		}
+	}
+}
+
+bool UGameplayTimerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGameplayTimerSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// sync the wheel to the world clock
+	CurrentTick = GetWorldTick();
+}
+
+void UGameplayTimerSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_GameplayTimersPending, NumPending);
+
+	// drop all pending timers
+	Entries.Empty();
+	OwnerHeads.Empty();
+	ExpiredBatch.Empty();
+	FreeHead = INDEX_NONE;
+	NumPending = 0;
+
+	for (int32 Level = 0; Level < NumLevels; ++Level)
+	{
+		for (int32 Slot = 0; Slot < SlotsPerLevel; ++Slot)
+		{
+			Slots[Level][Slot] = INDEX_NONE;
+		}
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId UGameplayTimerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameplayTimerSubsystem, STATGROUP_Tickables);
+}
+
+uint64 UGameplayTimerSubsystem::GetWorldTick() const
+{
+	return static_cast<uint64>(GetWorld()->GetTimeSeconds() / TickSeconds);
+}
+
+void UGameplayTimerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_GameplayTimerAdvance);
+
+		const uint64 TargetTick = GetWorldTick();
+
+		// advance one wheel tick at a time, collecting everything that expires along the way
+		while (CurrentTick < TargetTick)
+		{
+			++CurrentTick;
+
+			// when a level wraps around, pull the next slot of the level above down the wheel
+			for (int32 Level = 1; Level < NumLevels; ++Level)
+			{
+				if ((CurrentTick & ((uint64(1) << (Level * SlotBits)) - 1)) != 0)
+				{
+					break;
+				}
+
+				Cascade(Level);
+			}
+
+			CollectExpired();
+		}
+	}
+
+	// fire the batch. Entries were already released, so callbacks are free to schedule or cancel timers.
+	// Cancelling clears the callback of the batch entries that haven't fired yet
+	for (FiringIndex = 0; FiringIndex < ExpiredBatch.Num(); ++FiringIndex)
+	{
+		const FEntry& Expired = ExpiredBatch[FiringIndex];
+
+		if (!Expired.Callback)
+		{
+			continue;
+		}
+
+		if (UObject* Owner = Expired.Owner.ResolveObjectPtr())
+		{
+			INC_DWORD_STAT(STAT_GameplayTimersFired);
+
+			Expired.Callback(Owner);
+		}
+	}
+
+	FiringIndex = INDEX_NONE;
+
+	ExpiredBatch.Reset();
+}
+
+void UGameplayTimerSubsystem::ScheduleCallback(UObject* Owner, FCallback Callback, float Delay)
+{
+	check(Owner && Callback);
+
+	// grab a free entry
+	int32 EntryIndex = FreeHead;
+
+	if (EntryIndex != INDEX_NONE)
+	{
+		FreeHead = Entries[EntryIndex].NextInSlot;
+	}
+	else
+	{
+		EntryIndex = Entries.AddDefaulted();
+	}
+
+	// always wait at least one tick so timers never fire during the frame they were scheduled in
+	const uint64 DelayTicks = FMath::Max<uint64>(1, static_cast<uint64>(FMath::CeilToDouble(FMath::Max(Delay, 0.0f) / TickSeconds)));
+
+	FEntry& Entry = Entries[EntryIndex];
+	Entry.Owner = FObjectKey(Owner);
+	Entry.Callback = Callback;
+	Entry.ExpireTick = CurrentTick + DelayTicks;
+
+	// link the entry at the head of its owner's list
+	int32& OwnerHead = OwnerHeads.FindOrAdd(Entry.Owner, INDEX_NONE);
+
+	Entry.PrevOfOwner = INDEX_NONE;
+	Entry.NextOfOwner = OwnerHead;
+
+	if (OwnerHead != INDEX_NONE)
+	{
+		Entries[OwnerHead].PrevOfOwner = EntryIndex;
+	}
+
+	OwnerHead = EntryIndex;
+
+	InsertIntoWheel(EntryIndex);
+
+	++NumPending;
+	INC_DWORD_STAT(STAT_GameplayTimersPending);
+}
+
+void UGameplayTimerSubsystem::CancelAll(const UObject* Owner)
+{
+	CancelInBatch(Owner, nullptr);
+
+	const int32* OwnerHead = OwnerHeads.Find(FObjectKey(Owner));
+
+	if (!OwnerHead)
+	{
+		return;
+	}
+
+	// tombstone every entry. They'll be freed when the wheel reaches their slot
+	for (int32 EntryIndex = *OwnerHead; EntryIndex != INDEX_NONE; EntryIndex = Entries[EntryIndex].NextOfOwner)
+	{
+		Entries[EntryIndex].Callback = nullptr;
+
+		--NumPending;
+		DEC_DWORD_STAT(STAT_GameplayTimersPending);
+	}
+
+	OwnerHeads.Remove(FObjectKey(Owner));
+}
+
+void UGameplayTimerSubsystem::CancelCallback(const UObject* Owner, FCallback Callback)
+{
+	CancelInBatch(Owner, Callback);
+
+	const int32* OwnerHead = OwnerHeads.Find(FObjectKey(Owner));
+	int32 EntryIndex = OwnerHead ? *OwnerHead : INDEX_NONE;
+
+	while (EntryIndex != INDEX_NONE)
+	{
+		const int32 NextIndex = Entries[EntryIndex].NextOfOwner;
+
+		if (Entries[EntryIndex].Callback == Callback)
+		{
+			UnlinkFromOwner(EntryIndex);
+			Entries[EntryIndex].Callback = nullptr;
+
+			--NumPending;
+			DEC_DWORD_STAT(STAT_GameplayTimersPending);
+		}
+
+		EntryIndex = NextIndex;
+	}
+}
+
+bool UGameplayTimerSubsystem::IsCallbackScheduled(const UObject* Owner, FCallback Callback) const
+{
+	const int32* OwnerHead = OwnerHeads.Find(FObjectKey(Owner));
+
+	for (int32 EntryIndex = OwnerHead ? *OwnerHead : INDEX_NONE; EntryIndex != INDEX_NONE; EntryIndex = Entries[EntryIndex].NextOfOwner)
+	{
+		if (Entries[EntryIndex].Callback == Callback)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UGameplayTimerSubsystem::InsertIntoWheel(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+	const uint64 TicksLeft = Entry.ExpireTick - CurrentTick;
+
+	// find the lowest level whose range covers the remaining time
+	int32 Level = 0;
+
+	while (Level < NumLevels - 1 && TicksLeft >= (uint64(1) << ((Level + 1) * SlotBits)))
+	{
+		++Level;
+	}
+
+	// clamp timers beyond the top level's range. They'll be cascaded again when they come around
+	const uint64 SlotTick = FMath::Min(Entry.ExpireTick, CurrentTick + (uint64(1) << (NumLevels * SlotBits)) - 1);
+	const int32 Slot = static_cast<int32>((SlotTick >> (Level * SlotBits)) & (SlotsPerLevel - 1));
+
+	Entry.NextInSlot = Slots[Level][Slot];
+	Slots[Level][Slot] = EntryIndex;
+}
+
+void UGameplayTimerSubsystem::Cascade(int32 Level)
+{
+	const int32 Slot = static_cast<int32>((CurrentTick >> (Level * SlotBits)) & (SlotsPerLevel - 1));
+
+	// detach the slot list, then reinsert each entry relative to the current tick
+	int32 EntryIndex = Slots[Level][Slot];
+	Slots[Level][Slot] = INDEX_NONE;
+
+	while (EntryIndex != INDEX_NONE)
+	{
+		const int32 NextIndex = Entries[EntryIndex].NextInSlot;
+
+		if (Entries[EntryIndex].Callback)
+		{
+			InsertIntoWheel(EntryIndex);
+			INC_DWORD_STAT(STAT_GameplayTimersCascaded);
+		}
+		else
+		{
+			FreeEntry(EntryIndex);
+		}
+
+		EntryIndex = NextIndex;
+	}
+}
+
+void UGameplayTimerSubsystem::CollectExpired()
+{
+	const int32 Slot = static_cast<int32>(CurrentTick & (SlotsPerLevel - 1));
+
+	int32 EntryIndex = Slots[0][Slot];
+	Slots[0][Slot] = INDEX_NONE;
+
+	const int32 FirstCollected = ExpiredBatch.Num();
+
+	while (EntryIndex != INDEX_NONE)
+	{
+		const int32 NextIndex = Entries[EntryIndex].NextInSlot;
+		FEntry& Entry = Entries[EntryIndex];
+
+		if (Entry.Callback)
+		{
+			// copy the entry into the batch and release it
+			ExpiredBatch.Add(Entry);
+			UnlinkFromOwner(EntryIndex);
+
+			--NumPending;
+			DEC_DWORD_STAT(STAT_GameplayTimersPending);
+		}
+
+		FreeEntry(EntryIndex);
+
+		EntryIndex = NextIndex;
+	}
+
+	// slot lists are LIFO, so flip this tick's entries back into scheduling order
+	Algo::Reverse(MakeArrayView(ExpiredBatch.GetData() + FirstCollected, ExpiredBatch.Num() - FirstCollected));
+}
+
+void UGameplayTimerSubsystem::CancelInBatch(const UObject* Owner, FCallback Callback)
+{
+	// only the entries after the one being fired can still be stopped
+	if (FiringIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	const FObjectKey OwnerKey(Owner);
+
+	for (int32 BatchIndex = FiringIndex + 1; BatchIndex < ExpiredBatch.Num(); ++BatchIndex)
+	{
+		FEntry& Expired = ExpiredBatch[BatchIndex];
+
+		if (Expired.Owner == OwnerKey && (!Callback || Expired.Callback == Callback))
+		{
+			Expired.Callback = nullptr;
+		}
+	}
+}
+
+void UGameplayTimerSubsystem::UnlinkFromOwner(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+
+	if (Entry.PrevOfOwner != INDEX_NONE)
+	{
+		Entries[Entry.PrevOfOwner].NextOfOwner = Entry.NextOfOwner;
+	}
+	else
+	{
+		// the entry was the head of the owner's list
+		if (Entry.NextOfOwner != INDEX_NONE)
+		{
+			OwnerHeads.Add(Entry.Owner, Entry.NextOfOwner);
+		}
+		else
+		{
+			OwnerHeads.Remove(Entry.Owner);
+		}
+	}
+
+	if (Entry.NextOfOwner != INDEX_NONE)
+	{
+		Entries[Entry.NextOfOwner].PrevOfOwner = Entry.PrevOfOwner;
+	}
+
+	Entry.PrevOfOwner = INDEX_NONE;
+	Entry.NextOfOwner = INDEX_NONE;
+}
+
+void UGameplayTimerSubsystem::FreeEntry(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+	Entry.Owner = FObjectKey();
+	Entry.Callback = nullptr;
+	Entry.NextInSlot = FreeHead;
+
+	FreeHead = EntryIndex;
+}
@@ -0,0 +1,185 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "Stats/Stats.h"
+#include "GameplayTimerSubsystem.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("Gameplay Timers"), STATGROUP_GameplayTimers, STATCAT_Advanced);
+
+/**
+ *  Centralized scheduler for one-shot gameplay delays, built as a hierarchical timer wheel.
+ *  Timers are plain entries holding a weak owner and a function pointer, so there are no handles to store or clear.
+ *  Scheduling and cancelling are O(1). Timers are cancelled by owner, either all at once or for a single method.
+ *  Time is quantized to TickSeconds and follows world time, so timers respect pause and time dilation.
+ *  All timers expiring in the same frame are collected first and then fired as a single batch in expiry order,
+ *  so callbacks can safely schedule or cancel other timers. Cancelling a timer that's later in the batch stops it from firing.
+ *
+ *  Usage:
+ *    GetWorld()->GetSubsystem<UGameplayTimerSubsystem>()->Schedule<&AMyActor::OnDelayFinished>(this, Delay);
+ */
+UCLASS()
+class UGameplayTimerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Callback type stored in the entries */
+	using FCallback = void (*)(UObject*);
+
+	/** Wheel resolution, in seconds */
+	static constexpr double TickSeconds = 0.01;
+
+protected:
+
+	/** Number of bits of the tick counter covered by each wheel level */
+	static constexpr int32 SlotBits = 6;
+
+	/** Number of slots in each wheel level */
+	static constexpr int32 SlotsPerLevel = 1 << SlotBits;
+
+	/** Number of wheel levels. Four levels of 64 slots cover about 46 hours at 10ms resolution */
+	static constexpr int32 NumLevels = 4;
+
+	/** A scheduled timer. Cancelled entries stay in their slot with a null callback until the slot is processed */
+	struct FEntry
+	{
+		/** Object the callback will be called on */
+		FObjectKey Owner;
+
+		/** Function to call, or nullptr if the entry is cancelled or free */
+		FCallback Callback = nullptr;
+
+		/** Wheel tick this timer expires at */
+		uint64 ExpireTick = 0;
+
+		/** Next entry in the same wheel slot, or in the free list */
+		int32 NextInSlot = INDEX_NONE;
+
+		/** Previous and next entries scheduled by the same owner */
+		int32 PrevOfOwner = INDEX_NONE;
+		int32 NextOfOwner = INDEX_NONE;
+	};
+
+	/** Entry storage */
+	TArray<FEntry> Entries;
+
+	/** Head of the free entry list */
+	int32 FreeHead = INDEX_NONE;
+
+	/** Head of the entry list for each wheel slot */
+	int32 Slots[NumLevels][SlotsPerLevel];
+
+	/** Head of the entry list for each owner */
+	TMap<FObjectKey, int32> OwnerHeads;
+
+	/** Last processed wheel tick */
+	uint64 CurrentTick = 0;
+
+	/** Number of live timers */
+	int32 NumPending = 0;
+
+	/** Timers collected for firing this frame */
+	TArray<FEntry> ExpiredBatch;
+
+	/** Index of the batch entry being fired, or INDEX_NONE outside of firing */
+	int32 FiringIndex = INDEX_NONE;
+
+public:
+
+	/** Constructor */
+	UGameplayTimerSubsystem();
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Starts the wheel at the current world time */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Advances the wheel and fires the expired timers */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Calls Method on Owner after Delay seconds */
+	template<auto Method, typename OwnerType>
+	void Schedule(OwnerType* Owner, float Delay)
+	{
+		ScheduleCallback(Owner, &Thunk<Method, OwnerType>, Delay);
+	}
+
+	/** Cancels every pending call to Method on Owner */
+	template<auto Method, typename OwnerType>
+	void Cancel(const OwnerType* Owner)
+	{
+		CancelCallback(Owner, &Thunk<Method, OwnerType>);
+	}
+
+	/** Cancels any pending call to Method on Owner and schedules a new one after Delay seconds */
+	template<auto Method, typename OwnerType>
+	void Reschedule(OwnerType* Owner, float Delay)
+	{
+		CancelCallback(Owner, &Thunk<Method, OwnerType>);
+		ScheduleCallback(Owner, &Thunk<Method, OwnerType>, Delay);
+	}
+
+	/** Cancels every pending timer scheduled for Owner */
+	void CancelAll(const UObject* Owner);
+
+	/** Returns true if Owner has a pending call to Method */
+	template<auto Method, typename OwnerType>
+	bool IsScheduled(const OwnerType* Owner) const
+	{
+		return IsCallbackScheduled(Owner, &Thunk<Method, OwnerType>);
+	}
+
+	/** Returns the number of pending timers */
+	int32 GetNumPending() const { return NumPending; }
+
+protected:
+
+	/** Calls the templated method on the owner */
+	template<auto Method, typename OwnerType>
+	static void Thunk(UObject* Owner)
+	{
+		(static_cast<OwnerType*>(Owner)->*Method)();
+	}
+
+	/** Adds a timer entry */
+	void ScheduleCallback(UObject* Owner, FCallback Callback, float Delay);
+
+	/** Cancels the owner's entries using the provided callback */
+	void CancelCallback(const UObject* Owner, FCallback Callback);
+
+	/** Returns true if the owner has a live entry using the provided callback */
+	bool IsCallbackScheduled(const UObject* Owner, FCallback Callback) const;
+
+	/** Links an entry into the wheel slot matching its expire tick */
+	void InsertIntoWheel(int32 EntryIndex);
+
+	/** Moves the entries of a higher level slot down the wheel */
+	void Cascade(int32 Level);
+
+	/** Collects the expired entries of the current level 0 slot into the batch */
+	void CollectExpired();
+
+	/** Stops the owner's batch entries that haven't fired yet from firing. A null callback matches every entry */
+	void CancelInBatch(const UObject* Owner, FCallback Callback);
+
+	/** Unlinks an entry from its owner list */
+	void UnlinkFromOwner(int32 EntryIndex);
+
+	/** Returns an entry to the free list */
+	void FreeEntry(int32 EntryIndex);
+
+	/** Returns the wheel tick for the current world time */
+	uint64 GetWorldTick() const;
+};
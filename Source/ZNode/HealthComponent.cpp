@@ -2,6 +2,7 @@
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "BoneTransformCacheComponent.h"
 
 UHealthComponent::UHealthComponent()
 {
@@ -21,6 +22,13 @@ void UHealthComponent::BeginPlay()
 	{
 		Owner->OnTakePointDamage.AddDynamic(this, &UHealthComponent::HandlePointDamage);
 		Owner->OnTakeAnyDamage.AddDynamic(this, &UHealthComponent::HandleAnyDamage);
+
+		// Resolve o socket "head" uma vez s, em vez de a cada tiro
+		BoneCache = Owner->FindComponentByClass<UBoneTransformCacheComponent>();
+		if (BoneCache)
+		{
+			HeadSlot = BoneCache->FindSlot(TEXT("head"));
+		}
 	}
 
 	if (bDebugDamage)
@@ -78,20 +86,21 @@ void UHealthComponent::HandlePointDamage(AActor* DamagedActor, float Damage, ACo
 	// 2) Fallback por proximidade do socket "head"
 	if (!bIsHeadshot && HeadshotProximityRadius > 0.f)
 	{
-		if (ACharacter* Char = Cast<ACharacter>(DamagedActor))
+		static const FName HeadName(TEXT("head"));
+		FVector HeadLocation;
+
+		// Com cache: leitura direta do slot; sem cache: lookup no mesh
+		const bool bHasHead = BoneCache
+			? BoneCache->GetSocketLocation(HeadSlot, HeadLocation)
+			: UBoneTransformCacheComponent::FindSocketLocation(DamagedActor, HeadName, HeadLocation);
+
+		if (bHasHead)
 		{
-			if (USkeletalMeshComponent* Skel = Char->GetMesh())
+			const float DistToHead = FVector::Distance(HeadLocation, HitLocation);
+			if (DistToHead <= HeadshotProximityRadius)
 			{
-				static const FName HeadName(TEXT("head"));
-				if (Skel->DoesSocketExist(HeadName))
-				{
-					const float DistToHead = FVector::Distance(Skel->GetSocketLocation(HeadName), HitLocation);
-					if (DistToHead <= HeadshotProximityRadius)
-					{
-						bIsHeadshot = true;
-						BoneName = HeadName;
-					}
-				}
+				bIsHeadshot = true;
+				BoneName = HeadName;
 			}
 		}
 	}
@@ -80,4 +80,10 @@ private:
 
 	/** Evita contar duas vezes quando a engine dispara AnyDamage alm de PointDamage */
 	bool bBlockNextAnyDamage = false;
+
+	/** Cache de transforms do dono (se tiver) + slot do socket "head", resolvidos no BeginPlay */
+	UPROPERTY(Transient)
+	class UBoneTransformCacheComponent* BoneCache = nullptr;
+
+	int32 HeadSlot = INDEX_NONE;
 };
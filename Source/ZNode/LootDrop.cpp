@@ -0,0 +1,58 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "LootDrop.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "UObject/ConstructorHelpers.h"
+
+FLootDropTable::FLootDropTable()
+	: DropClass(ALootDrop::StaticClass())
+{
+}
+
+ALootDrop::ALootDrop()
+{
+	// collection is handled by the loot drop subsystem
+	PrimaryActorTick.bCanEverTick = false;
+
+	// create the mesh
+	RootComponent = Mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
+
+	// drops are collected through distance tests, so they don't need any collision
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetGenerateOverlapEvents(false);
+	Mesh->SetCanEverAffectNavigation(false);
+	Mesh->SetMobility(EComponentMobility::Movable);
+
+	// placeholder meshes, so the drops show up without a Blueprint subclass
+	static ConstructorHelpers::FObjectFinder<UStaticMesh> CubeMesh(TEXT("/Engine/BasicShapes/Cube.Cube"));
+	static ConstructorHelpers::FObjectFinder<UStaticMesh> SphereMesh(TEXT("/Engine/BasicShapes/Sphere.Sphere"));
+
+	AmmoMesh = CubeMesh.Object;
+	HealthMesh = SphereMesh.Object;
+
+	Mesh->SetRelativeScale3D(FVector(0.3f));
+
+	// start in the pool
+	SetActorHiddenInGame(true);
+}
+
+void ALootDrop::ActivateDrop(ELootDropType Type, const FVector& Location)
+{
+	// swap the mesh for the loot type
+	if (UStaticMesh* TypeMesh = Type == ELootDropType::Ammo ? AmmoMesh : HealthMesh)
+	{
+		Mesh->SetStaticMesh(TypeMesh);
+	}
+
+	SetActorLocation(Location);
+	SetActorHiddenInGame(false);
+
+	BP_OnDropActivated(Type);
+}
+
+void ALootDrop::DeactivateDrop()
+{
+	SetActorHiddenInGame(true);
+}
@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "LootDrop.generated.h"
+
+class UStaticMeshComponent;
+class UStaticMesh;
+
+/** Kinds of loot a drop can hold */
+UENUM(BlueprintType)
+enum class ELootDropType : uint8
+{
+	Ammo,
+	Health
+};
+
+/** What an actor drops when it dies */
+USTRUCT(BlueprintType)
+struct FLootDropTable
+{
+	GENERATED_BODY()
+
+	/** Constructor */
+	FLootDropTable();
+
+	/** Pooled drop actor to use. Defaults to the native drop, which shows engine basic shapes */
+	UPROPERTY(EditAnywhere, Category="Loot")
+	TSubclassOf<class ALootDrop> DropClass;
+
+	/** Chance of dropping ammo */
+	UPROPERTY(EditAnywhere, Category="Loot", meta = (ClampMin = 0, ClampMax = 1))
+	float AmmoChance = 0.35f;
+
+	/** Rounds added to the collector's reserve ammo */
+	UPROPERTY(EditAnywhere, Category="Loot", meta = (ClampMin = 1))
+	int32 AmmoAmount = 12;
+
+	/** Chance of dropping health. Off by default, since only pawns with a damaged health component can collect it */
+	UPROPERTY(EditAnywhere, Category="Loot", meta = (ClampMin = 0, ClampMax = 1))
+	float HealthChance = 0.0f;
+
+	/** HP restored to the collector */
+	UPROPERTY(EditAnywhere, Category="Loot", meta = (ClampMin = 0))
+	float HealthAmount = 25.0f;
+
+	/** Max horizontal distance between the drops and the death location */
+	UPROPERTY(EditAnywhere, Category="Loot", meta = (ClampMin = 0, Units = "cm"))
+	float ScatterRadius = 60.0f;
+
+	/** Number of drops of this class to keep in the pool ahead of time */
+	UPROPERTY(EditAnywhere, Category="Loot", meta = (ClampMin = 0))
+	int32 PrewarmedDrops = 32;
+};
+
+/**
+ *  A pooled ammo or health pickup.
+ *  Drops are owned and recycled by the loot drop subsystem, which also checks for collection with distance tests
+ *  against the player pawns, so drops don't tick or generate overlap events.
+ *  Inactive drops are hidden and kept around to be reused.
+ *  Works as is with placeholder meshes. Blueprint subclasses can swap the meshes and add effects.
+ */
+UCLASS()
+class ALootDrop : public AActor
+{
+	GENERATED_BODY()
+
+	/** Pickup mesh */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category ="Components", meta = (AllowPrivateAccess = "true"))
+	UStaticMeshComponent* Mesh;
+
+protected:
+
+	/** Mesh shown for ammo drops. Defaults to the engine cube */
+	UPROPERTY(EditAnywhere, Category="Loot")
+	UStaticMesh* AmmoMesh = nullptr;
+
+	/** Mesh shown for health drops. Defaults to the engine sphere */
+	UPROPERTY(EditAnywhere, Category="Loot")
+	UStaticMesh* HealthMesh = nullptr;
+
+public:
+
+	/** Constructor */
+	ALootDrop();
+
+	/** Takes the drop out of the pool and places it in the world */
+	void ActivateDrop(ELootDropType Type, const FVector& Location);
+
+	/** Hides the drop so it can return to the pool */
+	void DeactivateDrop();
+
+	/** Plays the pickup effects */
+	void NotifyPickedUp(ELootDropType Type, APawn* Collector) { BP_OnPickedUp(Type, Collector); }
+
+protected:
+
+	/** Passes control to BP to play effects when the drop appears */
+	UFUNCTION(BlueprintImplementableEvent, Category="Loot", meta=(DisplayName = "On Drop Activated"))
+	void BP_OnDropActivated(ELootDropType Type);
+
+	/** Passes control to BP to play effects on pickup */
+	UFUNCTION(BlueprintImplementableEvent, Category="Loot", meta=(DisplayName = "On Picked Up"))
+	void BP_OnPickedUp(ELootDropType Type, APawn* Collector);
+};
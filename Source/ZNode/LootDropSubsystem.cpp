@@ -0,0 +1,338 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "LootDropSubsystem.h"
+#include "ZNodeCharacter.h"
+#include "WeaponBase.h"
+#include "HealthComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Loot Collection"), STAT_LootDropCollection, STATGROUP_LootDrops);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Loot Drop Actors"), STAT_LootDropActors, STATGROUP_LootDrops);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Loot Drops"), STAT_LootDropActive, STATGROUP_LootDrops);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Loot Distance Tests"), STAT_LootDropTests, STATGROUP_LootDrops);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Loot Drops Recycled"), STAT_LootDropRecycled, STATGROUP_LootDrops);
+
+namespace LootDrops
+{
+	static float CollectRadius = 100.0f;
+	static FAutoConsoleVariableRef CVarCollectRadius(
+		TEXT("ZNode.Loot.CollectRadius"),
+		CollectRadius,
+		TEXT("Distance from a player pawn at which loot drops are collected."));
+
+	static float Lifetime = 30.0f;
+	static FAutoConsoleVariableRef CVarLifetime(
+		TEXT("ZNode.Loot.Lifetime"),
+		Lifetime,
+		TEXT("Time before an uncollected loot drop returns to the pool, in seconds."));
+
+	static int32 MaxDrops = 256;
+	static FAutoConsoleVariableRef CVarMaxDrops(
+		TEXT("ZNode.Loot.MaxDrops"),
+		MaxDrops,
+		TEXT("Max number of loot drop actors. Once reached, the oldest active drop is recycled for new drops."));
+}
+
+bool ULootDropSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void ULootDropSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (UGameplayRandomSubsystem* Random = InWorld.GetSubsystem<UGameplayRandomSubsystem>())
+	{
+		RandomStream = Random->MakeStream(FName(TEXT("LootDrops")));
+	}
+}
+
+void ULootDropSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_LootDropActors, Drops.Num());
+	DEC_DWORD_STAT_BY(STAT_LootDropActive, ActiveDrops.Num());
+
+	// the drop actors are destroyed with the world
+	Drops.Empty();
+	DropLocations.Empty();
+	DropTypes.Empty();
+	DropAmounts.Empty();
+	DropExpireTimes.Empty();
+	ActiveDrops.Empty();
+	FreeDrops.Empty();
+	PlayerPawns.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId ULootDropSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULootDropSubsystem, STATGROUP_Tickables);
+}
+
+void ULootDropSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_LootDropCollection);
+
+	if (ActiveDrops.IsEmpty())
+	{
+		return;
+	}
+
+	// gather the player pawns
+	PlayerPawns.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			PlayerPawns.Add(Pawn);
+		}
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float CollectRadiusSquared = FMath::Square(LootDrops::CollectRadius);
+
+	// iterate backwards so released drops can be swapped out
+	for (int32 ActiveIndex = ActiveDrops.Num() - 1; ActiveIndex >= 0; --ActiveIndex)
+	{
+		const int32 DropIndex = ActiveDrops[ActiveIndex];
+
+		// has the drop expired?
+		if (Now >= DropExpireTimes[DropIndex])
+		{
+			ReleaseDrop(ActiveIndex);
+			continue;
+		}
+
+		// is a player close enough to collect it?
+		for (APawn* Pawn : PlayerPawns)
+		{
+			INC_DWORD_STAT(STAT_LootDropTests);
+
+			if (FVector::DistSquared(Pawn->GetActorLocation(), DropLocations[DropIndex]) > CollectRadiusSquared)
+			{
+				continue;
+			}
+
+			if (GiveLoot(DropIndex, Pawn))
+			{
+				Drops[DropIndex]->NotifyPickedUp(DropTypes[DropIndex], Pawn);
+
+				ReleaseDrop(ActiveIndex);
+				break;
+			}
+		}
+	}
+}
+
+void ULootDropSubsystem::Prewarm(TSubclassOf<ALootDrop> DropClass, int32 Count)
+{
+	if (!DropClass)
+	{
+		return;
+	}
+
+	// count the drops of this class we already have
+	int32 NumExisting = 0;
+
+	for (const ALootDrop* Drop : Drops)
+	{
+		NumExisting += Drop && Drop->GetClass() == DropClass.Get() ? 1 : 0;
+	}
+
+	const int32 NumToCreate = FMath::Min(Count - NumExisting, LootDrops::MaxDrops - Drops.Num());
+
+	for (int32 Index = 0; Index < NumToCreate; ++Index)
+	{
+		const int32 DropIndex = CreateDrop(DropClass);
+
+		if (DropIndex == INDEX_NONE)
+		{
+			break;
+		}
+
+		FreeDrops.FindOrAdd(DropClass.Get()).Add(DropIndex);
+	}
+}
+
+void ULootDropSubsystem::SpawnDrops(const FVector& Location, const FLootDropTable& Table)
+{
+	if (!Table.DropClass)
+	{
+		return;
+	}
+
+	// roll each loot type
+	auto RollDrop = [&](ELootDropType Type, float Chance, float Amount)
+	{
+		if (RandomStream.FRand() >= Chance)
+		{
+			return;
+		}
+
+		// scatter around the death location
+		const float Angle = RandomStream.FRandRange(0.0f, UE_TWO_PI);
+		const float Distance = Table.ScatterRadius * FMath::Sqrt(RandomStream.FRand());
+		const FVector Offset(FMath::Cos(Angle) * Distance, FMath::Sin(Angle) * Distance, 0.0f);
+
+		SpawnDrop(Table.DropClass, Type, Amount, FindGroundLocation(Location + Offset));
+	};
+
+	RollDrop(ELootDropType::Ammo, Table.AmmoChance, static_cast<float>(Table.AmmoAmount));
+	RollDrop(ELootDropType::Health, Table.HealthChance, Table.HealthAmount);
+}
+
+void ULootDropSubsystem::SpawnDrop(TSubclassOf<ALootDrop> DropClass, ELootDropType Type, float Amount, const FVector& Location)
+{
+	if (!DropClass)
+	{
+		return;
+	}
+
+	const int32 DropIndex = AcquireDrop(DropClass);
+
+	if (DropIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	DropLocations[DropIndex] = Location;
+	DropTypes[DropIndex] = Type;
+	DropAmounts[DropIndex] = Amount;
+	DropExpireTimes[DropIndex] = GetWorld()->GetTimeSeconds() + LootDrops::Lifetime;
+
+	ActiveDrops.Add(DropIndex);
+	INC_DWORD_STAT(STAT_LootDropActive);
+
+	Drops[DropIndex]->ActivateDrop(Type, Location);
+}
+
+int32 ULootDropSubsystem::AcquireDrop(UClass* DropClass)
+{
+	// take a pooled drop if we have one
+	if (TArray<int32>* Free = FreeDrops.Find(DropClass))
+	{
+		if (Free->Num() > 0)
+		{
+			return Free->Pop(EAllowShrinking::No);
+		}
+	}
+
+	// grow the pool while we're under the limit
+	if (Drops.Num() < LootDrops::MaxDrops)
+	{
+		return CreateDrop(DropClass);
+	}
+
+	// otherwise recycle the oldest active drop of this class
+	int32 OldestActive = INDEX_NONE;
+
+	for (int32 ActiveIndex = 0; ActiveIndex < ActiveDrops.Num(); ++ActiveIndex)
+	{
+		const int32 DropIndex = ActiveDrops[ActiveIndex];
+
+		if (Drops[DropIndex]->GetClass() == DropClass && (OldestActive == INDEX_NONE || DropExpireTimes[DropIndex] < DropExpireTimes[ActiveDrops[OldestActive]]))
+		{
+			OldestActive = ActiveIndex;
+		}
+	}
+
+	if (OldestActive == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	INC_DWORD_STAT(STAT_LootDropRecycled);
+
+	// the released drop goes to the back of the free list
+	ReleaseDrop(OldestActive);
+
+	return FreeDrops.FindChecked(DropClass).Pop(EAllowShrinking::No);
+}
+
+int32 ULootDropSubsystem::CreateDrop(UClass* DropClass)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	ALootDrop* Drop = GetWorld()->SpawnActor<ALootDrop>(DropClass, FTransform::Identity, SpawnParams);
+
+	if (!Drop)
+	{
+		return INDEX_NONE;
+	}
+
+	Drop->DeactivateDrop();
+
+	DropLocations.AddZeroed();
+	DropTypes.Add(ELootDropType::Ammo);
+	DropAmounts.Add(0.0f);
+	DropExpireTimes.Add(0.0);
+
+	INC_DWORD_STAT(STAT_LootDropActors);
+
+	return Drops.Add(Drop);
+}
+
+void ULootDropSubsystem::ReleaseDrop(int32 ActiveIndex)
+{
+	const int32 DropIndex = ActiveDrops[ActiveIndex];
+	ActiveDrops.RemoveAtSwap(ActiveIndex, EAllowShrinking::No);
+
+	DEC_DWORD_STAT(STAT_LootDropActive);
+
+	ALootDrop* Drop = Drops[DropIndex];
+	Drop->DeactivateDrop();
+
+	FreeDrops.FindOrAdd(Drop->GetClass()).Add(DropIndex);
+}
+
+bool ULootDropSubsystem::GiveLoot(int32 DropIndex, APawn* Pawn) const
+{
+	switch (DropTypes[DropIndex])
+	{
+		case ELootDropType::Ammo:
+		{
+			// top up the reserve of the collector's weapon
+			const AZNodeCharacter* Character = Cast<AZNodeCharacter>(Pawn);
+			AWeaponBase* Weapon = Character ? Character->GetCurrentWeapon() : nullptr;
+
+			return Weapon && Weapon->AddReserveAmmo(FMath::RoundToInt32(DropAmounts[DropIndex]));
+		}
+
+		case ELootDropType::Health:
+		{
+			// only heal pawns that are hurt
+			UHealthComponent* Health = Pawn->FindComponentByClass<UHealthComponent>();
+
+			if (!Health || Health->IsDead() || Health->CurrentHealth >= Health->MaxHealth)
+			{
+				return false;
+			}
+
+			Health->Heal(DropAmounts[DropIndex]);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+FVector ULootDropSubsystem::FindGroundLocation(const FVector& Location) const
+{
+	FHitResult Hit;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(LootDropGround), false);
+
+	// drop straight down from the death location
+	if (GetWorld()->LineTraceSingleByChannel(Hit, Location, Location - FVector(0.0f, 0.0f, GroundTraceDistance), ECC_WorldStatic, QueryParams))
+	{
+		return Hit.ImpactPoint;
+	}
+
+	return Location;
+}
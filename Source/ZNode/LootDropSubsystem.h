@@ -0,0 +1,110 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Stats/Stats.h"
+#include "GameplayRandomSubsystem.h"
+#include "LootDrop.h"
+#include "LootDropSubsystem.generated.h"
+
+class APawn;
+
+DECLARE_STATS_GROUP(TEXT("Loot Drops"), STATGROUP_LootDrops, STATCAT_Advanced);
+
+/**
+ *  Spawns ammo and health drops from a recycled pool of drop actors.
+ *  Actors that die roll their loot table here. The drops are taken from the pool, and new actors are only spawned
+ *  while the pool is still growing towards its peak size. Once ZNode.Loot.MaxDrops are active, the oldest drop is recycled.
+ *  Once per frame, the active drops run a distance test against the player pawns instead of relying on physics overlaps.
+ *  Collected and expired drops are hidden and returned to the pool.
+ *  Drop rolls use their own gameplay random stream, so they can be reproduced for the same session seed.
+ *
+ *  Usage:
+ *    GetWorld()->GetSubsystem<ULootDropSubsystem>()->SpawnDrops(GetActorLocation(), LootTable);
+ */
+UCLASS()
+class ULootDropSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Every drop actor, active or pooled */
+	UPROPERTY(Transient)
+	TArray<ALootDrop*> Drops;
+
+	/** World location of each drop */
+	TArray<FVector> DropLocations;
+
+	/** Loot held by each drop */
+	TArray<ELootDropType> DropTypes;
+
+	/** Amount of ammo or health held by each drop */
+	TArray<float> DropAmounts;
+
+	/** World time each drop expires at */
+	TArray<double> DropExpireTimes;
+
+	/** Indices of the active drops */
+	TArray<int32> ActiveDrops;
+
+	/** Indices of the pooled drops, for each drop class */
+	TMap<const UClass*, TArray<int32>> FreeDrops;
+
+	/** Player pawns gathered this frame */
+	TArray<APawn*> PlayerPawns;
+
+	/** Random stream for the loot rolls */
+	FGameplayRandomStream RandomStream;
+
+	/** Max distance the ground is searched for below a drop */
+	static constexpr float GroundTraceDistance = 500.0f;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Creates the random stream */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Collects and expires the active drops */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Makes sure the pool holds at least Count drops of the provided class */
+	void Prewarm(TSubclassOf<ALootDrop> DropClass, int32 Count);
+
+	/** Rolls a loot table and places the resulting drops around the location */
+	void SpawnDrops(const FVector& Location, const FLootDropTable& Table);
+
+	/** Places a single drop at the location */
+	void SpawnDrop(TSubclassOf<ALootDrop> DropClass, ELootDropType Type, float Amount, const FVector& Location);
+
+	/** Returns the number of drops in the world */
+	int32 GetNumActiveDrops() const { return ActiveDrops.Num(); }
+
+protected:
+
+	/** Returns a pooled drop of the provided class, spawning or recycling one if needed. Returns INDEX_NONE on failure */
+	int32 AcquireDrop(UClass* DropClass);
+
+	/** Spawns a new, inactive drop. Returns INDEX_NONE on failure */
+	int32 CreateDrop(UClass* DropClass);
+
+	/** Hides an active drop and returns it to the pool */
+	void ReleaseDrop(int32 ActiveIndex);
+
+	/** Gives the drop's loot to a pawn. Returns false if the pawn can't use it */
+	bool GiveLoot(int32 DropIndex, APawn* Pawn) const;
+
+	/** Projects a location down to the ground */
+	FVector FindGroundLocation(const FVector& Location) const;
+};
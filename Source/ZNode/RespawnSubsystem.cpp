@@ -0,0 +1,261 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "RespawnSubsystem.h"
+#include "GameplayTimerSubsystem.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerStart.h"
+#include "WorldPartition/WorldPartitionSubsystem.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("Respawn Prewarm"), STAT_RespawnPrewarm, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("Respawn Possess"), STAT_RespawnPossess, STATGROUP_Game);
+
+bool URespawnSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URespawnSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	CachePlayerStarts();
+
+	// stream in the respawn areas
+	if (UWorldPartitionSubsystem* WorldPartition = InWorld.GetSubsystem<UWorldPartitionSubsystem>())
+	{
+		WorldPartition->RegisterStreamingSourceProvider(this);
+	}
+}
+
+void URespawnSubsystem::Deinitialize()
+{
+	if (UWorldPartitionSubsystem* WorldPartition = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>())
+	{
+		WorldPartition->UnregisterStreamingSourceProvider(this);
+	}
+
+	// the prewarmed pawns are destroyed along with the world
+	PendingRespawns.Empty();
+	PlayerStarts.Empty();
+
+	Super::Deinitialize();
+}
+
+bool URespawnSubsystem::GetStreamingSources(TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const
+{
+	for (const FPendingRespawn& Pending : PendingRespawns)
+	{
+		FWorldPartitionStreamingSource& Source = OutStreamingSources.AddDefaulted_GetRef();
+		Source.Name = TEXT("RespawnPrewarm");
+		Source.Location = Pending.Transform.GetLocation();
+		Source.Rotation = Pending.Transform.Rotator();
+		Source.TargetState = EStreamingSourceTargetState::Activated;
+		Source.Priority = EStreamingSourcePriority::High;
+	}
+
+	return !PendingRespawns.IsEmpty();
+}
+
+void URespawnSubsystem::CachePlayerStarts()
+{
+	PlayerStarts.Reset();
+
+	for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
+	{
+		PlayerStarts.Add(*It);
+	}
+}
+
+bool URespawnSubsystem::GetPlayerStartTransform(FTransform& OutTransform, int32 Index)
+{
+	// refresh the cache if a player start was streamed out
+	if (!PlayerStarts.IsValidIndex(Index) || !PlayerStarts[Index].IsValid())
+	{
+		CachePlayerStarts();
+	}
+
+	if (!PlayerStarts.IsValidIndex(Index))
+	{
+		return false;
+	}
+
+	OutTransform = PlayerStarts[Index]->GetActorTransform();
+	return true;
+}
+
+URespawnSubsystem::FPendingRespawn& URespawnSubsystem::FindOrAddPending(AController* Controller)
+{
+	for (FPendingRespawn& Pending : PendingRespawns)
+	{
+		if (Pending.Controller.Get() == Controller)
+		{
+			return Pending;
+		}
+	}
+
+	FPendingRespawn& Pending = PendingRespawns.AddDefaulted_GetRef();
+	Pending.Controller = Controller;
+
+	return Pending;
+}
+
+void URespawnSubsystem::PrepareRespawn(AController* Controller, TSubclassOf<APawn> PawnClass, const FTransform& Transform)
+{
+	if (!Controller || !PawnClass)
+	{
+		return;
+	}
+
+	FPendingRespawn& Pending = FindOrAddPending(Controller);
+	Pending.Transform = Transform;
+
+	// throw away the prewarmed pawn if the class changed
+	if (Pending.PawnClass != PawnClass && Pending.Pawn.IsValid())
+	{
+		Pending.Pawn->Destroy();
+	}
+
+	Pending.PawnClass = PawnClass;
+
+	if (!Pending.Pawn.IsValid())
+	{
+		PrewarmPawn(Pending);
+	}
+}
+
+void URespawnSubsystem::PrewarmPawn(FPendingRespawn& Pending)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RespawnPrewarm);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.bDeferConstruction = true;
+
+	APawn* Pawn = GetWorld()->SpawnActor<APawn>(Pending.PawnClass, Pending.Transform, SpawnParams);
+
+	if (!Pawn)
+	{
+		return;
+	}
+
+	// hide the pawn before it's ever rendered
+	Pawn->SetActorHiddenInGame(true);
+	Pawn->SetActorEnableCollision(false);
+
+	// run construction and BeginPlay now, while nobody is looking
+	Pawn->FinishSpawning(Pending.Transform);
+
+	// pause ticking until the pawn is needed
+	Pawn->SetActorTickEnabled(false);
+	Pending.PausedComponents.Reset();
+
+	for (UActorComponent* Component : Pawn->GetComponents())
+	{
+		if (Component && Component->IsComponentTickEnabled())
+		{
+			Component->SetComponentTickEnabled(false);
+			Pending.PausedComponents.Add(Component);
+		}
+	}
+
+	Pending.Pawn = Pawn;
+}
+
+void URespawnSubsystem::Respawn(AController* Controller, TSubclassOf<APawn> PawnClass, const FTransform& Transform)
+{
+	if (!Controller || !PawnClass)
+	{
+		return;
+	}
+
+	// prepare now if nobody did it ahead of time
+	PrepareRespawn(Controller, PawnClass, Transform);
+
+	FPendingRespawn& Pending = FindOrAddPending(Controller);
+	Pending.bWantsPossess = true;
+	Pending.RequestTime = GetWorld()->GetTimeSeconds();
+
+	// try right away, and keep polling if the area is still streaming in
+	if (!TryPossess(Pending))
+	{
+		if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+		{
+			Timers->Reschedule<&URespawnSubsystem::RetryPendingRespawns>(this, StreamingPollInterval);
+		}
+	}
+}
+
+bool URespawnSubsystem::TryPossess(FPendingRespawn& Pending)
+{
+	AController* Controller = Pending.Controller.Get();
+	APawn* Pawn = Pending.Pawn.Get();
+
+	// wait for the area to stream in, up to a point
+	const UWorldPartitionSubsystem* WorldPartition = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>();
+
+	if (WorldPartition && !WorldPartition->IsStreamingCompleted(this) && GetWorld()->GetTimeSeconds() - Pending.RequestTime < MaxStreamingWait)
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_RespawnPossess);
+
+	// the prewarmed pawn is gone, so fall back to spawning it now
+	if (Controller && !Pawn)
+	{
+		PrewarmPawn(Pending);
+		Pawn = Pending.Pawn.Get();
+	}
+
+	if (Controller && Pawn)
+	{
+		// move the pawn to the latest respawn transform
+		Pawn->SetActorTransform(Pending.Transform, false, nullptr, ETeleportType::ResetPhysics);
+
+		// wake it up
+		for (const TWeakObjectPtr<UActorComponent>& Component : Pending.PausedComponents)
+		{
+			if (Component.IsValid())
+			{
+				Component->SetComponentTickEnabled(true);
+			}
+		}
+
+		Pawn->SetActorTickEnabled(true);
+		Pawn->SetActorEnableCollision(true);
+		Pawn->SetActorHiddenInGame(false);
+
+		Controller->Possess(Pawn);
+	}
+
+	// this respawn is done
+	PendingRespawns.RemoveAll([&Pending](const FPendingRespawn& Other) { return &Other == &Pending; });
+
+	return true;
+}
+
+void URespawnSubsystem::RetryPendingRespawns()
+{
+	bool bStillWaiting = false;
+
+	for (int32 Index = PendingRespawns.Num() - 1; Index >= 0; --Index)
+	{
+		if (PendingRespawns[Index].bWantsPossess && !TryPossess(PendingRespawns[Index]))
+		{
+			bStillWaiting = true;
+		}
+	}
+
+	// keep polling
+	if (bStillWaiting)
+	{
+		if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+		{
+			Timers->Schedule<&URespawnSubsystem::RetryPendingRespawns>(this, StreamingPollInterval);
+		}
+	}
+}
@@ -0,0 +1,112 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldPartition/WorldPartitionStreamingSource.h"
+#include "RespawnSubsystem.generated.h"
+
+class AController;
+class APawn;
+class APlayerStart;
+
+/**
+ *  Keeps player respawns cheap.
+ *  Player starts are cached once instead of being searched for on every respawn.
+ *  A respawn can be prepared ahead of time, usually while the death camera is playing: the area around the
+ *  respawn point is streamed in through a world partition streaming source, and the pawn is spawned there
+ *  hidden, without collision and with ticking paused, so its BeginPlay, anim instance and widgets are paid for early.
+ *  When the respawn happens, the prewarmed pawn is teleported, woken up and possessed in a single step.
+ */
+UCLASS()
+class URespawnSubsystem : public UWorldSubsystem, public IWorldPartitionStreamingSourceProvider
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** A respawn being prepared for a controller */
+	struct FPendingRespawn
+	{
+		/** Controller that will possess the pawn */
+		TWeakObjectPtr<AController> Controller;
+
+		/** Class of the pawn to respawn */
+		TSubclassOf<APawn> PawnClass;
+
+		/** Where to respawn */
+		FTransform Transform;
+
+		/** Prewarmed pawn, waiting hidden at the respawn point */
+		TWeakObjectPtr<APawn> Pawn;
+
+		/** Components whose tick we paused while prewarming */
+		TArray<TWeakObjectPtr<UActorComponent>> PausedComponents;
+
+		/** If true, the respawn has been requested and is waiting for streaming to complete */
+		bool bWantsPossess = false;
+
+		/** World time the respawn was requested at */
+		double RequestTime = 0.0;
+	};
+
+	/** Respawns being prepared */
+	TArray<FPendingRespawn> PendingRespawns;
+
+	/** Cached player starts */
+	TArray<TWeakObjectPtr<APlayerStart>> PlayerStarts;
+
+	/** Max time to wait for the respawn area to stream in before possessing anyway */
+	static constexpr double MaxStreamingWait = 2.0;
+
+	/** Time between checks while waiting for streaming */
+	static constexpr float StreamingPollInterval = 0.1f;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Caches the player starts and registers the streaming source */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	// ~begin IWorldPartitionStreamingSourceProvider interface
+
+	/** Streams in the area around each pending respawn */
+	virtual bool GetStreamingSources(TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const override;
+
+	/** Returns the owner of the streaming sources */
+	virtual const UObject* GetStreamingSourceOwner() const override { return this; }
+
+	// ~end IWorldPartitionStreamingSourceProvider interface
+
+	/** Streams in the respawn area and prewarms a pawn there. Can be called again to update the transform */
+	void PrepareRespawn(AController* Controller, TSubclassOf<APawn> PawnClass, const FTransform& Transform);
+
+	/** Respawns the controller's pawn, using the prewarmed pawn if there's one. Possession may be delayed a little while the area streams in */
+	void Respawn(AController* Controller, TSubclassOf<APawn> PawnClass, const FTransform& Transform);
+
+	/** Returns the transform of a cached player start. Returns false if there's none */
+	bool GetPlayerStartTransform(FTransform& OutTransform, int32 Index = 0);
+
+protected:
+
+	/** Finds or adds the pending respawn for a controller */
+	FPendingRespawn& FindOrAddPending(AController* Controller);
+
+	/** Spawns the hidden, inactive pawn for a pending respawn */
+	void PrewarmPawn(FPendingRespawn& Pending);
+
+	/** Wakes up the prewarmed pawn and possesses it. Returns false if we should keep waiting for streaming */
+	bool TryPossess(FPendingRespawn& Pending);
+
+	/** Retries the respawns waiting on streaming */
+	void RetryPendingRespawns();
+
+	/** Rebuilds the player start cache */
+	void CachePlayerStarts();
+};
@@ -0,0 +1,103 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ServerAnimation.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/ObjectKey.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Server Skipped Meshes"), STAT_ServerAnimSkippedMeshes, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Server Lazy Poses"), STAT_ServerAnimLazyPoses, STATGROUP_Game);
+
+namespace ServerAnimation
+{
+	static bool bSkipPose = true;
+	static FAutoConsoleVariableRef CVarSkipPose(
+		TEXT("ZNode.ServerAnim.SkipPose"),
+		bSkipPose,
+		TEXT("If true, server character meshes that aren't rendered only tick montages, and their pose is evaluated on demand for hit tests."),
+		ECVF_Default);
+
+	/** Meshes whose pose was evaluated on demand this frame */
+	static TSet<TObjectKey<USkeletalMeshComponent>> PosedMeshes;
+
+	/** Meshes switched to montage-only ticking, so each one is counted once in the stats */
+	static TSet<TObjectKey<USkeletalMeshComponent>> SkippedMeshes;
+
+	/** Frame PosedMeshes belongs to */
+	static uint64 PosedMeshesFrame = MAX_uint64;
+
+	void ApplySkipping(USkeletalMeshComponent* Mesh)
+	{
+		if (!bSkipPose || !Mesh || !Mesh->GetWorld())
+		{
+			return;
+		}
+
+		// only servers need the bones without seeing the mesh
+		const ENetMode NetMode = Mesh->GetWorld()->GetNetMode();
+
+		if (NetMode != NM_DedicatedServer && NetMode != NM_ListenServer)
+		{
+			return;
+		}
+
+		// keep ticking montages so attack notifies still fire.
+		// This is the same option the VAT subsystem uses for hidden meshes, so it saves and restores it unchanged
+		Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+
+		// the enemy and its hitboxes can both apply skipping to the same mesh
+		bool bAlreadySkipped = false;
+		SkippedMeshes.Add(Mesh, &bAlreadySkipped);
+
+		if (!bAlreadySkipped)
+		{
+			INC_DWORD_STAT(STAT_ServerAnimSkippedMeshes);
+		}
+	}
+
+	void RemoveSkipping(USkeletalMeshComponent* Mesh)
+	{
+		if (SkippedMeshes.Remove(Mesh) > 0)
+		{
+			DEC_DWORD_STAT(STAT_ServerAnimSkippedMeshes);
+		}
+	}
+
+	bool IsSkippingPose(const USkeletalMeshComponent* Mesh)
+	{
+		return Mesh
+			&& Mesh->VisibilityBasedAnimTickOption >= EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered
+			&& !Mesh->bRecentlyRendered
+			&& !Mesh->IsAnySimulatingPhysics();
+	}
+
+	void EnsurePose(USkeletalMeshComponent* Mesh)
+	{
+		if (!IsSkippingPose(Mesh))
+		{
+			return;
+		}
+
+		// start a new set every frame, so it only ever holds the meshes evaluated this frame
+		if (PosedMeshesFrame != GFrameCounter)
+		{
+			PosedMeshesFrame = GFrameCounter;
+			PosedMeshes.Reset();
+		}
+
+		bool bAlreadyPosed = false;
+		PosedMeshes.Add(Mesh, &bAlreadyPosed);
+
+		if (bAlreadyPosed)
+		{
+			return;
+		}
+
+		// evaluate the anim graph right away, at the montages' current time
+		Mesh->RefreshBoneTransforms();
+
+		INC_DWORD_STAT(STAT_ServerAnimLazyPoses);
+	}
+}
@@ -0,0 +1,34 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeletalMeshComponent;
+
+/**
+ *  Server side animation skipping.
+ *  On servers, character meshes that aren't being rendered only tick their montages, so attack notifies still fire
+ *  but the anim graph isn't evaluated and the bones aren't refreshed every frame.
+ *  Code that needs accurate bones, like hit tests and attack traces, asks for the pose first,
+ *  which evaluates it once for the current frame at the montages' current time.
+ *  Rendered meshes on listen servers keep animating normally.
+ *  Toggle with ZNode.ServerAnim.SkipPose.
+ */
+namespace ServerAnimation
+{
+	/** Switches the mesh to montage-only ticking while not rendered, if it belongs to a server and skipping is enabled */
+	void ApplySkipping(USkeletalMeshComponent* Mesh);
+
+	/** Stops counting the mesh as skipped. Call from EndPlay for every mesh passed to ApplySkipping */
+	void RemoveSkipping(USkeletalMeshComponent* Mesh);
+
+	/** Returns true if the mesh isn't evaluating its pose on its own this frame */
+	bool IsSkippingPose(const USkeletalMeshComponent* Mesh);
+
+	/**
+	 *  Evaluates the mesh's pose if it's being skipped and hasn't been evaluated yet this frame.
+	 *  Evaluated meshes are tracked here, so the hitboxes, the bone cache and attack traces share a single evaluation per mesh and frame.
+	 */
+	void EnsurePose(USkeletalMeshComponent* Mesh);
+}
@@ -0,0 +1,309 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TickAuditSubsystem.h"
+#include "GameFramework/Actor.h"
+#include "Components/ActorComponent.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTickAudit, Log, All);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tick Dormancy Sleeps"), STAT_TickDormancySleeps, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tick Dormancy Wakes"), STAT_TickDormancyWakes, STATGROUP_Game);
+
+namespace TickAudit
+{
+	/** Number of worlds currently recording an audit */
+	static int32 NumRecording = 0;
+
+	static bool bDormancyEnabled = true;
+	static FAutoConsoleVariableRef CVarDormancy(
+		TEXT("ZNode.Ticks.Dormancy"),
+		bDormancyEnabled,
+		TEXT("If true, actors using tick dormancy disable their tick while idle."));
+
+	static float DormancyDelay = 0.5f;
+	static FAutoConsoleVariableRef CVarDormancyDelay(
+		TEXT("ZNode.Ticks.DormancyDelay"),
+		DormancyDelay,
+		TEXT("Time an actor needs to stay idle before its tick is disabled, in seconds."));
+
+	bool IsRecording()
+	{
+		return NumRecording > 0;
+	}
+
+	void RecordTick(const UObject* Object, uint64 Cycles, bool bDidWork)
+	{
+		const UWorld* World = Object ? Object->GetWorld() : nullptr;
+
+		if (UTickAuditSubsystem* Audit = World ? World->GetSubsystem<UTickAuditSubsystem>() : nullptr)
+		{
+			Audit->RecordTick(Object, Cycles, bDidWork);
+		}
+	}
+
+	/** Handles the audit console command */
+	static void RunCommand(const TArray<FString>& Args, UWorld* World)
+	{
+		UTickAuditSubsystem* Audit = World ? World->GetSubsystem<UTickAuditSubsystem>() : nullptr;
+
+		if (!Audit)
+		{
+			UE_LOG(LogTickAudit, Warning, TEXT("The tick audit can only run in a game world"));
+			return;
+		}
+
+		const int32 NumFrames = Args.Num() > 0 && Args[0].IsNumeric() ? FMath::Max(1, FCString::Atoi(*Args[0])) : 300;
+
+		Audit->StartAudit(NumFrames);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs AuditCommand(
+		TEXT("ZNode.Ticks.Audit"),
+		TEXT("Records every actor and component tick for a number of frames and lists how often they ran, what they cost and whether they did work. Usage: ZNode.Ticks.Audit [Frames]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunCommand));
+}
+
+bool FTickDormancy::Update(AActor* Owner, float DeltaTime, bool bDidWork)
+{
+	if (bDidWork || !TickAudit::bDormancyEnabled)
+	{
+		IdleTime = 0.0f;
+		return false;
+	}
+
+	IdleTime += DeltaTime;
+
+	if (bDormant || IdleTime < TickAudit::DormancyDelay)
+	{
+		return false;
+	}
+
+	// nothing to do for a while, stop ticking until woken up
+	bDormant = true;
+	Owner->SetActorTickEnabled(false);
+
+	INC_DWORD_STAT(STAT_TickDormancySleeps);
+
+	return true;
+}
+
+void FTickDormancy::Wake(AActor* Owner)
+{
+	IdleTime = 0.0f;
+
+	if (!bDormant)
+	{
+		return;
+	}
+
+	bDormant = false;
+	Owner->SetActorTickEnabled(true);
+
+	INC_DWORD_STAT(STAT_TickDormancyWakes);
+}
+
+bool UTickAuditSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTickAuditSubsystem::Deinitialize()
+{
+	// stop recording without logging
+	if (FramesLeft > 0)
+	{
+		--TickAudit::NumRecording;
+		FramesLeft = 0;
+	}
+
+	Entries.Empty();
+	EntryIndices.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UTickAuditSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTickAuditSubsystem, STATGROUP_Tickables);
+}
+
+void UTickAuditSubsystem::StartAudit(int32 NumFrames)
+{
+	if (FramesLeft == 0)
+	{
+		++TickAudit::NumRecording;
+	}
+
+	Entries.Reset();
+	EntryIndices.Reset();
+
+	FramesLeft = NumFrames;
+	FramesRecorded = 0;
+	TotalEnabledTicks = 0;
+
+	UE_LOG(LogTickAudit, Log, TEXT("Recording ticks for %d frames"), NumFrames);
+}
+
+void UTickAuditSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (FramesLeft <= 0)
+	{
+		return;
+	}
+
+	// sample every actor and component tick
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		const AActor* Actor = *It;
+
+		SampleTickFunction(Actor, Actor->PrimaryActorTick);
+
+		for (const UActorComponent* Component : Actor->GetComponents())
+		{
+			if (Component)
+			{
+				SampleTickFunction(Component, Component->PrimaryComponentTick);
+			}
+		}
+	}
+
+	++FramesRecorded;
+
+	if (--FramesLeft == 0)
+	{
+		--TickAudit::NumRecording;
+
+		FinishAudit();
+	}
+}
+
+UTickAuditSubsystem::FTickAuditEntry& UTickAuditSubsystem::FindOrAddEntry(const UObject* Object, const FTickFunction& TickFunction)
+{
+	if (const int32* Index = EntryIndices.Find(FObjectKey(Object)))
+	{
+		return Entries[*Index];
+	}
+
+	EntryIndices.Add(FObjectKey(Object), Entries.Num());
+
+	FTickAuditEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Object = Object;
+	Entry.TickGroup = TickFunction.TickGroup;
+	Entry.TickInterval = TickFunction.TickInterval;
+	Entry.LastTickTime = TickFunction.GetLastTickGameTimeSeconds();
+
+	// components are listed under their owner
+	const UActorComponent* Component = Cast<UActorComponent>(Object);
+	Entry.Description = Component && Component->GetOwner()
+		? FString::Printf(TEXT("%s.%s (%s)"), *Component->GetOwner()->GetName(), *Component->GetName(), *Object->GetClass()->GetName())
+		: FString::Printf(TEXT("%s (%s)"), *Object->GetName(), *Object->GetClass()->GetName());
+
+	return Entry;
+}
+
+void UTickAuditSubsystem::SampleTickFunction(const UObject* Object, const FTickFunction& TickFunction)
+{
+	if (!TickFunction.IsTickFunctionRegistered() || !TickFunction.IsTickFunctionEnabled())
+	{
+		return;
+	}
+
+	FTickAuditEntry& Entry = FindOrAddEntry(Object, TickFunction);
+
+	++Entry.FramesEnabled;
+	++TotalEnabledTicks;
+
+	// the tick ran if its last tick time moved since the previous frame
+	const float LastTickTime = TickFunction.GetLastTickGameTimeSeconds();
+
+	if (LastTickTime != Entry.LastTickTime)
+	{
+		++Entry.FramesTicked;
+		Entry.LastTickTime = LastTickTime;
+	}
+}
+
+void UTickAuditSubsystem::RecordTick(const UObject* Object, uint64 Cycles, bool bDidWork)
+{
+	if (FramesLeft <= 0)
+	{
+		return;
+	}
+
+	const FTickFunction* TickFunction = nullptr;
+
+	if (const AActor* Actor = Cast<AActor>(Object))
+	{
+		TickFunction = &Actor->PrimaryActorTick;
+	}
+	else if (const UActorComponent* Component = Cast<UActorComponent>(Object))
+	{
+		TickFunction = &Component->PrimaryComponentTick;
+	}
+
+	if (!TickFunction)
+	{
+		return;
+	}
+
+	FTickAuditEntry& Entry = FindOrAddEntry(Object, *TickFunction);
+
+	++Entry.InstrumentedTicks;
+	Entry.WorkTicks += bDidWork ? 1 : 0;
+	Entry.Cycles += Cycles;
+}
+
+void UTickAuditSubsystem::FinishAudit()
+{
+	// most expensive instrumented ticks first, then the most frequent
+	Entries.Sort([](const FTickAuditEntry& A, const FTickAuditEntry& B)
+	{
+		const double CostA = A.InstrumentedTicks > 0 ? double(A.Cycles) / A.InstrumentedTicks : 0.0;
+		const double CostB = B.InstrumentedTicks > 0 ? double(B.Cycles) / B.InstrumentedTicks : 0.0;
+
+		return CostA != CostB ? CostA > CostB : A.FramesTicked > B.FramesTicked;
+	});
+
+	const int32 Frames = FMath::Max(FramesRecorded, 1);
+
+	int32 NumIdle = 0;
+	int32 NumNeverTicked = 0;
+
+	UE_LOG(LogTickAudit, Log, TEXT("Tick audit over %d frames: %d ticks seen, %.1f enabled per frame"), FramesRecorded, Entries.Num(), double(TotalEnabledTicks) / Frames);
+	UE_LOG(LogTickAudit, Log, TEXT("  Ticked%%   Avg us   Work%%  Group  Interval  Owner"));
+
+	for (const FTickAuditEntry& Entry : Entries)
+	{
+		const double TickedPercent = 100.0 * Entry.FramesTicked / Frames;
+
+		// only instrumented ticks know their cost and whether they did work
+		FString Cost = TEXT("       -");
+		FString Work = TEXT("      -");
+
+		if (Entry.InstrumentedTicks > 0)
+		{
+			const double WorkPercent = 100.0 * Entry.WorkTicks / Entry.InstrumentedTicks;
+
+			Cost = FString::Printf(TEXT("%8.2f"), FPlatformTime::ToMilliseconds64(Entry.Cycles) * 1000.0 / Entry.InstrumentedTicks);
+			Work = FString::Printf(TEXT("%6.1f%%"), WorkPercent);
+
+			NumIdle += Entry.WorkTicks == 0 ? 1 : 0;
+		}
+
+		NumNeverTicked += Entry.FramesTicked == 0 ? 1 : 0;
+
+		UE_LOG(LogTickAudit, Log, TEXT("  %6.1f%% %s %s  %5d  %8.3f  %s"),
+			TickedPercent, *Cost, *Work, int32(Entry.TickGroup), Entry.TickInterval, *Entry.Description);
+	}
+
+	UE_LOG(LogTickAudit, Log, TEXT("%d instrumented ticks never did work, %d enabled ticks never ran"), NumIdle, NumNeverTicked);
+
+	Entries.Reset();
+	EntryIndices.Reset();
+}
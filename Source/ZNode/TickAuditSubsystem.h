@@ -0,0 +1,173 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "HAL/PlatformTime.h"
+#include "TickAuditSubsystem.generated.h"
+
+namespace TickAudit
+{
+	/** Returns true while a tick audit is recording */
+	bool IsRecording();
+
+	/** Records an instrumented tick of an actor or component, with its cost and whether it found something to do */
+	void RecordTick(const UObject* Object, uint64 Cycles, bool bDidWork);
+}
+
+/**
+ *  Times a tick function body for the tick auditor. Costs nothing while no audit is recording.
+ *  Call SetDidWork(false) when the tick found nothing to do, so the audit can flag it as idle.
+ *
+ *  Usage:
+ *    FTickAuditScope AuditScope(this);
+ */
+struct FTickAuditScope
+{
+	FTickAuditScope(const UObject* InObject)
+		: Object(InObject)
+		, StartCycles(TickAudit::IsRecording() ? FPlatformTime::Cycles64() : 0)
+	{}
+
+	~FTickAuditScope()
+	{
+		if (StartCycles != 0)
+		{
+			TickAudit::RecordTick(Object, FPlatformTime::Cycles64() - StartCycles, bDidWork);
+		}
+	}
+
+	/** Reports whether the tick did anything */
+	void SetDidWork(bool bInDidWork) { bDidWork = bInDidWork; }
+
+private:
+
+	const UObject* Object;
+	uint64 StartCycles;
+	bool bDidWork = true;
+};
+
+/**
+ *  Tick dormancy for actors that are often idle.
+ *  The owner reports whether each tick did anything. After ZNode.Ticks.DormancyDelay seconds without work,
+ *  the actor's tick is disabled. Events that give the actor something to do call Wake to enable it again.
+ */
+struct FTickDormancy
+{
+	/** Call at the end of the owner's tick. Returns true if the actor just went dormant */
+	bool Update(AActor* Owner, float DeltaTime, bool bDidWork);
+
+	/** Enables the owner's tick again if it's dormant */
+	void Wake(AActor* Owner);
+
+	/** Returns true if the owner's tick is disabled */
+	bool IsDormant() const { return bDormant; }
+
+private:
+
+	/** Time the owner has been idle for */
+	float IdleTime = 0.0f;
+
+	/** If true, the owner's tick is disabled */
+	bool bDormant = false;
+};
+
+/**
+ *  Runtime tick auditor.
+ *  While recording, every registered actor and component tick is sampled each frame, to find out how often it actually ran.
+ *  Ticks instrumented with FTickAuditScope also report their average cost and how often they did any work.
+ *  At the end, the ticks are listed by cost, so ticks that can be removed or made dormant stand out.
+ *  Start an audit with ZNode.Ticks.Audit [Frames].
+ */
+UCLASS()
+class UTickAuditSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Audit results for one tick function */
+	struct FTickAuditEntry
+	{
+		/** Actor or component that owns the tick */
+		TWeakObjectPtr<const UObject> Object;
+
+		/** Name and class of the owner, captured when first seen */
+		FString Description;
+
+		/** Tick group */
+		ETickingGroup TickGroup = TG_PrePhysics;
+
+		/** Tick interval, in seconds */
+		float TickInterval = 0.0f;
+
+		/** Frames the tick was registered and enabled in */
+		int32 FramesEnabled = 0;
+
+		/** Frames the tick actually ran in */
+		int32 FramesTicked = 0;
+
+		/** Last tick time seen, used to detect whether the tick ran */
+		float LastTickTime = -1.0f;
+
+		/** Instrumented ticks recorded */
+		int32 InstrumentedTicks = 0;
+
+		/** Instrumented ticks that did work */
+		int32 WorkTicks = 0;
+
+		/** Total cost of the instrumented ticks */
+		uint64 Cycles = 0;
+	};
+
+	/** Entries for every tick seen during the audit */
+	TArray<FTickAuditEntry> Entries;
+
+	/** Maps each owner to its entry */
+	TMap<FObjectKey, int32> EntryIndices;
+
+	/** Frames left to record */
+	int32 FramesLeft = 0;
+
+	/** Frames recorded so far */
+	int32 FramesRecorded = 0;
+
+	/** Enabled ticks counted over the recorded frames */
+	int64 TotalEnabledTicks = 0;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Samples the registered ticks while recording */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Starts recording for the provided number of frames */
+	void StartAudit(int32 NumFrames);
+
+	/** Adds an instrumented tick to its entry */
+	void RecordTick(const UObject* Object, uint64 Cycles, bool bDidWork);
+
+	/** Returns true if an audit is recording */
+	bool IsAuditing() const { return FramesLeft > 0; }
+
+protected:
+
+	/** Finds or adds the entry for a tick owner */
+	FTickAuditEntry& FindOrAddEntry(const UObject* Object, const FTickFunction& TickFunction);
+
+	/** Samples a tick function for this frame */
+	void SampleTickFunction(const UObject* Object, const FTickFunction& TickFunction);
+
+	/** Logs the results and stops recording */
+	void FinishAudit();
+};
@@ -0,0 +1,542 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatAIBenchmarkSubsystem.h"
+#include "CombatEnemy.h"
+#include "CombatEnemySpawner.h"
+#include "CombatAIController.h"
+#include "CombatAIScheduler.h"
+#include "CombatFlowFieldSubsystem.h"
+#include "Components/StateTreeAIComponent.h"
+#include "StateTreeAsyncExecutionContext.h"
+#include "Kismet/GameplayStatics.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY(LogCombatAIBenchmark);
+
+namespace CombatAIBenchmark
+{
+	/** Distance between spawned enemies */
+	constexpr float SpawnSpacing = 150.0f;
+
+	/** Minimum distance from the player enemies will be spawned at */
+	constexpr float SpawnMinRadius = 800.0f;
+
+	/** Enemies moved by the benchmark stop this close to the player */
+	constexpr float AcceptanceRadius = 100.0f;
+
+	/** Enemies moved by the benchmark only request a new path once the player moves this far, like the Follow Flow Field task */
+	constexpr float RepathDistance = 200.0f;
+
+	/** Handles the benchmark console command */
+	static void RunCommand(const TArray<FString>& Args, UWorld* World)
+	{
+		UCombatAIBenchmarkSubsystem* Benchmark = World ? World->GetSubsystem<UCombatAIBenchmarkSubsystem>() : nullptr;
+
+		if (!Benchmark)
+		{
+			UE_LOG(LogCombatAIBenchmark, Warning, TEXT("The AI benchmark can only run in a game world"));
+			return;
+		}
+
+		TArray<int32> Counts;
+		TSubclassOf<ACombatEnemy> EnemyClass;
+		ECombatAIBenchmarkMovement Movement = ECombatAIBenchmarkMovement::StateTree;
+
+		// parse the arguments
+		for (const FString& Arg : Args)
+		{
+			FString ClassPath;
+			FString MoveMode;
+
+			if (FParse::Value(*Arg, TEXT("Class="), ClassPath))
+			{
+				EnemyClass = LoadClass<ACombatEnemy>(nullptr, *ClassPath);
+			}
+			else if (FParse::Value(*Arg, TEXT("Move="), MoveMode))
+			{
+				// chase the player along the flow field or with per-enemy pathfinding
+				if (MoveMode.Equals(TEXT("Field"), ESearchCase::IgnoreCase))
+				{
+					Movement = ECombatAIBenchmarkMovement::FlowField;
+				}
+				else if (MoveMode.Equals(TEXT("Path"), ESearchCase::IgnoreCase))
+				{
+					Movement = ECombatAIBenchmarkMovement::Pathfinding;
+				}
+			}
+			else if (Arg.IsNumeric())
+			{
+				Counts.Add(FMath::Max(1, FCString::Atoi(*Arg)));
+			}
+		}
+
+		// default to the counts we care about the most
+		if (Counts.IsEmpty())
+		{
+			Counts = { 100, 500 };
+		}
+
+		// if no class was provided, borrow it from the first spawner in the level
+		if (!EnemyClass)
+		{
+			for (TActorIterator<ACombatEnemySpawner> It(World); It; ++It)
+			{
+				if ((EnemyClass = It->GetEnemyClass()) != nullptr)
+				{
+					break;
+				}
+			}
+		}
+
+		if (!EnemyClass)
+		{
+			UE_LOG(LogCombatAIBenchmark, Warning, TEXT("No enemy class to benchmark. Pass Class=/Path/To/Enemy.Enemy_C or place an enemy spawner in the level"));
+			return;
+		}
+
+		Benchmark->StartBenchmark(Counts, EnemyClass, Movement);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("Combat.AI.Benchmark"),
+		TEXT("Spawns enemies around the player and measures StateTree update and pathing cost per enemy. Usage: Combat.AI.Benchmark [Count...] [Class=/Path/To/Enemy.Enemy_C] [Move=Field|Path]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunCommand));
+}
+
+bool UCombatAIBenchmarkSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatAIBenchmarkSubsystem::Deinitialize()
+{
+	// abort any running benchmark. The world is going away, so the enemies will be cleaned up with it
+	Enemies.Empty();
+	LastPathGoals.Empty();
+	FollowingPath.Empty();
+	bFollowingFlowField = false;
+	TickPlayerInfo.Empty();
+	IntervalPlayerInfo.Empty();
+	IntervalCountdowns.Empty();
+	PendingCounts.Empty();
+	Stage = EBenchmarkStage::Idle;
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatAIBenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatAIBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatAIBenchmarkSubsystem::StartBenchmark(const TArray<int32>& Counts, TSubclassOf<ACombatEnemy> InEnemyClass, ECombatAIBenchmarkMovement InMovement)
+{
+	// ignore if we're already running
+	if (IsRunning())
+	{
+		UE_LOG(LogCombatAIBenchmark, Warning, TEXT("An AI benchmark is already running"));
+		return;
+	}
+
+	PendingCounts = Counts;
+	EnemyClass = InEnemyClass;
+	Movement = InMovement;
+
+	StartNextRun();
+}
+
+void UCombatAIBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	switch (Stage)
+	{
+	case EBenchmarkStage::Warmup:
+
+		// keep the AI running while it settles, but don't measure
+		if (Movement == ECombatAIBenchmarkMovement::StateTree)
+		{
+			TickStateTrees(DeltaTime);
+		}
+		else
+		{
+			MoveEnemies();
+		}
+
+		TickPlayerInfoTasks(DeltaTime);
+
+		if (--FramesRemaining <= 0)
+		{
+			// reset the accumulators and start measuring
+			StateTreeSeconds = 0.0;
+			FrameSeconds = 0.0;
+			StateTreeUpdates = 0;
+			PathRequests = 0;
+			PathRequestSeconds = 0.0;
+			TickTaskSeconds = 0.0;
+			IntervalTaskSeconds = 0.0;
+			TickTaskUpdates = 0;
+			IntervalTaskUpdates = 0;
+			MovementSeconds = 0.0;
+
+			const UCombatFlowFieldSubsystem* FlowField = GetWorld()->GetSubsystem<UCombatFlowFieldSubsystem>();
+			FlowFieldStartSeconds = FlowField ? FlowField->GetTotalUpdateSeconds() : 0.0;
+
+			FramesRemaining = MeasureFrames;
+			Stage = EBenchmarkStage::Measure;
+		}
+		break;
+
+	case EBenchmarkStage::Measure:
+
+		if (Movement == ECombatAIBenchmarkMovement::StateTree)
+		{
+			TickStateTrees(DeltaTime);
+		}
+		else
+		{
+			MoveEnemies();
+		}
+
+		TickPlayerInfoTasks(DeltaTime);
+		FrameSeconds += DeltaTime;
+
+		if (--FramesRemaining <= 0)
+		{
+			// log the results and move on to the next count
+			ReportRun();
+			DestroyEnemies();
+
+			if (!StartNextRun())
+			{
+				// stop keeping the flow fields built for us
+				if (bFollowingFlowField)
+				{
+					if (UCombatFlowFieldSubsystem* FlowField = GetWorld()->GetSubsystem<UCombatFlowFieldSubsystem>())
+					{
+						FlowField->RemoveFollower();
+					}
+
+					bFollowingFlowField = false;
+				}
+
+				UE_LOG(LogCombatAIBenchmark, Log, TEXT("AI benchmark complete"));
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+bool UCombatAIBenchmarkSubsystem::StartNextRun()
+{
+	Stage = EBenchmarkStage::Idle;
+
+	// do we have anything left to run?
+	if (PendingCounts.IsEmpty() || !EnemyClass)
+	{
+		return false;
+	}
+
+	const int32 Count = PendingCounts[0];
+	PendingCounts.RemoveAt(0);
+
+	// spawn the enemies on a square grid around the player, leaving a hole in the middle
+	const APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0);
+	const FVector Center = PlayerPawn ? PlayerPawn->GetActorLocation() : FVector::ZeroVector;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	const int32 HoleCells = FMath::CeilToInt(CombatAIBenchmark::SpawnMinRadius / CombatAIBenchmark::SpawnSpacing);
+
+	// cap the number of rings in case spawning keeps failing
+	for (int32 Ring = HoleCells; Enemies.Num() < Count && Ring < HoleCells + Count; ++Ring)
+	{
+		for (int32 Y = -Ring; Y <= Ring && Enemies.Num() < Count; ++Y)
+		{
+			for (int32 X = -Ring; X <= Ring && Enemies.Num() < Count; ++X)
+			{
+				// only walk the outer edge of the ring
+				if (FMath::Abs(X) != Ring && FMath::Abs(Y) != Ring)
+				{
+					continue;
+				}
+
+				const FVector Location = Center + FVector(X * CombatAIBenchmark::SpawnSpacing, Y * CombatAIBenchmark::SpawnSpacing, 0.0f);
+				const FRotator Rotation = (Center - Location).Rotation();
+
+				if (ACombatEnemy* Enemy = GetWorld()->SpawnActor<ACombatEnemy>(EnemyClass, Location, FRotator(0.0f, Rotation.Yaw, 0.0f), SpawnParams))
+				{
+					Enemies.Add(Enemy);
+				}
+			}
+		}
+	}
+
+	UE_LOG(LogCombatAIBenchmark, Log, TEXT("AI benchmark: spawned %d enemies of class %s"), Enemies.Num(), *EnemyClass->GetName());
+
+	// take over the movement if we're comparing flow fields and pathfinding
+	LastPathGoals.Init(FVector::ZeroVector, Enemies.Num());
+	FollowingPath.Init(false, Enemies.Num());
+
+	if (Movement != ECombatAIBenchmarkMovement::StateTree)
+	{
+		for (const TWeakObjectPtr<ACombatEnemy>& Enemy : Enemies)
+		{
+			const ACombatAIController* AIController = Cast<ACombatAIController>(Enemy->GetController());
+
+			if (UStateTreeAIComponent* StateTreeAI = AIController ? AIController->GetStateTreeAI() : nullptr)
+			{
+				StateTreeAI->StopLogic(TEXT("AI benchmark movement"));
+			}
+		}
+
+		// keep the flow fields built while we follow them
+		if (Movement == ECombatAIBenchmarkMovement::FlowField && !bFollowingFlowField)
+		{
+			if (UCombatFlowFieldSubsystem* FlowField = GetWorld()->GetSubsystem<UCombatFlowFieldSubsystem>())
+			{
+				FlowField->AddFollower();
+				bFollowingFlowField = true;
+			}
+		}
+	}
+
+	// set up the player info tasks for every enemy
+	const FStateTreeGetPlayerInfoIntervalInstanceData IntervalDefaults;
+
+	TickPlayerInfo.SetNum(Enemies.Num());
+	IntervalPlayerInfo.SetNum(Enemies.Num());
+	IntervalCountdowns.SetNum(Enemies.Num());
+
+	for (int32 EnemyIndex = 0; EnemyIndex < Enemies.Num(); ++EnemyIndex)
+	{
+		TickPlayerInfo[EnemyIndex].Character = Enemies[EnemyIndex].Get();
+		TickPlayerInfo[EnemyIndex].TargetPlayerLocation = FVector::ZeroVector;
+		IntervalPlayerInfo[EnemyIndex].Character = Enemies[EnemyIndex].Get();
+
+		// spread the first updates over the interval, like enemies entering the state at different times
+		IntervalCountdowns[EnemyIndex] = IntervalDefaults.UpdateInterval * EnemyIndex / Enemies.Num();
+	}
+
+	FramesRemaining = WarmupFrames;
+	Stage = EBenchmarkStage::Warmup;
+
+	return true;
+}
+
+void UCombatAIBenchmarkSubsystem::RecordPathRequest(double Seconds)
+{
+	// only count requests while measuring
+	if (Stage == EBenchmarkStage::Measure)
+	{
+		++PathRequests;
+		PathRequestSeconds += Seconds;
+	}
+}
+
+void UCombatAIBenchmarkSubsystem::TickStateTrees(float DeltaTime)
+{
+	for (const TWeakObjectPtr<ACombatEnemy>& Enemy : Enemies)
+	{
+		const ACombatAIController* AIController = Enemy.IsValid() ? Cast<ACombatAIController>(Enemy->GetController()) : nullptr;
+		UStateTreeAIComponent* StateTreeAI = AIController ? AIController->GetStateTreeAI() : nullptr;
+
+		if (!StateTreeAI)
+		{
+			continue;
+		}
+
+		// take over the component tick so we can time it on its own
+		StateTreeAI->SetComponentTickEnabled(false);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		StateTreeAI->TickComponent(DeltaTime, LEVELTICK_All, &StateTreeAI->PrimaryComponentTick);
+
+		StateTreeSeconds += FPlatformTime::Seconds() - StartTime;
+		++StateTreeUpdates;
+	}
+}
+
+void UCombatAIBenchmarkSubsystem::MoveEnemies()
+{
+	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0);
+
+	if (!PlayerPawn)
+	{
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	const UCombatFlowFieldSubsystem* FlowField = Movement == ECombatAIBenchmarkMovement::FlowField && UCombatFlowFieldSubsystem::IsEnabled()
+		? GetWorld()->GetSubsystem<UCombatFlowFieldSubsystem>()
+		: nullptr;
+
+	const FVector TargetLocation = PlayerPawn->GetActorLocation();
+
+	for (int32 EnemyIndex = 0; EnemyIndex < Enemies.Num(); ++EnemyIndex)
+	{
+		ACombatEnemy* Enemy = Enemies[EnemyIndex].Get();
+		AAIController* AIController = Enemy ? Cast<AAIController>(Enemy->GetController()) : nullptr;
+
+		if (!AIController)
+		{
+			continue;
+		}
+
+		// have we arrived?
+		if (FVector::DistSquared2D(Enemy->GetActorLocation(), TargetLocation) < FMath::Square(CombatAIBenchmark::AcceptanceRadius))
+		{
+			continue;
+		}
+
+		// sample the flow field first
+		FVector FlowDirection;
+
+		if (FlowField && FlowField->SampleDirection(Enemy->GetActorLocation(), FlowDirection, PlayerPawn))
+		{
+			if (FollowingPath[EnemyIndex])
+			{
+				AIController->StopMovement();
+				FollowingPath[EnemyIndex] = false;
+			}
+
+			Enemy->AddMovementInput(FlowDirection);
+			continue;
+		}
+
+		// request a path, only repathing once the player has moved far enough
+		if (!FollowingPath[EnemyIndex] || FVector::DistSquared(LastPathGoals[EnemyIndex], TargetLocation) > FMath::Square(CombatAIBenchmark::RepathDistance))
+		{
+			AIController->MoveToActor(PlayerPawn, CombatAIBenchmark::AcceptanceRadius);
+			LastPathGoals[EnemyIndex] = TargetLocation;
+			FollowingPath[EnemyIndex] = true;
+		}
+	}
+
+	MovementSeconds += FPlatformTime::Seconds() - StartTime;
+}
+
+void UCombatAIBenchmarkSubsystem::TickPlayerInfoTasks(float DeltaTime)
+{
+	// the benchmark has no StateTree to send events to, and the default task parameters don't send any
+	const FStateTreeWeakExecutionContext NoContext;
+
+	for (int32 EnemyIndex = 0; EnemyIndex < Enemies.Num(); ++EnemyIndex)
+	{
+		if (!Enemies[EnemyIndex].IsValid())
+		{
+			continue;
+		}
+
+		// the ticking task updates every frame
+		double StartTime = FPlatformTime::Seconds();
+
+		FStateTreeGetPlayerInfoTask::UpdatePlayerInfo(TickPlayerInfo[EnemyIndex]);
+
+		TickTaskSeconds += FPlatformTime::Seconds() - StartTime;
+		++TickTaskUpdates;
+
+		// the interval task only updates when its timer fires
+		IntervalCountdowns[EnemyIndex] -= DeltaTime;
+
+		if (IntervalCountdowns[EnemyIndex] > 0.0f)
+		{
+			continue;
+		}
+
+		FStateTreeGetPlayerInfoIntervalInstanceData& IntervalData = IntervalPlayerInfo[EnemyIndex];
+		IntervalCountdowns[EnemyIndex] += IntervalData.UpdateInterval;
+
+		StartTime = FPlatformTime::Seconds();
+
+		FStateTreeGetPlayerInfoIntervalTask::UpdatePlayerInfo(IntervalData, NoContext, false);
+
+		IntervalTaskSeconds += FPlatformTime::Seconds() - StartTime;
+		++IntervalTaskUpdates;
+	}
+}
+
+void UCombatAIBenchmarkSubsystem::ReportRun() const
+{
+	const int32 NumEnemies = Enemies.Num();
+	const double MeasuredFrames = FMath::Max(1, MeasureFrames);
+
+	const double StateTreeMsPerFrame = StateTreeSeconds * 1000.0 / MeasuredFrames;
+	const double StateTreeUsPerEnemy = StateTreeUpdates > 0 ? StateTreeSeconds * 1000000.0 / StateTreeUpdates : 0.0;
+	const double FrameMs = FrameSeconds * 1000.0 / MeasuredFrames;
+
+	UE_LOG(LogCombatAIBenchmark, Log, TEXT("AI benchmark [%d enemies]: StateTree %.3f ms/frame, %.2f us/enemy, frame %.2f ms"),
+		NumEnemies, StateTreeMsPerFrame, StateTreeUsPerEnemy, FrameMs);
+
+	// compare the player info task versions
+	UE_LOG(LogCombatAIBenchmark, Log, TEXT("AI benchmark [%d enemies]: GetPlayerInfo tick %.3f ms/frame (%.3f us/enemy/frame), interval %.3f ms/frame (%.3f us/enemy/frame, %lld updates)"),
+		NumEnemies,
+		TickTaskSeconds * 1000.0 / MeasuredFrames, NumEnemies > 0 ? TickTaskSeconds * 1000000.0 / (MeasuredFrames * NumEnemies) : 0.0,
+		IntervalTaskSeconds * 1000.0 / MeasuredFrames, NumEnemies > 0 ? IntervalTaskSeconds * 1000000.0 / (MeasuredFrames * NumEnemies) : 0.0,
+		IntervalTaskUpdates);
+
+	// report the pathing cost
+	const UCombatFlowFieldSubsystem* FlowField = GetWorld()->GetSubsystem<UCombatFlowFieldSubsystem>();
+	const double FlowFieldMs = FlowField ? (FlowField->GetTotalUpdateSeconds() - FlowFieldStartSeconds) * 1000.0 / MeasuredFrames : 0.0;
+
+	const TCHAR* MovementName = Movement == ECombatAIBenchmarkMovement::FlowField ? TEXT("flow field")
+		: Movement == ECombatAIBenchmarkMovement::Pathfinding ? TEXT("pathfinding")
+		: TEXT("StateTree");
+
+	UE_LOG(LogCombatAIBenchmark, Log, TEXT("AI benchmark [%d enemies]: movement %s %.3f ms/frame, %lld path requests (%.2f/frame), path requests %.3f ms/frame, flow field update %.3f ms/frame"),
+		NumEnemies, MovementName, MovementSeconds * 1000.0 / MeasuredFrames, PathRequests, PathRequests / MeasuredFrames, PathRequestSeconds * 1000.0 / MeasuredFrames, FlowFieldMs);
+
+	// report the batched decision timings if the enemies are using the scheduler
+	const UCombatAIScheduler* Scheduler = GetWorld()->GetSubsystem<UCombatAIScheduler>();
+
+	if (Scheduler && Scheduler->Num() > 0)
+	{
+		double SerialMs = 0.0;
+		double ParallelMs = 0.0;
+		Scheduler->GetLastTimings(SerialMs, ParallelMs);
+
+		if (SerialMs > 0.0)
+		{
+			UE_LOG(LogCombatAIBenchmark, Log, TEXT("AI benchmark [%d enemies]: scheduler decisions serial %.3f ms, parallel %.3f ms, speedup %.2fx"),
+				Scheduler->Num(), SerialMs, ParallelMs, ParallelMs > 0.0 ? SerialMs / ParallelMs : 0.0);
+		}
+		else
+		{
+			UE_LOG(LogCombatAIBenchmark, Log, TEXT("AI benchmark [%d enemies]: scheduler decisions %.3f ms. Set Combat.AI.SchedulerSerialSampleRate to measure the parallel speedup"),
+				Scheduler->Num(), ParallelMs);
+		}
+	}
+}
+
+void UCombatAIBenchmarkSubsystem::DestroyEnemies()
+{
+	for (const TWeakObjectPtr<ACombatEnemy>& Enemy : Enemies)
+	{
+		if (Enemy.IsValid())
+		{
+			// destroy the controller along with the pawn
+			if (AController* Controller = Enemy->GetController())
+			{
+				Controller->Destroy();
+			}
+
+			Enemy->Destroy();
+		}
+	}
+
+	Enemies.Empty();
+	LastPathGoals.Reset();
+	FollowingPath.Reset();
+	TickPlayerInfo.Reset();
+	IntervalPlayerInfo.Reset();
+	IntervalCountdowns.Reset();
+}
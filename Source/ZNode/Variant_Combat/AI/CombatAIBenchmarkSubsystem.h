@@ -0,0 +1,168 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatStateTreeUtility.h"
+#include "CombatAIBenchmarkSubsystem.generated.h"
+
+class ACombatEnemy;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCombatAIBenchmark, Log, All);
+
+/** How the benchmark enemies chase the player */
+enum class ECombatAIBenchmarkMovement : uint8
+{
+	/** Enemies run their own StateTree */
+	StateTree,
+
+	/** The benchmark moves the enemies along the flow field, falling back to paths where it has no direction */
+	FlowField,
+
+	/** The benchmark moves the enemies by requesting paths */
+	Pathfinding
+};
+
+/**
+ *  Spawns batches of enemies around the player and measures how much their AI costs per enemy.
+ *  StateTree components are ticked manually by the benchmark so their cost can be timed in isolation.
+ *  The enemy StateTree asset doesn't use the player info tasks, so the benchmark also runs both versions
+ *  for every enemy at their own cadence: the ticking task every frame and the interval task on its update interval.
+ *  With Move=Field or Move=Path, the enemy StateTrees are stopped and the benchmark chases the player with every enemy itself,
+ *  either along the flow field or by requesting paths, so the two can be compared in path requests and ms per frame.
+ *  Run it with the Combat.AI.Benchmark console command, e.g. "Combat.AI.Benchmark 100 500"
+ */
+UCLASS()
+class UCombatAIBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Benchmark stages */
+	enum class EBenchmarkStage : uint8
+	{
+		Idle,
+		Warmup,
+		Measure
+	};
+
+	/** Current benchmark stage */
+	EBenchmarkStage Stage = EBenchmarkStage::Idle;
+
+	/** Enemy counts still waiting to be benchmarked */
+	TArray<int32> PendingCounts;
+
+	/** Enemy type to spawn */
+	TSubclassOf<ACombatEnemy> EnemyClass;
+
+	/** How the enemies chase the player */
+	ECombatAIBenchmarkMovement Movement = ECombatAIBenchmarkMovement::StateTree;
+
+	/** Enemies spawned for the current run */
+	TArray<TWeakObjectPtr<ACombatEnemy>> Enemies;
+
+	/** Player location at each enemy's last path request */
+	TArray<FVector> LastPathGoals;
+
+	/** True for each enemy that's following a requested path */
+	TArray<bool> FollowingPath;
+
+	/** True while the benchmark is registered as a flow field follower */
+	bool bFollowingFlowField = false;
+
+	/** Time spent moving the enemies in the current run, including path requests */
+	double MovementSeconds = 0.0;
+
+	/** Frames left in the current stage */
+	int32 FramesRemaining = 0;
+
+	/** Number of frames to let the AI settle before measuring */
+	int32 WarmupFrames = 60;
+
+	/** Number of frames to measure */
+	int32 MeasureFrames = 300;
+
+	/** Accumulated StateTree update time for the current run */
+	double StateTreeSeconds = 0.0;
+
+	/** Accumulated frame time for the current run */
+	double FrameSeconds = 0.0;
+
+	/** Number of StateTree updates performed in the current run */
+	int64 StateTreeUpdates = 0;
+
+	/** Number of path requests made in the current run */
+	int64 PathRequests = 0;
+
+	/** Time spent on path requests in the current run */
+	double PathRequestSeconds = 0.0;
+
+	/** Player info for each enemy, refreshed by the ticking task */
+	TArray<FStateTreeGetPlayerInfoInstanceData> TickPlayerInfo;
+
+	/** Player info for each enemy, refreshed by the interval task */
+	TArray<FStateTreeGetPlayerInfoIntervalInstanceData> IntervalPlayerInfo;
+
+	/** Time left until each enemy's next interval task update */
+	TArray<float> IntervalCountdowns;
+
+	/** Time spent in the ticking player info task in the current run */
+	double TickTaskSeconds = 0.0;
+
+	/** Time spent in the interval player info task in the current run */
+	double IntervalTaskSeconds = 0.0;
+
+	/** Number of ticking player info task updates in the current run */
+	int64 TickTaskUpdates = 0;
+
+	/** Number of interval player info task updates in the current run */
+	int64 IntervalTaskUpdates = 0;
+
+	/** Flow field update time at the start of the measurement */
+	double FlowFieldStartSeconds = 0.0;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Runs the benchmark state machine */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Starts a benchmark run for each of the provided enemy counts */
+	void StartBenchmark(const TArray<int32>& Counts, TSubclassOf<ACombatEnemy> InEnemyClass, ECombatAIBenchmarkMovement InMovement = ECombatAIBenchmarkMovement::StateTree);
+
+	/** Returns true if a benchmark is currently running */
+	bool IsRunning() const { return Stage != EBenchmarkStage::Idle; }
+
+	/** Records a path request made by an enemy controller */
+	void RecordPathRequest(double Seconds);
+
+protected:
+
+	/** Spawns the enemies for the next pending count. Returns false if there's nothing left to run */
+	bool StartNextRun();
+
+	/** Ticks the StateTree component for every enemy and accumulates the time spent */
+	void TickStateTrees(float DeltaTime);
+
+	/** Moves every enemy towards the player along the flow field or by requesting paths */
+	void MoveEnemies();
+
+	/** Runs both player info task versions for every enemy and accumulates the time spent in each */
+	void TickPlayerInfoTasks(float DeltaTime);
+
+	/** Logs the results for the current run */
+	void ReportRun() const;
+
+	/** Destroys all spawned enemies */
+	void DestroyEnemies();
+};
@@ -3,6 +3,11 @@
 
 #include "CombatAIController.h"
 #include "Components/StateTreeAIComponent.h"
+#include "CombatAIBenchmarkSubsystem.h"
+#include "CombatStateTreeUtility.h"
+
+DECLARE_CYCLE_STAT(TEXT("Path Requests"), STAT_CombatPathRequests, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Request Count"), STAT_CombatPathRequestCount, STATGROUP_CombatAI);
 
 ACombatAIController::ACombatAIController()
 {
@@ -17,3 +22,19 @@ ACombatAIController::ACombatAIController()
 	// this is necessary for EnvQueries to work correctly
 	bAttachToPawn = true;
 }
+
+void ACombatAIController::FindPathForMoveRequest(const FAIMoveRequest& MoveRequest, FPathFindingQuery& Query, FNavPathSharedPtr& OutPath) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatPathRequests);
+	INC_DWORD_STAT(STAT_CombatPathRequestCount);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	Super::FindPathForMoveRequest(MoveRequest, Query, OutPath);
+
+	// let the benchmark know about the request
+	if (UCombatAIBenchmarkSubsystem* Benchmark = GetWorld()->GetSubsystem<UCombatAIBenchmarkSubsystem>())
+	{
+		Benchmark->RecordPathRequest(FPlatformTime::Seconds() - StartTime);
+	}
+}
@@ -24,4 +24,12 @@ public:
 
 	/** Constructor */
 	ACombatAIController();
+
+	/** Returns the StateTree component */
+	UStateTreeAIComponent* GetStateTreeAI() const { return StateTreeAI; }
+
+protected:
+
+	/** Counts and times path requests so they can be compared against the flow field */
+	virtual void FindPathForMoveRequest(const FAIMoveRequest& MoveRequest, FPathFindingQuery& Query, FNavPathSharedPtr& OutPath) const override;
 };
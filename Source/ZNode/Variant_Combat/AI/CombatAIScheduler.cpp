@@ -0,0 +1,336 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatAIScheduler.h"
+#include "CombatEnemy.h"
+#include "CombatAIController.h"
+#include "CombatStateTreeUtility.h"
+#include "Components/StateTreeAIComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/TaskGraphInterfaces.h"
+
+DECLARE_CYCLE_STAT(TEXT("Scheduler Gather"), STAT_CombatAISchedulerGather, STATGROUP_CombatAI);
+DECLARE_CYCLE_STAT(TEXT("Scheduler Decide"), STAT_CombatAISchedulerDecide, STATGROUP_CombatAI);
+DECLARE_CYCLE_STAT(TEXT("Scheduler Apply"), STAT_CombatAISchedulerApply, STATGROUP_CombatAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Scheduled Enemies"), STAT_CombatAIScheduledEnemies, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Focus Changes"), STAT_CombatAIFocusChanges, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Speed Changes"), STAT_CombatAISpeedChanges, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Attacks Triggered"), STAT_CombatAIAttacks, STATGROUP_CombatAI);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Decide Serial (ms)"), STAT_CombatAIDecideSerialMs, STATGROUP_CombatAI);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Decide Parallel (ms)"), STAT_CombatAIDecideParallelMs, STATGROUP_CombatAI);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Decide Speedup"), STAT_CombatAIDecideSpeedup, STATGROUP_CombatAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Worker Threads"), STAT_CombatAIWorkerThreads, STATGROUP_CombatAI);
+
+namespace CombatAIScheduler
+{
+	static float UpdateInterval = 0.1f;
+	static FAutoConsoleVariableRef CVarUpdateInterval(
+		TEXT("Combat.AI.SchedulerInterval"),
+		UpdateInterval,
+		TEXT("Time between batched AI decision updates, in seconds. 0 updates every frame"));
+
+	static bool bParallel = true;
+	static FAutoConsoleVariableRef CVarParallel(
+		TEXT("Combat.AI.SchedulerParallel"),
+		bParallel,
+		TEXT("If true, batched AI decisions are spread across worker threads"));
+
+	static int32 SerialSampleRate = 0;
+	static FAutoConsoleVariableRef CVarSerialSampleRate(
+		TEXT("Combat.AI.SchedulerSerialSampleRate"),
+		SerialSampleRate,
+		TEXT("Every N updates, the parallel decision pass is also run on a single thread to measure the speedup. 0 disables sampling. Profiling only, since each sample runs the decisions twice"));
+
+	/** Minimum number of enemies per worker batch */
+	constexpr int32 MinBatchSize = 32;
+}
+
+bool UCombatAIScheduler::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatAIScheduler::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_CombatAIScheduledEnemies, Enemies.Num());
+
+	// release all enemies
+	Enemies.Empty();
+	Settings.Empty();
+	NextAttackTimes.Empty();
+	AppliedTargets.Empty();
+	AppliedSpeeds.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatAIScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatAIScheduler, STATGROUP_Tickables);
+}
+
+void UCombatAIScheduler::RegisterEnemy(ACombatEnemy* Enemy, const FCombatAIDecisionSettings& InSettings)
+{
+	// ignore invalid or already registered enemies
+	if (!IsValid(Enemy) || Enemies.Contains(Enemy))
+	{
+		return;
+	}
+
+	Enemies.Add(Enemy);
+	Settings.Add(InSettings);
+	NextAttackTimes.Add(0.0);
+	AppliedTargets.AddDefaulted();
+	AppliedSpeeds.Add(-1.0f);
+
+	INC_DWORD_STAT(STAT_CombatAIScheduledEnemies);
+}
+
+void UCombatAIScheduler::UnregisterEnemy(ACombatEnemy* Enemy)
+{
+	const int32 Index = Enemies.IndexOfByKey(Enemy);
+
+	if (Index != INDEX_NONE)
+	{
+		RemoveAt(Index);
+	}
+}
+
+void UCombatAIScheduler::RemoveAt(int32 Index)
+{
+	Enemies.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Settings.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	NextAttackTimes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	AppliedTargets.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	AppliedSpeeds.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	DEC_DWORD_STAT(STAT_CombatAIScheduledEnemies);
+}
+
+void UCombatAIScheduler::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// nothing to do without enemies
+	if (Enemies.IsEmpty())
+	{
+		return;
+	}
+
+	// wait for the next update
+	TimeSinceUpdate += DeltaTime;
+
+	if (TimeSinceUpdate < CombatAIScheduler::UpdateInterval)
+	{
+		return;
+	}
+
+	TimeSinceUpdate = 0.0f;
+	++UpdateCount;
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+
+	// copy the state we need out of the actors
+	GatherSnapshot();
+
+	// run the decisions, occasionally sampling the single threaded time so we can report the speedup
+	const double ParallelStart = FPlatformTime::Seconds();
+	MakeDecisions(CurrentTime, !CombatAIScheduler::bParallel);
+	LastParallelMs = (FPlatformTime::Seconds() - ParallelStart) * 1000.0;
+
+	// only sample while profiling the parallel path, since there's nothing to compare against otherwise
+	if (CombatAIScheduler::bParallel && CombatAIScheduler::SerialSampleRate > 0 && UpdateCount % CombatAIScheduler::SerialSampleRate == 0)
+	{
+		// the kernel only writes the decision arrays, so running it again produces the same results
+		const double SerialStart = FPlatformTime::Seconds();
+		MakeDecisions(CurrentTime, true);
+		LastSerialMs = (FPlatformTime::Seconds() - SerialStart) * 1000.0;
+
+		SET_FLOAT_STAT(STAT_CombatAIDecideSerialMs, LastSerialMs);
+		SET_FLOAT_STAT(STAT_CombatAIDecideParallelMs, LastParallelMs);
+		SET_FLOAT_STAT(STAT_CombatAIDecideSpeedup, LastParallelMs > 0.0 ? LastSerialMs / LastParallelMs : 0.0);
+		SET_DWORD_STAT(STAT_CombatAIWorkerThreads, FTaskGraphInterface::Get().GetNumWorkerThreads());
+	}
+
+	// apply the results on the game thread
+	ApplyDecisions(CurrentTime);
+}
+
+void UCombatAIScheduler::GatherSnapshot()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatAISchedulerGather);
+
+	// drop any enemies that have been destroyed
+	for (int32 Index = Enemies.Num() - 1; Index >= 0; --Index)
+	{
+		if (!Enemies[Index].IsValid())
+		{
+			RemoveAt(Index);
+		}
+	}
+
+	const int32 NumEnemies = Enemies.Num();
+
+	Locations.SetNumUninitialized(NumEnemies, EAllowShrinking::No);
+	Forwards.SetNumUninitialized(NumEnemies, EAllowShrinking::No);
+	CanAttack.SetNumUninitialized(NumEnemies, EAllowShrinking::No);
+
+	for (int32 Index = 0; Index < NumEnemies; ++Index)
+	{
+		const ACombatEnemy* Enemy = Enemies[Index].Get();
+
+		Locations[Index] = Enemy->GetActorLocation();
+		Forwards[Index] = Enemy->GetActorForwardVector();
+		CanAttack[Index] = Enemy->CurrentHP > 0.0f && !Enemy->IsAttacking() && Enemy->GetCharacterMovement()->IsMovingOnGround();
+	}
+
+	// gather all player pawns
+	Players.Reset();
+	PlayerLocations.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get())
+		{
+			if (APawn* PlayerPawn = PlayerController->GetPawn())
+			{
+				Players.Add(PlayerPawn);
+				PlayerLocations.Add(PlayerPawn->GetActorLocation());
+			}
+		}
+	}
+}
+
+void UCombatAIScheduler::MakeDecisions(double CurrentTime, bool bSingleThreaded)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatAISchedulerDecide);
+
+	const int32 NumEnemies = Enemies.Num();
+
+	TargetDecisions.SetNumUninitialized(NumEnemies, EAllowShrinking::No);
+	SpeedDecisions.SetNumUninitialized(NumEnemies, EAllowShrinking::No);
+	AttackDecisions.SetNumUninitialized(NumEnemies, EAllowShrinking::No);
+
+	// each enemy only reads the snapshot and writes its own decision slots, so there's nothing to synchronize
+	ParallelFor(TEXT("CombatAIScheduler"), NumEnemies, CombatAIScheduler::MinBatchSize, [this, CurrentTime](int32 Index)
+	{
+		DecideForEnemy(Index, CurrentTime);
+
+	}, bSingleThreaded ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void UCombatAIScheduler::DecideForEnemy(int32 Index, double CurrentTime)
+{
+	const FCombatAIDecisionSettings& EnemySettings = Settings[Index];
+	const FVector& Location = Locations[Index];
+
+	// find the closest player within sight range
+	int32 BestTarget = INDEX_NONE;
+	double BestDistanceSquared = FMath::Square(EnemySettings.SightRange);
+
+	for (int32 PlayerIndex = 0; PlayerIndex < PlayerLocations.Num(); ++PlayerIndex)
+	{
+		const double DistanceSquared = FVector::DistSquared(Location, PlayerLocations[PlayerIndex]);
+
+		if (DistanceSquared < BestDistanceSquared)
+		{
+			BestDistanceSquared = DistanceSquared;
+			BestTarget = PlayerIndex;
+		}
+	}
+
+	TargetDecisions[Index] = BestTarget;
+	AttackDecisions[Index] = EAttackDecision::None;
+
+	// no target in sight, so keep chasing at full speed
+	if (BestTarget == INDEX_NONE)
+	{
+		SpeedDecisions[Index] = EnemySettings.ChaseSpeed;
+		return;
+	}
+
+	const double Distance = FMath::Sqrt(BestDistanceSquared);
+
+	// slow down as we get close to the target
+	SpeedDecisions[Index] = Distance > EnemySettings.ApproachDistance ? EnemySettings.ChaseSpeed : EnemySettings.ApproachSpeed;
+
+	// can we attack?
+	if (!CanAttack[Index] || CurrentTime < NextAttackTimes[Index] || Distance > EnemySettings.ChargedAttackRange)
+	{
+		return;
+	}
+
+	// are we facing the target?
+	const FVector ToTarget = (PlayerLocations[BestTarget] - Location).GetSafeNormal2D();
+
+	if (FVector::DotProduct(Forwards[Index].GetSafeNormal2D(), ToTarget) < FMath::Cos(FMath::DegreesToRadians(EnemySettings.AttackAngle)))
+	{
+		return;
+	}
+
+	// pick the attack based on range
+	AttackDecisions[Index] = Distance <= EnemySettings.ComboAttackRange ? EAttackDecision::Combo : EAttackDecision::Charged;
+}
+
+void UCombatAIScheduler::ApplyDecisions(double CurrentTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatAISchedulerApply);
+
+	for (int32 Index = 0; Index < Enemies.Num(); ++Index)
+	{
+		ACombatEnemy* Enemy = Enemies[Index].Get();
+		ACombatAIController* AIController = Cast<ACombatAIController>(Enemy->GetController());
+
+		if (!AIController)
+		{
+			continue;
+		}
+
+		// update the focus if the target has changed
+		AActor* Target = TargetDecisions[Index] != INDEX_NONE ? Players[TargetDecisions[Index]].Get() : nullptr;
+
+		if (Target != AppliedTargets[Index].Get())
+		{
+			AppliedTargets[Index] = Target;
+
+			if (Target)
+			{
+				AIController->SetFocus(Target);
+			}
+			else
+			{
+				AIController->ClearFocus(EAIFocusPriority::Gameplay);
+			}
+
+			INC_DWORD_STAT(STAT_CombatAIFocusChanges);
+		}
+
+		// update the speed if it has changed
+		if (!FMath::IsNearlyEqual(SpeedDecisions[Index], AppliedSpeeds[Index]))
+		{
+			AppliedSpeeds[Index] = SpeedDecisions[Index];
+			Enemy->GetCharacterMovement()->MaxWalkSpeed = SpeedDecisions[Index];
+
+			INC_DWORD_STAT(STAT_CombatAISpeedChanges);
+		}
+
+		// trigger the attack through the StateTree so it can play the right task
+		if (AttackDecisions[Index] != EAttackDecision::None)
+		{
+			const FCombatAIDecisionSettings& EnemySettings = Settings[Index];
+			const FGameplayTag& AttackEvent = AttackDecisions[Index] == EAttackDecision::Combo ? EnemySettings.ComboAttackEvent : EnemySettings.ChargedAttackEvent;
+
+			if (AttackEvent.IsValid())
+			{
+				AIController->GetStateTreeAI()->SendStateTreeEvent(AttackEvent);
+				NextAttackTimes[Index] = CurrentTime + EnemySettings.AttackCooldown;
+
+				INC_DWORD_STAT(STAT_CombatAIAttacks);
+			}
+		}
+	}
+}
@@ -0,0 +1,174 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameplayTagContainer.h"
+#include "CombatAIScheduler.generated.h"
+
+class ACombatEnemy;
+class ACombatAIController;
+
+/**
+ *  Per-enemy tuning for the decisions made by the AI scheduler
+ */
+USTRUCT(BlueprintType)
+struct FCombatAIDecisionSettings
+{
+	GENERATED_BODY()
+
+	/** Max walk speed while the target is further than the approach distance */
+	UPROPERTY(EditAnywhere, Category="AI", meta = (ClampMin = 0, Units = "cm/s"))
+	float ChaseSpeed = 500.0f;
+
+	/** Max walk speed while the target is within the approach distance */
+	UPROPERTY(EditAnywhere, Category="AI", meta = (ClampMin = 0, Units = "cm/s"))
+	float ApproachSpeed = 200.0f;
+
+	/** Distance under which the enemy slows down to the approach speed */
+	UPROPERTY(EditAnywhere, Category="AI", meta = (ClampMin = 0, Units = "cm"))
+	float ApproachDistance = 400.0f;
+
+	/** Distance under which the enemy will trigger a combo attack */
+	UPROPERTY(EditAnywhere, Category="AI", meta = (ClampMin = 0, Units = "cm"))
+	float ComboAttackRange = 150.0f;
+
+	/** Distance under which the enemy will trigger a charged attack, if it's too far for a combo */
+	UPROPERTY(EditAnywhere, Category="AI", meta = (ClampMin = 0, Units = "cm"))
+	float ChargedAttackRange = 300.0f;
+
+	/** Max angle between the enemy's forward vector and the target for an attack to be triggered */
+	UPROPERTY(EditAnywhere, Category="AI", meta = (ClampMin = 0, ClampMax = 180, Units = "deg"))
+	float AttackAngle = 45.0f;
+
+	/** Time to wait between attacks */
+	UPROPERTY(EditAnywhere, Category="AI", meta = (ClampMin = 0, Units = "s"))
+	float AttackCooldown = 1.5f;
+
+	/** Targets further than this are ignored */
+	UPROPERTY(EditAnywhere, Category="AI", meta = (ClampMin = 0, Units = "cm"))
+	float SightRange = 3000.0f;
+
+	/** StateTree event sent to trigger a combo attack */
+	UPROPERTY(EditAnywhere, Category="AI")
+	FGameplayTag ComboAttackEvent;
+
+	/** StateTree event sent to trigger a charged attack */
+	UPROPERTY(EditAnywhere, Category="AI")
+	FGameplayTag ChargedAttackEvent;
+};
+
+/**
+ *  Batches the data-only parts of the enemy AI decisions for every registered enemy.
+ *  Enemy and player state is copied into flat arrays on the game thread, the distance checks,
+ *  target selection and attack range tests run in a ParallelFor over those arrays,
+ *  and only the resulting focus, speed and attack decisions are applied back on the game thread.
+ */
+UCLASS()
+class UCombatAIScheduler : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Attack decisions */
+	enum class EAttackDecision : uint8
+	{
+		None,
+		Combo,
+		Charged
+	};
+
+	/** Registered enemies */
+	TArray<TWeakObjectPtr<ACombatEnemy>> Enemies;
+
+	/** Decision settings for each enemy */
+	TArray<FCombatAIDecisionSettings> Settings;
+
+	/** Earliest time each enemy can attack again */
+	TArray<double> NextAttackTimes;
+
+	/** Target currently applied to each enemy */
+	TArray<TWeakObjectPtr<AActor>> AppliedTargets;
+
+	/** Speed currently applied to each enemy */
+	TArray<float> AppliedSpeeds;
+
+	/** Snapshot: enemy locations */
+	TArray<FVector> Locations;
+
+	/** Snapshot: enemy forward vectors */
+	TArray<FVector> Forwards;
+
+	/** Snapshot: true if the enemy is able to start an attack */
+	TArray<bool> CanAttack;
+
+	/** Snapshot: player pawns */
+	TArray<TWeakObjectPtr<AActor>> Players;
+
+	/** Snapshot: player locations */
+	TArray<FVector> PlayerLocations;
+
+	/** Decision: index of the target player, or INDEX_NONE */
+	TArray<int32> TargetDecisions;
+
+	/** Decision: max walk speed */
+	TArray<float> SpeedDecisions;
+
+	/** Decision: attack to trigger */
+	TArray<EAttackDecision> AttackDecisions;
+
+	/** Time accumulated since the last update */
+	float TimeSinceUpdate = 0.0f;
+
+	/** Number of updates performed, used to schedule serial timing samples */
+	uint32 UpdateCount = 0;
+
+	/** Last measured time for the decision pass, in milliseconds */
+	double LastParallelMs = 0.0;
+	double LastSerialMs = 0.0;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Runs the batched AI update */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Adds an enemy to the batched AI update */
+	void RegisterEnemy(ACombatEnemy* Enemy, const FCombatAIDecisionSettings& InSettings);
+
+	/** Removes an enemy from the batched AI update */
+	void UnregisterEnemy(ACombatEnemy* Enemy);
+
+	/** Returns the number of registered enemies */
+	int32 Num() const { return Enemies.Num(); }
+
+	/** Returns the last sampled serial and parallel decision times, in milliseconds */
+	void GetLastTimings(double& OutSerialMs, double& OutParallelMs) const { OutSerialMs = LastSerialMs; OutParallelMs = LastParallelMs; }
+
+protected:
+
+	/** Removes the enemy at the provided index from all arrays */
+	void RemoveAt(int32 Index);
+
+	/** Copies enemy and player state into the snapshot arrays */
+	void GatherSnapshot();
+
+	/** Runs the decision kernel over all enemies. Only reads the snapshot and writes the decision arrays */
+	void MakeDecisions(double CurrentTime, bool bSingleThreaded);
+
+	/** Decides for a single enemy */
+	void DecideForEnemy(int32 Index, double CurrentTime);
+
+	/** Applies the decisions back to the enemies */
+	void ApplyDecisions(double CurrentTime);
+};
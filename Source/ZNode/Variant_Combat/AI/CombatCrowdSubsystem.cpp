@@ -0,0 +1,366 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatCrowdSubsystem.h"
+#include "CombatEnemyMovementComponent.h"
+#include "CombatStateTreeUtility.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Algo/Sort.h"
+
+DECLARE_CYCLE_STAT(TEXT("Crowd Avoidance"), STAT_CombatCrowdAvoidance, STATGROUP_CombatAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Crowd Agents"), STAT_CombatCrowdAgents, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crowd Neighbours Evaluated"), STAT_CombatCrowdNeighbours, STATGROUP_CombatAI);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Crowd Avoidance (ms)"), STAT_CombatCrowdAvoidanceMs, STATGROUP_CombatAI);
+
+namespace CombatCrowd
+{
+	static bool bEnabled = false;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("Combat.AI.CrowdAvoidance"),
+		bEnabled,
+		TEXT("If true, enemies that opt in with bUseCrowdAvoidance will steer around each other using crowd avoidance"));
+
+	static float NeighbourRadius = 300.0f;
+	static FAutoConsoleVariableRef CVarNeighbourRadius(
+		TEXT("Combat.AI.CrowdNeighbourRadius"),
+		NeighbourRadius,
+		TEXT("Agents further than this are not considered neighbours. Also used as the spatial hash cell size"));
+
+	static int32 MaxNeighbours = 10;
+	static FAutoConsoleVariableRef CVarMaxNeighbours(
+		TEXT("Combat.AI.CrowdMaxNeighbours"),
+		MaxNeighbours,
+		TEXT("Max number of neighbours each agent will avoid"));
+
+	static float TimeHorizon = 1.5f;
+	static FAutoConsoleVariableRef CVarTimeHorizon(
+		TEXT("Combat.AI.CrowdTimeHorizon"),
+		TimeHorizon,
+		TEXT("Collisions further in the future than this are ignored, in seconds"));
+
+	/** Minimum number of agents per worker batch */
+	constexpr int32 MinBatchSize = 32;
+
+	/** Angles the preferred velocity is rotated by to build the candidate velocities, in degrees */
+	constexpr double CandidateAngles[] = { 0.0, 20.0, -20.0, 45.0, -45.0, 75.0, -75.0, 110.0, -110.0 };
+
+	/** Speed scales applied to each candidate direction */
+	constexpr double CandidateSpeeds[] = { 1.0, 0.5 };
+
+	/** How much a collision at time zero costs compared to deviating from the preferred velocity at full speed */
+	constexpr double CollisionPenalty = 2.0;
+
+	/** Returns the time until two discs collide, or TimeHorizon if they don't collide within it */
+	static double TimeToCollision(const FVector2D& RelativePosition, const FVector2D& RelativeVelocity, double CombinedRadius, double Horizon)
+	{
+		// solve |P - V*t| = R for the smallest positive t
+		const double A = RelativeVelocity.SizeSquared();
+		const double B = FVector2D::DotProduct(RelativePosition, RelativeVelocity);
+		const double C = RelativePosition.SizeSquared() - CombinedRadius * CombinedRadius;
+
+		// moving apart or not moving relative to each other
+		if (B <= 0.0 || A <= UE_SMALL_NUMBER)
+		{
+			return Horizon;
+		}
+
+		const double Discriminant = B * B - A * C;
+
+		if (Discriminant <= 0.0)
+		{
+			return Horizon;
+		}
+
+		const double Time = (B - FMath::Sqrt(Discriminant)) / A;
+
+		return FMath::Clamp(Time, 0.0, Horizon);
+	}
+}
+
+bool UCombatCrowdSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatCrowdSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_CombatCrowdAgents, Agents.Num());
+
+	Agents.Empty();
+	CellRanges.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatCrowdSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatCrowdSubsystem::IsEnabled()
+{
+	return CombatCrowd::bEnabled;
+}
+
+void UCombatCrowdSubsystem::RegisterAgent(UCombatEnemyMovementComponent* Agent)
+{
+	if (IsValid(Agent) && !Agents.Contains(Agent))
+	{
+		Agents.Add(Agent);
+		INC_DWORD_STAT(STAT_CombatCrowdAgents);
+	}
+}
+
+void UCombatCrowdSubsystem::UnregisterAgent(UCombatEnemyMovementComponent* Agent)
+{
+	if (Agents.RemoveSingleSwap(Agent, EAllowShrinking::No) > 0)
+	{
+		DEC_DWORD_STAT(STAT_CombatCrowdAgents);
+	}
+}
+
+void UCombatCrowdSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatCrowdAvoidance);
+
+	// drop any agents that have been destroyed
+	const int32 NumRemoved = Agents.RemoveAllSwap([](const TWeakObjectPtr<UCombatEnemyMovementComponent>& Agent) { return !Agent.IsValid(); }, EAllowShrinking::No);
+	DEC_DWORD_STAT_BY(STAT_CombatCrowdAgents, NumRemoved);
+
+	// stop steering if avoidance was turned off
+	if (!IsEnabled())
+	{
+		for (const TWeakObjectPtr<UCombatEnemyMovementComponent>& Agent : Agents)
+		{
+			Agent->ClearCrowdVelocity();
+		}
+
+		return;
+	}
+
+	if (Agents.IsEmpty())
+	{
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// copy the agent state and bucket the agents
+	const double NeighbourRadius = FMath::Max(CombatCrowd::NeighbourRadius, 1.0f);
+
+	GatherAgents();
+	BuildSpatialHash(NeighbourRadius);
+
+	// compute the avoidance velocities in parallel. Each agent only writes its own result slots
+	const int32 NumAgents = Agents.Num();
+	const int32 MaxNeighbours = FMath::Max(CombatCrowd::MaxNeighbours, 0);
+	const double TimeHorizon = FMath::Max(CombatCrowd::TimeHorizon, 0.1f);
+
+	AvoidanceVelocities.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+	NeighbourCounts.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+
+	ParallelFor(TEXT("CombatCrowdAvoidance"), NumAgents, CombatCrowd::MinBatchSize, [this, NeighbourRadius, MaxNeighbours, TimeHorizon](int32 Index)
+	{
+		ComputeAvoidance(Index, NeighbourRadius, MaxNeighbours, TimeHorizon);
+	});
+
+	// hand the results to the movement components
+	int32 TotalNeighbours = 0;
+
+	for (int32 Index = 0; Index < NumAgents; ++Index)
+	{
+		Agents[Index]->SetCrowdVelocity(FVector(AvoidanceVelocities[Index], 0.0));
+		TotalNeighbours += NeighbourCounts[Index];
+	}
+
+	INC_DWORD_STAT_BY(STAT_CombatCrowdNeighbours, TotalNeighbours);
+	INC_FLOAT_STAT_BY(STAT_CombatCrowdAvoidanceMs, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+void UCombatCrowdSubsystem::GatherAgents()
+{
+	const int32 NumAgents = Agents.Num();
+
+	Positions.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+	Velocities.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+	PreferredVelocities.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+	Radii.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+	MaxSpeeds.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+
+	for (int32 Index = 0; Index < NumAgents; ++Index)
+	{
+		const UCombatEnemyMovementComponent* Agent = Agents[Index].Get();
+		const ACharacter* Character = Agent->GetCharacterOwner();
+
+		Positions[Index] = FVector2D(Agent->GetActorFeetLocation());
+		Velocities[Index] = FVector2D(Agent->Velocity);
+		PreferredVelocities[Index] = FVector2D(Agent->GetPreferredVelocity());
+		Radii[Index] = Character ? Character->GetCapsuleComponent()->GetScaledCapsuleRadius() : 35.0f;
+		MaxSpeeds[Index] = Agent->GetMaxSpeed();
+	}
+}
+
+void UCombatCrowdSubsystem::BuildSpatialHash(double CellSize)
+{
+	const int32 NumAgents = Agents.Num();
+
+	// sort the agent indices by cell
+	SortedAgents.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+
+	TArray<uint64> AgentKeys;
+	AgentKeys.SetNumUninitialized(NumAgents);
+
+	for (int32 Index = 0; Index < NumAgents; ++Index)
+	{
+		AgentKeys[Index] = CellKey(FMath::FloorToInt32(Positions[Index].X / CellSize), FMath::FloorToInt32(Positions[Index].Y / CellSize));
+		SortedAgents[Index] = Index;
+	}
+
+	Algo::Sort(SortedAgents, [&AgentKeys](int32 A, int32 B) { return AgentKeys[A] < AgentKeys[B]; });
+
+	// record the range of sorted agents that falls into each cell
+	CellRanges.Reset();
+
+	for (int32 SortedIndex = 0; SortedIndex < NumAgents; ++SortedIndex)
+	{
+		const uint64 Key = AgentKeys[SortedAgents[SortedIndex]];
+
+		if (FIntPoint* Range = CellRanges.Find(Key))
+		{
+			++Range->Y;
+		}
+		else
+		{
+			CellRanges.Add(Key, FIntPoint(SortedIndex, 1));
+		}
+	}
+}
+
+void UCombatCrowdSubsystem::ComputeAvoidance(int32 Index, double NeighbourRadius, int32 MaxNeighbours, double TimeHorizon)
+{
+	const FVector2D& Position = Positions[Index];
+	const FVector2D& Velocity = Velocities[Index];
+	const FVector2D& Preferred = PreferredVelocities[Index];
+	const double Radius = Radii[Index];
+	const double MaxSpeed = FMath::Max(MaxSpeeds[Index], 1.0f);
+
+	// find the closest neighbours in the surrounding cells
+	constexpr int32 MaxNeighbourCapacity = 32;
+
+	int32 Neighbours[MaxNeighbourCapacity];
+	double NeighbourDistances[MaxNeighbourCapacity];
+	int32 NumNeighbours = 0;
+	const int32 NeighbourLimit = FMath::Min(MaxNeighbours, MaxNeighbourCapacity);
+
+	const int32 CellX = FMath::FloorToInt32(Position.X / NeighbourRadius);
+	const int32 CellY = FMath::FloorToInt32(Position.Y / NeighbourRadius);
+	const double NeighbourRadiusSquared = NeighbourRadius * NeighbourRadius;
+
+	for (int32 OffsetY = -1; OffsetY <= 1; ++OffsetY)
+	{
+		for (int32 OffsetX = -1; OffsetX <= 1; ++OffsetX)
+		{
+			const FIntPoint* Range = CellRanges.Find(CellKey(CellX + OffsetX, CellY + OffsetY));
+
+			if (!Range)
+			{
+				continue;
+			}
+
+			for (int32 SortedIndex = Range->X; SortedIndex < Range->X + Range->Y; ++SortedIndex)
+			{
+				const int32 Other = SortedAgents[SortedIndex];
+
+				if (Other == Index)
+				{
+					continue;
+				}
+
+				const double DistanceSquared = FVector2D::DistSquared(Position, Positions[Other]);
+
+				if (DistanceSquared > NeighbourRadiusSquared)
+				{
+					continue;
+				}
+
+				// keep the closest neighbours with an insertion sort
+				if (NumNeighbours < NeighbourLimit || (NeighbourLimit > 0 && DistanceSquared < NeighbourDistances[NumNeighbours - 1]))
+				{
+					int32 Slot = NumNeighbours < NeighbourLimit ? NumNeighbours++ : NumNeighbours - 1;
+
+					while (Slot > 0 && NeighbourDistances[Slot - 1] > DistanceSquared)
+					{
+						Neighbours[Slot] = Neighbours[Slot - 1];
+						NeighbourDistances[Slot] = NeighbourDistances[Slot - 1];
+						--Slot;
+					}
+
+					Neighbours[Slot] = Other;
+					NeighbourDistances[Slot] = DistanceSquared;
+				}
+			}
+		}
+	}
+
+	NeighbourCounts[Index] = NumNeighbours;
+
+	// nothing to avoid, or no intent to move
+	if (NumNeighbours == 0 || Preferred.IsNearlyZero())
+	{
+		AvoidanceVelocities[Index] = Preferred;
+		return;
+	}
+
+	// score each candidate velocity against the reciprocal velocity obstacles of the neighbours
+	FVector2D BestVelocity = Preferred;
+	double BestPenalty = UE_BIG_NUMBER;
+
+	for (const double Speed : CombatCrowd::CandidateSpeeds)
+	{
+		for (const double Angle : CombatCrowd::CandidateAngles)
+		{
+			const FVector2D Candidate = Preferred.GetRotated(Angle) * Speed;
+
+			double MinTime = TimeHorizon;
+
+			for (int32 NeighbourIndex = 0; NeighbourIndex < NumNeighbours; ++NeighbourIndex)
+			{
+				const int32 Other = Neighbours[NeighbourIndex];
+				const FVector2D RelativePosition = Positions[Other] - Position;
+				const double CombinedRadius = Radius + Radii[Other];
+
+				// reciprocal: each agent takes half the responsibility for avoiding the other
+				const FVector2D RelativeVelocity = Candidate * 2.0 - Velocity - Velocities[Other];
+
+				// already overlapping, so any velocity moving towards the neighbour collides right away
+				if (RelativePosition.SizeSquared() < CombinedRadius * CombinedRadius)
+				{
+					if (FVector2D::DotProduct(Candidate, RelativePosition) > 0.0)
+					{
+						MinTime = 0.0;
+					}
+
+					continue;
+				}
+
+				MinTime = FMath::Min(MinTime, CombatCrowd::TimeToCollision(RelativePosition, RelativeVelocity, CombinedRadius, TimeHorizon));
+			}
+
+			// deviation from the preferred velocity plus how soon we'd collide
+			const double Penalty = FVector2D::Distance(Candidate, Preferred) + CombatCrowd::CollisionPenalty * MaxSpeed * (1.0 - MinTime / TimeHorizon);
+
+			if (Penalty < BestPenalty)
+			{
+				BestPenalty = Penalty;
+				BestVelocity = Candidate;
+			}
+		}
+	}
+
+	AvoidanceVelocities[Index] = BestVelocity.GetClampedToMaxSize(MaxSpeed);
+}
@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatCrowdSubsystem.generated.h"
+
+class UCombatEnemyMovementComponent;
+
+/**
+ *  Lightweight local avoidance for combat enemies.
+ *  Agents are bucketed into a spatial hash every frame. Each agent then picks a velocity
+ *  from a small set of candidates around its preferred velocity, scoring them against
+ *  the reciprocal velocity obstacles of its closest neighbours (RVO sampling).
+ *  Agents are evaluated in parallel, and the results are handed to their movement components.
+ *  Off by default. Enable it with Combat.AI.CrowdAvoidance, and opt enemies in with bUseCrowdAvoidance on their movement component.
+ */
+UCLASS()
+class UCombatCrowdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Registered agents */
+	TArray<TWeakObjectPtr<UCombatEnemyMovementComponent>> Agents;
+
+	/** Snapshot: 2D agent positions */
+	TArray<FVector2D> Positions;
+
+	/** Snapshot: 2D agent velocities */
+	TArray<FVector2D> Velocities;
+
+	/** Snapshot: 2D preferred velocities */
+	TArray<FVector2D> PreferredVelocities;
+
+	/** Snapshot: agent radii */
+	TArray<float> Radii;
+
+	/** Snapshot: agent max speeds */
+	TArray<float> MaxSpeeds;
+
+	/** Spatial hash: agent indices sorted by cell */
+	TArray<int32> SortedAgents;
+
+	/** Spatial hash: first sorted index and agent count for each occupied cell */
+	TMap<uint64, FIntPoint> CellRanges;
+
+	/** Result: avoidance velocity for each agent */
+	TArray<FVector2D> AvoidanceVelocities;
+
+	/** Result: number of neighbours each agent evaluated */
+	TArray<int32> NeighbourCounts;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Computes avoidance for all agents */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Adds an agent to the crowd */
+	void RegisterAgent(UCombatEnemyMovementComponent* Agent);
+
+	/** Removes an agent from the crowd */
+	void UnregisterAgent(UCombatEnemyMovementComponent* Agent);
+
+	/** Returns true if crowd avoidance is enabled */
+	static bool IsEnabled();
+
+protected:
+
+	/** Copies the agent state into the snapshot arrays */
+	void GatherAgents();
+
+	/** Buckets the agents into the spatial hash */
+	void BuildSpatialHash(double CellSize);
+
+	/** Computes the avoidance velocity for a single agent. Only reads the snapshot and writes the agent's result slots */
+	void ComputeAvoidance(int32 Index, double NeighbourRadius, int32 MaxNeighbours, double TimeHorizon);
+
+	/** Returns the spatial hash key for a cell */
+	static uint64 CellKey(int32 X, int32 Y) { return (static_cast<uint64>(static_cast<uint32>(X)) << 32) | static_cast<uint32>(Y); }
+};
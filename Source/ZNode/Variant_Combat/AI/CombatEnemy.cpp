@@ -5,16 +5,27 @@
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "CombatAIController.h"
+#include "CombatEnemyMovementComponent.h"
+#include "CombatCrowdSubsystem.h"
 #include "Components/WidgetComponent.h"
 #include "Engine/DamageEvents.h"
 #include "CombatLifeBar.h"
-#include "TimerManager.h"
+#include "CombatLifeBarSubsystem.h"
+#include "CombatHUD.h"
+#include "GameFramework/PlayerController.h"
+#include "CombatVATSubsystem.h"
+#include "GameplayTimerSubsystem.h"
+#include "CombatReplaySubsystem.h"
+#include "FrameScratchAllocator.h"
+#include "ServerAnimation.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Animation/AnimInstance.h"
 
-ACombatEnemy::ACombatEnemy()
+ACombatEnemy::ACombatEnemy(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCombatEnemyMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// nothing to do per frame, so don't register a tick. Movement, animation and AI tick on their own components
+	PrimaryActorTick.bCanEverTick = false;
 
 	// bind the attack montage ended delegate
 	OnAttackMontageEnded.BindUObject(this, &ACombatEnemy::AttackMontageEnded);
@@ -54,7 +65,7 @@ void ACombatEnemy::DoAIComboAttack()
 	bIsAttacking = true;
 
 	// choose how many times we're going to attack
-	TargetComboCount = FMath::RandRange(1, ComboSectionNames.Num() - 1);
+	TargetComboCount = RandomStream.RandRange(1, ComboSectionNames.Num() - 1);
 
 	// reset the attack counter
 	CurrentComboAttack = 0;
@@ -85,7 +96,7 @@ void ACombatEnemy::DoAIChargedAttack()
 	bIsAttacking = true;
 
 	// choose how many loops are we going to charge for
-	TargetChargeLoops = FMath::RandRange(MinChargeLoops, MaxChargeLoops);
+	TargetChargeLoops = RandomStream.RandRange(MinChargeLoops, MaxChargeLoops);
 
 	// reset the charge loop counter
 	CurrentChargeLoop = 0;
@@ -116,7 +127,11 @@ void ACombatEnemy::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted)
 void ACombatEnemy::DoAttackTrace(FName DamageSourceBone)
 {
 	// sweep for objects in front of the character to be hit by the attack
-	TArray<FHitResult> OutHits;
+	FScopedHitResults ScopedHits;
+	TArray<FHitResult>& OutHits = ScopedHits.Get();
+
+	// servers may be skipping our pose, so make sure the socket is up to date
+	ServerAnimation::EnsurePose(GetMesh());
 
 	// start at the provided socket location, sweep forward
 	const FVector TraceStart = GetMesh()->GetSocketLocation(DamageSourceBone);
@@ -189,7 +204,12 @@ void ACombatEnemy::CheckChargedAttack()
 
 void ACombatEnemy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
 {
-	
+	// record the damage for replays
+	if (UCombatReplaySubsystem* Replay = GetWorld()->GetSubsystem<UCombatReplaySubsystem>())
+	{
+		Replay->RecordDamage(this, Damage);
+	}
+
 	// pass the damage event to the actor
 	FDamageEvent DamageEvent;
 	const float ActualDamage = TakeDamage(Damage, DamageEvent, nullptr, DamageCauser);
@@ -222,7 +242,28 @@ void ACombatEnemy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector
 void ACombatEnemy::HandleDeath()
 {
 	// hide the life bar
-	LifeBar->SetHiddenInGame(true);
+	if (LifeBar)
+	{
+		LifeBar->SetHiddenInGame(true);
+	}
+
+	// remove the batched life bar
+	UnregisterBatchedLifeBar();
+
+	// stop making AI decisions for this enemy
+	if (bUseScheduledAI)
+	{
+		if (UCombatAIScheduler* Scheduler = GetWorld()->GetSubsystem<UCombatAIScheduler>())
+		{
+			Scheduler->UnregisterEnemy(this);
+		}
+	}
+
+	// ragdolls need the skeletal mesh
+	if (UCombatVATSubsystem* VAT = GetWorld()->GetSubsystem<UCombatVATSubsystem>())
+	{
+		VAT->UnregisterEnemy(this);
+	}
 
 	// disable the collision capsule to avoid being hit again while dead
 	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
@@ -230,14 +271,23 @@ void ACombatEnemy::HandleDeath()
 	// disable character movement
 	GetCharacterMovement()->DisableMovement();
 
+	// stop other enemies from avoiding our body
+	if (UCombatCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UCombatCrowdSubsystem>())
+	{
+		Crowd->UnregisterAgent(Cast<UCombatEnemyMovementComponent>(GetCharacterMovement()));
+	}
+
 	// enable full ragdoll physics
 	GetMesh()->SetSimulatePhysics(true);
 
 	// call the died delegate to notify any subscribers
 	OnEnemyDied.Broadcast();
 
-	// set up the death timer
-	GetWorld()->GetTimerManager().SetTimer(DeathTimer, this, &ACombatEnemy::RemoveFromLevel, DeathRemovalTime);
+	// schedule the removal from the level
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->Schedule<&ACombatEnemy::RemoveFromLevel>(this, DeathRemovalTime);
+	}
 }
 
 void ACombatEnemy::ApplyHealing(float Healing, AActor* Healer)
@@ -251,6 +301,47 @@ void ACombatEnemy::RemoveFromLevel()
 	Destroy();
 }
 
+void ACombatEnemy::UpdateLifeBar(float Percentage)
+{
+	// update the batched life bar if we have one
+	if (BatchedLifeBarHandle != INDEX_NONE)
+	{
+		if (UCombatLifeBarSubsystem* LifeBars = GetWorld()->GetSubsystem<UCombatLifeBarSubsystem>())
+		{
+			LifeBars->SetLifePercentage(BatchedLifeBarHandle, Percentage);
+		}
+	}
+	else if (LifeBarWidget)
+	{
+		// otherwise update the widget
+		LifeBarWidget->SetLifePercentage(Percentage);
+	}
+}
+
+void ACombatEnemy::SetCurrentHP(float NewHP)
+{
+	CurrentHP = FMath::Min(NewHP, MaxHP);
+
+	// refresh the life bar
+	UpdateLifeBar(CurrentHP / MaxHP);
+}
+
+void ACombatEnemy::UnregisterBatchedLifeBar()
+{
+	// ignore if we don't have a batched life bar
+	if (BatchedLifeBarHandle == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (UCombatLifeBarSubsystem* LifeBars = GetWorld()->GetSubsystem<UCombatLifeBarSubsystem>())
+	{
+		LifeBars->UnregisterLifeBar(BatchedLifeBarHandle);
+	}
+
+	BatchedLifeBarHandle = INDEX_NONE;
+}
+
 float ACombatEnemy::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
 	// only process damage if the character is still alive
@@ -271,7 +362,7 @@ float ACombatEnemy::TakeDamage(float Damage, struct FDamageEvent const& DamageEv
 	else
 	{
 		// update the life bar
-		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
+		UpdateLifeBar(CurrentHP / MaxHP);
 
 		// enable partial ragdoll physics, but keep the pelvis vertical
 		GetMesh()->SetPhysicsBlendWeight(0.5f);
@@ -305,18 +396,90 @@ void ACombatEnemy::BeginPlay()
 	// we top the HP before BeginPlay so StateTree picks it up at the right value
 	Super::BeginPlay();
 
-	// get the life bar widget from the widget comp
-	LifeBarWidget = Cast<UCombatLifeBar>(LifeBar->GetUserWidgetObject());
-	check(LifeBarWidget);
+	// on servers, only tick montages while not rendered. Attack traces evaluate the pose on demand
+	ServerAnimation::ApplySkipping(GetMesh());
+
+	// get our own random stream so attack choices don't depend on other enemies
+	if (UGameplayRandomSubsystem* Random = GetWorld()->GetSubsystem<UGameplayRandomSubsystem>())
+	{
+		RandomStream = Random->MakeActorStream(this);
+	}
+
+	// are we using the batched life bar? Only the combat HUD draws it, so keep the widget component otherwise
+	const APlayerController* LocalController = GetWorld()->GetFirstPlayerController();
+	const bool bHasCombatHUD = LocalController && Cast<ACombatHUD>(LocalController->GetHUD());
+
+	UCombatLifeBarSubsystem* LifeBars = bUseBatchedLifeBar && bHasCombatHUD ? GetWorld()->GetSubsystem<UCombatLifeBarSubsystem>() : nullptr;
+
+	if (LifeBars)
+	{
+		// register a full life bar with the subsystem so the HUD draws it
+		BatchedLifeBarHandle = LifeBars->RegisterLifeBar(GetRootComponent(), BatchedLifeBarOffset, BatchedLifeBarColor, 1.0f);
+
+		// we no longer need the widget component, so remove it to save its render target and tick
+		if (LifeBar)
+		{
+			LifeBar->DestroyComponent();
+			LifeBar = nullptr;
+		}
+	}
+	else
+	{
+		// get the life bar widget from the widget comp
+		LifeBarWidget = Cast<UCombatLifeBar>(LifeBar->GetUserWidgetObject());
+		check(LifeBarWidget);
+
+		// fill the life bar
+		LifeBarWidget->SetLifePercentage(1.0f);
+	}
 
-	// fill the life bar
-	LifeBarWidget->SetLifePercentage(1.0f);
+	// hand our AI decisions over to the scheduler
+	if (bUseScheduledAI)
+	{
+		if (UCombatAIScheduler* Scheduler = GetWorld()->GetSubsystem<UCombatAIScheduler>())
+		{
+			Scheduler->RegisterEnemy(this, ScheduledAISettings);
+		}
+	}
+
+	// draw ourselves through the VAT batch while far away
+	if (VATAsset)
+	{
+		if (UCombatVATSubsystem* VAT = GetWorld()->GetSubsystem<UCombatVATSubsystem>())
+		{
+			VAT->RegisterEnemy(this, VATAsset);
+		}
+	}
 }
 
 void ACombatEnemy::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the death timer
-	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+	// cancel the pending death removal
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->CancelAll(this);
+	}
+
+	// remove our life bar from the batch
+	UnregisterBatchedLifeBar();
+
+	// stop counting our mesh as skipped
+	ServerAnimation::RemoveSkipping(GetMesh());
+
+	// remove ourselves from the AI scheduler
+	if (bUseScheduledAI)
+	{
+		if (UCombatAIScheduler* Scheduler = GetWorld()->GetSubsystem<UCombatAIScheduler>())
+		{
+			Scheduler->UnregisterEnemy(this);
+		}
+	}
+
+	// leave the VAT batch
+	if (UCombatVATSubsystem* VAT = GetWorld()->GetSubsystem<UCombatVATSubsystem>())
+	{
+		VAT->UnregisterEnemy(this);
+	}
 }
@@ -8,11 +8,14 @@
 #include "CombatDamageable.h"
 #include "Animation/AnimMontage.h"
 #include "Engine/TimerHandle.h"
+#include "CombatAIScheduler.h"
+#include "GameplayRandomSubsystem.h"
 #include "CombatEnemy.generated.h"
 
 class UWidgetComponent;
 class UCombatLifeBar;
 class UAnimMontage;
+class UCombatVATAsset;
 
 /** Completed attack animation delegate for StateTree */
 DECLARE_DELEGATE(FOnEnemyAttackCompleted);
@@ -39,7 +42,7 @@ class ACombatEnemy : public ACharacter, public ICombatAttacker, public ICombatDa
 public:
 	
 	/** Constructor */
-	ACombatEnemy();
+	ACombatEnemy(const FObjectInitializer& ObjectInitializer);
 
 protected:
 
@@ -63,6 +66,22 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Damage")
 	UCombatLifeBar* LifeBarWidget;
 
+	/** If true, the life bar will be drawn by the combat HUD in a single batch instead of through the widget component.
+	 *  The widget component will be removed on BeginPlay. Falls back to the widget component if the local player has no combat HUD */
+	UPROPERTY(EditAnywhere, Category="UI")
+	bool bUseBatchedLifeBar = false;
+
+	/** Offset from the actor root where the batched life bar will be drawn */
+	UPROPERTY(EditAnywhere, Category="UI", meta = (EditCondition = "bUseBatchedLifeBar"))
+	FVector BatchedLifeBarOffset = FVector(0.0f, 0.0f, 120.0f);
+
+	/** Fill color for the batched life bar */
+	UPROPERTY(EditAnywhere, Category="UI", meta = (EditCondition = "bUseBatchedLifeBar"))
+	FLinearColor BatchedLifeBarColor = FLinearColor(0.8f, 0.05f, 0.05f, 1.0f);
+
+	/** Handle to our life bar in the batched life bar subsystem */
+	int32 BatchedLifeBarHandle = INDEX_NONE;
+
 	/** If true, the character is currently playing an attack animation */
 	bool bIsAttacking = false;
 
@@ -130,12 +149,24 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Death")
 	float DeathRemovalTime = 5.0f;
 
-	/** Enemy death timer */
-	FTimerHandle DeathTimer;
-
 	/** Attack montage ended delegate */
 	FOnMontageEnded OnAttackMontageEnded;
 
+	/** Random stream for attack choices, so they can be reproduced for the same session seed */
+	FGameplayRandomStream RandomStream;
+
+	/** If true, focus, speed and attack decisions for this enemy will be made by the batched AI scheduler */
+	UPROPERTY(EditAnywhere, Category="AI")
+	bool bUseScheduledAI = false;
+
+	/** Decision settings used by the batched AI scheduler */
+	UPROPERTY(EditAnywhere, Category="AI", meta = (EditCondition = "bUseScheduledAI"))
+	FCombatAIDecisionSettings ScheduledAISettings;
+
+	/** Baked vertex animations used to draw this enemy as an instance while it's far away. Leave empty to always use the skeletal mesh */
+	UPROPERTY(EditAnywhere, Category="Rendering")
+	UCombatVATAsset* VATAsset = nullptr;
+
 public:
 	/** Attack completed internal delegate to notify StateTree tasks */
 	FOnEnemyAttackCompleted OnAttackCompleted;
@@ -158,6 +189,18 @@ public:
 	/** Called from a delegate when the attack montage ends */
 	void AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted);
 
+	/** Returns true if the character is currently playing an attack animation */
+	bool IsAttacking() const { return bIsAttacking; }
+
+	/** Returns the character's max HP */
+	float GetMaxHP() const { return MaxHP; }
+
+	/** Returns the baked vertex animations used to draw this enemy while far away */
+	UCombatVATAsset* GetVATAsset() const { return VATAsset; }
+
+	/** Overrides the current HP and refreshes the life bar. Used to carry HP over when spawning from another representation */
+	void SetCurrentHP(float NewHP);
+
 public:
 
 	// ~begin ICombatAttacker interface
@@ -193,6 +236,12 @@ protected:
 	/** Removes this character from the level after it dies */
 	void RemoveFromLevel();
 
+	/** Updates the life bar with the provided fill percentage */
+	void UpdateLifeBar(float Percentage);
+
+	/** Removes our life bar from the batched life bar subsystem */
+	void UnregisterBatchedLifeBar();
+
 public:
 
 	/** Overrides the default TakeDamage functionality */
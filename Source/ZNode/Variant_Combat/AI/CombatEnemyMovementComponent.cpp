@@ -0,0 +1,63 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatEnemyMovementComponent.h"
+#include "CombatCrowdSubsystem.h"
+#include "Engine/World.h"
+
+void UCombatEnemyMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// join the crowd
+	if (bUseCrowdAvoidance)
+	{
+		if (UCombatCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UCombatCrowdSubsystem>())
+		{
+			Crowd->RegisterAgent(this);
+		}
+	}
+}
+
+void UCombatEnemyMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// leave the crowd
+	if (UCombatCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UCombatCrowdSubsystem>())
+	{
+		Crowd->UnregisterAgent(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UCombatEnemyMovementComponent::CalcVelocity(float DeltaTime, float Friction, bool bFluid, float BrakingDeceleration)
+{
+	// save the velocity we want to move at so the crowd can plan around it
+	PreferredVelocity = bHasRequestedVelocity ? RequestedVelocity : Acceleration.GetSafeNormal() * GetMaxSpeed();
+
+	Super::CalcVelocity(DeltaTime, Friction, bFluid, BrakingDeceleration);
+
+	// only steer while walking with some intent to move
+	if (!bHasCrowdVelocity || !IsMovingOnGround() || PreferredVelocity.IsNearlyZero())
+	{
+		return;
+	}
+
+	// blend the horizontal velocity towards the avoidance velocity
+	const FVector Horizontal(Velocity.X, Velocity.Y, 0.0f);
+	const FVector Blended = FMath::Lerp(Horizontal, CrowdVelocity, CrowdAvoidanceWeight).GetClampedToMaxSize(GetMaxSpeed());
+
+	Velocity.X = Blended.X;
+	Velocity.Y = Blended.Y;
+}
+
+void UCombatEnemyMovementComponent::SetCrowdVelocity(const FVector& InVelocity)
+{
+	CrowdVelocity = FVector(InVelocity.X, InVelocity.Y, 0.0f);
+	bHasCrowdVelocity = true;
+}
+
+void UCombatEnemyMovementComponent::ClearCrowdVelocity()
+{
+	bHasCrowdVelocity = false;
+}
@@ -0,0 +1,58 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "CombatEnemyMovementComponent.generated.h"
+
+/**
+ *  Character Movement Component for combat enemies.
+ *  Optionally registers with the crowd subsystem and steers its walking velocity
+ *  towards the avoidance velocity computed for it, so enemies spread out around
+ *  their target instead of relying on capsule collisions to separate.
+ */
+UCLASS()
+class UCombatEnemyMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** If true, this enemy will take part in crowd avoidance while Combat.AI.CrowdAvoidance is enabled */
+	UPROPERTY(EditAnywhere, Category="Crowd Avoidance")
+	bool bUseCrowdAvoidance = false;
+
+	/** How strongly the avoidance velocity overrides the desired velocity. 1 fully replaces it */
+	UPROPERTY(EditAnywhere, Category="Crowd Avoidance", meta = (ClampMin = 0, ClampMax = 1, EditCondition = "bUseCrowdAvoidance"))
+	float CrowdAvoidanceWeight = 0.8f;
+
+	/** Velocity the character wanted to move at before avoidance was applied */
+	FVector PreferredVelocity = FVector::ZeroVector;
+
+	/** Avoidance velocity provided by the crowd subsystem */
+	FVector CrowdVelocity = FVector::ZeroVector;
+
+	/** True if the crowd subsystem has provided an avoidance velocity */
+	bool bHasCrowdVelocity = false;
+
+public:
+
+	/** Registers with the crowd subsystem */
+	virtual void BeginPlay() override;
+
+	/** Unregisters from the crowd subsystem */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Blends the crowd avoidance velocity into the walking velocity */
+	virtual void CalcVelocity(float DeltaTime, float Friction, bool bFluid, float BrakingDeceleration) override;
+
+	/** Returns the velocity the character wanted to move at before avoidance */
+	const FVector& GetPreferredVelocity() const { return PreferredVelocity; }
+
+	/** Sets the avoidance velocity to blend in on the next movement update */
+	void SetCrowdVelocity(const FVector& InVelocity);
+
+	/** Stops applying crowd avoidance until a new velocity is provided */
+	void ClearCrowdVelocity();
+};
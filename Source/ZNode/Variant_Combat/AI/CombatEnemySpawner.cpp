@@ -5,7 +5,8 @@
 #include "Components/SceneComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/ArrowComponent.h"
-#include "TimerManager.h"
+#include "GameplayTimerSubsystem.h"
+#include "CombatReplaySubsystem.h"
 #include "CombatEnemy.h"
 
 ACombatEnemySpawner::ACombatEnemySpawner()
@@ -35,7 +36,10 @@ void ACombatEnemySpawner::BeginPlay()
 	if (bShouldSpawnEnemiesImmediately)
 	{
 		// schedule the first enemy spawn
-		GetWorld()->GetTimerManager().SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnEnemy, InitialSpawnDelay);
+		if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+		{
+			Timers->Schedule<&ACombatEnemySpawner::SpawnEnemy>(this, InitialSpawnDelay);
+		}
 	}
 
 }
@@ -44,8 +48,11 @@ void ACombatEnemySpawner::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the spawn timer
-	GetWorld()->GetTimerManager().ClearTimer(SpawnTimer);
+	// cancel any pending spawns
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->CancelAll(this);
+	}
 }
 
 void ACombatEnemySpawner::SpawnEnemy()
@@ -57,6 +64,9 @@ void ACombatEnemySpawner::SpawnEnemy()
 		FActorSpawnParameters SpawnParams;
 		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
 
+		// own the enemy so its random stream is keyed on this spawner
+		SpawnParams.Owner = this;
+
 		ACombatEnemy* SpawnedEnemy = GetWorld()->SpawnActor<ACombatEnemy>(EnemyClass, SpawnCapsule->GetComponentTransform(), SpawnParams);
 
 		// was the enemy successfully created?
@@ -64,6 +74,12 @@ void ACombatEnemySpawner::SpawnEnemy()
 		{
 			// subscribe to the death delegate
 			SpawnedEnemy->OnEnemyDied.AddDynamic(this, &ACombatEnemySpawner::OnEnemyDied);
+
+			// record the spawn for replays
+			if (UCombatReplaySubsystem* Replay = GetWorld()->GetSubsystem<UCombatReplaySubsystem>())
+			{
+				Replay->RecordSpawn(this);
+			}
 		}
 	}
 }
@@ -77,12 +93,18 @@ void ACombatEnemySpawner::OnEnemyDied()
 	if (SpawnCount <= 0)
 	{
 		// schedule the activation on depleted message
-		GetWorld()->GetTimerManager().SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnerDepleted, ActivationDelay);
+		if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+		{
+			Timers->Schedule<&ACombatEnemySpawner::SpawnerDepleted>(this, ActivationDelay);
+		}
 		return;
 	}
 
 	// schedule the next enemy spawn
-	GetWorld()->GetTimerManager().SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnEnemy, RespawnDelay);
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->Schedule<&ACombatEnemySpawner::SpawnEnemy>(this, RespawnDelay);
+	}
 }
 
 void ACombatEnemySpawner::SpawnerDepleted()
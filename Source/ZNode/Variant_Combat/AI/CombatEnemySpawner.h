@@ -61,9 +61,6 @@ protected:
 	/** Flag to ensure this is only activated once */
 	bool bHasBeenActivated = false;
 
-	/** Timer to spawn enemies after a delay */
-	FTimerHandle SpawnTimer;
-
 public:	
 	
 	/** Constructor */
@@ -91,6 +88,9 @@ protected:
 
 public:
 
+	/** Returns the type of enemy this spawner creates */
+	TSubclassOf<ACombatEnemy> GetEnemyClass() const { return EnemyClass; }
+
 	// ~begin ICombatActivatable interface
 
 	/** Toggles the Spawner */
@@ -0,0 +1,494 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatFlowFieldSubsystem.h"
+#include "CombatStateTreeUtility.h"
+#include "NavigationSystem.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Flow Field Update"), STAT_CombatFlowFieldUpdate, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Cells Integrated"), STAT_CombatFlowFieldCells, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Walkability Probes"), STAT_CombatFlowFieldProbes, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Passes Published"), STAT_CombatFlowFieldPasses, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Samples"), STAT_CombatFlowFieldSamples, STATGROUP_CombatAI);
+
+namespace CombatFlowField
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("Combat.AI.FlowField"),
+		bEnabled,
+		TEXT("If true, enemies following the flow field will sample it instead of requesting paths"));
+
+	static int32 CellsPerFrame = 8192;
+	static FAutoConsoleVariableRef CVarCellsPerFrame(
+		TEXT("Combat.AI.FlowFieldCellsPerFrame"),
+		CellsPerFrame,
+		TEXT("Max number of flow field cells integrated per frame across all fields"));
+
+	static int32 ProbesPerFrame = 256;
+	static FAutoConsoleVariableRef CVarProbesPerFrame(
+		TEXT("Combat.AI.FlowFieldProbesPerFrame"),
+		ProbesPerFrame,
+		TEXT("Max number of navmesh walkability probes per frame across all fields"));
+
+	/** Number of cells along each side of the grid */
+	constexpr int32 GridSize = 128;
+
+	/** Total number of cells in the grid. Must fit in the low 16 bits of an open list entry */
+	constexpr int32 NumCells = GridSize * GridSize;
+	static_assert(NumCells <= 0x10000, "Flow field cell indices must fit in 16 bits");
+
+	/** Size of each cell */
+	constexpr double CellSize = 100.0;
+
+	/** Vertical extent used when probing the navmesh */
+	constexpr double ProbeHeight = 300.0;
+
+	/** The grid is recentered when the target gets this many cells away from its center */
+	constexpr int32 RecenterDistance = GridSize / 4;
+
+	/** Walkability values */
+	constexpr uint8 Unknown = 0;
+	constexpr uint8 Walkable = 1;
+	constexpr uint8 Blocked = 2;
+
+	/** Special direction values */
+	constexpr uint8 AtGoal = 8;
+	constexpr uint8 NoDirection = 255;
+
+	/** Neighbour offsets for each of the 8 directions, and their step costs */
+	constexpr int32 OffsetX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+	constexpr int32 OffsetY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+	constexpr uint32 StepCost[8] = { 10, 14, 10, 14, 10, 14, 10, 14 };
+
+	/** Unit vector for each of the 8 directions */
+	static const FVector2D DirectionVectors[8] =
+	{
+		FVector2D(1.0, 0.0), FVector2D(UE_INV_SQRT_2, UE_INV_SQRT_2), FVector2D(0.0, 1.0), FVector2D(-UE_INV_SQRT_2, UE_INV_SQRT_2),
+		FVector2D(-1.0, 0.0), FVector2D(-UE_INV_SQRT_2, -UE_INV_SQRT_2), FVector2D(0.0, -1.0), FVector2D(UE_INV_SQRT_2, -UE_INV_SQRT_2)
+	};
+
+	/** Returns true if a step from the cell in the provided direction is allowed. Diagonal steps can't cut blocked corners */
+	static bool CanStep(const TArray<uint8>& Walkability, int32 X, int32 Y, int32 Direction)
+	{
+		const int32 NX = X + OffsetX[Direction];
+		const int32 NY = Y + OffsetY[Direction];
+
+		if (NX < 0 || NY < 0 || NX >= GridSize || NY >= GridSize || Walkability[NY * GridSize + NX] == Blocked)
+		{
+			return false;
+		}
+
+		// check the corners for diagonal steps
+		if (Direction % 2 == 1)
+		{
+			return Walkability[Y * GridSize + NX] != Blocked && Walkability[NY * GridSize + X] != Blocked;
+		}
+
+		return true;
+	}
+}
+
+bool UCombatFlowFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatFlowFieldSubsystem::Deinitialize()
+{
+	Fields.Empty();
+	NumFollowers = 0;
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatFlowFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatFlowFieldSubsystem::IsEnabled()
+{
+	return CombatFlowField::bEnabled;
+}
+
+void UCombatFlowFieldSubsystem::AddFollower()
+{
+	++NumFollowers;
+}
+
+void UCombatFlowFieldSubsystem::RemoveFollower()
+{
+	NumFollowers = FMath::Max(NumFollowers - 1, 0);
+
+	// nobody is following the fields anymore, so release them instead of keeping them up to date
+	if (NumFollowers == 0)
+	{
+		Fields.Empty();
+	}
+}
+
+void UCombatFlowFieldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatFlowFieldUpdate);
+
+	if (!IsEnabled() || NumFollowers == 0)
+	{
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	SyncTargets();
+
+	// share the per-frame budgets between all fields
+	int32 ProbeBudget = CombatFlowField::ProbesPerFrame;
+	int32 CellBudget = CombatFlowField::CellsPerFrame;
+
+	for (FFlowField& Field : Fields)
+	{
+		UpdateField(Field);
+
+		ProbeBudget -= ProbeWalkability(Field, ProbeBudget);
+		CellBudget -= AdvanceIntegration(Field, CellBudget);
+	}
+
+	TotalUpdateSeconds += FPlatformTime::Seconds() - StartTime;
+}
+
+void UCombatFlowFieldSubsystem::SyncTargets()
+{
+	// drop fields for targets that are gone
+	Fields.RemoveAllSwap([](const FFlowField& Field) { return !Field.Target.IsValid(); }, EAllowShrinking::No);
+
+	// add a field for every player pawn that doesn't have one
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		const APawn* PlayerPawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+
+		if (PlayerPawn && !Fields.ContainsByPredicate([PlayerPawn](const FFlowField& Field) { return Field.Target.Get() == PlayerPawn; }))
+		{
+			FFlowField& NewField = Fields.AddDefaulted_GetRef();
+			NewField.Target = PlayerPawn;
+		}
+	}
+}
+
+void UCombatFlowFieldSubsystem::UpdateField(FFlowField& Field)
+{
+	using namespace CombatFlowField;
+
+	const FVector TargetLocation = Field.Target->GetActorLocation();
+	const FIntPoint TargetCell = WorldToCell(TargetLocation);
+	const FIntPoint Offset = TargetCell - (Field.Origin + FIntPoint(GridSize / 2));
+
+	// recenter the grid if the target has moved too far from the center
+	if (Field.Walkability.IsEmpty() || FMath::Abs(Offset.X) > RecenterDistance || FMath::Abs(Offset.Y) > RecenterDistance)
+	{
+		const FIntPoint NewOrigin = TargetCell - FIntPoint(GridSize / 2);
+
+		// keep the walkability for the cells that overlap the old grid so we only need to probe the new ones
+		TArray<uint8> NewWalkability;
+		NewWalkability.SetNumZeroed(NumCells);
+
+		if (!Field.Walkability.IsEmpty())
+		{
+			const FIntPoint Shift = NewOrigin - Field.Origin;
+
+			for (int32 Y = 0; Y < GridSize; ++Y)
+			{
+				const int32 OldY = Y + Shift.Y;
+
+				if (OldY < 0 || OldY >= GridSize)
+				{
+					continue;
+				}
+
+				for (int32 X = 0; X < GridSize; ++X)
+				{
+					const int32 OldX = X + Shift.X;
+
+					if (OldX >= 0 && OldX < GridSize)
+					{
+						NewWalkability[Y * GridSize + X] = Field.Walkability[OldY * GridSize + OldX];
+					}
+				}
+			}
+		}
+
+		Field.Walkability = MoveTemp(NewWalkability);
+		Field.Origin = NewOrigin;
+		Field.ReferenceZ = TargetLocation.Z;
+		Field.ProbeCursor = 0;
+		Field.bWalkabilityDirty = true;
+
+		// the pass in progress was indexed against the old grid, so it has to start over
+		Field.bBuilding = false;
+	}
+
+	// start a new integration pass if the target has changed cells or we've learned about new obstacles
+	if (!Field.bBuilding && (!Field.bHasDirections || TargetCell != Field.DirectionsGoal || Field.bWalkabilityDirty))
+	{
+		Field.BuildOrigin = Field.Origin;
+		Field.BuildGoal = TargetCell;
+		Field.bWalkabilityDirty = false;
+		Field.bBuilding = true;
+
+		Field.Integration.Init(MAX_uint16, NumCells);
+		Field.OpenList.Reset();
+
+		const FIntPoint GoalLocal = TargetCell - Field.Origin;
+		const int32 GoalIndex = GoalLocal.Y * GridSize + GoalLocal.X;
+
+		Field.Integration[GoalIndex] = 0;
+		Field.OpenList.HeapPush(static_cast<uint32>(GoalIndex));
+	}
+}
+
+int32 UCombatFlowFieldSubsystem::ProbeWalkability(FFlowField& Field, int32 Budget)
+{
+	using namespace CombatFlowField;
+
+	const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	// without a navmesh, every cell stays walkable and the field works as a plain grid
+	if (!NavSys || Budget <= 0)
+	{
+		return 0;
+	}
+
+	const FVector Extent(CellSize * 0.5, CellSize * 0.5, ProbeHeight);
+	int32 Used = 0;
+
+	while (Used < Budget && Field.ProbeCursor < NumCells)
+	{
+		const int32 Index = Field.ProbeCursor++;
+
+		if (Field.Walkability[Index] != Unknown)
+		{
+			continue;
+		}
+
+		// probe the navmesh at the cell center
+		const FVector CellCenter((Field.Origin.X + Index % GridSize + 0.5) * CellSize, (Field.Origin.Y + Index / GridSize + 0.5) * CellSize, Field.ReferenceZ);
+
+		FNavLocation NavLocation;
+		const bool bWalkable = NavSys->ProjectPointToNavigation(CellCenter, NavLocation, Extent);
+
+		Field.Walkability[Index] = bWalkable ? Walkable : Blocked;
+
+		// unknown cells were treated as walkable, so a blocked cell invalidates the field
+		Field.bWalkabilityDirty |= !bWalkable;
+
+		++Used;
+	}
+
+	INC_DWORD_STAT_BY(STAT_CombatFlowFieldProbes, Used);
+
+	return Used;
+}
+
+int32 UCombatFlowFieldSubsystem::AdvanceIntegration(FFlowField& Field, int32 Budget)
+{
+	using namespace CombatFlowField;
+
+	if (!Field.bBuilding || Budget <= 0)
+	{
+		return 0;
+	}
+
+	int32 Used = 0;
+
+	while (Used < Budget && Field.OpenList.Num() > 0)
+	{
+		uint32 Entry;
+		Field.OpenList.HeapPop(Entry, EAllowShrinking::No);
+
+		const int32 Index = Entry & 0xFFFF;
+		const uint32 Cost = Entry >> 16;
+
+		// skip stale entries
+		if (Cost > Field.Integration[Index])
+		{
+			continue;
+		}
+
+		++Used;
+
+		const int32 X = Index % GridSize;
+		const int32 Y = Index / GridSize;
+
+		// relax the neighbours
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			if (!CanStep(Field.Walkability, X, Y, Direction))
+			{
+				continue;
+			}
+
+			const int32 NeighbourIndex = (Y + OffsetY[Direction]) * GridSize + X + OffsetX[Direction];
+			const uint32 NewCost = Cost + StepCost[Direction];
+
+			if (NewCost < Field.Integration[NeighbourIndex])
+			{
+				Field.Integration[NeighbourIndex] = static_cast<uint16>(NewCost);
+				Field.OpenList.HeapPush((NewCost << 16) | static_cast<uint32>(NeighbourIndex));
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_CombatFlowFieldCells, Used);
+
+	// has the pass finished?
+	if (Field.OpenList.IsEmpty())
+	{
+		PublishDirections(Field);
+		Field.bBuilding = false;
+	}
+
+	return Used;
+}
+
+void UCombatFlowFieldSubsystem::PublishDirections(FFlowField& Field)
+{
+	using namespace CombatFlowField;
+
+	Field.Directions.SetNumUninitialized(NumCells, EAllowShrinking::No);
+
+	for (int32 Index = 0; Index < NumCells; ++Index)
+	{
+		const uint16 Cost = Field.Integration[Index];
+
+		// unreachable cells have no direction, and the goal cell points straight at the target
+		if (Cost == MAX_uint16 || Cost == 0)
+		{
+			Field.Directions[Index] = Cost == 0 ? AtGoal : NoDirection;
+			continue;
+		}
+
+		const int32 X = Index % GridSize;
+		const int32 Y = Index / GridSize;
+
+		// point towards the cheapest neighbour
+		uint8 BestDirection = NoDirection;
+		uint16 BestCost = Cost;
+
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			if (!CanStep(Field.Walkability, X, Y, Direction))
+			{
+				continue;
+			}
+
+			const uint16 NeighbourCost = Field.Integration[(Y + OffsetY[Direction]) * GridSize + X + OffsetX[Direction]];
+
+			if (NeighbourCost < BestCost)
+			{
+				BestCost = NeighbourCost;
+				BestDirection = static_cast<uint8>(Direction);
+			}
+		}
+
+		Field.Directions[Index] = BestDirection;
+	}
+
+	Field.DirectionsOrigin = Field.BuildOrigin;
+	Field.DirectionsGoal = Field.BuildGoal;
+	Field.bHasDirections = true;
+
+	INC_DWORD_STAT(STAT_CombatFlowFieldPasses);
+}
+
+bool UCombatFlowFieldSubsystem::SampleDirection(const FVector& Location, FVector& OutDirection, const AActor* Target) const
+{
+	using namespace CombatFlowField;
+
+	INC_DWORD_STAT(STAT_CombatFlowFieldSamples);
+
+	// find the field to sample
+	const FFlowField* BestField = nullptr;
+	double BestDistanceSquared = UE_BIG_NUMBER;
+
+	for (const FFlowField& Field : Fields)
+	{
+		const AActor* FieldTarget = Field.Target.Get();
+
+		if (!Field.bHasDirections || !FieldTarget || (Target && FieldTarget != Target))
+		{
+			continue;
+		}
+
+		const double DistanceSquared = FVector::DistSquared(Location, FieldTarget->GetActorLocation());
+
+		if (DistanceSquared < BestDistanceSquared)
+		{
+			BestDistanceSquared = DistanceSquared;
+			BestField = &Field;
+		}
+	}
+
+	if (!BestField)
+	{
+		return false;
+	}
+
+	// blend the directions of the four closest cell centers so enemies don't snap between the 8 directions
+	const double GridX = Location.X / CellSize - 0.5 - BestField->DirectionsOrigin.X;
+	const double GridY = Location.Y / CellSize - 0.5 - BestField->DirectionsOrigin.Y;
+
+	const int32 X0 = FMath::FloorToInt32(GridX);
+	const int32 Y0 = FMath::FloorToInt32(GridY);
+
+	const double FracX = GridX - X0;
+	const double FracY = GridY - Y0;
+
+	const FVector2D ToTarget = FVector2D(BestField->Target->GetActorLocation() - Location).GetSafeNormal();
+
+	FVector2D Sum = FVector2D::ZeroVector;
+	double WeightSum = 0.0;
+
+	for (int32 Corner = 0; Corner < 4; ++Corner)
+	{
+		const int32 X = X0 + (Corner & 1);
+		const int32 Y = Y0 + (Corner >> 1);
+
+		if (X < 0 || Y < 0 || X >= GridSize || Y >= GridSize)
+		{
+			continue;
+		}
+
+		const uint8 Direction = BestField->Directions[Y * GridSize + X];
+
+		if (Direction == NoDirection)
+		{
+			continue;
+		}
+
+		const double Weight = ((Corner & 1) ? FracX : 1.0 - FracX) * ((Corner >> 1) ? FracY : 1.0 - FracY);
+
+		Sum += (Direction == AtGoal ? ToTarget : DirectionVectors[Direction]) * Weight;
+		WeightSum += Weight;
+	}
+
+	if (WeightSum <= UE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	const FVector2D Direction2D = (Sum / WeightSum).GetSafeNormal();
+	OutDirection = FVector(Direction2D, 0.0);
+
+	return !Direction2D.IsNearlyZero();
+}
+
+FIntPoint UCombatFlowFieldSubsystem::WorldToCell(const FVector& Location)
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CombatFlowField::CellSize), FMath::FloorToInt32(Location.Y / CombatFlowField::CellSize));
+}
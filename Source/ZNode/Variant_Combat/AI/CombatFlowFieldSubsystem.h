@@ -0,0 +1,132 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatFlowFieldSubsystem.generated.h"
+
+/**
+ *  Builds a flow field towards each player so large numbers of enemies can chase them
+ *  without requesting individual paths.
+ *
+ *  Each player gets a square grid of cells centered on them. Cell walkability is probed against the navmesh
+ *  a few cells per frame, and an integration field is built outwards from the player's cell with a time-sliced Dijkstra pass.
+ *  Once a pass finishes, the resulting directions are published, so enemies can look up the direction to move in
+ *  with a single array lookup. Fields are rebuilt incrementally as the players move.
+ *  Fields are only built while something follows them. Followers register with AddFollower and RemoveFollower.
+ */
+UCLASS()
+class UCombatFlowFieldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Flow field state for a single target */
+	struct FFlowField
+	{
+		/** Actor the field flows towards */
+		TWeakObjectPtr<const AActor> Target;
+
+		/** World cell coordinates of the grid corner */
+		FIntPoint Origin = FIntPoint::ZeroValue;
+
+		/** Height used to probe the navmesh for walkability */
+		double ReferenceZ = 0.0;
+
+		/** Walkability for each cell. Unknown cells are treated as walkable until probed */
+		TArray<uint8> Walkability;
+
+		/** Next cell to probe for walkability */
+		int32 ProbeCursor = 0;
+
+		/** True if walkability has changed since the last integration pass started */
+		bool bWalkabilityDirty = false;
+
+		/** True while an integration pass is in progress */
+		bool bBuilding = false;
+
+		/** Grid origin and goal cell used by the integration pass in progress */
+		FIntPoint BuildOrigin = FIntPoint::ZeroValue;
+		FIntPoint BuildGoal = FIntPoint::ZeroValue;
+
+		/** Integration cost for each cell in the pass in progress */
+		TArray<uint16> Integration;
+
+		/** Dijkstra open list. Each entry packs the cost in the high bits and the cell index in the low bits */
+		TArray<uint32> OpenList;
+
+		/** Published direction for each cell, encoded as one of 8 directions */
+		TArray<uint8> Directions;
+
+		/** Grid origin and goal cell of the published directions */
+		FIntPoint DirectionsOrigin = FIntPoint::ZeroValue;
+		FIntPoint DirectionsGoal = FIntPoint::ZeroValue;
+
+		/** True once a pass has been published */
+		bool bHasDirections = false;
+	};
+
+	/** One flow field per player */
+	TArray<FFlowField> Fields;
+
+	/** Total time spent updating the flow fields, for benchmarking */
+	double TotalUpdateSeconds = 0.0;
+
+	/** Number of registered followers. Fields are only built while this is above zero */
+	int32 NumFollowers = 0;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Updates the flow fields */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 *  Samples the flow direction at the provided location.
+	 *  If a target is provided, its field is used. Otherwise the field for the closest target is used.
+	 *  Returns false if the location isn't covered by a published field or can't reach the target.
+	 */
+	bool SampleDirection(const FVector& Location, FVector& OutDirection, const AActor* Target = nullptr) const;
+
+	/** Returns true if flow fields are enabled */
+	static bool IsEnabled();
+
+	/** Registers something that follows the flow fields, so they're kept up to date */
+	void AddFollower();
+
+	/** Unregisters a follower. The fields are released once the last follower is gone */
+	void RemoveFollower();
+
+	/** Returns the total time spent updating the flow fields */
+	double GetTotalUpdateSeconds() const { return TotalUpdateSeconds; }
+
+protected:
+
+	/** Adds and removes fields to match the current player pawns */
+	void SyncTargets();
+
+	/** Moves the grid with the target and starts a new integration pass when needed */
+	void UpdateField(FFlowField& Field);
+
+	/** Probes up to the provided number of cells for walkability. Returns the number of probes used */
+	int32 ProbeWalkability(FFlowField& Field, int32 Budget);
+
+	/** Advances the integration pass by up to the provided number of cells. Returns the number of cells used */
+	int32 AdvanceIntegration(FFlowField& Field, int32 Budget);
+
+	/** Converts the finished integration field into directions and publishes them */
+	void PublishDirections(FFlowField& Field);
+
+	/** Converts a world location to world cell coordinates */
+	static FIntPoint WorldToCell(const FVector& Location);
+};
@@ -0,0 +1,464 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatHordeManager.h"
+#include "CombatEnemy.h"
+#include "CombatStateTreeUtility.h"
+#include "CombatVATSubsystem.h"
+#include "GameplayRandomSubsystem.h"
+#include "TickAuditSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Horde Simulation"), STAT_CombatHordeSimulate, STATGROUP_CombatAI);
+DECLARE_CYCLE_STAT(TEXT("Horde Hydration"), STAT_CombatHordeHydration, STATGROUP_CombatAI);
+DECLARE_CYCLE_STAT(TEXT("Horde Instance Update"), STAT_CombatHordeInstances, STATGROUP_CombatAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Horde Entities"), STAT_CombatHordeEntities, STATGROUP_CombatAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Horde Hydrated Actors"), STAT_CombatHordeHydrated, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Horde Hydrations"), STAT_CombatHordeHydrations, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Horde Dehydrations"), STAT_CombatHordeDehydrations, STATGROUP_CombatAI);
+
+ACombatHordeManager::ACombatHordeManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	// create the instanced mesh for the entities
+	EntityInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Entity Instances"));
+	SetRootComponent(EntityInstances);
+
+	// the instances are only visuals
+	EntityInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	EntityInstances->SetCanEverAffectNavigation(false);
+	EntityInstances->SetMobility(EComponentMobility::Movable);
+}
+
+void ACombatHordeManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// ensure we have an enemy class to read the max HP from
+	const ACombatEnemy* EnemyCDO = EnemyClass ? EnemyClass->GetDefaultObject<ACombatEnemy>() : nullptr;
+	const float EntityHealth = EnemyCDO ? EnemyCDO->GetMaxHP() : 3.0f;
+
+	// draw the instances with the enemy's vertex animations if it has them
+	UCombatVATAsset* EnemyVAT = EnemyCDO ? EnemyCDO->GetVATAsset() : nullptr;
+
+	if (EnemyVAT && EnemyVAT->IsBaked() && UCombatVATSubsystem::IsEnabled())
+	{
+		VATAsset = EnemyVAT;
+		MeshRelativeTransform = EnemyCDO->GetMesh()->GetRelativeTransform();
+
+		EntityInstances->SetStaticMesh(VATAsset->InstanceMesh);
+		EntityInstances->SetNumCustomDataFloats(ECombatVATCustomData::Count);
+	}
+
+	// derive the horde's random key from the session seed, so wander and spawn patterns can be reproduced
+	FGameplayRandomStream SpawnStream;
+
+	if (UGameplayRandomSubsystem* Random = GetWorld()->GetSubsystem<UGameplayRandomSubsystem>())
+	{
+		SpawnStream = Random->MakeActorStream(this);
+		RandomKey = GameplayRandom::MakeKey(Random->GetSeed(), SpawnStream.Next());
+	}
+
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(this);
+
+	// spawn the initial entities inside the spawn box
+	for (int32 Index = 0; Index < InitialEntityCount; ++Index)
+	{
+		FVector Location = GetActorLocation() + FVector(
+			SpawnStream.FRandRange(-SpawnExtent.X, SpawnExtent.X),
+			SpawnStream.FRandRange(-SpawnExtent.Y, SpawnExtent.Y),
+			SpawnStream.FRandRange(-SpawnExtent.Z, SpawnExtent.Z));
+
+		// snap the entity to the ground once. Entities don't follow the terrain while they move
+		FHitResult Hit;
+
+		if (GetWorld()->LineTraceSingleByChannel(Hit, Location + FVector(0.0f, 0.0f, 1000.0f), Location - FVector(0.0f, 0.0f, 5000.0f), ECC_Visibility, QueryParams))
+		{
+			Location = Hit.ImpactPoint;
+		}
+
+		AddEntity(Location, EntityHealth);
+	}
+}
+
+void ACombatHordeManager::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	DEC_DWORD_STAT_BY(STAT_CombatHordeEntities, GetNumEntities());
+	DEC_DWORD_STAT_BY(STAT_CombatHordeHydrated, HydratedActors.Num());
+
+	// release the hydrated actors
+	HydratedActors.Empty();
+	Chunks.Empty();
+}
+
+int32 ACombatHordeManager::AddEntity(const FVector& Location, float Health)
+{
+	// start a new chunk if the last one is full
+	if (Chunks.IsEmpty() || Chunks.Last().Num == FEntityChunk::Capacity)
+	{
+		Chunks.AddDefaulted();
+	}
+
+	const int32 ChunkIndex = Chunks.Num() - 1;
+	FEntityChunk& Chunk = Chunks[ChunkIndex];
+	const int32 Slot = Chunk.Num++;
+
+	Chunk.Positions[Slot] = FVector3f(Location);
+	Chunk.Velocities[Slot] = FVector3f::ZeroVector;
+	Chunk.Health[Slot] = Health;
+	Chunk.States[Slot] = ECombatHordeEntityState::Idle;
+	Chunk.WanderTimers[Slot] = 0.0f;
+	Chunk.PlayerDistancesSquared[Slot] = UE_BIG_NUMBER;
+	Chunk.RenderedAnims[Slot] = 0xFF;
+
+	// each entity owns the instance with the same index
+	EntityInstances->AddInstance(FTransform(Location), true);
+
+	INC_DWORD_STAT(STAT_CombatHordeEntities);
+
+	return ChunkIndex * FEntityChunk::Capacity + Slot;
+}
+
+int32 ACombatHordeManager::GetNumEntities() const
+{
+	return Chunks.IsEmpty() ? 0 : (Chunks.Num() - 1) * FEntityChunk::Capacity + Chunks.Last().Num;
+}
+
+void ACombatHordeManager::Tick(float DeltaTime)
+{
+	FTickAuditScope AuditScope(this);
+	AuditScope.SetDidWork(GetNumEntities() > 0);
+
+	Super::Tick(DeltaTime);
+
+	++FrameCounter;
+
+	GatherPlayers();
+	SimulateEntities(DeltaTime);
+	UpdateHydration();
+	UpdateInstances();
+}
+
+void ACombatHordeManager::GatherPlayers()
+{
+	PlayerLocations.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+
+		if (const APawn* PlayerPawn = PlayerController ? PlayerController->GetPawn() : nullptr)
+		{
+			PlayerLocations.Add(FVector3f(PlayerPawn->GetActorLocation()));
+		}
+	}
+}
+
+float ACombatHordeManager::GetClosestPlayerDistanceSquared(const FVector3f& Location) const
+{
+	float BestDistanceSquared = UE_BIG_NUMBER;
+
+	for (const FVector3f& PlayerLocation : PlayerLocations)
+	{
+		BestDistanceSquared = FMath::Min(BestDistanceSquared, FVector3f::DistSquared2D(Location, PlayerLocation));
+	}
+
+	return BestDistanceSquared;
+}
+
+void ACombatHordeManager::SimulateEntities(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatHordeSimulate);
+
+	const float ChaseRadiusSquared = FMath::Square(ChaseRadius);
+
+	// each chunk is independent, so spread them across the worker threads
+	ParallelFor(TEXT("CombatHordeSimulate"), Chunks.Num(), 1, [this, DeltaTime, ChaseRadiusSquared](int32 ChunkIndex)
+	{
+		FEntityChunk& Chunk = Chunks[ChunkIndex];
+
+		for (int32 Slot = 0; Slot < Chunk.Num; ++Slot)
+		{
+			const ECombatHordeEntityState State = Chunk.States[Slot];
+
+			// hydrated entities are driven by their actor, and dead entities don't move
+			if (State == ECombatHordeEntityState::Hydrated || State == ECombatHordeEntityState::Dead)
+			{
+				continue;
+			}
+
+			FVector3f& Position = Chunk.Positions[Slot];
+			FVector3f& Velocity = Chunk.Velocities[Slot];
+
+			// find the closest player
+			FVector3f ClosestPlayer = FVector3f::ZeroVector;
+			float ClosestDistanceSquared = UE_BIG_NUMBER;
+
+			for (const FVector3f& PlayerLocation : PlayerLocations)
+			{
+				const float DistanceSquared = FVector3f::DistSquared2D(Position, PlayerLocation);
+
+				if (DistanceSquared < ClosestDistanceSquared)
+				{
+					ClosestDistanceSquared = DistanceSquared;
+					ClosestPlayer = PlayerLocation;
+				}
+			}
+
+			Chunk.PlayerDistancesSquared[Slot] = ClosestDistanceSquared;
+
+			if (ClosestDistanceSquared < ChaseRadiusSquared)
+			{
+				// head straight for the player
+				FVector3f ToPlayer = ClosestPlayer - Position;
+				ToPlayer.Z = 0.0f;
+
+				Velocity = ToPlayer.GetSafeNormal() * ChaseSpeed;
+				Chunk.States[Slot] = ECombatHordeEntityState::Chasing;
+			}
+			else
+			{
+				// wander around, picking a new direction every so often
+				Chunk.WanderTimers[Slot] -= DeltaTime;
+
+				if (Chunk.WanderTimers[Slot] <= 0.0f || State != ECombatHordeEntityState::Idle)
+				{
+					const uint64 EntityKey = GameplayRandom::MakeKey(RandomKey, ChunkIndex * FEntityChunk::Capacity + Slot);
+					const uint32 Seed = static_cast<uint32>(GameplayRandom::Hash(EntityKey, FrameCounter) >> 32);
+					const float Angle = (Seed & 0xFFFF) * (UE_TWO_PI / 65536.0f);
+
+					// some entities stand still instead of wandering
+					const bool bStandStill = ((Seed >> 16) & 3) == 0;
+
+					Velocity = bStandStill ? FVector3f::ZeroVector : FVector3f(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * WanderSpeed;
+					Chunk.WanderTimers[Slot] = WanderInterval * (0.5f + ((Seed >> 18) & 0xFF) / 255.0f);
+				}
+
+				Chunk.States[Slot] = ECombatHordeEntityState::Idle;
+			}
+
+			// integrate the position
+			Position += Velocity * DeltaTime;
+		}
+	});
+}
+
+void ACombatHordeManager::UpdateHydration()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatHordeHydration);
+
+	int32 Budget = MaxHydrationsPerFrame;
+	const float DehydrationRadiusSquared = FMath::Square(FMath::Max(DehydrationRadius, HydrationRadius));
+
+	// check on the hydrated actors first
+	for (auto It = HydratedActors.CreateIterator(); It; ++It)
+	{
+		const int32 EntityIndex = It.Key();
+		ACombatEnemy* Enemy = It.Value().Get();
+
+		FEntityChunk& Chunk = Chunks[EntityIndex / FEntityChunk::Capacity];
+		const int32 Slot = EntityIndex % FEntityChunk::Capacity;
+
+		// has the actor died or been removed? The actor takes care of its own death, so we just forget it
+		if (!Enemy || Enemy->CurrentHP <= 0.0f)
+		{
+			Chunk.States[Slot] = ECombatHordeEntityState::Dead;
+			Chunk.Health[Slot] = 0.0f;
+
+			It.RemoveCurrent();
+			DEC_DWORD_STAT(STAT_CombatHordeHydrated);
+			continue;
+		}
+
+		// keep the entity in sync with its actor
+		Chunk.Positions[Slot] = FVector3f(Enemy->GetCharacterMovement()->GetActorFeetLocation());
+		Chunk.Health[Slot] = Enemy->CurrentHP;
+
+		// dehydrate once the actor is far enough from every player, unless it's in the middle of an attack
+		if (Budget > 0 && !Enemy->IsAttacking() && GetClosestPlayerDistanceSquared(Chunk.Positions[Slot]) > DehydrationRadiusSquared)
+		{
+			DehydrateEntity(EntityIndex, Enemy);
+			It.RemoveCurrent();
+
+			--Budget;
+		}
+	}
+
+	// hydrate the entities that came close to a player
+	const float HydrationRadiusSquared = FMath::Square(HydrationRadius);
+
+	for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num() && Budget > 0 && HydratedActors.Num() < MaxHydratedActors; ++ChunkIndex)
+	{
+		const FEntityChunk& Chunk = Chunks[ChunkIndex];
+
+		for (int32 Slot = 0; Slot < Chunk.Num && Budget > 0 && HydratedActors.Num() < MaxHydratedActors; ++Slot)
+		{
+			const ECombatHordeEntityState State = Chunk.States[Slot];
+
+			if (State != ECombatHordeEntityState::Hydrated && State != ECombatHordeEntityState::Dead && Chunk.PlayerDistancesSquared[Slot] < HydrationRadiusSquared)
+			{
+				if (HydrateEntity(ChunkIndex * FEntityChunk::Capacity + Slot))
+				{
+					--Budget;
+				}
+			}
+		}
+	}
+}
+
+bool ACombatHordeManager::HydrateEntity(int32 EntityIndex)
+{
+	if (!EnemyClass)
+	{
+		return false;
+	}
+
+	FEntityChunk& Chunk = Chunks[EntityIndex / FEntityChunk::Capacity];
+	const int32 Slot = EntityIndex % FEntityChunk::Capacity;
+
+	// spawn the actor standing where the entity is, facing the way it was moving
+	const FVector Location = FVector(Chunk.Positions[Slot]) + FVector(0.0f, 0.0f, GetEnemyHalfHeight());
+	const FRotator Rotation = Chunk.Velocities[Slot].IsNearlyZero() ? FRotator::ZeroRotator : FRotator(0.0f, FVector(Chunk.Velocities[Slot]).Rotation().Yaw, 0.0f);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	// own the enemy so its random stream is keyed on this horde
+	SpawnParams.Owner = this;
+
+	ACombatEnemy* Enemy = GetWorld()->SpawnActor<ACombatEnemy>(EnemyClass, Location, Rotation, SpawnParams);
+
+	if (!Enemy)
+	{
+		return false;
+	}
+
+	// carry over the entity state
+	Enemy->SetCurrentHP(Chunk.Health[Slot]);
+	Enemy->GetCharacterMovement()->Velocity = FVector(Chunk.Velocities[Slot]);
+
+	Chunk.States[Slot] = ECombatHordeEntityState::Hydrated;
+	HydratedActors.Add(EntityIndex, Enemy);
+
+	INC_DWORD_STAT(STAT_CombatHordeHydrated);
+	INC_DWORD_STAT(STAT_CombatHordeHydrations);
+
+	return true;
+}
+
+void ACombatHordeManager::DehydrateEntity(int32 EntityIndex, ACombatEnemy* Enemy)
+{
+	FEntityChunk& Chunk = Chunks[EntityIndex / FEntityChunk::Capacity];
+	const int32 Slot = EntityIndex % FEntityChunk::Capacity;
+
+	// copy the actor state back into the entity
+	Chunk.Positions[Slot] = FVector3f(Enemy->GetCharacterMovement()->GetActorFeetLocation());
+	Chunk.Velocities[Slot] = FVector3f(Enemy->GetVelocity());
+	Chunk.Health[Slot] = Enemy->CurrentHP;
+	Chunk.States[Slot] = ECombatHordeEntityState::Chasing;
+
+	// destroy the actor and its controller
+	if (AController* Controller = Enemy->GetController())
+	{
+		Controller->Destroy();
+	}
+
+	Enemy->Destroy();
+
+	DEC_DWORD_STAT(STAT_CombatHordeHydrated);
+	INC_DWORD_STAT(STAT_CombatHordeDehydrations);
+}
+
+void ACombatHordeManager::UpdateInstances()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatHordeInstances);
+
+	const int32 NumEntities = GetNumEntities();
+
+	if (NumEntities == 0)
+	{
+		return;
+	}
+
+	InstanceTransforms.SetNumUninitialized(NumEntities, EAllowShrinking::No);
+
+	const float HalfHeight = GetEnemyHalfHeight();
+	bool bCustomDataDirty = false;
+
+	float CustomData[ECombatVATCustomData::Count];
+
+	for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+	{
+		FEntityChunk& Chunk = Chunks[ChunkIndex];
+
+		for (int32 Slot = 0; Slot < Chunk.Num; ++Slot)
+		{
+			const int32 EntityIndex = ChunkIndex * FEntityChunk::Capacity + Slot;
+			FTransform& Transform = InstanceTransforms[EntityIndex];
+			const FVector Location(Chunk.Positions[Slot]);
+
+			// hide the instances for hydrated and dead entities by collapsing them
+			const ECombatHordeEntityState State = Chunk.States[Slot];
+
+			if (State == ECombatHordeEntityState::Hydrated || State == ECombatHordeEntityState::Dead)
+			{
+				Transform = FTransform(FQuat::Identity, Location, FVector::ZeroVector);
+				continue;
+			}
+
+			// face the direction of movement
+			const FVector3f& Velocity = Chunk.Velocities[Slot];
+			const FQuat Rotation = Velocity.IsNearlyZero() ? FQuat::Identity : FRotator(0.0f, FMath::RadiansToDegrees(FMath::Atan2(Velocity.Y, Velocity.X)), 0.0f).Quaternion();
+
+			if (!VATAsset)
+			{
+				Transform = FTransform(Rotation, Location);
+				continue;
+			}
+
+			// place the instance like the enemy's skeletal mesh
+			Transform = MeshRelativeTransform * FTransform(Rotation, Location + FVector(0.0f, 0.0f, HalfHeight));
+
+			// pick the clip to play and only send it when it changes
+			const bool bMoving = !Velocity.IsNearlyZero();
+			const ECombatVATClip Clip = Velocity.Size() > VATAsset->RunSpeedThreshold ? ECombatVATClip::Run : ECombatVATClip::Walk;
+			const uint8 Anim = static_cast<uint8>(Clip) * 2 + (bMoving ? 1 : 0);
+
+			if (Chunk.RenderedAnims[Slot] != Anim)
+			{
+				Chunk.RenderedAnims[Slot] = Anim;
+
+				// offset each entity's start time so the horde doesn't walk in lockstep
+				const float StartTime = -static_cast<float>(GameplayRandom::MakeKey(RandomKey, EntityIndex) % 1000) * 0.01f;
+
+				VATAsset->MakeCustomData(Clip, StartTime, bMoving ? 1.0f : 0.0f, CustomData);
+				EntityInstances->SetCustomData(EntityIndex, CustomData, false);
+
+				bCustomDataDirty = true;
+			}
+		}
+	}
+
+	EntityInstances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, !bCustomDataDirty, true);
+
+	if (bCustomDataDirty)
+	{
+		EntityInstances->MarkRenderStateDirty();
+	}
+}
+
+float ACombatHordeManager::GetEnemyHalfHeight() const
+{
+	const ACombatEnemy* EnemyCDO = EnemyClass ? EnemyClass->GetDefaultObject<ACombatEnemy>() : nullptr;
+	return EnemyCDO ? EnemyCDO->GetCapsuleComponent()->GetScaledCapsuleHalfHeight() : 90.0f;
+}
@@ -0,0 +1,189 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CombatVATAsset.h"
+#include "CombatHordeManager.generated.h"
+
+class ACombatEnemy;
+class UInstancedStaticMeshComponent;
+
+/**
+ *  State of a horde entity
+ */
+UENUM()
+enum class ECombatHordeEntityState : uint8
+{
+	Idle,
+	Chasing,
+	Hydrated,
+	Dead
+};
+
+/**
+ *  Holds a large horde of zombies as lightweight entities instead of actors.
+ *  Entity position, velocity, health and state are stored in fixed size chunks and simulated in parallel.
+ *  Distant entities are drawn as instances of a single mesh, using the enemy's baked vertex animations if it has them. When an entity comes within the hydration radius
+ *  of a player, it's swapped for a real enemy actor, and it's swapped back once it leaves the dehydration radius.
+ */
+UCLASS(abstract)
+class ACombatHordeManager : public AActor
+{
+	GENERATED_BODY()
+
+	/** Instanced mesh used to draw the entities that aren't hydrated */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Components, meta = (AllowPrivateAccess = "true"))
+	UInstancedStaticMeshComponent* EntityInstances;
+
+protected:
+
+	/** Entity storage chunk. Fields are stored as separate arrays so the simulation can stream through them */
+	struct FEntityChunk
+	{
+		static constexpr int32 Capacity = 64;
+
+		/** Number of entities in the chunk */
+		int32 Num = 0;
+
+		/** Entity feet locations */
+		FVector3f Positions[Capacity];
+
+		/** Entity velocities */
+		FVector3f Velocities[Capacity];
+
+		/** Entity health */
+		float Health[Capacity];
+
+		/** Entity states */
+		ECombatHordeEntityState States[Capacity];
+
+		/** Time until each entity picks a new wander direction */
+		float WanderTimers[Capacity];
+
+		/** Squared distance from each entity to the closest player, updated by the simulation */
+		float PlayerDistancesSquared[Capacity];
+
+		/** Animation last sent to each instance, as the clip index times two plus one if it's playing. 0xFF if unset */
+		uint8 RenderedAnims[Capacity];
+	};
+
+	/** Entity chunks */
+	TArray<FEntityChunk> Chunks;
+
+	/** Actors standing in for the hydrated entities, keyed by entity index */
+	TMap<int32, TWeakObjectPtr<ACombatEnemy>> HydratedActors;
+
+	/** Player locations gathered for the current frame */
+	TArray<FVector3f> PlayerLocations;
+
+	/** Instance transforms, rebuilt every frame */
+	TArray<FTransform> InstanceTransforms;
+
+	/** Baked vertex animations for the instances, taken from the enemy class */
+	UPROPERTY(Transient)
+	UCombatVATAsset* VATAsset = nullptr;
+
+	/** Transform of the enemy's mesh relative to its capsule, applied to the instances when drawing vertex animations */
+	FTransform MeshRelativeTransform;
+
+	/** Number of simulation frames, used as the random counter for wander directions */
+	uint32 FrameCounter = 0;
+
+	/** Random key for this horde. Each entity hashes it with its index and the frame counter */
+	uint64 RandomKey = 0;
+
+	/** Enemy type to hydrate entities into */
+	UPROPERTY(EditAnywhere, Category="Horde")
+	TSubclassOf<ACombatEnemy> EnemyClass;
+
+	/** Number of entities to create on BeginPlay */
+	UPROPERTY(EditAnywhere, Category="Horde", meta = (ClampMin = 0))
+	int32 InitialEntityCount = 1000;
+
+	/** Entities are spawned at random inside this box, centered on the manager */
+	UPROPERTY(EditAnywhere, Category="Horde", meta = (Units = "cm"))
+	FVector SpawnExtent = FVector(10000.0f, 10000.0f, 0.0f);
+
+	/** Entities within this distance of a player are hydrated into actors */
+	UPROPERTY(EditAnywhere, Category="Horde|Hydration", meta = (ClampMin = 0, Units = "cm"))
+	float HydrationRadius = 2500.0f;
+
+	/** Hydrated actors further than this from every player are turned back into entities. Should be larger than the hydration radius to avoid thrashing */
+	UPROPERTY(EditAnywhere, Category="Horde|Hydration", meta = (ClampMin = 0, Units = "cm"))
+	float DehydrationRadius = 3000.0f;
+
+	/** Max number of entities that can be hydrated or dehydrated in a single frame */
+	UPROPERTY(EditAnywhere, Category="Horde|Hydration", meta = (ClampMin = 1))
+	int32 MaxHydrationsPerFrame = 4;
+
+	/** Max number of hydrated actors at any time */
+	UPROPERTY(EditAnywhere, Category="Horde|Hydration", meta = (ClampMin = 0))
+	int32 MaxHydratedActors = 64;
+
+	/** Entities within this distance of a player will move towards them */
+	UPROPERTY(EditAnywhere, Category="Horde|Movement", meta = (ClampMin = 0, Units = "cm"))
+	float ChaseRadius = 8000.0f;
+
+	/** Speed entities move at while chasing a player */
+	UPROPERTY(EditAnywhere, Category="Horde|Movement", meta = (ClampMin = 0, Units = "cm/s"))
+	float ChaseSpeed = 300.0f;
+
+	/** Speed entities move at while wandering */
+	UPROPERTY(EditAnywhere, Category="Horde|Movement", meta = (ClampMin = 0, Units = "cm/s"))
+	float WanderSpeed = 80.0f;
+
+	/** Time between wander direction changes */
+	UPROPERTY(EditAnywhere, Category="Horde|Movement", meta = (ClampMin = 0.1, Units = "s"))
+	float WanderInterval = 4.0f;
+
+public:
+
+	/** Constructor */
+	ACombatHordeManager();
+
+	/** Creates the initial entities */
+	virtual void BeginPlay() override;
+
+	/** Cleanup */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+	/** Simulates the horde and handles hydration */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Adds an entity at the provided feet location. Returns its index */
+	int32 AddEntity(const FVector& Location, float Health);
+
+	/** Returns the total number of entities, alive or not */
+	int32 GetNumEntities() const;
+
+	/** Returns the number of entities currently hydrated into actors */
+	int32 GetNumHydrated() const { return HydratedActors.Num(); }
+
+protected:
+
+	/** Gathers the player locations for this frame */
+	void GatherPlayers();
+
+	/** Moves all entities that aren't hydrated */
+	void SimulateEntities(float DeltaTime);
+
+	/** Swaps entities and actors as they cross the hydration radii */
+	void UpdateHydration();
+
+	/** Spawns an actor for the entity. Returns false if it couldn't be spawned */
+	bool HydrateEntity(int32 EntityIndex);
+
+	/** Copies the actor state back into the entity and destroys the actor */
+	void DehydrateEntity(int32 EntityIndex, ACombatEnemy* Enemy);
+
+	/** Rebuilds the instance transforms for all entities */
+	void UpdateInstances();
+
+	/** Returns the squared distance from the location to the closest player */
+	float GetClosestPlayerDistanceSquared(const FVector3f& Location) const;
+
+	/** Returns the vertical offset between an enemy's feet and its actor location */
+	float GetEnemyHalfHeight() const;
+};
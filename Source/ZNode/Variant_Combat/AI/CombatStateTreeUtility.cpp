@@ -10,6 +10,13 @@
 #include "CombatEnemy.h"
 #include "Kismet/GameplayStatics.h"
 #include "StateTreeAsyncExecutionContext.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "CombatFlowFieldSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("GetPlayerInfo Tick"), STAT_CombatGetPlayerInfoTick, STATGROUP_CombatAI);
+DECLARE_CYCLE_STAT(TEXT("GetPlayerInfo Interval Update"), STAT_CombatGetPlayerInfoIntervalUpdate, STATGROUP_CombatAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Player Info Events Sent"), STAT_CombatPlayerInfoEvents, STATGROUP_CombatAI);
 
 bool FStateTreeCharacterGroundedCondition::TestCondition(FStateTreeExecutionContext& Context) const
 {
@@ -263,9 +270,18 @@ FText FStateTreeSetCharacterSpeedTask::GetDescription(const FGuid& ID, FStateTre
 
 EStateTreeRunStatus FStateTreeGetPlayerInfoTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
 {
+	SCOPE_CYCLE_COUNTER(STAT_CombatGetPlayerInfoTick);
+
 	// get the instance data
 	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
+	UpdatePlayerInfo(InstanceData);
+
+	return EStateTreeRunStatus::Running;
+}
+
+void FStateTreeGetPlayerInfoTask::UpdatePlayerInfo(FInstanceDataType& InstanceData)
+{
 	// get the character possessed by the first local player
 	InstanceData.TargetPlayerCharacter = Cast<ACharacter>(UGameplayStatics::GetPlayerPawn(InstanceData.Character, 0));
 
@@ -278,8 +294,6 @@ EStateTreeRunStatus FStateTreeGetPlayerInfoTask::Tick(FStateTreeExecutionContext
 
 	// update the distance
 	InstanceData.DistanceToTarget = FVector::Distance(InstanceData.TargetPlayerLocation, InstanceData.Character->GetActorLocation());
-
-	return EStateTreeRunStatus::Running;
 }
 
 #if WITH_EDITOR
@@ -287,4 +301,223 @@ FText FStateTreeGetPlayerInfoTask::GetDescription(const FGuid& ID, FStateTreeDat
 {
 	return FText::FromString("<b>Get Player Info</b>");
 }
-#endif // WITH_EDITOR
\ No newline at end of file
+#endif // WITH_EDITOR
+
+FStateTreeGetPlayerInfoIntervalTask::FStateTreeGetPlayerInfoIntervalTask()
+{
+	// this task is driven by a timer, so it doesn't need to tick
+	bShouldCallTick = false;
+}
+
+EStateTreeRunStatus FStateTreeGetPlayerInfoIntervalTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// have we transitioned from another state?
+	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
+	{
+		// get the instance data
+		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+		// reset the range flag so the first update sends the right event
+		InstanceData.bTargetInRange = false;
+
+		// do an initial update so the outputs are valid right away
+		const FStateTreeWeakExecutionContext WeakContext = Context.MakeWeakExecutionContext();
+		UpdatePlayerInfo(InstanceData, WeakContext, true);
+
+		// refresh the player info on a looping timer
+		Context.GetWorld()->GetTimerManager().SetTimer(InstanceData.UpdateTimer, FTimerDelegate::CreateLambda(
+			[WeakContext]()
+			{
+				// the instance data is only valid while the state is still active
+				const FStateTreeStrongExecutionContext StrongContext = WeakContext.MakeStrongExecutionContext();
+
+				if (FInstanceDataType* InstanceDataPtr = StrongContext.GetInstanceDataPtr<FInstanceDataType>())
+				{
+					UpdatePlayerInfo(*InstanceDataPtr, WeakContext, false);
+				}
+			}
+		), InstanceData.UpdateInterval, true);
+	}
+
+	return EStateTreeRunStatus::Running;
+}
+
+void FStateTreeGetPlayerInfoIntervalTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// have we transitioned to another state?
+	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
+	{
+		// get the instance data
+		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+		// stop the refresh timer
+		Context.GetWorld()->GetTimerManager().ClearTimer(InstanceData.UpdateTimer);
+	}
+}
+
+void FStateTreeGetPlayerInfoIntervalTask::UpdatePlayerInfo(FInstanceDataType& InstanceData, const FStateTreeWeakExecutionContext& WeakContext, bool bForceUpdate)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatGetPlayerInfoIntervalUpdate);
+
+	// ensure we have a character
+	if (!IsValid(InstanceData.Character))
+	{
+		return;
+	}
+
+	// get the character possessed by the first local player
+	InstanceData.TargetPlayerCharacter = Cast<ACharacter>(UGameplayStatics::GetPlayerPawn(InstanceData.Character, 0));
+
+	// do we have a valid target?
+	if (InstanceData.TargetPlayerCharacter)
+	{
+		const FVector NewLocation = InstanceData.TargetPlayerCharacter->GetActorLocation();
+
+		// only publish the new location if the player has moved far enough
+		if (bForceUpdate || FVector::DistSquared(NewLocation, InstanceData.TargetPlayerLocation) > FMath::Square(InstanceData.MoveThreshold))
+		{
+			InstanceData.TargetPlayerLocation = NewLocation;
+
+			if (!bForceUpdate && InstanceData.PlayerMovedEvent.IsValid())
+			{
+				WeakContext.SendEvent(InstanceData.PlayerMovedEvent);
+				INC_DWORD_STAT(STAT_CombatPlayerInfoEvents);
+			}
+		}
+	}
+
+	// update the distance
+	InstanceData.DistanceToTarget = FVector::Distance(InstanceData.TargetPlayerLocation, InstanceData.Character->GetActorLocation());
+
+	// has the target crossed the range threshold?
+	const bool bInRange = InstanceData.TargetPlayerCharacter && InstanceData.DistanceToTarget <= InstanceData.RangeThreshold;
+
+	if (bInRange != InstanceData.bTargetInRange)
+	{
+		InstanceData.bTargetInRange = bInRange;
+
+		// send the range event
+		const FGameplayTag& RangeEvent = bInRange ? InstanceData.PlayerEnteredRangeEvent : InstanceData.PlayerLeftRangeEvent;
+
+		if (RangeEvent.IsValid())
+		{
+			WeakContext.SendEvent(RangeEvent);
+			INC_DWORD_STAT(STAT_CombatPlayerInfoEvents);
+		}
+	}
+}
+
+#if WITH_EDITOR
+FText FStateTreeGetPlayerInfoIntervalTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Get Player Info</b> (Interval)");
+}
+#endif // WITH_EDITOR
+
+EStateTreeRunStatus FStateTreeFollowFlowFieldTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// have we transitioned from another state?
+	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
+	{
+		// reset the path state
+		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+		InstanceData.bFollowingPath = false;
+
+		// keep the flow fields up to date while we follow them
+		UCombatFlowFieldSubsystem* FlowField = Context.GetWorld()->GetSubsystem<UCombatFlowFieldSubsystem>();
+
+		if (FlowField && !InstanceData.bFollowingField)
+		{
+			FlowField->AddFollower();
+			InstanceData.bFollowingField = true;
+		}
+	}
+
+	return EStateTreeRunStatus::Running;
+}
+
+EStateTreeRunStatus FStateTreeFollowFlowFieldTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	// default to the first local player if we have no target
+	AActor* Target = InstanceData.Target ? InstanceData.Target.Get() : UGameplayStatics::GetPlayerPawn(InstanceData.Character, 0);
+
+	if (!Target)
+	{
+		return EStateTreeRunStatus::Running;
+	}
+
+	const FVector CharacterLocation = InstanceData.Character->GetActorLocation();
+
+	// have we arrived?
+	if (FVector::DistSquared2D(CharacterLocation, Target->GetActorLocation()) < FMath::Square(InstanceData.AcceptanceRadius))
+	{
+		return EStateTreeRunStatus::Succeeded;
+	}
+
+	// try sampling the flow field first
+	const UCombatFlowFieldSubsystem* FlowField = Context.GetWorld()->GetSubsystem<UCombatFlowFieldSubsystem>();
+	FVector FlowDirection;
+
+	if (FlowField && UCombatFlowFieldSubsystem::IsEnabled() && FlowField->SampleDirection(CharacterLocation, FlowDirection, Target))
+	{
+		// stop following any path we requested before
+		if (InstanceData.bFollowingPath)
+		{
+			InstanceData.Controller->StopMovement();
+			InstanceData.bFollowingPath = false;
+		}
+
+		// move along the field
+		InstanceData.Character->AddMovementInput(FlowDirection);
+
+		return EStateTreeRunStatus::Running;
+	}
+
+	// fall back to pathfinding, only requesting a new path if the target has moved enough
+	if (!InstanceData.bFollowingPath || FVector::DistSquared(InstanceData.LastPathGoal, Target->GetActorLocation()) > FMath::Square(InstanceData.RepathDistance))
+	{
+		InstanceData.Controller->MoveToActor(Target, InstanceData.AcceptanceRadius);
+		InstanceData.LastPathGoal = Target->GetActorLocation();
+		InstanceData.bFollowingPath = true;
+	}
+
+	return EStateTreeRunStatus::Running;
+}
+
+void FStateTreeFollowFlowFieldTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// have we transitioned to another state?
+	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
+	{
+		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+		// stop any path we were following
+		if (InstanceData.bFollowingPath && InstanceData.Controller)
+		{
+			InstanceData.Controller->StopMovement();
+		}
+
+		InstanceData.bFollowingPath = false;
+
+		// let the flow fields go idle if we were the last follower
+		if (InstanceData.bFollowingField)
+		{
+			if (UCombatFlowFieldSubsystem* FlowField = Context.GetWorld()->GetSubsystem<UCombatFlowFieldSubsystem>())
+			{
+				FlowField->RemoveFollower();
+			}
+
+			InstanceData.bFollowingField = false;
+		}
+	}
+}
+
+#if WITH_EDITOR
+FText FStateTreeFollowFlowFieldTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Follow Flow Field</b>");
+}
+#endif // WITH_EDITOR
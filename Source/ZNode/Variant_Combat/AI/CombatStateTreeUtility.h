@@ -5,12 +5,18 @@
 #include "CoreMinimal.h"
 #include "StateTreeTaskBase.h"
 #include "StateTreeConditionBase.h"
+#include "GameplayTagContainer.h"
+#include "Engine/TimerHandle.h"
+#include "Stats/Stats.h"
 
 #include "CombatStateTreeUtility.generated.h"
 
 class ACharacter;
 class AAIController;
 class ACombatEnemy;
+struct FStateTreeWeakExecutionContext;
+
+DECLARE_STATS_GROUP(TEXT("Combat AI"), STATGROUP_CombatAI, STATCAT_Advanced);
 
 /**
  *  Instance data struct for the FStateTreeCharacterGroundedCondition condition
@@ -308,4 +314,164 @@ struct FStateTreeGetPlayerInfoTask : public FStateTreeTaskCommonBase
 #if WITH_EDITOR
 	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
 #endif // WITH_EDITOR
-};
\ No newline at end of file
+
+	/** Refreshes the player info. Also used by the AI benchmark to run the task outside of a StateTree */
+	static void UpdatePlayerInfo(FInstanceDataType& InstanceData);
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data struct for the Get Player Info (Interval) task
+ */
+USTRUCT()
+struct FStateTreeGetPlayerInfoIntervalInstanceData
+{
+	GENERATED_BODY()
+
+	/** Character that owns this task */
+	UPROPERTY(EditAnywhere, Category = Context)
+	TObjectPtr<ACharacter> Character;
+
+	/** Time between player info refreshes */
+	UPROPERTY(EditAnywhere, Category = Parameter, meta = (ClampMin = 0.05, Units = "s"))
+	float UpdateInterval = 0.25f;
+
+	/** The target location is only published if the player has moved further than this since the last update */
+	UPROPERTY(EditAnywhere, Category = Parameter, meta = (ClampMin = 0, Units = "cm"))
+	float MoveThreshold = 50.0f;
+
+	/** Distance under which the player is considered to be in range */
+	UPROPERTY(EditAnywhere, Category = Parameter, meta = (ClampMin = 0, Units = "cm"))
+	float RangeThreshold = 200.0f;
+
+	/** Event sent when the player moves further than the move threshold */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	FGameplayTag PlayerMovedEvent;
+
+	/** Event sent when the player comes within range */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	FGameplayTag PlayerEnteredRangeEvent;
+
+	/** Event sent when the player goes out of range */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	FGameplayTag PlayerLeftRangeEvent;
+
+	/** Character possessed by the player */
+	UPROPERTY(VisibleAnywhere)
+	TObjectPtr<ACharacter> TargetPlayerCharacter;
+
+	/** Last published location for the target */
+	UPROPERTY(VisibleAnywhere)
+	FVector TargetPlayerLocation = FVector::ZeroVector;
+
+	/** Distance to the target */
+	UPROPERTY(VisibleAnywhere)
+	float DistanceToTarget = 0.0f;
+
+	/** True if the target is within the range threshold */
+	UPROPERTY(VisibleAnywhere)
+	bool bTargetInRange = false;
+
+	/** Refresh timer */
+	FTimerHandle UpdateTimer;
+};
+
+/**
+ *  Event-driven version of the Get Player Info task.
+ *  Doesn't tick. Instead, it refreshes the player info on a timer and sends
+ *  StateTree events when the player moves or crosses the range threshold,
+ *  so transitions can be driven by events instead of per-frame conditions.
+ */
+USTRUCT(meta=(DisplayName="GetPlayerInfo (Interval)", Category="Combat"))
+struct FStateTreeGetPlayerInfoIntervalTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeGetPlayerInfoIntervalInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Constructor */
+	FStateTreeGetPlayerInfoIntervalTask();
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs when the owning state is ended */
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+
+	/** Refreshes the player info and sends any events that apply. Also used by the AI benchmark to run the task outside of a StateTree */
+	static void UpdatePlayerInfo(FInstanceDataType& InstanceData, const FStateTreeWeakExecutionContext& WeakContext, bool bForceUpdate);
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data struct for the Follow Flow Field task
+ */
+USTRUCT()
+struct FStateTreeFollowFlowFieldInstanceData
+{
+	GENERATED_BODY()
+
+	/** Character that will move */
+	UPROPERTY(EditAnywhere, Category = Context)
+	TObjectPtr<ACharacter> Character;
+
+	/** AI Controller used when falling back to pathfinding */
+	UPROPERTY(EditAnywhere, Category = Context)
+	TObjectPtr<AAIController> Controller;
+
+	/** Actor to move towards. If not set, the first local player will be used */
+	UPROPERTY(EditAnywhere, Category = Input)
+	TObjectPtr<AActor> Target;
+
+	/** The task succeeds once the character gets this close to the target */
+	UPROPERTY(EditAnywhere, Category = Parameter, meta = (ClampMin = 0, Units = "cm"))
+	float AcceptanceRadius = 100.0f;
+
+	/** When falling back to pathfinding, a new path is only requested once the target moves this far */
+	UPROPERTY(EditAnywhere, Category = Parameter, meta = (ClampMin = 0, Units = "cm"))
+	float RepathDistance = 200.0f;
+
+	/** Target location of the last path request */
+	FVector LastPathGoal = FVector::ZeroVector;
+
+	/** True while the character is following a path instead of the flow field */
+	bool bFollowingPath = false;
+
+	/** True while registered as a flow field follower */
+	bool bFollowingField = false;
+};
+
+/**
+ *  StateTree task to move a character towards a player by sampling the flow field.
+ *  Falls back to regular pathfinding when the flow field is disabled or doesn't cover the character
+ */
+USTRUCT(meta=(DisplayName="Follow Flow Field", Category="Combat"))
+struct FStateTreeFollowFlowFieldTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeFollowFlowFieldInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs while the owning state is active */
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+
+	/** Runs when the owning state is ended */
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+};
@@ -3,8 +3,11 @@
 
 #include "CombatActivationVolume.h"
 #include "Components/BoxComponent.h"
-#include "GameFramework/Character.h"
+#include "GameFramework/Pawn.h"
 #include "CombatActivatable.h"
+#include "CombatTriggerSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/CollisionProfile.h"
 
 ACombatActivationVolume::ACombatActivationVolume()
 {
@@ -17,33 +20,43 @@ ACombatActivationVolume::ACombatActivationVolume()
 	// set the box's extent
 	Box->SetBoxExtent(FVector(500.0f, 500.0f, 500.0f));
 
-	// set the default collision profile to overlap all dynamic
-	Box->SetCollisionProfileName(FName("OverlapAllDynamic"));
+	// the trigger subsystem tests the box against the player pawns, so it doesn't need to collide with anything
+	Box->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+}
+
+void ACombatActivationVolume::BeginPlay()
+{
+	Super::BeginPlay();
 
-	// bind the begin overlap 
-	Box->OnComponentBeginOverlap.AddDynamic(this, &ACombatActivationVolume::OnOverlap);
+	// register the box with the trigger subsystem
+	if (UCombatTriggerSubsystem* Triggers = GetWorld()->GetSubsystem<UCombatTriggerSubsystem>())
+	{
+		TriggerHandle = Triggers->RegisterVolume<&ACombatActivationVolume::OnPlayerEntered>(this, Box->Bounds.GetBox());
+	}
 }
 
-void ACombatActivationVolume::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void ACombatActivationVolume::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
-	// has a Character entered the volume?
-	ACharacter* PlayerCharacter = Cast<ACharacter>(OtherActor);
+	Super::EndPlay(EndPlayReason);
 
-	if (PlayerCharacter)
+	// unregister from the trigger subsystem
+	if (UCombatTriggerSubsystem* Triggers = GetWorld()->GetSubsystem<UCombatTriggerSubsystem>())
 	{
-		// is the Character controlled by a player
-		if (PlayerCharacter->IsPlayerControlled())
+		Triggers->UnregisterVolume(TriggerHandle);
+	}
+
+	TriggerHandle = INDEX_NONE;
+}
+
+void ACombatActivationVolume::OnPlayerEntered(APawn* PlayerPawn)
+{
+	// process the actors to activate list
+	for (AActor* CurrentActor : ActorsToActivate)
+	{
+		// is the referenced actor activatable?
+		if(ICombatActivatable* Activatable = Cast<ICombatActivatable>(CurrentActor))
 		{
-			// process the actors to activate list
-			for (AActor* CurrentActor : ActorsToActivate)
-			{
-				// is the referenced actor activatable?
-				if(ICombatActivatable* Activatable = Cast<ICombatActivatable>(CurrentActor))
-				{
-					Activatable->ActivateInteraction(PlayerCharacter);
-				}
-			}
+			Activatable->ActivateInteraction(PlayerPawn);
 		}
 	}
-
-}
\ No newline at end of file
+}
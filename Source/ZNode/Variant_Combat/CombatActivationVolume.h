@@ -10,6 +10,7 @@ class UBoxComponent;
 
 /**
  *  A simple volume that activates a list of actors when the player pawn enters.
+ *  The box doesn't generate overlap events. It's tested against the player pawns by the trigger subsystem instead.
  */
 UCLASS()
 class ACombatActivationVolume : public AActor
@@ -26,6 +27,9 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Activation Volume")
 	TArray<AActor*> ActorsToActivate;
 
+	/** Handle for this volume in the trigger subsystem */
+	int32 TriggerHandle = INDEX_NONE;
+
 public:	
 	
 	/** Constructor */
@@ -33,8 +37,15 @@ public:
 
 protected:
 
-	/** Handles overlaps with the box volume */
-	UFUNCTION()
-	void OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	/** Registers the volume with the trigger subsystem */
+	virtual void BeginPlay() override;
+
+	/** Unregisters the volume from the trigger subsystem */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+public:
+
+	/** Called by the trigger subsystem when a player pawn enters the volume */
+	void OnPlayerEntered(APawn* PlayerPawn);
 
 };
@@ -0,0 +1,422 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatBreakableManager.h"
+#include "CombatDamageableBox.h"
+#include "TickAuditSubsystem.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Breakable Props"), STAT_CombatBreakableProps, STATGROUP_CombatBreakables);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Breakable Physics Proxies"), STAT_CombatBreakableProxies, STATGROUP_CombatBreakables);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Breakable Promotions"), STAT_CombatBreakablePromotions, STATGROUP_CombatBreakables);
+
+ACombatBreakableManager::ACombatBreakableManager()
+{
+	// only tick while props are simulating
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	// create the instanced mesh
+	RootComponent = Instances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Instances"));
+
+	// set the collision properties so attacks can hit the instances
+	Instances->SetCollisionProfileName(FName("BlockAllDynamic"));
+
+	// removed instances are replaced by the last one, so we only need to fix up one mapping
+	Instances->SetRemoveSwap();
+
+	// disable navigation relevance so props don't affect NavMesh generation
+	Instances->bNavigationRelevant = false;
+}
+
+void ACombatBreakableManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// every instance placed in the editor is a prop
+	const int32 NumPlaced = Instances->GetInstanceCount();
+
+	PropHealth.Init(PropHP, NumPlaced);
+	PropProxies.Init(INDEX_NONE, NumPlaced);
+	PropInstances.SetNumUninitialized(NumPlaced);
+	InstanceProps.SetNumUninitialized(NumPlaced);
+
+	for (int32 Index = 0; Index < NumPlaced; ++Index)
+	{
+		PropInstances[Index] = Index;
+		InstanceProps[Index] = Index;
+	}
+
+	INC_DWORD_STAT_BY(STAT_CombatBreakableProps, NumPlaced);
+
+	// take over the damageable boxes in the level
+	if (bAbsorbDamageableBoxes)
+	{
+		AbsorbDamageableBoxes();
+	}
+
+	// prewarm the proxy pool
+	for (int32 Index = 0; Index < FMath::Min(PrewarmedProxies, MaxProxies); ++Index)
+	{
+		FreeProxies.Add(CreateProxy());
+	}
+}
+
+void ACombatBreakableManager::AbsorbDamageableBoxes()
+{
+	const UStaticMesh* PropMesh = Instances->GetStaticMesh();
+
+	if (!PropMesh)
+	{
+		return;
+	}
+
+	for (TActorIterator<ACombatDamageableBox> It(GetWorld()); It; ++It)
+	{
+		ACombatDamageableBox* Box = *It;
+
+		// only absorb boxes that look like our props
+		if (Box->GetMesh()->GetStaticMesh() != PropMesh)
+		{
+			continue;
+		}
+
+		// the box may not have begun play yet, so take its starting HP from the class default
+		const float BoxHP = Box->GetClass()->GetDefaultObject<ACombatDamageableBox>()->GetCurrentHP();
+
+		AddProp(Box->GetMesh()->GetComponentTransform(), BoxHP);
+
+		Box->Destroy();
+	}
+}
+
+int32 ACombatBreakableManager::AddProp(const FTransform& Transform, float HP)
+{
+	const int32 PropIndex = PropHealth.Add(HP);
+	PropProxies.Add(INDEX_NONE);
+	PropInstances.Add(Instances->AddInstance(Transform, true));
+	InstanceProps.Add(PropIndex);
+
+	INC_DWORD_STAT(STAT_CombatBreakableProps);
+
+	return PropIndex;
+}
+
+void ACombatBreakableManager::Tick(float DeltaTime)
+{
+	FTickAuditScope AuditScope(this);
+
+	Super::Tick(DeltaTime);
+
+	const float SettleSpeedSquared = FMath::Square(SettleSpeed);
+
+	for (int32 ProxyIndex = 0; ProxyIndex < Proxies.Num(); ++ProxyIndex)
+	{
+		const int32 PropIndex = ProxyProps[ProxyIndex];
+
+		// skip free proxies
+		if (PropIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		// is the prop dead?
+		if (PropHealth[PropIndex] <= 0.0f)
+		{
+			// remove it once the death delay expires
+			ProxyTimers[ProxyIndex] -= DeltaTime;
+
+			if (ProxyTimers[ProxyIndex] <= 0.0f)
+			{
+				PropProxies[PropIndex] = INDEX_NONE;
+				ReleaseProxy(ProxyIndex);
+			}
+
+			continue;
+		}
+
+		// has the prop come to rest?
+		const UStaticMeshComponent* Proxy = Proxies[ProxyIndex];
+
+		if (!Proxy->RigidBodyIsAwake() || Proxy->GetPhysicsLinearVelocity().SizeSquared() < SettleSpeedSquared)
+		{
+			ProxyTimers[ProxyIndex] += DeltaTime;
+
+			if (ProxyTimers[ProxyIndex] >= SettleTime)
+			{
+				DemoteProp(PropIndex);
+			}
+		}
+		else
+		{
+			ProxyTimers[ProxyIndex] = 0.0f;
+		}
+	}
+
+	// stop ticking once nothing is simulating
+	if (NumActiveProxies == 0)
+	{
+		SetActorTickEnabled(false);
+	}
+}
+
+void ACombatBreakableManager::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	// find the prop that was hit
+	const int32 PropIndex = FindProp(DamageLocation);
+
+	// only process damage if the prop still has HP
+	if (PropIndex == INDEX_NONE || PropHealth[PropIndex] <= 0.0f)
+	{
+		return;
+	}
+
+	// make the prop simulate physics if it's still an instance
+	if (PropProxies[PropIndex] == INDEX_NONE)
+	{
+		PromoteProp(PropIndex);
+	}
+
+	// apply the damage
+	PropHealth[PropIndex] -= Damage;
+
+	// apply a physics impulse to the prop, ignoring its mass
+	if (PropProxies[PropIndex] != INDEX_NONE)
+	{
+		UStaticMeshComponent* Proxy = Proxies[PropProxies[PropIndex]];
+		Proxy->AddImpulseAtLocation(DamageImpulse * Proxy->GetMass(), DamageLocation);
+
+		// restart the settle timer
+		ProxyTimers[PropProxies[PropIndex]] = 0.0f;
+	}
+
+	// is the prop dead?
+	if (PropHealth[PropIndex] <= 0.0f)
+	{
+		KillProp(PropIndex);
+	}
+
+	// call the BP handler to play effects, etc.
+	OnPropDamaged(DamageLocation, DamageImpulse);
+}
+
+void ACombatBreakableManager::HandleDeath()
+{
+	// stub. Props die individually through KillProp
+}
+
+void ACombatBreakableManager::ApplyHealing(float Healing, AActor* Healer)
+{
+	// stub
+}
+
+int32 ACombatBreakableManager::FindProp(const FVector& Location) const
+{
+	int32 BestProp = INDEX_NONE;
+	double BestDistanceSquared = UE_BIG_NUMBER;
+
+	// check the simulated props first, using their bounds
+	for (int32 ProxyIndex = 0; ProxyIndex < Proxies.Num(); ++ProxyIndex)
+	{
+		if (ProxyProps[ProxyIndex] == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FBoxSphereBounds& Bounds = Proxies[ProxyIndex]->Bounds;
+		const double DistanceSquared = FVector::DistSquared(Bounds.Origin, Location);
+
+		if (DistanceSquared < FMath::Square(Bounds.SphereRadius + HitResolveRadius) && DistanceSquared < BestDistanceSquared)
+		{
+			BestDistanceSquared = DistanceSquared;
+			BestProp = ProxyProps[ProxyIndex];
+		}
+	}
+
+	// then the instances around the location
+	const TArray<int32> Overlapping = Instances->GetInstancesOverlappingSphere(Location, HitResolveRadius, true);
+
+	for (int32 InstanceIndex : Overlapping)
+	{
+		FTransform InstanceTransform;
+		Instances->GetInstanceTransform(InstanceIndex, InstanceTransform, true);
+
+		const double DistanceSquared = FVector::DistSquared(InstanceTransform.GetLocation(), Location);
+
+		if (DistanceSquared < BestDistanceSquared)
+		{
+			BestDistanceSquared = DistanceSquared;
+			BestProp = InstanceProps[InstanceIndex];
+		}
+	}
+
+	return BestProp;
+}
+
+bool ACombatBreakableManager::PromoteProp(int32 PropIndex)
+{
+	const int32 ProxyIndex = AcquireProxy();
+
+	// props hit while the pool is exhausted stay as instances
+	if (ProxyIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FTransform InstanceTransform;
+	Instances->GetInstanceTransform(PropInstances[PropIndex], InstanceTransform, true);
+
+	// remove the instance
+	RemovePropInstance(PropIndex);
+
+	// place the proxy where the instance was and start simulating
+	UStaticMeshComponent* Proxy = Proxies[ProxyIndex];
+	Proxy->SetWorldTransform(InstanceTransform, false, nullptr, ETeleportType::ResetPhysics);
+	Proxy->SetCollisionObjectType(ECC_WorldDynamic);
+	Proxy->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	Proxy->SetVisibility(true);
+	Proxy->SetSimulatePhysics(true);
+
+	ProxyProps[ProxyIndex] = PropIndex;
+	ProxyTimers[ProxyIndex] = 0.0f;
+	PropProxies[PropIndex] = ProxyIndex;
+
+	// start ticking to watch the prop settle
+	SetActorTickEnabled(true);
+
+	INC_DWORD_STAT(STAT_CombatBreakablePromotions);
+
+	return true;
+}
+
+void ACombatBreakableManager::DemoteProp(int32 PropIndex)
+{
+	const int32 ProxyIndex = PropProxies[PropIndex];
+
+	// add an instance where the proxy came to rest
+	const int32 InstanceIndex = Instances->AddInstance(Proxies[ProxyIndex]->GetComponentTransform(), true);
+
+	PropInstances[PropIndex] = InstanceIndex;
+	InstanceProps.SetNum(FMath::Max(InstanceProps.Num(), InstanceIndex + 1));
+	InstanceProps[InstanceIndex] = PropIndex;
+
+	// return the proxy to the pool
+	PropProxies[PropIndex] = INDEX_NONE;
+	ReleaseProxy(ProxyIndex);
+}
+
+void ACombatBreakableManager::KillProp(int32 PropIndex)
+{
+	const int32 ProxyIndex = PropProxies[PropIndex];
+
+	if (ProxyIndex != INDEX_NONE)
+	{
+		// change the collision object type to Visibility so we ignore most interactions but still retain physics collisions
+		Proxies[ProxyIndex]->SetCollisionObjectType(ECC_Visibility);
+
+		// start the removal countdown
+		ProxyTimers[ProxyIndex] = DeathDelayTime;
+
+		// call the BP handler to play effects, etc.
+		OnPropDestroyed(Proxies[ProxyIndex]->GetComponentLocation());
+	}
+	else if (PropInstances[PropIndex] != INDEX_NONE)
+	{
+		// we couldn't get a proxy, so remove the instance right away
+		FTransform InstanceTransform;
+		Instances->GetInstanceTransform(PropInstances[PropIndex], InstanceTransform, true);
+
+		RemovePropInstance(PropIndex);
+
+		// call the BP handler to play effects, etc.
+		OnPropDestroyed(InstanceTransform.GetLocation());
+	}
+}
+
+void ACombatBreakableManager::RemovePropInstance(int32 PropIndex)
+{
+	const int32 InstanceIndex = PropInstances[PropIndex];
+	const int32 LastInstance = Instances->GetInstanceCount() - 1;
+
+	Instances->RemoveInstance(InstanceIndex);
+
+	// the last instance was moved into the removed slot
+	if (InstanceIndex != LastInstance)
+	{
+		const int32 MovedProp = InstanceProps[LastInstance];
+
+		InstanceProps[InstanceIndex] = MovedProp;
+		PropInstances[MovedProp] = InstanceIndex;
+	}
+
+	InstanceProps.SetNum(LastInstance, EAllowShrinking::No);
+	PropInstances[PropIndex] = INDEX_NONE;
+}
+
+int32 ACombatBreakableManager::AcquireProxy()
+{
+	int32 ProxyIndex = INDEX_NONE;
+
+	if (!FreeProxies.IsEmpty())
+	{
+		ProxyIndex = FreeProxies.Pop(EAllowShrinking::No);
+	}
+	else if (Proxies.Num() < MaxProxies)
+	{
+		ProxyIndex = CreateProxy();
+	}
+
+	if (ProxyIndex != INDEX_NONE)
+	{
+		++NumActiveProxies;
+		INC_DWORD_STAT(STAT_CombatBreakableProxies);
+	}
+
+	return ProxyIndex;
+}
+
+void ACombatBreakableManager::ReleaseProxy(int32 ProxyIndex)
+{
+	// deactivate the proxy
+	UStaticMeshComponent* Proxy = Proxies[ProxyIndex];
+	Proxy->SetSimulatePhysics(false);
+	Proxy->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Proxy->SetVisibility(false);
+
+	ProxyProps[ProxyIndex] = INDEX_NONE;
+	FreeProxies.Add(ProxyIndex);
+
+	--NumActiveProxies;
+	DEC_DWORD_STAT(STAT_CombatBreakableProxies);
+}
+
+int32 ACombatBreakableManager::CreateProxy()
+{
+	UStaticMeshComponent* Proxy = NewObject<UStaticMeshComponent>(this);
+
+	// copy the look of the instances
+	Proxy->SetStaticMesh(Instances->GetStaticMesh());
+
+	for (int32 MaterialIndex = 0; MaterialIndex < Instances->GetNumMaterials(); ++MaterialIndex)
+	{
+		Proxy->SetMaterial(MaterialIndex, Instances->GetMaterial(MaterialIndex));
+	}
+
+	// set the collision properties
+	Proxy->SetCollisionProfileName(FName("BlockAllDynamic"));
+	Proxy->bNavigationRelevant = false;
+	Proxy->SetMobility(EComponentMobility::Movable);
+
+	// start inactive
+	Proxy->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Proxy->SetVisibility(false);
+	Proxy->RegisterComponent();
+
+	ProxyProps.Add(INDEX_NONE);
+	ProxyTimers.Add(0.0f);
+
+	return Proxies.Add(Proxy);
+}
@@ -0,0 +1,166 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CombatDamageable.h"
+#include "Stats/Stats.h"
+#include "CombatBreakableManager.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+class UStaticMeshComponent;
+
+DECLARE_STATS_GROUP(TEXT("Combat Breakables"), STATGROUP_CombatBreakables, STATCAT_Advanced);
+
+/**
+ *  Holds many damageable props as instances of a single HISM, so a level can have thousands of breakables cheaply.
+ *  Instances are static until they're hit. A hit instance is promoted into a pooled physics simulated mesh,
+ *  and returned to the HISM once it settles. Destroyed props are removed after a delay and their proxy is reused.
+ *  Damage is received through the ICombatDamageable interface and resolved to a prop by the damage location.
+ *  Can optionally absorb the matching ACombatDamageableBox actors placed in the level on BeginPlay. Absorbed boxes are destroyed,
+ *  so their own Blueprint damage effects and death timers are replaced by the manager's.
+ */
+UCLASS(abstract)
+class ACombatBreakableManager : public AActor, public ICombatDamageable
+{
+	GENERATED_BODY()
+
+	/** Instanced mesh for the props at rest */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
+	UHierarchicalInstancedStaticMeshComponent* Instances;
+
+public:
+
+	/** Constructor */
+	ACombatBreakableManager();
+
+protected:
+
+	/** Amount of HP each prop starts with */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Damage", meta = (ClampMin = 0))
+	float PropHP = 3.0f;
+
+	/** Time to wait before a destroyed prop is removed from the level */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Damage", meta = (ClampMin = 0, Units = "s"))
+	float DeathDelayTime = 6.0f;
+
+	/** Max distance from the damage location to a prop for the damage to be applied to it */
+	UPROPERTY(EditAnywhere, Category="Damage", meta = (ClampMin = 0, Units = "cm"))
+	float HitResolveRadius = 50.0f;
+
+	/** Number of physics proxies created on BeginPlay */
+	UPROPERTY(EditAnywhere, Category="Physics Proxies", meta = (ClampMin = 0))
+	int32 PrewarmedProxies = 8;
+
+	/** Max number of props that can simulate physics at the same time. Props hit while the pool is exhausted take damage without moving */
+	UPROPERTY(EditAnywhere, Category="Physics Proxies", meta = (ClampMin = 1))
+	int32 MaxProxies = 64;
+
+	/** Props moving slower than this for SettleTime are returned to the HISM */
+	UPROPERTY(EditAnywhere, Category="Physics Proxies", meta = (ClampMin = 0, Units = "cm/s"))
+	float SettleSpeed = 5.0f;
+
+	/** Time a prop needs to stay still before being returned to the HISM */
+	UPROPERTY(EditAnywhere, Category="Physics Proxies", meta = (ClampMin = 0, Units = "s"))
+	float SettleTime = 1.0f;
+
+	/** If true, ACombatDamageableBox actors using the same static mesh will be destroyed and converted into instances on BeginPlay. They start with their class default HP */
+	UPROPERTY(EditAnywhere, Category="Setup")
+	bool bAbsorbDamageableBoxes = false;
+
+	/** Current HP for each prop */
+	TArray<float> PropHealth;
+
+	/** HISM instance index for each prop, or INDEX_NONE if it's not an instance */
+	TArray<int32> PropInstances;
+
+	/** Physics proxy index for each prop, or INDEX_NONE if it's not simulating */
+	TArray<int32> PropProxies;
+
+	/** Maps each HISM instance back to its prop */
+	TArray<int32> InstanceProps;
+
+	/** Physics proxy pool */
+	UPROPERTY(Transient)
+	TArray<UStaticMeshComponent*> Proxies;
+
+	/** Prop simulated by each proxy, or INDEX_NONE if the proxy is free */
+	TArray<int32> ProxyProps;
+
+	/** For live props, time the proxy has been still for. For dead props, time left until removal */
+	TArray<float> ProxyTimers;
+
+	/** Indices of the free proxies */
+	TArray<int32> FreeProxies;
+
+	/** Number of proxies in use */
+	int32 NumActiveProxies = 0;
+
+	/** Blueprint damage handler for effect playback */
+	UFUNCTION(BlueprintImplementableEvent, Category="Damage")
+	void OnPropDamaged(const FVector& DamageLocation, const FVector& DamageImpulse);
+
+	/** Blueprint destruction handler for effect playback */
+	UFUNCTION(BlueprintImplementableEvent, Category="Damage")
+	void OnPropDestroyed(const FVector& PropLocation);
+
+public:
+
+	/** Builds the prop list and prewarms the proxy pool */
+	virtual void BeginPlay() override;
+
+	/** Settles and removes the simulated props */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Adds a prop at the provided transform. Returns its index */
+	int32 AddProp(const FTransform& Transform, float HP);
+
+	/** Returns the number of props, including destroyed ones */
+	int32 GetNumProps() const { return PropHealth.Num(); }
+
+	/** Returns the number of props currently simulating physics */
+	int32 GetNumActiveProxies() const { return NumActiveProxies; }
+
+	// ~Begin CombatDamageable interface
+
+	/** Handles damage and knockback events for the prop closest to the damage location */
+	virtual void ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse) override;
+
+	/** Handles death events */
+	virtual void HandleDeath() override;
+
+	/** Handles healing events */
+	virtual void ApplyHealing(float Healing, AActor* Healer) override;
+
+	// ~End CombatDamageable interface
+
+protected:
+
+	/** Returns the prop closest to the location, or INDEX_NONE if there's none within the resolve radius */
+	int32 FindProp(const FVector& Location) const;
+
+	/** Swaps a prop from its instance to a physics proxy. Returns false if the pool is exhausted */
+	bool PromoteProp(int32 PropIndex);
+
+	/** Swaps a settled prop back to an instance */
+	void DemoteProp(int32 PropIndex);
+
+	/** Kills a prop and schedules its removal */
+	void KillProp(int32 PropIndex);
+
+	/** Removes a prop's HISM instance, keeping the instance mapping packed */
+	void RemovePropInstance(int32 PropIndex);
+
+	/** Returns a free physics proxy, creating one if needed. Returns INDEX_NONE if the pool is exhausted */
+	int32 AcquireProxy();
+
+	/** Returns a proxy to the pool */
+	void ReleaseProxy(int32 ProxyIndex);
+
+	/** Creates a new, inactive physics proxy */
+	int32 CreateProxy();
+
+	/** Converts the matching damageable box actors in the level into props */
+	void AbsorbDamageableBoxes();
+};
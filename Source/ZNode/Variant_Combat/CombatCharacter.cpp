@@ -12,15 +12,18 @@
 #include "EnhancedInputComponent.h"
 #include "CombatLifeBar.h"
 #include "Engine/DamageEvents.h"
-#include "TimerManager.h"
+#include "GameplayTimerSubsystem.h"
 #include "Engine/LocalPlayer.h"
 #include "CombatPlayerController.h"
+#include "CombatReplaySubsystem.h"
+#include "FrameScratchAllocator.h"
 
 DEFINE_LOG_CATEGORY(LogCombatCharacter);
 
 ACombatCharacter::ACombatCharacter()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// nothing to do per frame, so don't register a tick. Movement, animation and AI tick on their own components
+	PrimaryActorTick.bCanEverTick = false;
 
 	// bind the attack montage ended delegate
 	OnAttackMontageEnded.BindUObject(this, &ACombatCharacter::AttackMontageEnded);
@@ -245,7 +248,8 @@ void ACombatCharacter::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupt
 void ACombatCharacter::DoAttackTrace(FName DamageSourceBone)
 {
 	// sweep for objects in front of the character to be hit by the attack
-	TArray<FHitResult> OutHits;
+	FScopedHitResults ScopedHits;
+	TArray<FHitResult>& OutHits = ScopedHits.Get();
 
 	// start at the provided socket location, sweep forward
 	const FVector TraceStart = GetMesh()->GetSocketLocation(DamageSourceBone);
@@ -328,6 +332,12 @@ void ACombatCharacter::CheckChargedAttack()
 
 void ACombatCharacter::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
 {
+	// record the damage for replays
+	if (UCombatReplaySubsystem* Replay = GetWorld()->GetSubsystem<UCombatReplaySubsystem>())
+	{
+		Replay->RecordDamage(this, Damage);
+	}
+
 	// pass the damage event to the actor
 	FDamageEvent DamageEvent;
 	const float ActualDamage = TakeDamage(Damage, DamageEvent, nullptr, DamageCauser);
@@ -366,7 +376,16 @@ void ACombatCharacter::HandleDeath()
 	GetCameraBoom()->TargetArmLength = DeathCameraDistance;
 
 	// schedule respawning
-	GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &ACombatCharacter::RespawnCharacter, RespawnTime, false);
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->Schedule<&ACombatCharacter::RespawnCharacter>(this, RespawnTime);
+	}
+
+	// get the next character ready while the death camera plays
+	if (ACombatPlayerController* PC = Cast<ACombatPlayerController>(GetController()))
+	{
+		PC->PrepareRespawn();
+	}
 }
 
 void ACombatCharacter::ApplyHealing(float Healing, AActor* Healer)
@@ -380,6 +399,17 @@ void ACombatCharacter::RespawnCharacter()
 	Destroy();
 }
 
+void ACombatCharacter::GetInputActions(TArray<const UInputAction*>& OutActions) const
+{
+	for (const UInputAction* Action : { JumpAction, MoveAction, LookAction, MouseLookAction, ComboAttackAction, ChargedAttackAction })
+	{
+		if (Action)
+		{
+			OutActions.Add(Action);
+		}
+	}
+}
+
 float ACombatCharacter::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
 	// only process damage if the character is still alive
@@ -448,8 +478,11 @@ void ACombatCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the respawn timer
-	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+	// cancel the pending respawn
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->CancelAll(this);
+	}
 }
 
 void ACombatCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -167,9 +167,6 @@ protected:
 	/** Attack montage ended delegate */
 	FOnMontageEnded OnAttackMontageEnded;
 
-	/** Character respawn timer */
-	FTimerHandle RespawnTimer;
-
 	/** Copy of the mesh's transform so we can reset it after ragdoll animations */
 	FTransform MeshStartingTransform;
 
@@ -267,6 +264,9 @@ public:
 	/** Called from the respawn timer to destroy and re-create the character */
 	void RespawnCharacter();
 
+	/** Returns the input actions the character responds to */
+	void GetInputActions(TArray<const UInputAction*>& OutActions) const;
+
 public:
 
 	/** Overrides the default TakeDamage functionality */
@@ -4,6 +4,9 @@
 #include "CombatCheckpointVolume.h"
 #include "CombatCharacter.h"
 #include "CombatPlayerController.h"
+#include "CombatTriggerSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/CollisionProfile.h"
 
 ACombatCheckpointVolume::ACombatCheckpointVolume()
 {
@@ -14,14 +17,35 @@ ACombatCheckpointVolume::ACombatCheckpointVolume()
 	// set the box's extent
 	Box->SetBoxExtent(FVector(500.0f, 500.0f, 500.0f));
 
-	// set the default collision profile to overlap all dynamic
-	Box->SetCollisionProfileName(FName("OverlapAllDynamic"));
+	// the trigger subsystem tests the box against the player pawns, so it doesn't need to collide with anything
+	Box->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+}
+
+void ACombatCheckpointVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// register the box with the trigger subsystem
+	if (UCombatTriggerSubsystem* Triggers = GetWorld()->GetSubsystem<UCombatTriggerSubsystem>())
+	{
+		TriggerHandle = Triggers->RegisterVolume<&ACombatCheckpointVolume::OnPlayerEntered>(this, Box->Bounds.GetBox());
+	}
+}
+
+void ACombatCheckpointVolume::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// unregister from the trigger subsystem
+	if (UCombatTriggerSubsystem* Triggers = GetWorld()->GetSubsystem<UCombatTriggerSubsystem>())
+	{
+		Triggers->UnregisterVolume(TriggerHandle);
+	}
 
-	// bind the begin overlap 
-	Box->OnComponentBeginOverlap.AddDynamic(this, &ACombatCheckpointVolume::OnOverlap);
+	TriggerHandle = INDEX_NONE;
 }
 
-void ACombatCheckpointVolume::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void ACombatCheckpointVolume::OnPlayerEntered(APawn* PlayerPawn)
 {
 	// ensure we use this only once
 	if (bCheckpointUsed)
@@ -30,7 +54,7 @@ void ACombatCheckpointVolume::OnOverlap(UPrimitiveComponent* OverlappedComponent
 	}
 		
 	// has the player entered this volume?
-	ACombatCharacter* PlayerCharacter = Cast<ACombatCharacter>(OtherActor);
+	ACombatCharacter* PlayerCharacter = Cast<ACombatCharacter>(PlayerPawn);
 
 	if (PlayerCharacter)
 	{
@@ -7,6 +7,10 @@
 #include "Components/BoxComponent.h"
 #include "CombatCheckpointVolume.generated.h"
 
+/**
+ *  Updates the player's respawn checkpoint the first time they enter the volume.
+ *  The box doesn't generate overlap events. It's tested against the player pawns by the trigger subsystem instead.
+ */
 UCLASS(abstract)
 class ACombatCheckpointVolume : public AActor
 {
@@ -26,7 +30,17 @@ protected:
 	/** Set to true after use to avoid accidentally resetting the checkpoint */
 	bool bCheckpointUsed = false;
 
-	/** Handles overlaps with the box volume */
-	UFUNCTION()
-	void OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	/** Handle for this volume in the trigger subsystem */
+	int32 TriggerHandle = INDEX_NONE;
+
+	/** Registers the volume with the trigger subsystem */
+	virtual void BeginPlay() override;
+
+	/** Unregisters the volume from the trigger subsystem */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+public:
+
+	/** Called by the trigger subsystem when a player pawn enters the volume */
+	void OnPlayerEntered(APawn* PlayerPawn);
 };
@@ -3,7 +3,7 @@
 
 #include "CombatDamageableBox.h"
 #include "Components/StaticMeshComponent.h"
-#include "TimerManager.h"
+#include "GameplayTimerSubsystem.h"
 #include "Engine/World.h"
 
 ACombatDamageableBox::ACombatDamageableBox()
@@ -33,8 +33,11 @@ void ACombatDamageableBox::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the death timer
-	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+	// cancel the pending death cleanup
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->CancelAll(this);
+	}
 }
 
 void ACombatDamageableBox::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
@@ -68,7 +71,10 @@ void ACombatDamageableBox::HandleDeath()
 	OnBoxDestroyed();
 
 	// set up the death cleanup timer
-	GetWorld()->GetTimerManager().SetTimer(DeathTimer, this, &ACombatDamageableBox::RemoveFromLevel, DeathDelayTime);
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->Schedule<&ACombatDamageableBox::RemoveFromLevel>(this, DeathDelayTime);
+	}
 }
 
 void ACombatDamageableBox::ApplyHealing(float Healing, AActor* Healer)
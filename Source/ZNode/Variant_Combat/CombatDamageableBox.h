@@ -34,8 +34,6 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Damage")
 	float DeathDelayTime = 6.0f;
 
-	FTimerHandle DeathTimer;
-
 	/** Blueprint damage handler for effect playback */
 	UFUNCTION(BlueprintImplementableEvent, Category="Damage")
 	void OnBoxDamaged(const FVector& DamageLocation, const FVector& DamageImpulse);
@@ -49,6 +47,12 @@ protected:
 
 public:
 
+	/** Returns the box mesh */
+	UStaticMeshComponent* GetMesh() const { return Mesh; }
+
+	/** Returns the box's current HP */
+	float GetCurrentHP() const { return CurrentHP; }
+
 	/** EndPlay cleanup */
 	void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
@@ -8,7 +8,8 @@
 
 ACombatDummy::ACombatDummy()
 {
- 	PrimaryActorTick.bCanEverTick = true;
+	// nothing to do per frame, so don't register a tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// create the root
 	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
@@ -2,8 +2,10 @@
 
 
 #include "Variant_Combat/CombatGameMode.h"
+#include "CombatHUD.h"
 
 ACombatGameMode::ACombatGameMode()
 {
-
+	// use the combat HUD so batched life bars get drawn
+	HUDClass = ACombatHUD::StaticClass();
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatHUD.h"
+#include "CombatLifeBarSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/Canvas.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Draw Life Bars"), STAT_CombatDrawLifeBars, STATGROUP_CombatUI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Life Bars Drawn"), STAT_CombatLifeBarsDrawn, STATGROUP_CombatUI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Life Bars Culled"), STAT_CombatLifeBarsCulled, STATGROUP_CombatUI);
+
+void ACombatHUD::DrawHUD()
+{
+	Super::DrawHUD();
+
+	// draw the batched life bars
+	if (bDrawLifeBars)
+	{
+		if (const UCombatLifeBarSubsystem* LifeBars = GetWorld()->GetSubsystem<UCombatLifeBarSubsystem>())
+		{
+			DrawLifeBars(*LifeBars);
+		}
+	}
+}
+
+void ACombatHUD::DrawLifeBars(const UCombatLifeBarSubsystem& LifeBars)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatDrawLifeBars);
+
+	// ensure we have a canvas and a camera to project from
+	if (!Canvas || !PlayerOwner || !PlayerOwner->PlayerCameraManager || LifeBars.Num() == 0)
+	{
+		return;
+	}
+
+	const FVector ViewLocation = PlayerOwner->PlayerCameraManager->GetCameraLocation();
+	const float MaxDistanceSquared = FMath::Square(LifeBarMaxDrawDistance);
+
+	const TArray<TWeakObjectPtr<const USceneComponent>>& Anchors = LifeBars.GetAnchors();
+	const TArray<FVector>& Offsets = LifeBars.GetOffsets();
+	const TArray<float>& Percentages = LifeBars.GetPercentages();
+	const TArray<FLinearColor>& Colors = LifeBars.GetColors();
+
+	int32 NumDrawn = 0;
+
+	for (int32 Index = 0; Index < Anchors.Num(); ++Index)
+	{
+		const USceneComponent* Anchor = Anchors[Index].Get();
+
+		if (!Anchor)
+		{
+			continue;
+		}
+
+		const FVector BarLocation = Anchor->GetComponentLocation() + Offsets[Index];
+
+		// cull distant bars
+		const float DistanceSquared = FVector::DistSquared(ViewLocation, BarLocation);
+
+		if (DistanceSquared > MaxDistanceSquared)
+		{
+			continue;
+		}
+
+		// project to the screen. Z will be zero if the bar is behind the camera
+		const FVector ScreenLocation = Project(BarLocation, true);
+
+		if (ScreenLocation.Z <= 0.0f)
+		{
+			continue;
+		}
+
+		// shrink the bar with distance
+		const float Scale = FMath::Clamp(LifeBarReferenceDistance / FMath::Max(FMath::Sqrt(DistanceSquared), 1.0f), LifeBarMinScale, 1.0f);
+		const FVector2D BarSize = LifeBarSize * Scale;
+
+		const float Left = ScreenLocation.X - BarSize.X * 0.5f;
+		const float Top = ScreenLocation.Y - BarSize.Y * 0.5f;
+
+		// cull bars that are fully off screen
+		if (Left > Canvas->ClipX || Top > Canvas->ClipY || Left + BarSize.X < 0.0f || Top + BarSize.Y < 0.0f)
+		{
+			continue;
+		}
+
+		// draw the background and the fill. Both use the same white texture so the canvas batches them together
+		const float FillWidth = BarSize.X * Percentages[Index];
+
+		DrawRect(LifeBarBackgroundColor, Left, Top, BarSize.X, BarSize.Y);
+
+		if (FillWidth > 0.0f)
+		{
+			DrawRect(Colors[Index], Left, Top, FillWidth, BarSize.Y);
+		}
+
+		++NumDrawn;
+	}
+
+	INC_DWORD_STAT_BY(STAT_CombatLifeBarsDrawn, NumDrawn);
+	INC_DWORD_STAT_BY(STAT_CombatLifeBarsCulled, Anchors.Num() - NumDrawn);
+}
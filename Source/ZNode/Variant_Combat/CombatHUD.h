@@ -0,0 +1,56 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/HUD.h"
+#include "CombatHUD.generated.h"
+
+class UCombatLifeBarSubsystem;
+
+/**
+ *  Simple HUD for a third person combat game
+ *  Draws every batched enemy life bar in a single Canvas pass.
+ *  Bars that are behind the camera, off screen or too far away are culled.
+ */
+UCLASS()
+class ACombatHUD : public AHUD
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** If true, batched life bars will be drawn */
+	UPROPERTY(EditAnywhere, Category="Life Bars")
+	bool bDrawLifeBars = true;
+
+	/** Life bars further away from the camera than this will not be drawn */
+	UPROPERTY(EditAnywhere, Category="Life Bars", meta = (ClampMin = 0, Units = "cm"))
+	float LifeBarMaxDrawDistance = 3000.0f;
+
+	/** Size of a life bar on screen when it's at the reference distance */
+	UPROPERTY(EditAnywhere, Category="Life Bars")
+	FVector2D LifeBarSize = FVector2D(80.0f, 8.0f);
+
+	/** Distance from the camera at which life bars are drawn at their full size. Closer bars don't grow any further */
+	UPROPERTY(EditAnywhere, Category="Life Bars", meta = (ClampMin = 1, Units = "cm"))
+	float LifeBarReferenceDistance = 500.0f;
+
+	/** Smallest scale a far away life bar can shrink to */
+	UPROPERTY(EditAnywhere, Category="Life Bars", meta = (ClampMin = 0, ClampMax = 1))
+	float LifeBarMinScale = 0.4f;
+
+	/** Background color for the empty part of the life bars */
+	UPROPERTY(EditAnywhere, Category="Life Bars")
+	FLinearColor LifeBarBackgroundColor = FLinearColor(0.0f, 0.0f, 0.0f, 0.6f);
+
+public:
+
+	/** Draws the HUD */
+	virtual void DrawHUD() override;
+
+protected:
+
+	/** Draws all visible life bars from the subsystem in one pass */
+	void DrawLifeBars(const UCombatLifeBarSubsystem& LifeBars);
+};
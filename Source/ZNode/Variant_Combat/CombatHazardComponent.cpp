@@ -0,0 +1,77 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatHazardComponent.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+
+UCombatHazardComponent::UCombatHazardComponent()
+{
+	// only pawns can be inside the zone
+	SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	SetCollisionResponseToAllChannels(ECR_Ignore);
+	SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
+	SetGenerateOverlapEvents(true);
+	SetCanEverAffectNavigation(false);
+}
+
+void UCombatHazardComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OnComponentBeginOverlap.AddDynamic(this, &UCombatHazardComponent::OnBeginOverlap);
+	OnComponentEndOverlap.AddDynamic(this, &UCombatHazardComponent::OnEndOverlap);
+
+	if (UCombatHazardSubsystem* Hazards = GetWorld()->GetSubsystem<UCombatHazardSubsystem>())
+	{
+		HazardHandle = Hazards->RegisterZone(GetOwner(), Hazard);
+
+		// pick up the actors that were already inside before we registered
+		TArray<AActor*> Inside;
+		GetOverlappingActors(Inside);
+
+		for (AActor* Actor : Inside)
+		{
+			Hazards->EnterZone(HazardHandle, Actor);
+		}
+	}
+}
+
+void UCombatHazardComponent::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	if (UCombatHazardSubsystem* Hazards = GetWorld()->GetSubsystem<UCombatHazardSubsystem>())
+	{
+		Hazards->UnregisterZone(HazardHandle);
+	}
+
+	HazardHandle = INDEX_NONE;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UCombatHazardComponent::OnBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	// only count the root, so actors with several overlapping components enter once
+	if (!OtherActor || OtherComp != OtherActor->GetRootComponent())
+	{
+		return;
+	}
+
+	if (UCombatHazardSubsystem* Hazards = GetWorld()->GetSubsystem<UCombatHazardSubsystem>())
+	{
+		Hazards->EnterZone(HazardHandle, OtherActor);
+	}
+}
+
+void UCombatHazardComponent::OnEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+{
+	if (!OtherActor || OtherComp != OtherActor->GetRootComponent())
+	{
+		return;
+	}
+
+	if (UCombatHazardSubsystem* Hazards = GetWorld()->GetSubsystem<UCombatHazardSubsystem>())
+	{
+		Hazards->ExitZone(HazardHandle, OtherActor);
+	}
+}
@@ -0,0 +1,55 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/BoxComponent.h"
+#include "CombatHazardSubsystem.h"
+#include "CombatHazardComponent.generated.h"
+
+/**
+ *  A box that damages the damageable actors inside it over time.
+ *  The box only overlaps pawns. It reports actors entering and leaving it to the hazard subsystem,
+ *  which applies the damage at a fixed rate. Fire, gas and lava hazards only differ by their settings.
+ */
+UCLASS(ClassGroup = (Combat), meta = (BlueprintSpawnableComponent))
+class UCombatHazardComponent : public UBoxComponent
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Damage settings */
+	UPROPERTY(EditAnywhere, Category="Hazard")
+	FCombatHazardSettings Hazard;
+
+	/** Handle for this zone in the hazard subsystem */
+	int32 HazardHandle = INDEX_NONE;
+
+public:
+
+	/** Constructor */
+	UCombatHazardComponent();
+
+	/** Registers the zone with the hazard subsystem */
+	virtual void BeginPlay() override;
+
+	/** Unregisters the zone from the hazard subsystem */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+	/** Returns the damage settings */
+	const FCombatHazardSettings& GetHazardSettings() const { return Hazard; }
+
+	/** Sets the damage settings. Only takes effect if called before BeginPlay */
+	void SetHazardSettings(const FCombatHazardSettings& Settings) { Hazard = Settings; }
+
+protected:
+
+	/** Adds the overlapping actor to the zone */
+	UFUNCTION()
+	void OnBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	/** Removes the actor from the zone */
+	UFUNCTION()
+	void OnEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+};
@@ -0,0 +1,311 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatHazardSubsystem.h"
+#include "CombatDamageable.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hazard Damage Pass"), STAT_CombatHazardPass, STATGROUP_CombatHazards);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hazard Zones"), STAT_CombatHazardZones, STATGROUP_CombatHazards);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hazard Occupants"), STAT_CombatHazardOccupants, STATGROUP_CombatHazards);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hazard Damage Events"), STAT_CombatHazardEvents, STATGROUP_CombatHazards);
+
+namespace CombatHazards
+{
+	static float TickRate = 4.0f;
+	static FAutoConsoleVariableRef CVarTickRate(
+		TEXT("Combat.Hazards.TickRate"),
+		TickRate,
+		TEXT("Number of hazard damage passes per second."));
+
+	/** Max passes to catch up on in a single frame after a hitch */
+	static constexpr int32 MaxPassesPerFrame = 4;
+}
+
+bool UCombatHazardSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatHazardSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_CombatHazardZones, Zones.Num() - FreeZones.Num());
+	DEC_DWORD_STAT_BY(STAT_CombatHazardOccupants, Occupants.Num());
+
+	// release everything
+	Zones.Empty();
+	FreeZones.Empty();
+	Occupants.Empty();
+	OccupantIndices.Empty();
+	DamageBatch.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatHazardSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatHazardSubsystem, STATGROUP_Tickables);
+}
+
+int32 UCombatHazardSubsystem::RegisterZone(AActor* Owner, const FCombatHazardSettings& Settings)
+{
+	check(Owner);
+
+	// reuse a free slot if we have one
+	const int32 Handle = FreeZones.Num() > 0 ? FreeZones.Pop(EAllowShrinking::No) : Zones.AddDefaulted();
+
+	FHazardZone& Zone = Zones[Handle];
+	Zone.Owner = Owner;
+	Zone.Settings = Settings;
+	Zone.bActive = true;
+
+	INC_DWORD_STAT(STAT_CombatHazardZones);
+
+	return Handle;
+}
+
+void UCombatHazardSubsystem::UnregisterZone(int32 Handle)
+{
+	if (!Zones.IsValidIndex(Handle) || !Zones[Handle].bActive)
+	{
+		return;
+	}
+
+	// take the occupants out of the zone
+	for (int32 OccupantIndex = Occupants.Num() - 1; OccupantIndex >= 0; --OccupantIndex)
+	{
+		FHazardOccupant& Occupant = Occupants[OccupantIndex];
+		Occupant.Zones.RemoveSingleSwap(Handle, EAllowShrinking::No);
+
+		if (Occupant.Zones.IsEmpty())
+		{
+			RemoveOccupant(OccupantIndex);
+		}
+	}
+
+	Zones[Handle] = FHazardZone();
+	FreeZones.Add(Handle);
+
+	DEC_DWORD_STAT(STAT_CombatHazardZones);
+}
+
+void UCombatHazardSubsystem::EnterZone(int32 Handle, AActor* Actor)
+{
+	if (!Actor || !Zones.IsValidIndex(Handle) || !Zones[Handle].bActive)
+	{
+		return;
+	}
+
+	// find or add the occupant, resolving the interface only once
+	int32 OccupantIndex;
+
+	if (const int32* ExistingIndex = OccupantIndices.Find(FObjectKey(Actor)))
+	{
+		OccupantIndex = *ExistingIndex;
+	}
+	else
+	{
+		ICombatDamageable* Damageable = Cast<ICombatDamageable>(Actor);
+
+		if (!Damageable)
+		{
+			return;
+		}
+
+		OccupantIndex = Occupants.AddDefaulted();
+		Occupants[OccupantIndex].Actor = Actor;
+		Occupants[OccupantIndex].Key = FObjectKey(Actor);
+		Occupants[OccupantIndex].Damageable = Damageable;
+		OccupantIndices.Add(Occupants[OccupantIndex].Key, OccupantIndex);
+
+		INC_DWORD_STAT(STAT_CombatHazardOccupants);
+	}
+
+	FHazardOccupant& Occupant = Occupants[OccupantIndex];
+
+	if (Occupant.Zones.Contains(Handle))
+	{
+		return;
+	}
+
+	Occupant.Zones.Add(Handle);
+
+	// apply the enter damage right away
+	const FHazardZone& Zone = Zones[Handle];
+
+	if (Zone.Settings.EnterDamage > 0.0f)
+	{
+		INC_DWORD_STAT(STAT_CombatHazardEvents);
+
+		Occupant.Damageable->ApplyDamage(Zone.Settings.EnterDamage, Zone.Owner.Get(), Actor->GetActorLocation(), FVector::ZeroVector);
+	}
+}
+
+void UCombatHazardSubsystem::ExitZone(int32 Handle, AActor* Actor)
+{
+	const int32* FoundIndex = OccupantIndices.Find(FObjectKey(Actor));
+
+	if (!FoundIndex)
+	{
+		return;
+	}
+
+	// copy the index, since removing the occupant changes the map
+	const int32 OccupantIndex = *FoundIndex;
+
+	FHazardOccupant& Occupant = Occupants[OccupantIndex];
+	Occupant.Zones.RemoveSingleSwap(Handle, EAllowShrinking::No);
+
+	if (Occupant.Zones.IsEmpty())
+	{
+		RemoveOccupant(OccupantIndex);
+	}
+}
+
+void UCombatHazardSubsystem::RemoveOccupant(int32 OccupantIndex)
+{
+	OccupantIndices.Remove(Occupants[OccupantIndex].Key);
+
+	Occupants.RemoveAtSwap(OccupantIndex, EAllowShrinking::No);
+
+	// fix up the index of the occupant swapped into the slot
+	if (Occupants.IsValidIndex(OccupantIndex))
+	{
+		OccupantIndices.Add(Occupants[OccupantIndex].Key, OccupantIndex);
+	}
+
+	DEC_DWORD_STAT(STAT_CombatHazardOccupants);
+}
+
+void UCombatHazardSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (CombatHazards::TickRate <= 0.0f)
+	{
+		return;
+	}
+
+	const float Interval = 1.0f / CombatHazards::TickRate;
+
+	// only accumulate time while something is inside a zone, so entering a zone doesn't trigger a pass right away
+	if (Occupants.IsEmpty())
+	{
+		TimeSinceDamagePass = 0.0f;
+		return;
+	}
+
+	TimeSinceDamagePass += DeltaTime;
+
+	// run the passes at a fixed rate, dropping the ones we can't catch up on
+	int32 NumPasses = 0;
+
+	while (TimeSinceDamagePass >= Interval && NumPasses < CombatHazards::MaxPassesPerFrame)
+	{
+		TimeSinceDamagePass -= Interval;
+		++NumPasses;
+
+		RunDamagePass(Interval);
+	}
+
+	TimeSinceDamagePass = FMath::Min(TimeSinceDamagePass, Interval);
+}
+
+void UCombatHazardSubsystem::RunDamagePass(float Interval)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatHazardPass);
+
+	/** Damage from all the zones of one hazard type */
+	struct FHazardTypeTotal
+	{
+		FName HazardType;
+		float Sum = 0.0f;
+		float Strongest = 0.0f;
+		int32 StrongestZone = INDEX_NONE;
+	};
+
+	DamageBatch.Reset();
+
+	for (int32 OccupantIndex = Occupants.Num() - 1; OccupantIndex >= 0; --OccupantIndex)
+	{
+		const FHazardOccupant& Occupant = Occupants[OccupantIndex];
+		AActor* Actor = Occupant.Actor.Get();
+
+		// drop destroyed occupants
+		if (!Actor)
+		{
+			RemoveOccupant(OccupantIndex);
+			continue;
+		}
+
+		// sum the zones by hazard type
+		TArray<FHazardTypeTotal, TInlineAllocator<4>> Totals;
+
+		for (const int32 Handle : Occupant.Zones)
+		{
+			const FCombatHazardSettings& Settings = Zones[Handle].Settings;
+
+			FHazardTypeTotal* Total = Totals.FindByPredicate([&Settings](const FHazardTypeTotal& Candidate) { return Candidate.HazardType == Settings.HazardType; });
+
+			if (!Total)
+			{
+				Total = &Totals.AddDefaulted_GetRef();
+				Total->HazardType = Settings.HazardType;
+			}
+
+			Total->Sum += Settings.DamagePerSecond;
+
+			if (Total->StrongestZone == INDEX_NONE || Settings.DamagePerSecond > Total->Strongest)
+			{
+				Total->Strongest = Settings.DamagePerSecond;
+				Total->StrongestZone = Handle;
+			}
+		}
+
+		// combine each type with the stacking rule of its strongest zone
+		float DamagePerSecond = 0.0f;
+		float StrongestDamage = 0.0f;
+		int32 CauserZone = INDEX_NONE;
+
+		for (const FHazardTypeTotal& Total : Totals)
+		{
+			const FCombatHazardSettings& Settings = Zones[Total.StrongestZone].Settings;
+
+			const float TypeDamage = Settings.Stacking == ECombatHazardStacking::Stack
+				? FMath::Min(Total.Sum, Total.Strongest * Settings.MaxStacks)
+				: Total.Strongest;
+
+			DamagePerSecond += TypeDamage;
+
+			if (CauserZone == INDEX_NONE || TypeDamage > StrongestDamage)
+			{
+				StrongestDamage = TypeDamage;
+				CauserZone = Total.StrongestZone;
+			}
+		}
+
+		if (DamagePerSecond <= 0.0f)
+		{
+			continue;
+		}
+
+		FHazardDamage& Damage = DamageBatch.AddDefaulted_GetRef();
+		Damage.Actor = Actor;
+		Damage.Damageable = Occupant.Damageable;
+		Damage.Damage = DamagePerSecond * Interval;
+		Damage.Causer = Zones[CauserZone].Owner;
+	}
+
+	// apply the damage after the pass, since it can kill occupants or move them out of zones
+	for (const FHazardDamage& Damage : DamageBatch)
+	{
+		if (AActor* Actor = Damage.Actor.Get())
+		{
+			INC_DWORD_STAT(STAT_CombatHazardEvents);
+
+			Damage.Damageable->ApplyDamage(Damage.Damage, Damage.Causer.Get(), Actor->GetActorLocation(), FVector::ZeroVector);
+		}
+	}
+}
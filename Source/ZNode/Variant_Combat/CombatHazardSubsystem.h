@@ -0,0 +1,166 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "Stats/Stats.h"
+#include "CombatHazardSubsystem.generated.h"
+
+class ICombatDamageable;
+
+DECLARE_STATS_GROUP(TEXT("Combat Hazards"), STATGROUP_CombatHazards, STATCAT_Advanced);
+
+/** How overlapping zones of the same hazard type combine on an occupant */
+UENUM(BlueprintType)
+enum class ECombatHazardStacking : uint8
+{
+	/** Only the strongest zone damages the occupant */
+	Strongest,
+
+	/** Zone damage adds up, to at most MaxStacks times the strongest zone */
+	Stack
+};
+
+/** Damage settings for a hazard zone */
+USTRUCT(BlueprintType)
+struct FCombatHazardSettings
+{
+	GENERATED_BODY()
+
+	/** Hazard type, such as Lava, Fire or Gas. Stacking rules apply between zones of the same type */
+	UPROPERTY(EditAnywhere, Category="Hazard")
+	FName HazardType = FName("Fire");
+
+	/** Damage dealt to each occupant per second */
+	UPROPERTY(EditAnywhere, Category="Hazard", meta = (ClampMin = 0))
+	float DamagePerSecond = 10.0f;
+
+	/** Damage dealt once when an occupant enters the zone */
+	UPROPERTY(EditAnywhere, Category="Hazard", meta = (ClampMin = 0))
+	float EnterDamage = 0.0f;
+
+	/** How this zone combines with other zones of the same type */
+	UPROPERTY(EditAnywhere, Category="Hazard")
+	ECombatHazardStacking Stacking = ECombatHazardStacking::Strongest;
+
+	/** Max number of zones that can stack, when stacking */
+	UPROPERTY(EditAnywhere, Category="Hazard", meta = (ClampMin = 1, EditCondition = "Stacking == ECombatHazardStacking::Stack"))
+	int32 MaxStacks = 3;
+};
+
+/**
+ *  Applies damage over time to the occupants of hazard zones, such as fire, gas and lava.
+ *  Zones report occupants as they enter and exit, and the damageable interface is resolved once on enter.
+ *  At a fixed rate set by Combat.Hazards.TickRate, a single batched pass sums the damage from every zone each
+ *  occupant is in, combining zones of the same hazard type by their stacking rule, and applies it in one call per occupant.
+ *  Damage is collected first and applied after the pass, so occupants can die or leave zones while it's being applied.
+ */
+UCLASS()
+class UCombatHazardSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** A registered hazard zone */
+	struct FHazardZone
+	{
+		/** Actor that owns the zone, used as the damage causer */
+		TWeakObjectPtr<AActor> Owner;
+
+		/** Damage settings */
+		FCombatHazardSettings Settings;
+
+		/** If false, the zone slot is free */
+		bool bActive = false;
+	};
+
+	/** An actor inside one or more zones */
+	struct FHazardOccupant
+	{
+		/** Occupant actor */
+		TWeakObjectPtr<AActor> Actor;
+
+		/** Key for the occupant index map, still valid after the actor is destroyed */
+		FObjectKey Key;
+
+		/** Damageable interface, resolved on enter */
+		ICombatDamageable* Damageable = nullptr;
+
+		/** Zones the occupant is inside */
+		TArray<int32, TInlineAllocator<4>> Zones;
+	};
+
+	/** Damage to apply to an occupant after the pass */
+	struct FHazardDamage
+	{
+		/** Occupant actor */
+		TWeakObjectPtr<AActor> Actor;
+
+		/** Damageable interface */
+		ICombatDamageable* Damageable = nullptr;
+
+		/** Damage to apply */
+		float Damage = 0.0f;
+
+		/** Zone owner dealing the most damage */
+		TWeakObjectPtr<AActor> Causer;
+	};
+
+	/** Registered zones */
+	TArray<FHazardZone> Zones;
+
+	/** Zone slots that have been released and can be reused */
+	TArray<int32> FreeZones;
+
+	/** Actors inside zones */
+	TArray<FHazardOccupant> Occupants;
+
+	/** Maps each occupant actor to its index */
+	TMap<FObjectKey, int32> OccupantIndices;
+
+	/** Damage collected during the pass */
+	TArray<FHazardDamage> DamageBatch;
+
+	/** Time accumulated towards the next damage pass */
+	float TimeSinceDamagePass = 0.0f;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Runs the damage passes at a fixed rate */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Adds a zone owned by the provided actor. Returns a handle used to remove it */
+	int32 RegisterZone(AActor* Owner, const FCombatHazardSettings& Settings);
+
+	/** Removes a zone and takes its occupants out of it */
+	void UnregisterZone(int32 Handle);
+
+	/** Adds an actor to a zone. Actors that aren't damageable are ignored */
+	void EnterZone(int32 Handle, AActor* Actor);
+
+	/** Removes an actor from a zone */
+	void ExitZone(int32 Handle, AActor* Actor);
+
+	/** Returns the number of actors inside zones */
+	int32 GetNumOccupants() const { return Occupants.Num(); }
+
+protected:
+
+	/** Collects the damage for every occupant over the interval, then applies it */
+	void RunDamagePass(float Interval);
+
+	/** Removes an occupant, keeping the index map up to date */
+	void RemoveOccupant(int32 OccupantIndex);
+};
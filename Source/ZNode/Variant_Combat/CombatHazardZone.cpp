@@ -0,0 +1,14 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatHazardZone.h"
+#include "CombatHazardComponent.h"
+
+ACombatHazardZone::ACombatHazardZone()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	// create the hazard volume
+	RootComponent = HazardVolume = CreateDefaultSubobject<UCombatHazardComponent>(TEXT("Hazard Volume"));
+	HazardVolume->SetBoxExtent(FVector(200.0f, 200.0f, 100.0f));
+}
@@ -0,0 +1,29 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CombatHazardZone.generated.h"
+
+class UCombatHazardComponent;
+
+/**
+ *  A placeable damage over time zone, such as a fire or a gas cloud.
+ *  Damage is applied by the hazard subsystem to the damageable actors inside the volume.
+ *  Effects are expected to be added by Blueprint subclasses.
+ */
+UCLASS()
+class ACombatHazardZone : public AActor
+{
+	GENERATED_BODY()
+
+	/** Hazard volume */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Components, meta = (AllowPrivateAccess = "true"))
+	UCombatHazardComponent* HazardVolume;
+
+public:
+
+	/** Constructor */
+	ACombatHazardZone();
+};
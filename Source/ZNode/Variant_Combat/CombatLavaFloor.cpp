@@ -2,8 +2,11 @@
 
 
 #include "CombatLavaFloor.h"
+#include "CombatHazardComponent.h"
 #include "CombatDamageable.h"
+#include "GameFramework/Pawn.h"
 #include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
 
 ACombatLavaFloor::ACombatLavaFloor()
 {
@@ -14,10 +17,55 @@ ACombatLavaFloor::ACombatLavaFloor()
 
 	// bind the hit handler
 	Mesh->OnComponentHit.AddDynamic(this, &ACombatLavaFloor::OnFloorHit);
+
+	// create the hazard volume
+	HazardVolume = CreateDefaultSubobject<UCombatHazardComponent>(TEXT("Hazard Volume"));
+	HazardVolume->SetupAttachment(Mesh);
+}
+
+void ACombatLavaFloor::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	const UStaticMesh* FloorMesh = Mesh->GetStaticMesh();
+
+	if (!FloorMesh)
+	{
+		return;
+	}
+
+	// cover the top of the mesh, keeping the height in world units regardless of the floor scale
+	const FBox LocalBounds = FloorMesh->GetBoundingBox();
+	const float ScaleZ = FMath::Max(FMath::Abs(Mesh->GetComponentScale().Z), UE_KINDA_SMALL_NUMBER);
+	const float LocalHeight = HazardHeight / ScaleZ;
+
+	const FVector Extent = LocalBounds.GetExtent();
+
+	HazardVolume->SetRelativeLocation(FVector(LocalBounds.GetCenter().X, LocalBounds.GetCenter().Y, LocalBounds.Max.Z + LocalHeight * 0.5f));
+	HazardVolume->SetBoxExtent(FVector(Extent.X, Extent.Y, LocalHeight * 0.5f));
+}
+
+void ACombatLavaFloor::BeginPlay()
+{
+	// lava kills on contact and keeps burning anything that stays on it
+	FCombatHazardSettings Lava = HazardVolume->GetHazardSettings();
+	Lava.HazardType = FName("Lava");
+	Lava.EnterDamage = Damage;
+	Lava.DamagePerSecond = Damage;
+	HazardVolume->SetHazardSettings(Lava);
+
+	// components register their zones during BeginPlay
+	Super::BeginPlay();
 }
 
 void ACombatLavaFloor::OnFloorHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
+	// pawns are damaged by the hazard volume
+	if (!OtherActor || OtherActor->IsA<APawn>())
+	{
+		return;
+	}
+
 	// check if the hit actor is damageable by casting to the interface
 	if (ICombatDamageable* Damageable = Cast<ICombatDamageable>(OtherActor))
 	{
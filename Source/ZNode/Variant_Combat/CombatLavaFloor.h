@@ -7,10 +7,14 @@
 #include "CombatLavaFloor.generated.h"
 
 class UStaticMeshComponent;
-class UPrimitiveComponent;
+class UCombatHazardComponent;
 
 /**
- *  A basic actor that applies damage on contact through the ICombatDamageable interface. 
+ *  A floor that damages the damageable actors standing on it through the ICombatDamageable interface.
+ *  Pawns are damaged once on contact and then over time by the hazard subsystem, through a hazard volume
+ *  fitted on top of the floor mesh, instead of on every physics contact.
+ *  Other damageable actors, like boxes, dummies and breakable pieces, are simulated bodies the pawn-only volume can't see,
+ *  so they're still damaged by the floor's hit events.
  */
 UCLASS(abstract)
 class ACombatLavaFloor : public AActor
@@ -21,12 +25,20 @@ class ACombatLavaFloor : public AActor
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	UStaticMeshComponent* Mesh;
 
+	/** Hazard volume covering the top of the floor */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Components, meta = (AllowPrivateAccess = "true"))
+	UCombatHazardComponent* HazardVolume;
+
 protected:
 
-	/** Amount of damage to deal on contact */
+	/** Amount of damage to deal on contact, and then every second while standing on the floor */
 	UPROPERTY(EditAnywhere, Category="Damage")
 	float Damage = 10000.0f;
 
+	/** Height of the hazard volume above the top of the floor mesh */
+	UPROPERTY(EditAnywhere, Category="Damage", meta = (ClampMin = 0, Units = "cm"))
+	float HazardHeight = 50.0f;
+
 public:	
 
 	/** Constructor */
@@ -34,7 +46,13 @@ public:
 
 protected:
 
-	/** Blocking hit handler */
+	/** Fits the hazard volume to the floor mesh */
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+	/** Passes the damage to the hazard volume before it registers */
+	virtual void BeginPlay() override;
+
+	/** Blocking hit handler. Damages the non-pawn actors that hit the floor */
 	UFUNCTION()
 	void OnFloorHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 };
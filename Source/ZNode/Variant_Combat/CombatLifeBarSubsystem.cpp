@@ -0,0 +1,112 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatLifeBarSubsystem.h"
+#include "Components/SceneComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Life Bar Value Updates"), STAT_CombatLifeBarUpdates, STATGROUP_CombatUI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Life Bars Registered"), STAT_CombatLifeBarsRegistered, STATGROUP_CombatUI);
+
+bool UCombatLifeBarSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatLifeBarSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_CombatLifeBarsRegistered, Anchors.Num());
+
+	// release all bars
+	Anchors.Empty();
+	Offsets.Empty();
+	Percentages.Empty();
+	Colors.Empty();
+	IndexToHandle.Empty();
+	HandleToIndex.Empty();
+	FreeHandles.Empty();
+
+	Super::Deinitialize();
+}
+
+int32 UCombatLifeBarSubsystem::RegisterLifeBar(const USceneComponent* Anchor, const FVector& Offset, const FLinearColor& Color, float Percentage)
+{
+	// reuse a released handle if we have one
+	const int32 Handle = FreeHandles.Num() > 0 ? FreeHandles.Pop(EAllowShrinking::No) : HandleToIndex.AddUninitialized();
+
+	// append the bar at the end of the packed arrays
+	HandleToIndex[Handle] = Anchors.Add(Anchor);
+	Offsets.Add(Offset);
+	Percentages.Add(FMath::Clamp(Percentage, 0.0f, 1.0f));
+	Colors.Add(Color);
+	IndexToHandle.Add(Handle);
+
+	INC_DWORD_STAT(STAT_CombatLifeBarsRegistered);
+
+	return Handle;
+}
+
+void UCombatLifeBarSubsystem::UnregisterLifeBar(int32 Handle)
+{
+	const int32 Index = GetIndex(Handle);
+
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	// swap the last bar into the removed slot to keep the arrays packed
+	Anchors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Offsets.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Percentages.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Colors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	IndexToHandle.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	// fix up the handle of the bar we moved
+	if (IndexToHandle.IsValidIndex(Index))
+	{
+		HandleToIndex[IndexToHandle[Index]] = Index;
+	}
+
+	// release the handle
+	HandleToIndex[Handle] = INDEX_NONE;
+	FreeHandles.Add(Handle);
+
+	DEC_DWORD_STAT(STAT_CombatLifeBarsRegistered);
+}
+
+void UCombatLifeBarSubsystem::SetLifePercentage(int32 Handle, float Percentage)
+{
+	const int32 Index = GetIndex(Handle);
+
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	const float ClampedPercentage = FMath::Clamp(Percentage, 0.0f, 1.0f);
+
+	// only touch the bar if the value has changed
+	if (!FMath::IsNearlyEqual(Percentages[Index], ClampedPercentage))
+	{
+		Percentages[Index] = ClampedPercentage;
+
+		INC_DWORD_STAT(STAT_CombatLifeBarUpdates);
+	}
+}
+
+void UCombatLifeBarSubsystem::SetBarColor(int32 Handle, const FLinearColor& Color)
+{
+	const int32 Index = GetIndex(Handle);
+
+	if (Index != INDEX_NONE && !Colors[Index].Equals(Color))
+	{
+		Colors[Index] = Color;
+
+		INC_DWORD_STAT(STAT_CombatLifeBarUpdates);
+	}
+}
+
+int32 UCombatLifeBarSubsystem::GetIndex(int32 Handle) const
+{
+	return HandleToIndex.IsValidIndex(Handle) ? HandleToIndex[Handle] : INDEX_NONE;
+}
@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Stats/Stats.h"
+#include "CombatLifeBarSubsystem.generated.h"
+
+class USceneComponent;
+
+DECLARE_STATS_GROUP(TEXT("Combat UI"), STATGROUP_CombatUI, STATCAT_Advanced);
+
+/**
+ *  Holds the render state for every batched life bar in the world.
+ *  Bars are stored as tightly packed arrays so the HUD can draw all of them in a single Canvas pass,
+ *  instead of each enemy owning its own widget component and render target.
+ *  Bar values are only written when they actually change.
+ */
+UCLASS()
+class UCombatLifeBarSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Scene components the bars follow */
+	TArray<TWeakObjectPtr<const USceneComponent>> Anchors;
+
+	/** World space offset from each anchor where the bar is drawn */
+	TArray<FVector> Offsets;
+
+	/** 0-1 fill percentage for each bar */
+	TArray<float> Percentages;
+
+	/** Fill color for each bar */
+	TArray<FLinearColor> Colors;
+
+	/** Maps each dense bar index back to the handle that owns it */
+	TArray<int32> IndexToHandle;
+
+	/** Maps each handle to its current dense bar index, or INDEX_NONE if the handle is free */
+	TArray<int32> HandleToIndex;
+
+	/** Handles that have been released and can be reused */
+	TArray<int32> FreeHandles;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Adds a life bar that follows the provided component. Returns a handle used to update or remove it */
+	int32 RegisterLifeBar(const USceneComponent* Anchor, const FVector& Offset, const FLinearColor& Color, float Percentage = 1.0f);
+
+	/** Removes a previously registered life bar */
+	void UnregisterLifeBar(int32 Handle);
+
+	/** Sets the fill percentage for a life bar. Ignored if the value hasn't changed */
+	void SetLifePercentage(int32 Handle, float Percentage);
+
+	/** Sets the fill color for a life bar. Ignored if the value hasn't changed */
+	void SetBarColor(int32 Handle, const FLinearColor& Color);
+
+	/** Returns the number of registered life bars */
+	int32 Num() const { return Anchors.Num(); }
+
+	/** Read-only access to the packed bar data for rendering */
+	const TArray<TWeakObjectPtr<const USceneComponent>>& GetAnchors() const { return Anchors; }
+	const TArray<FVector>& GetOffsets() const { return Offsets; }
+	const TArray<float>& GetPercentages() const { return Percentages; }
+	const TArray<FLinearColor>& GetColors() const { return Colors; }
+
+protected:
+
+	/** Returns the dense index for a handle, or INDEX_NONE if it's not valid */
+	int32 GetIndex(int32 Handle) const;
+};
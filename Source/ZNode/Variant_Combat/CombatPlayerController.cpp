@@ -4,9 +4,9 @@
 #include "Variant_Combat/CombatPlayerController.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputMappingContext.h"
-#include "Kismet/GameplayStatics.h"
-#include "GameFramework/PlayerStart.h"
 #include "CombatCharacter.h"
+#include "CombatTriggerSubsystem.h"
+#include "RespawnSubsystem.h"
 #include "Engine/LocalPlayer.h"
 #include "Engine/World.h"
 
@@ -28,6 +28,23 @@ void ACombatPlayerController::OnPossess(APawn* InPawn)
 
 	// subscribe to the pawn's OnDestroyed delegate
 	InPawn->OnDestroyed.AddDynamic(this, &ACombatPlayerController::OnPawnDestroyed);
+
+	// let the pawn set off trigger volumes
+	if (UCombatTriggerSubsystem* Triggers = GetWorld()->GetSubsystem<UCombatTriggerSubsystem>())
+	{
+		Triggers->RegisterPawn(InPawn);
+	}
+}
+
+void ACombatPlayerController::OnUnPossess()
+{
+	// stop testing the pawn against trigger volumes
+	if (UCombatTriggerSubsystem* Triggers = GetWorld()->GetSubsystem<UCombatTriggerSubsystem>())
+	{
+		Triggers->UnregisterPawn(GetPawn());
+	}
+
+	Super::OnUnPossess();
 }
 
 void ACombatPlayerController::SetRespawnTransform(const FTransform& NewRespawn)
@@ -36,12 +53,20 @@ void ACombatPlayerController::SetRespawnTransform(const FTransform& NewRespawn)
 	RespawnTransform = NewRespawn;
 }
 
+void ACombatPlayerController::PrepareRespawn()
+{
+	// prewarm the next character at the respawn transform
+	if (URespawnSubsystem* Respawns = GetWorld()->GetSubsystem<URespawnSubsystem>())
+	{
+		Respawns->PrepareRespawn(this, CharacterClass, RespawnTransform);
+	}
+}
+
 void ACombatPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 {
-	// spawn a new character at the respawn transform
-	if (ACombatCharacter* RespawnedCharacter = GetWorld()->SpawnActor<ACombatCharacter>(CharacterClass, RespawnTransform))
+	// respawn the character at the respawn transform. It will be possessed by the respawn service
+	if (URespawnSubsystem* Respawns = GetWorld()->GetSubsystem<URespawnSubsystem>())
 	{
-		// possess the character
-		Possess(RespawnedCharacter);
+		Respawns->Respawn(this, CharacterClass, RespawnTransform);
 	}
 }
\ No newline at end of file
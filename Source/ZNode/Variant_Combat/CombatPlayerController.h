@@ -13,6 +13,7 @@ class ACombatCharacter;
  *  Simple Player Controller for a third person combat game
  *  Manages input mappings
  *  Respawns the player character at the checkpoint when it's destroyed
+ *  The respawn can be prepared ahead of time so the new character is ready when the old one is destroyed
  */
 UCLASS(abstract)
 class ACombatPlayerController : public APlayerController
@@ -40,11 +41,17 @@ protected:
 	/** Pawn initialization */
 	virtual void OnPossess(APawn* InPawn) override;
 
+	/** Pawn cleanup */
+	virtual void OnUnPossess() override;
+
 public:
 
 	/** Updates the character respawn transform */
 	void SetRespawnTransform(const FTransform& NewRespawn);
 
+	/** Streams in the respawn area and prewarms the next character. Call while the death camera is playing */
+	void PrepareRespawn();
+
 protected:
 
 	/** Called if the possessed pawn is destroyed */
@@ -0,0 +1,553 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatReplaySubsystem.h"
+#include "CombatCharacter.h"
+#include "GameplayRandomSubsystem.h"
+#include "EnhancedInputSubsystems.h"
+#include "EnhancedPlayerInput.h"
+#include "InputAction.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "CoreGlobals.h"
+
+DEFINE_LOG_CATEGORY(LogCombatReplay);
+
+namespace CombatReplay
+{
+	/** Identifies replay files */
+	constexpr uint32 Magic = 0x4C505243; // "CRPL"
+
+	/** Values closer than this are considered unchanged */
+	constexpr float InputTolerance = 1.e-4f;
+
+	/** Returns the replay subsystem for the console command world */
+	static UCombatReplaySubsystem* GetReplay(UWorld* World)
+	{
+		UCombatReplaySubsystem* Replay = World ? World->GetSubsystem<UCombatReplaySubsystem>() : nullptr;
+
+		if (!Replay)
+		{
+			UE_LOG(LogCombatReplay, Warning, TEXT("Combat replays can only run in a game world"));
+		}
+
+		return Replay;
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs RecordCommand(
+		TEXT("Combat.Replay.Record"),
+		TEXT("Starts recording a combat replay. Usage: Combat.Replay.Record [Name]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UCombatReplaySubsystem* Replay = GetReplay(World))
+			{
+				Replay->StartRecording(Args.Num() > 0 ? Args[0] : FString(TEXT("Combat")));
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs PlayCommand(
+		TEXT("Combat.Replay.Play"),
+		TEXT("Plays back a recorded combat replay. Usage: Combat.Replay.Play [Name]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UCombatReplaySubsystem* Replay = GetReplay(World))
+			{
+				Replay->StartPlayback(Args.Num() > 0 ? Args[0] : FString(TEXT("Combat")));
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld StopCommand(
+		TEXT("Combat.Replay.Stop"),
+		TEXT("Stops recording or playing back a combat replay. Recordings are saved to Saved/Replays"),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UCombatReplaySubsystem* Replay = GetReplay(World))
+			{
+				Replay->Stop();
+			}
+		}));
+
+	/** Returns the value at the provided percentile of an unsorted list */
+	static float Percentile(TArray<float> Values, float Fraction)
+	{
+		if (Values.IsEmpty())
+		{
+			return 0.0f;
+		}
+
+		Values.Sort();
+		return Values[FMath::Clamp(FMath::FloorToInt32(Fraction * Values.Num()), 0, Values.Num() - 1)];
+	}
+
+	/** Returns the average of a list */
+	static float Average(const TArray<float>& Values)
+	{
+		float Total = 0.0f;
+
+		for (const float Value : Values)
+		{
+			Total += Value;
+		}
+
+		return Values.IsEmpty() ? 0.0f : Total / Values.Num();
+	}
+}
+
+bool UCombatReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// start right away if requested from the command line
+	FString Name;
+
+	if (FParse::Value(FCommandLine::Get(), TEXT("CombatReplayRecord="), Name))
+	{
+		StartRecording(Name);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("CombatReplay="), Name))
+	{
+		bExitWhenDone = FParse::Param(FCommandLine::Get(), TEXT("CombatReplayExit"));
+
+		StartPlayback(Name);
+	}
+}
+
+void UCombatReplaySubsystem::Deinitialize()
+{
+	// save any recording in progress
+	Stop();
+
+	Stream.Empty();
+	Frames.Empty();
+	Actions.Empty();
+	ActionValues.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatReplaySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatReplaySubsystem, STATGROUP_Tickables);
+}
+
+FString UCombatReplaySubsystem::GetReplayPath(const FString& Name)
+{
+	return FPaths::ProjectSavedDir() / TEXT("Replays") / (Name + TEXT(".combatreplay"));
+}
+
+UEnhancedInputLocalPlayerSubsystem* UCombatReplaySubsystem::GetInputSubsystem() const
+{
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+
+	return PC ? ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PC->GetLocalPlayer()) : nullptr;
+}
+
+bool UCombatReplaySubsystem::GatherActions()
+{
+	Actions.Reset();
+
+	// the actions are borrowed from the player's character
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	const ACombatCharacter* Character = PC ? Cast<ACombatCharacter>(PC->GetPawn()) : nullptr;
+
+	if (!Character)
+	{
+		return false;
+	}
+
+	TArray<const UInputAction*> CharacterActions;
+	Character->GetInputActions(CharacterActions);
+
+	for (const UInputAction* Action : CharacterActions)
+	{
+		Actions.Add(Action);
+	}
+
+	ActionValues.Init(FVector3f::ZeroVector, Actions.Num());
+
+	return Actions.Num() > 0;
+}
+
+void UCombatReplaySubsystem::ApplySeed()
+{
+	if (UGameplayRandomSubsystem* Random = GetWorld()->GetSubsystem<UGameplayRandomSubsystem>())
+	{
+		Random->SetSeed(Seed);
+	}
+
+	// also seed the global RNG for anything that still uses it
+	FMath::RandInit(static_cast<int32>(Seed));
+	FMath::SRandInit(static_cast<int32>(Seed));
+}
+
+void UCombatReplaySubsystem::StartRecording(const FString& Name)
+{
+	if (State != EReplayState::Idle)
+	{
+		UE_LOG(LogCombatReplay, Warning, TEXT("Can't record while a replay is already running"));
+		return;
+	}
+
+	if (!GatherActions())
+	{
+		UE_LOG(LogCombatReplay, Warning, TEXT("Can't record without a combat character to read input from"));
+		return;
+	}
+
+	ReplayName = Name;
+	Stream.Reset();
+
+	// reseed the gameplay RNG so playback can make the same rolls
+	Seed = GameplayRandom::Mix(FPlatformTime::Cycles64());
+	ApplySeed();
+
+	State = EReplayState::Recording;
+
+	UE_LOG(LogCombatReplay, Log, TEXT("Recording combat replay %s"), *ReplayName);
+}
+
+void UCombatReplaySubsystem::StartPlayback(const FString& Name)
+{
+	if (State != EReplayState::Idle)
+	{
+		UE_LOG(LogCombatReplay, Warning, TEXT("Can't play back while a replay is already running"));
+		return;
+	}
+
+	TArray<uint8> FileData;
+
+	if (!FFileHelper::LoadFileToArray(FileData, *GetReplayPath(Name)))
+	{
+		UE_LOG(LogCombatReplay, Warning, TEXT("Couldn't load combat replay %s"), *GetReplayPath(Name));
+		return;
+	}
+
+	FMemoryReader Reader(FileData);
+
+	// read the header
+	uint32 FileMagic = 0;
+	int32 FileVersion = 0;
+	TArray<FString> ActionPaths;
+
+	Reader << FileMagic << FileVersion << Seed << ActionPaths;
+
+	if (FileMagic != CombatReplay::Magic || FileVersion != Version)
+	{
+		UE_LOG(LogCombatReplay, Warning, TEXT("%s is not a compatible combat replay"), *Name);
+		return;
+	}
+
+	// resolve the actions
+	Actions.Reset();
+
+	for (const FString& Path : ActionPaths)
+	{
+		Actions.Add(Cast<UInputAction>(FSoftObjectPath(Path).TryLoad()));
+	}
+
+	ActionValues.Init(FVector3f::ZeroVector, Actions.Num());
+
+	// decode the frames
+	Frames.Reset();
+	FReplayFrame* Frame = &Frames.AddDefaulted_GetRef();
+
+	while (!Reader.AtEnd() && !Reader.IsError())
+	{
+		uint8 Tag = 0;
+		Reader << Tag;
+
+		switch (static_cast<EReplayTag>(Tag))
+		{
+		case EReplayTag::EndFrame:
+
+			Reader << Frame->DeltaTime;
+			Frame = &Frames.AddDefaulted_GetRef();
+			break;
+
+		case EReplayTag::Input:
+		{
+			TPair<uint8, FVector3f>& Change = Frame->InputChanges.AddDefaulted_GetRef();
+			Reader << Change.Key << Change.Value;
+			break;
+		}
+
+		default:
+		{
+			FReplayEvent& Event = Frame->Events.AddDefaulted_GetRef();
+			Event.Tag = static_cast<EReplayTag>(Tag);
+			Reader << Event.ActorName << Event.Damage;
+			break;
+		}
+		}
+	}
+
+	// the last frame was never closed
+	Frames.Pop();
+
+	if (Frames.IsEmpty())
+	{
+		UE_LOG(LogCombatReplay, Warning, TEXT("Combat replay %s has no frames"), *Name);
+		return;
+	}
+
+	ReplayName = Name;
+	PlaybackFrame = 0;
+	DivergedFrames = 0;
+	ObservedEvents.Reset();
+	GameThreadTimes.Reset(Frames.Num());
+	FrameTimes.Reset(Frames.Num());
+	LastTickSeconds = FPlatformTime::Seconds();
+
+	// replay the same rolls
+	ApplySeed();
+
+	// take over the time step
+	bPrevUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PrevFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+
+	State = EReplayState::Playing;
+
+	ApplyPlaybackFrame();
+
+	UE_LOG(LogCombatReplay, Log, TEXT("Playing back combat replay %s, %d frames"), *ReplayName, Frames.Num());
+}
+
+void UCombatReplaySubsystem::Stop()
+{
+	if (State == EReplayState::Recording)
+	{
+		// write the header and the stream
+		TArray<uint8> FileData;
+		FMemoryWriter Writer(FileData);
+
+		uint32 FileMagic = CombatReplay::Magic;
+		int32 FileVersion = Version;
+		TArray<FString> ActionPaths;
+
+		for (const TWeakObjectPtr<const UInputAction>& Action : Actions)
+		{
+			ActionPaths.Add(Action.IsValid() ? Action->GetPathName() : FString());
+		}
+
+		Writer << FileMagic << FileVersion << Seed << ActionPaths;
+		Writer.Serialize(Stream.GetData(), Stream.Num());
+
+		if (FFileHelper::SaveArrayToFile(FileData, *GetReplayPath(ReplayName)))
+		{
+			UE_LOG(LogCombatReplay, Log, TEXT("Saved combat replay %s, %d bytes"), *GetReplayPath(ReplayName), FileData.Num());
+		}
+		else
+		{
+			UE_LOG(LogCombatReplay, Warning, TEXT("Couldn't save combat replay %s"), *GetReplayPath(ReplayName));
+		}
+
+		Stream.Reset();
+	}
+	else if (State == EReplayState::Playing)
+	{
+		// give the time step back
+		FApp::SetUseFixedTimeStep(bPrevUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(PrevFixedDeltaTime);
+
+		Frames.Reset();
+	}
+
+	State = EReplayState::Idle;
+}
+
+void UCombatReplaySubsystem::RecordSpawn(const AActor* Spawner)
+{
+	if (State != EReplayState::Idle && Spawner)
+	{
+		FReplayEvent Event;
+		Event.Tag = EReplayTag::Spawn;
+		Event.ActorName = Spawner->GetFName();
+
+		AddEvent(Event);
+	}
+}
+
+void UCombatReplaySubsystem::RecordDamage(const AActor* Target, float Damage)
+{
+	if (State != EReplayState::Idle && Target)
+	{
+		FReplayEvent Event;
+		Event.Tag = EReplayTag::Damage;
+		Event.ActorName = Target->GetFName();
+		Event.Damage = Damage;
+
+		AddEvent(Event);
+	}
+}
+
+void UCombatReplaySubsystem::AddEvent(const FReplayEvent& Event)
+{
+	if (State == EReplayState::Playing)
+	{
+		ObservedEvents.Add(Event);
+		return;
+	}
+
+	FMemoryWriter Writer(Stream);
+	Writer.Seek(Stream.Num());
+
+	uint8 Tag = static_cast<uint8>(Event.Tag);
+	FName ActorName = Event.ActorName;
+	float Damage = Event.Damage;
+
+	Writer << Tag << ActorName << Damage;
+}
+
+void UCombatReplaySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	switch (State)
+	{
+	case EReplayState::Recording:
+		RecordFrame(DeltaTime);
+		break;
+
+	case EReplayState::Playing:
+		PlayFrame();
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UCombatReplaySubsystem::RecordFrame(float DeltaTime)
+{
+	FMemoryWriter Writer(Stream);
+	Writer.Seek(Stream.Num());
+
+	// write the action values that changed this frame
+	if (UEnhancedInputLocalPlayerSubsystem* InputSubsystem = GetInputSubsystem())
+	{
+		if (const UEnhancedPlayerInput* PlayerInput = InputSubsystem->GetPlayerInput())
+		{
+			for (int32 ActionIndex = 0; ActionIndex < Actions.Num(); ++ActionIndex)
+			{
+				if (!Actions[ActionIndex].IsValid())
+				{
+					continue;
+				}
+
+				FVector3f Value = FVector3f(PlayerInput->GetActionValue(Actions[ActionIndex].Get()).Get<FVector>());
+
+				if (!Value.Equals(ActionValues[ActionIndex], CombatReplay::InputTolerance))
+				{
+					ActionValues[ActionIndex] = Value;
+
+					uint8 Tag = static_cast<uint8>(EReplayTag::Input);
+					uint8 Index = static_cast<uint8>(ActionIndex);
+
+					Writer << Tag << Index << Value;
+				}
+			}
+		}
+	}
+
+	// close the frame
+	uint8 Tag = static_cast<uint8>(EReplayTag::EndFrame);
+	Writer << Tag << DeltaTime;
+}
+
+void UCombatReplaySubsystem::PlayFrame()
+{
+	// time the frame
+	const double Now = FPlatformTime::Seconds();
+
+	FrameTimes.Add(static_cast<float>((Now - LastTickSeconds) * 1000.0));
+	GameThreadTimes.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+	LastTickSeconds = Now;
+
+	// did the frame play out like the recording?
+	if (ObservedEvents != Frames[PlaybackFrame].Events)
+	{
+		if (DivergedFrames == 0)
+		{
+			UE_LOG(LogCombatReplay, Warning, TEXT("Combat replay %s diverged at frame %d: expected %d events, got %d"), *ReplayName, PlaybackFrame, Frames[PlaybackFrame].Events.Num(), ObservedEvents.Num());
+		}
+
+		++DivergedFrames;
+	}
+
+	ObservedEvents.Reset();
+
+	// move to the next frame
+	if (++PlaybackFrame >= Frames.Num())
+	{
+		ReportPlayback();
+		Stop();
+
+		if (bExitWhenDone)
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+
+		return;
+	}
+
+	ApplyPlaybackFrame();
+}
+
+void UCombatReplaySubsystem::ApplyPlaybackFrame()
+{
+	const FReplayFrame& Frame = Frames[PlaybackFrame];
+
+	// the next frame runs with the recorded time step
+	FApp::SetFixedDeltaTime(Frame.DeltaTime);
+
+	for (const TPair<uint8, FVector3f>& Change : Frame.InputChanges)
+	{
+		if (ActionValues.IsValidIndex(Change.Key))
+		{
+			ActionValues[Change.Key] = Change.Value;
+		}
+	}
+
+	// injected input only lasts a frame, so keep injecting every held value
+	if (UEnhancedInputLocalPlayerSubsystem* InputSubsystem = GetInputSubsystem())
+	{
+		for (int32 ActionIndex = 0; ActionIndex < Actions.Num(); ++ActionIndex)
+		{
+			const UInputAction* Action = Actions[ActionIndex].Get();
+
+			if (Action && !ActionValues[ActionIndex].IsNearlyZero(CombatReplay::InputTolerance))
+			{
+				InputSubsystem->InjectInputForAction(Action, FInputActionValue(Action->ValueType, FVector(ActionValues[ActionIndex])), {}, {});
+			}
+		}
+	}
+}
+
+void UCombatReplaySubsystem::ReportPlayback() const
+{
+	UE_LOG(LogCombatReplay, Log, TEXT("Combat replay %s [%d frames]: frame avg %.2f ms, p99 %.2f ms, max %.2f ms | game thread avg %.2f ms, p99 %.2f ms, max %.2f ms | diverged frames %d"),
+		*ReplayName,
+		FrameTimes.Num(),
+		CombatReplay::Average(FrameTimes),
+		CombatReplay::Percentile(FrameTimes, 0.99f),
+		CombatReplay::Percentile(FrameTimes, 1.0f),
+		CombatReplay::Average(GameThreadTimes),
+		CombatReplay::Percentile(GameThreadTimes, 0.99f),
+		CombatReplay::Percentile(GameThreadTimes, 1.0f),
+		DivergedFrames);
+}
@@ -0,0 +1,196 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatReplaySubsystem.generated.h"
+
+class UInputAction;
+class UEnhancedInputLocalPlayerSubsystem;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCombatReplay, Log, All);
+
+/**
+ *  Records combat sessions into a compact binary stream and plays them back, so a session can be profiled repeatedly.
+ *  The stream holds the gameplay RNG seed, the frame delta times, the player's Enhanced Input action values whenever they change,
+ *  and the enemy spawn and damage events.
+ *  During playback, the recorded delta times are forced through a fixed time step and the action values are injected
+ *  into Enhanced Input, while spawn and damage events are compared against the recording to detect divergence.
+ *  At the end of the playback, frame and game thread times are logged.
+ *
+ *  Recordings should start with the level, so launch with -CombatReplayRecord=Name to record,
+ *  and with -CombatReplay=Name to play back. Add -CombatReplayExit to quit when playback ends, e.g. for headless runs with -nullrhi.
+ *  The Combat.Replay.Record, Combat.Replay.Play and Combat.Replay.Stop console commands do the same from a running game.
+ */
+UCLASS()
+class UCombatReplaySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Tags for the entries in the stream */
+	enum class EReplayTag : uint8
+	{
+		EndFrame,
+		Input,
+		Spawn,
+		Damage
+	};
+
+	/** A spawn or damage event */
+	struct FReplayEvent
+	{
+		/** Event type */
+		EReplayTag Tag = EReplayTag::Spawn;
+
+		/** Spawner or damaged actor */
+		FName ActorName;
+
+		/** Damage amount */
+		float Damage = 0.0f;
+
+		bool operator==(const FReplayEvent& Other) const
+		{
+			return Tag == Other.Tag && ActorName == Other.ActorName && Damage == Other.Damage;
+		}
+	};
+
+	/** Everything that happened in a recorded frame */
+	struct FReplayFrame
+	{
+		/** Frame delta time */
+		float DeltaTime = 0.0f;
+
+		/** Action values that changed this frame */
+		TArray<TPair<uint8, FVector3f>> InputChanges;
+
+		/** Spawn and damage events */
+		TArray<FReplayEvent> Events;
+	};
+
+	/** Replay states */
+	enum class EReplayState : uint8
+	{
+		Idle,
+		Recording,
+		Playing
+	};
+
+	/** Current state */
+	EReplayState State = EReplayState::Idle;
+
+	/** Name of the replay being recorded or played */
+	FString ReplayName;
+
+	/** Gameplay RNG seed for the session */
+	uint64 Seed = 0;
+
+	/** Input actions tracked by the replay */
+	TArray<TWeakObjectPtr<const UInputAction>> Actions;
+
+	/** Last recorded or injected value for each action */
+	TArray<FVector3f> ActionValues;
+
+	/** Stream being recorded */
+	TArray<uint8> Stream;
+
+	/** Frames being played back */
+	TArray<FReplayFrame> Frames;
+
+	/** Frame being played back */
+	int32 PlaybackFrame = 0;
+
+	/** Events observed during the current playback frame */
+	TArray<FReplayEvent> ObservedEvents;
+
+	/** Number of frames where the playback diverged from the recording */
+	int32 DivergedFrames = 0;
+
+	/** Game thread time for each played back frame, in ms */
+	TArray<float> GameThreadTimes;
+
+	/** Wall clock time for each played back frame, in ms */
+	TArray<float> FrameTimes;
+
+	/** Wall clock time at the last tick */
+	double LastTickSeconds = 0.0;
+
+	/** If true, quit when playback ends */
+	bool bExitWhenDone = false;
+
+	/** Fixed time step settings to restore when playback ends */
+	bool bPrevUseFixedTimeStep = false;
+	double PrevFixedDeltaTime = 0.0;
+
+	/** Stream format version */
+	static constexpr int32 Version = 2;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Starts recording or playback if requested from the command line */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Records or plays back a frame */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Starts recording a new replay */
+	void StartRecording(const FString& Name);
+
+	/** Starts playing back a recorded replay */
+	void StartPlayback(const FString& Name);
+
+	/** Stops recording or playback. Recordings are saved to disk */
+	void Stop();
+
+	/** Returns true if we're recording */
+	bool IsRecording() const { return State == EReplayState::Recording; }
+
+	/** Returns true if we're playing back */
+	bool IsPlaying() const { return State == EReplayState::Playing; }
+
+	/** Records an enemy spawn */
+	void RecordSpawn(const AActor* Spawner);
+
+	/** Records damage applied to an actor */
+	void RecordDamage(const AActor* Target, float Damage);
+
+protected:
+
+	/** Gathers the input actions of the player's character */
+	bool GatherActions();
+
+	/** Seeds the gameplay RNG with the session seed */
+	void ApplySeed();
+
+	/** Returns the Enhanced Input subsystem for the first local player */
+	UEnhancedInputLocalPlayerSubsystem* GetInputSubsystem() const;
+
+	/** Adds an event to the recording, or to the observed playback events */
+	void AddEvent(const FReplayEvent& Event);
+
+	/** Writes the input values that changed this frame and closes the frame */
+	void RecordFrame(float DeltaTime);
+
+	/** Checks the finished frame against the recording and sets up the next one */
+	void PlayFrame();
+
+	/** Injects the action values and time step for the current playback frame */
+	void ApplyPlaybackFrame();
+
+	/** Logs the playback results */
+	void ReportPlayback() const;
+
+	/** Returns the file path for a replay */
+	static FString GetReplayPath(const FString& Name);
+};
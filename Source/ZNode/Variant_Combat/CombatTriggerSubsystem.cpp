@@ -0,0 +1,332 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatTriggerSubsystem.h"
+#include "GameFramework/Pawn.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "Engine/OverlapResult.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Trigger Update"), STAT_CombatTriggerUpdate, STATGROUP_CombatTriggers);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Trigger Volumes"), STAT_CombatTriggerVolumes, STATGROUP_CombatTriggers);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Trigger Box Tests"), STAT_CombatTriggerTests, STATGROUP_CombatTriggers);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Trigger Events"), STAT_CombatTriggerEvents, STATGROUP_CombatTriggers);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Avoided Overlap Callbacks"), STAT_CombatTriggerAvoided, STATGROUP_CombatTriggers);
+
+namespace CombatTriggers
+{
+	static bool bCountAvoided = false;
+	static FAutoConsoleVariableRef CVarCountAvoided(
+		TEXT("Combat.Triggers.CountAvoided"),
+		bCountAvoided,
+		TEXT("If true, the trigger volumes will run physics overlap queries to count the overlap events non-player objects would have generated. Debug only"));
+}
+
+bool UCombatTriggerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatTriggerSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_CombatTriggerVolumes, VolumeBounds.Num() - FreeVolumes.Num());
+
+	// release everything
+	VolumeBounds.Empty();
+	VolumeOwners.Empty();
+	VolumeCallbacks.Empty();
+	FreeVolumes.Empty();
+	Cells.Empty();
+	Pawns.Empty();
+	PawnVolumes.Empty();
+	EventBatch.Empty();
+	Candidates.Empty();
+	DebugOverlaps.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatTriggerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatTriggerSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatTriggerSubsystem::GetCellRange(const FBox& Bounds, FIntPoint& OutMin, FIntPoint& OutMax)
+{
+	OutMin = FIntPoint(FMath::FloorToInt32(Bounds.Min.X / CellSize), FMath::FloorToInt32(Bounds.Min.Y / CellSize));
+	OutMax = FIntPoint(FMath::FloorToInt32(Bounds.Max.X / CellSize), FMath::FloorToInt32(Bounds.Max.Y / CellSize));
+}
+
+int32 UCombatTriggerSubsystem::RegisterVolumeCallback(UObject* Owner, FCallback Callback, const FBox& Bounds)
+{
+	check(Owner && Callback);
+
+	// reuse a free slot if we have one
+	int32 Handle;
+
+	if (FreeVolumes.Num() > 0)
+	{
+		Handle = FreeVolumes.Pop(EAllowShrinking::No);
+
+		VolumeBounds[Handle] = Bounds;
+		VolumeOwners[Handle] = FObjectKey(Owner);
+		VolumeCallbacks[Handle] = Callback;
+	}
+	else
+	{
+		Handle = VolumeBounds.Add(Bounds);
+		VolumeOwners.Add(FObjectKey(Owner));
+		VolumeCallbacks.Add(Callback);
+	}
+
+	// add the volume to every cell it touches
+	FIntPoint CellMin, CellMax;
+	GetCellRange(Bounds, CellMin, CellMax);
+
+	for (int32 Y = CellMin.Y; Y <= CellMax.Y; ++Y)
+	{
+		for (int32 X = CellMin.X; X <= CellMax.X; ++X)
+		{
+			Cells.FindOrAdd(FIntPoint(X, Y)).Add(Handle);
+		}
+	}
+
+	INC_DWORD_STAT(STAT_CombatTriggerVolumes);
+
+	return Handle;
+}
+
+void UCombatTriggerSubsystem::UnregisterVolume(int32 Handle)
+{
+	if (!VolumeCallbacks.IsValidIndex(Handle) || !VolumeCallbacks[Handle])
+	{
+		return;
+	}
+
+	// remove the volume from its cells
+	FIntPoint CellMin, CellMax;
+	GetCellRange(VolumeBounds[Handle], CellMin, CellMax);
+
+	for (int32 Y = CellMin.Y; Y <= CellMax.Y; ++Y)
+	{
+		for (int32 X = CellMin.X; X <= CellMax.X; ++X)
+		{
+			const FIntPoint Cell(X, Y);
+
+			if (TArray<int32>* CellVolumes = Cells.Find(Cell))
+			{
+				CellVolumes->RemoveSingleSwap(Handle, EAllowShrinking::No);
+
+				if (CellVolumes->IsEmpty())
+				{
+					Cells.Remove(Cell);
+				}
+			}
+		}
+	}
+
+	// forget the pawns inside, so the slot can be reused cleanly
+	for (TArray<int32>& InsideVolumes : PawnVolumes)
+	{
+		InsideVolumes.Remove(Handle);
+	}
+
+	DebugOverlaps.Remove(Handle);
+
+	VolumeOwners[Handle] = FObjectKey();
+	VolumeCallbacks[Handle] = nullptr;
+	FreeVolumes.Add(Handle);
+
+	DEC_DWORD_STAT(STAT_CombatTriggerVolumes);
+}
+
+void UCombatTriggerSubsystem::RegisterPawn(APawn* Pawn)
+{
+	if (!Pawn || Pawns.Contains(Pawn))
+	{
+		return;
+	}
+
+	Pawns.Add(Pawn);
+	PawnVolumes.AddDefaulted();
+}
+
+void UCombatTriggerSubsystem::UnregisterPawn(APawn* Pawn)
+{
+	const int32 Index = Pawns.IndexOfByKey(Pawn);
+
+	if (Index != INDEX_NONE)
+	{
+		Pawns.RemoveAtSwap(Index);
+		PawnVolumes.RemoveAtSwap(Index);
+	}
+}
+
+void UCombatTriggerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_CombatTriggerUpdate);
+
+		int32 NumTests = 0;
+
+		for (int32 PawnIndex = Pawns.Num() - 1; PawnIndex >= 0; --PawnIndex)
+		{
+			APawn* Pawn = Pawns[PawnIndex].Get();
+
+			// drop destroyed pawns
+			if (!Pawn)
+			{
+				Pawns.RemoveAtSwap(PawnIndex);
+				PawnVolumes.RemoveAtSwap(PawnIndex);
+				continue;
+			}
+
+			const USceneComponent* Root = Pawn->GetRootComponent();
+
+			if (!Root)
+			{
+				continue;
+			}
+
+			const FBox PawnBounds = Root->Bounds.GetBox();
+
+			// gather the volumes in the cells touched by the pawn
+			FIntPoint CellMin, CellMax;
+			GetCellRange(PawnBounds, CellMin, CellMax);
+
+			Candidates.Reset();
+
+			for (int32 Y = CellMin.Y; Y <= CellMax.Y; ++Y)
+			{
+				for (int32 X = CellMin.X; X <= CellMax.X; ++X)
+				{
+					if (const TArray<int32>* CellVolumes = Cells.Find(FIntPoint(X, Y)))
+					{
+						Candidates.Append(*CellVolumes);
+					}
+				}
+			}
+
+			// a volume can span several cells, so sort and dedupe before testing
+			Candidates.Sort();
+
+			int32 NumInside = 0;
+			int32 PrevHandle = INDEX_NONE;
+
+			for (int32 CandidateIndex = 0; CandidateIndex < Candidates.Num(); ++CandidateIndex)
+			{
+				const int32 Handle = Candidates[CandidateIndex];
+
+				// duplicates are adjacent after sorting, so only test the first copy of each volume
+				if (Handle == PrevHandle)
+				{
+					continue;
+				}
+
+				PrevHandle = Handle;
+				++NumTests;
+
+				// compact the volumes the pawn is inside to the front of the list
+				if (VolumeBounds[Handle].Intersect(PawnBounds))
+				{
+					Candidates[NumInside++] = Handle;
+				}
+			}
+
+			Candidates.SetNum(NumInside, EAllowShrinking::No);
+
+			// both lists are sorted, so walk them together to find the volumes we just entered
+			TArray<int32>& InsideVolumes = PawnVolumes[PawnIndex];
+			int32 PrevIndex = 0;
+
+			for (const int32 Handle : Candidates)
+			{
+				while (PrevIndex < InsideVolumes.Num() && InsideVolumes[PrevIndex] < Handle)
+				{
+					++PrevIndex;
+				}
+
+				if (PrevIndex >= InsideVolumes.Num() || InsideVolumes[PrevIndex] != Handle)
+				{
+					FTriggerEvent& Event = EventBatch.AddDefaulted_GetRef();
+					Event.Owner = VolumeOwners[Handle];
+					Event.Callback = VolumeCallbacks[Handle];
+					Event.Pawn = Pawn;
+				}
+			}
+
+			InsideVolumes = Candidates;
+		}
+
+		INC_DWORD_STAT_BY(STAT_CombatTriggerTests, NumTests);
+
+		if (CombatTriggers::bCountAvoided)
+		{
+			CountAvoidedOverlaps();
+		}
+	}
+
+	// fire the batch. Callbacks are free to register or unregister volumes
+	for (const FTriggerEvent& Event : EventBatch)
+	{
+		UObject* Owner = Event.Owner.ResolveObjectPtr();
+		APawn* Pawn = Event.Pawn.Get();
+
+		if (Owner && Pawn)
+		{
+			Event.Callback(Owner, Pawn);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_CombatTriggerEvents, EventBatch.Num());
+
+	EventBatch.Reset();
+}
+
+void UCombatTriggerSubsystem::CountAvoidedOverlaps()
+{
+	int32 NumAvoided = 0;
+
+	TArray<FOverlapResult> Overlaps;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(CombatTriggerAvoided));
+
+	for (const TWeakObjectPtr<APawn>& Pawn : Pawns)
+	{
+		QueryParams.AddIgnoredActor(Pawn.Get());
+	}
+
+	for (int32 Handle = 0; Handle < VolumeBounds.Num(); ++Handle)
+	{
+		if (!VolumeCallbacks[Handle])
+		{
+			continue;
+		}
+
+		// find every dynamic primitive the old overlap box would have reacted to
+		Overlaps.Reset();
+		GetWorld()->OverlapMultiByObjectType(Overlaps, VolumeBounds[Handle].GetCenter(), FQuat::Identity, FCollisionObjectQueryParams(FCollisionObjectQueryParams::AllDynamicObjects), FCollisionShape::MakeBox(VolumeBounds[Handle].GetExtent()), QueryParams);
+
+		TSet<FObjectKey>& PrevInside = DebugOverlaps.FindOrAdd(Handle);
+		TSet<FObjectKey> NowInside;
+
+		for (const FOverlapResult& Overlap : Overlaps)
+		{
+			const FObjectKey Key(Overlap.GetComponent());
+			NowInside.Add(Key);
+
+			// each primitive entering the box would have fired a begin overlap callback
+			if (!PrevInside.Contains(Key))
+			{
+				++NumAvoided;
+			}
+		}
+
+		PrevInside = MoveTemp(NowInside);
+	}
+
+	INC_DWORD_STAT_BY(STAT_CombatTriggerAvoided, NumAvoided);
+}
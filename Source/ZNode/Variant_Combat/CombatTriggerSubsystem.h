@@ -0,0 +1,131 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "Stats/Stats.h"
+#include "CombatTriggerSubsystem.generated.h"
+
+class APawn;
+
+DECLARE_STATS_GROUP(TEXT("Combat Triggers"), STATGROUP_CombatTriggers, STATCAT_Advanced);
+
+/**
+ *  Trigger volumes that only care about player pawns.
+ *  Instead of relying on physics overlap events, which are generated by every enemy, ragdoll and prop moving through
+ *  the volume, registered volumes are stored as static world boxes in a coarse 2D grid.
+ *  Once per frame, each registered player pawn looks up the grid cells it touches and runs a cheap box test
+ *  against the volumes in them. Volumes the pawn has just entered are collected and notified as a single batch.
+ *  Volumes are assumed not to move after they're registered.
+ *
+ *  Usage:
+ *    TriggerHandle = GetWorld()->GetSubsystem<UCombatTriggerSubsystem>()->RegisterVolume<&AMyVolume::OnPlayerEntered>(this, Box->Bounds.GetBox());
+ */
+UCLASS()
+class UCombatTriggerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Callback type stored in the volumes */
+	using FCallback = void (*)(UObject*, APawn*);
+
+protected:
+
+	/** Size of the spatial index grid cells, in world units */
+	static constexpr float CellSize = 2000.0f;
+
+	/** World bounds for each volume */
+	TArray<FBox> VolumeBounds;
+
+	/** Object that owns each volume */
+	TArray<FObjectKey> VolumeOwners;
+
+	/** Function called when a player enters each volume, or nullptr if the volume slot is free */
+	TArray<FCallback> VolumeCallbacks;
+
+	/** Volume slots that have been released and can be reused */
+	TArray<int32> FreeVolumes;
+
+	/** Spatial index. Maps each grid cell to the volumes that touch it */
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	/** Registered player pawns */
+	TArray<TWeakObjectPtr<APawn>> Pawns;
+
+	/** Volumes each registered pawn was inside last frame. Kept sorted */
+	TArray<TArray<int32>> PawnVolumes;
+
+	/** A pawn that entered a volume this frame */
+	struct FTriggerEvent
+	{
+		/** Volume owner */
+		FObjectKey Owner;
+
+		/** Volume callback */
+		FCallback Callback = nullptr;
+
+		/** Pawn that entered the volume */
+		TWeakObjectPtr<APawn> Pawn;
+	};
+
+	/** Events collected for firing this frame */
+	TArray<FTriggerEvent> EventBatch;
+
+	/** Scratch list of volumes touched by a pawn this frame */
+	TArray<int32> Candidates;
+
+	/** Non-player primitives inside each volume, only tracked while measuring avoided overlaps */
+	TMap<int32, TSet<FObjectKey>> DebugOverlaps;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Tests the registered pawns against the volumes and fires the enter events */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Adds a volume that calls Method on Owner when a player pawn enters the provided world box. Returns a handle used to remove it */
+	template<auto Method, typename OwnerType>
+	int32 RegisterVolume(OwnerType* Owner, const FBox& Bounds)
+	{
+		return RegisterVolumeCallback(Owner, &Thunk<Method, OwnerType>, Bounds);
+	}
+
+	/** Removes a previously registered volume */
+	void UnregisterVolume(int32 Handle);
+
+	/** Adds a player pawn to be tested against the volumes */
+	void RegisterPawn(APawn* Pawn);
+
+	/** Removes a player pawn */
+	void UnregisterPawn(APawn* Pawn);
+
+protected:
+
+	/** Calls the templated method on the owner */
+	template<auto Method, typename OwnerType>
+	static void Thunk(UObject* Owner, APawn* Pawn)
+	{
+		(static_cast<OwnerType*>(Owner)->*Method)(Pawn);
+	}
+
+	/** Adds a volume using the provided callback */
+	int32 RegisterVolumeCallback(UObject* Owner, FCallback Callback, const FBox& Bounds);
+
+	/** Returns the range of grid cells touched by a box */
+	static void GetCellRange(const FBox& Bounds, FIntPoint& OutMin, FIntPoint& OutMax);
+
+	/** Counts the overlap events non-player objects would have generated on the volumes. Debug only */
+	void CountAvoidedOverlaps();
+};
@@ -0,0 +1,238 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatVATAsset.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/Texture2D.h"
+
+#if WITH_EDITOR
+#include "Engine/SkeletalMesh.h"
+#include "Animation/AnimSequence.h"
+#include "Animation/AnimationPoseData.h"
+#include "Animation/AttributesRuntime.h"
+#include "BonePose.h"
+#include "Rendering/SkeletalMeshModel.h"
+#include "Rendering/SkeletalMeshLODModel.h"
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogCombatVAT, Log, All);
+
+const FCombatVATClipInfo& UCombatVATAsset::GetClip(ECombatVATClip Clip) const
+{
+	switch (Clip)
+	{
+	case ECombatVATClip::Run:
+		return Run;
+
+	case ECombatVATClip::Attack:
+		return Attack;
+
+	default:
+		return Walk;
+	}
+}
+
+bool UCombatVATAsset::IsBaked() const
+{
+	return InstanceMesh && PositionTexture && NumVertices > 0;
+}
+
+void UCombatVATAsset::MakeCustomData(ECombatVATClip Clip, float StartTime, float PlayRateScale, TArrayView<float> OutData) const
+{
+	check(OutData.Num() >= ECombatVATCustomData::Count);
+
+	const FCombatVATClipInfo& ClipInfo = GetClip(Clip);
+
+	OutData[ECombatVATCustomData::StartFrame] = ClipInfo.StartFrame;
+	OutData[ECombatVATCustomData::NumFrames] = ClipInfo.NumFrames;
+	OutData[ECombatVATCustomData::FrameRate] = SampleRate * ClipInfo.PlayRate * PlayRateScale;
+	OutData[ECombatVATCustomData::StartTime] = StartTime;
+}
+
+#if WITH_EDITOR
+
+namespace CombatVAT
+{
+	/** Reference pose vertex and its skin weights, remapped to skeleton bone indices */
+	struct FBakeVertex
+	{
+		FVector3f Position;
+		int32 NumInfluences = 0;
+		int32 Bones[MAX_TOTAL_INFLUENCES];
+		float Weights[MAX_TOTAL_INFLUENCES];
+	};
+}
+
+void UCombatVATAsset::Bake()
+{
+	// ensure we have a source mesh with editor data
+	const FSkeletalMeshModel* ImportedModel = SourceMesh ? SourceMesh->GetImportedModel() : nullptr;
+
+	if (!ImportedModel || ImportedModel->LODModels.IsEmpty())
+	{
+		UE_LOG(LogCombatVAT, Error, TEXT("%s: can't bake without a valid source mesh"), *GetName());
+		return;
+	}
+
+	const FSkeletalMeshLODModel& LODModel = ImportedModel->LODModels[0];
+
+	// gather the reference pose vertices in render order
+	TArray<CombatVAT::FBakeVertex> Vertices;
+	Vertices.Reserve(LODModel.NumVertices);
+
+	for (const FSkelMeshSection& Section : LODModel.Sections)
+	{
+		for (const FSoftSkinVertex& SoftVertex : Section.SoftVertices)
+		{
+			CombatVAT::FBakeVertex& Vertex = Vertices.AddDefaulted_GetRef();
+			Vertex.Position = SoftVertex.Position;
+
+			float TotalWeight = 0.0f;
+
+			for (int32 Influence = 0; Influence < MAX_TOTAL_INFLUENCES; ++Influence)
+			{
+				if (SoftVertex.InfluenceWeights[Influence] == 0)
+				{
+					continue;
+				}
+
+				// section bone indices are remapped through the bone map
+				Vertex.Bones[Vertex.NumInfluences] = Section.BoneMap[SoftVertex.InfluenceBones[Influence]];
+				Vertex.Weights[Vertex.NumInfluences] = SoftVertex.InfluenceWeights[Influence];
+				TotalWeight += Vertex.Weights[Vertex.NumInfluences];
+
+				++Vertex.NumInfluences;
+			}
+
+			// normalize the weights
+			for (int32 Influence = 0; Influence < Vertex.NumInfluences; ++Influence)
+			{
+				Vertex.Weights[Influence] /= TotalWeight;
+			}
+		}
+	}
+
+	if (Vertices.IsEmpty())
+	{
+		UE_LOG(LogCombatVAT, Error, TEXT("%s: source mesh has no vertices"), *GetName());
+		return;
+	}
+
+	Modify();
+
+	// work out the frame range for each clip
+	FCombatVATClipInfo* Clips[] = { &Walk, &Run, &Attack };
+	int32 TotalFrames = 0;
+
+	for (FCombatVATClipInfo* Clip : Clips)
+	{
+		Clip->StartFrame = TotalFrames;
+		Clip->NumFrames = Clip->Sequence ? FMath::Max(1, FMath::FloorToInt(Clip->Sequence->GetPlayLength() * SampleRate)) : 0;
+
+		TotalFrames += Clip->NumFrames;
+	}
+
+	if (TotalFrames == 0)
+	{
+		UE_LOG(LogCombatVAT, Error, TEXT("%s: no clips to bake"), *GetName());
+		return;
+	}
+
+	// size the texture
+	NumVertices = Vertices.Num();
+
+	const int32 Width = FMath::Min(NumVertices, MaxTextureWidth);
+	RowsPerFrame = FMath::DivideAndRoundUp(NumVertices, Width);
+
+	const int32 Height = TotalFrames * RowsPerFrame;
+
+	TArray<FFloat16Color> Pixels;
+	Pixels.SetNumZeroed(Width * Height);
+
+	// set up the pose evaluation for every bone in the mesh
+	const int32 NumBones = SourceMesh->GetRefSkeleton().GetNum();
+	const TArray<FMatrix44f>& RefBasesInv = SourceMesh->GetRefBasesInvMatrix();
+
+	TArray<FBoneIndexType> RequiredBones;
+	RequiredBones.SetNumUninitialized(NumBones);
+
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		RequiredBones[BoneIndex] = static_cast<FBoneIndexType>(BoneIndex);
+	}
+
+	FBoneContainer BoneContainer(RequiredBones, UE::Anim::FCurveFilterSettings(UE::Anim::ECurveFilterMode::DisallowAll), *SourceMesh);
+
+	TArray<FMatrix44f> RefToLocals;
+	RefToLocals.SetNumUninitialized(NumBones);
+
+	// bake every frame of every clip
+	for (const FCombatVATClipInfo* Clip : Clips)
+	{
+		for (int32 Frame = 0; Frame < Clip->NumFrames; ++Frame)
+		{
+			FMemMark Mark(FMemStack::Get());
+
+			// evaluate the pose
+			FCompactPose Pose;
+			Pose.SetBoneContainer(&BoneContainer);
+
+			FBlendedCurve Curve;
+			Curve.InitFrom(BoneContainer);
+
+			UE::Anim::FStackAttributeContainer Attributes;
+			FAnimationPoseData PoseData(Pose, Curve, Attributes);
+
+			Clip->Sequence->GetAnimationPose(PoseData, FAnimExtractContext(static_cast<double>(Frame) / SampleRate));
+
+			// convert it to skinning matrices
+			FCSPose<FCompactPose> ComponentPose;
+			ComponentPose.InitPose(Pose);
+
+			for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+			{
+				const FTransform& BoneTransform = ComponentPose.GetComponentSpaceTransform(FCompactPoseBoneIndex(BoneIndex));
+				RefToLocals[BoneIndex] = RefBasesInv[BoneIndex] * FMatrix44f(BoneTransform.ToMatrixWithScale());
+			}
+
+			// skin the vertices and write their offsets from the reference pose
+			const int32 FirstPixel = (Clip->StartFrame + Frame) * RowsPerFrame * Width;
+
+			for (int32 VertexIndex = 0; VertexIndex < NumVertices; ++VertexIndex)
+			{
+				const CombatVAT::FBakeVertex& Vertex = Vertices[VertexIndex];
+				FVector3f Skinned = FVector3f::ZeroVector;
+
+				for (int32 Influence = 0; Influence < Vertex.NumInfluences; ++Influence)
+				{
+					Skinned += RefToLocals[Vertex.Bones[Influence]].TransformPosition(Vertex.Position) * Vertex.Weights[Influence];
+				}
+
+				const FVector3f Offset = Skinned - Vertex.Position;
+				Pixels[FirstPixel + VertexIndex] = FFloat16Color(FLinearColor(Offset.X, Offset.Y, Offset.Z, 1.0f));
+			}
+		}
+	}
+
+	// create the texture inside this asset's package
+	if (!PositionTexture)
+	{
+		PositionTexture = NewObject<UTexture2D>(this, TEXT("PositionTexture"), RF_Public);
+	}
+
+	// write the pixels. Offsets need full precision and no filtering or mips
+	PositionTexture->PreEditChange(nullptr);
+	PositionTexture->Source.Init(Width, Height, 1, 1, TSF_RGBA16F, reinterpret_cast<const uint8*>(Pixels.GetData()));
+	PositionTexture->CompressionSettings = TC_HDR;
+	PositionTexture->SRGB = false;
+	PositionTexture->Filter = TF_Nearest;
+	PositionTexture->MipGenSettings = TMGS_NoMipmaps;
+	PositionTexture->NeverStream = true;
+	PositionTexture->PostEditChange();
+
+	MarkPackageDirty();
+
+	UE_LOG(LogCombatVAT, Log, TEXT("%s: baked %d frames of %d vertices into a %dx%d texture"), *GetName(), TotalFrames, NumVertices, Width, Height);
+}
+
+#endif // WITH_EDITOR
@@ -0,0 +1,155 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "CombatVATAsset.generated.h"
+
+class USkeletalMesh;
+class UStaticMesh;
+class UAnimSequence;
+class UTexture2D;
+
+/**
+ *  Animation clips that can be baked into a vertex animation texture
+ */
+UENUM(BlueprintType)
+enum class ECombatVATClip : uint8
+{
+	Walk,
+	Run,
+	Attack
+};
+
+/**
+ *  A single animation baked into a vertex animation texture
+ */
+USTRUCT(BlueprintType)
+struct FCombatVATClipInfo
+{
+	GENERATED_BODY()
+
+	/** Animation to bake */
+	UPROPERTY(EditAnywhere, Category="VAT")
+	UAnimSequence* Sequence = nullptr;
+
+	/** Multiplier applied to the playback speed at runtime */
+	UPROPERTY(EditAnywhere, Category="VAT", meta = (ClampMin = 0.01))
+	float PlayRate = 1.0f;
+
+	/** First frame of this clip in the texture. Written by the bake */
+	UPROPERTY(VisibleAnywhere, Category="VAT")
+	int32 StartFrame = 0;
+
+	/** Number of frames of this clip in the texture. Written by the bake */
+	UPROPERTY(VisibleAnywhere, Category="VAT")
+	int32 NumFrames = 0;
+};
+
+/**
+ *  Holds a set of enemy animations baked into a vertex animation texture (VAT),
+ *  so far away enemies can be drawn as static mesh instances instead of animated skeletal meshes.
+ *
+ *  The texture stores the offset of every render vertex from the reference pose, one texel per vertex.
+ *  Each frame takes RowsPerFrame rows, and frames for every clip are stacked vertically.
+ *  The instance material reads the vertex index from the InstanceMesh's second UV channel, and the clip
+ *  to play from the per-instance custom data (see ECombatVATCustomData).
+ *
+ *  The bake is editor only. Use the Bake button on the asset after setting up the source mesh and clips.
+ */
+UCLASS(BlueprintType)
+class UCombatVATAsset : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Skeletal mesh the animations are baked from */
+	UPROPERTY(EditAnywhere, Category="Source")
+	USkeletalMesh* SourceMesh = nullptr;
+
+	/** Static mesh version of the source mesh drawn by the instances. Must keep the LOD 0 vertex order of the source mesh */
+	UPROPERTY(EditAnywhere, Category="Rendering")
+	UStaticMesh* InstanceMesh = nullptr;
+
+	/** Walk cycle */
+	UPROPERTY(EditAnywhere, Category="Clips")
+	FCombatVATClipInfo Walk;
+
+	/** Run cycle */
+	UPROPERTY(EditAnywhere, Category="Clips")
+	FCombatVATClipInfo Run;
+
+	/** Attack animation */
+	UPROPERTY(EditAnywhere, Category="Clips")
+	FCombatVATClipInfo Attack;
+
+	/** Ground speed above which the run clip is played instead of the walk clip */
+	UPROPERTY(EditAnywhere, Category="Clips", meta = (ClampMin = 0, Units = "cm/s"))
+	float RunSpeedThreshold = 250.0f;
+
+	/** Frames per second the clips are sampled at */
+	UPROPERTY(EditAnywhere, Category="Bake", meta = (ClampMin = 1, ClampMax = 120))
+	int32 SampleRate = 30;
+
+	/** Max texture width. Meshes with more vertices than this use several rows per frame */
+	UPROPERTY(EditAnywhere, Category="Bake", meta = (ClampMin = 64, ClampMax = 8192))
+	int32 MaxTextureWidth = 4096;
+
+	/** Baked vertex offsets */
+	UPROPERTY(VisibleAnywhere, Category="Bake")
+	UTexture2D* PositionTexture = nullptr;
+
+	/** Number of vertices baked per frame */
+	UPROPERTY(VisibleAnywhere, Category="Bake")
+	int32 NumVertices = 0;
+
+	/** Number of texture rows used by each frame */
+	UPROPERTY(VisibleAnywhere, Category="Bake")
+	int32 RowsPerFrame = 0;
+
+public:
+
+	/** Returns the info for the provided clip */
+	const FCombatVATClipInfo& GetClip(ECombatVATClip Clip) const;
+
+	/** Returns true if the asset has been baked and has a mesh to draw */
+	bool IsBaked() const;
+
+	/** Fills out the per-instance custom data to play a clip. PlayRateScale of zero holds the first frame */
+	void MakeCustomData(ECombatVATClip Clip, float StartTime, float PlayRateScale, TArrayView<float> OutData) const;
+
+#if WITH_EDITOR
+
+	/** Bakes all clips into the position texture */
+	UFUNCTION(CallInEditor, Category="Bake")
+	void Bake();
+
+#endif // WITH_EDITOR
+
+};
+
+/**
+ *  Layout of the per-instance custom data read by the VAT material
+ */
+namespace ECombatVATCustomData
+{
+	enum Type : int32
+	{
+		/** First frame of the clip in the texture */
+		StartFrame,
+
+		/** Number of frames in the clip */
+		NumFrames,
+
+		/** Playback rate in frames per second */
+		FrameRate,
+
+		/** Game time the clip started playing at */
+		StartTime,
+
+		/** Number of custom data floats */
+		Count
+	};
+}
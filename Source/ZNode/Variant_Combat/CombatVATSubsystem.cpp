@@ -0,0 +1,347 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatVATSubsystem.h"
+#include "CombatEnemy.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("VAT Update"), STAT_CombatVATUpdate, STATGROUP_CombatRender);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("VAT Enemies Registered"), STAT_CombatVATRegistered, STATGROUP_CombatRender);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("VAT Enemies Drawn"), STAT_CombatVATDrawn, STATGROUP_CombatRender);
+DECLARE_DWORD_COUNTER_STAT(TEXT("VAT Swaps"), STAT_CombatVATSwaps, STATGROUP_CombatRender);
+
+namespace CombatVAT
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("Combat.Render.VAT"),
+		bEnabled,
+		TEXT("If true, far away enemies will be drawn through vertex animation textures instead of their skeletal mesh"));
+
+	static float VATDistance = 3000.0f;
+	static FAutoConsoleVariableRef CVarVATDistance(
+		TEXT("Combat.Render.VATDistance"),
+		VATDistance,
+		TEXT("Enemies further than this from every viewpoint are drawn through vertex animation textures"));
+
+	static int32 MaxSwapsPerFrame = 16;
+	static FAutoConsoleVariableRef CVarMaxSwapsPerFrame(
+		TEXT("Combat.Render.VATSwapsPerFrame"),
+		MaxSwapsPerFrame,
+		TEXT("Max number of enemies that can swap between skeletal and VAT rendering in a single frame"));
+
+	/** Fraction of the VAT distance enemies need to come within before swapping back, to avoid flickering at the boundary */
+	constexpr float RestoreHysteresis = 0.9f;
+
+	/** Enemies moving slower than this hold the first frame of their clip */
+	constexpr float MinAnimatedSpeed = 10.0f;
+}
+
+bool UCombatVATSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatVATSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_CombatVATRegistered, Proxies.Num());
+
+	// release everything. The batch actor is destroyed along with the world
+	Proxies.Empty();
+	Batches.Empty();
+	BatchAssets.Empty();
+	BatchComponents.Empty();
+	BatchActor = nullptr;
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatVATSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatVATSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatVATSubsystem::IsEnabled()
+{
+	return CombatVAT::bEnabled;
+}
+
+void UCombatVATSubsystem::RegisterEnemy(ACombatEnemy* Enemy, UCombatVATAsset* Asset)
+{
+	// ignore enemies without a usable asset
+	if (!Enemy || !Asset || !Asset->IsBaked())
+	{
+		return;
+	}
+
+	// there's nothing to draw on a dedicated server
+	if (GetWorld()->GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	FProxy& Proxy = Proxies.AddDefaulted_GetRef();
+	Proxy.Enemy = Enemy;
+	Proxy.BatchIndex = FindOrAddBatch(Asset);
+
+	INC_DWORD_STAT(STAT_CombatVATRegistered);
+}
+
+void UCombatVATSubsystem::UnregisterEnemy(ACombatEnemy* Enemy)
+{
+	const int32 Index = Proxies.IndexOfByPredicate([Enemy](const FProxy& Proxy) { return Proxy.Enemy.Get() == Enemy; });
+
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	// give the enemy back its skeletal mesh
+	if (Proxies[Index].bUsingVAT)
+	{
+		SetUsingVAT(Proxies[Index], Enemy, false);
+	}
+
+	Proxies.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	DEC_DWORD_STAT(STAT_CombatVATRegistered);
+}
+
+int32 UCombatVATSubsystem::FindOrAddBatch(UCombatVATAsset* Asset)
+{
+	const int32 Existing = BatchAssets.Find(Asset);
+
+	if (Existing != INDEX_NONE)
+	{
+		return Existing;
+	}
+
+	// spawn the actor that owns the instanced meshes
+	if (!BatchActor)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+
+		BatchActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+	}
+
+	// create the instanced mesh for this asset
+	UInstancedStaticMeshComponent* Instances = NewObject<UInstancedStaticMeshComponent>(BatchActor);
+	Instances->SetMobility(EComponentMobility::Movable);
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetCanEverAffectNavigation(false);
+	Instances->SetStaticMesh(Asset->InstanceMesh);
+	Instances->SetNumCustomDataFloats(ECombatVATCustomData::Count);
+	Instances->RegisterComponent();
+
+	BatchAssets.Add(Asset);
+	BatchComponents.Add(Instances);
+
+	return Batches.AddDefaulted();
+}
+
+void UCombatVATSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatVATUpdate);
+
+	if (Proxies.IsEmpty())
+	{
+		return;
+	}
+
+	// gather the local viewpoints
+	TArray<FVector, TInlineAllocator<4>> Viewpoints;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+
+		if (PlayerController && PlayerController->IsLocalController() && PlayerController->PlayerCameraManager)
+		{
+			Viewpoints.Add(PlayerController->PlayerCameraManager->GetCameraLocation());
+		}
+	}
+
+	const float SwapDistanceSquared = FMath::Square(CombatVAT::VATDistance);
+	const float RestoreDistanceSquared = FMath::Square(CombatVAT::VATDistance * CombatVAT::RestoreHysteresis);
+
+	int32 SwapBudget = CombatVAT::MaxSwapsPerFrame;
+
+	for (int32 Index = Proxies.Num() - 1; Index >= 0; --Index)
+	{
+		FProxy& Proxy = Proxies[Index];
+		ACombatEnemy* Enemy = Proxy.Enemy.Get();
+
+		// drop enemies that were destroyed without unregistering
+		if (!Enemy)
+		{
+			Proxies.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			DEC_DWORD_STAT(STAT_CombatVATRegistered);
+			continue;
+		}
+
+		// dead and ragdolling enemies always need their skeletal mesh
+		const bool bCanUseVAT = CombatVAT::bEnabled && !Viewpoints.IsEmpty() && Enemy->CurrentHP > 0.0f && !Enemy->GetMesh()->IsAnySimulatingPhysics();
+
+		float ClosestDistanceSquared = UE_BIG_NUMBER;
+
+		for (const FVector& Viewpoint : Viewpoints)
+		{
+			ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared, static_cast<float>(FVector::DistSquared(Viewpoint, Enemy->GetActorLocation())));
+		}
+
+		const bool bWantsVAT = bCanUseVAT && ClosestDistanceSquared > (Proxy.bUsingVAT ? RestoreDistanceSquared : SwapDistanceSquared);
+
+		if (bWantsVAT != Proxy.bUsingVAT)
+		{
+			// forced swaps back to the skeletal mesh ignore the budget
+			if (!bCanUseVAT)
+			{
+				SetUsingVAT(Proxy, Enemy, false);
+			}
+			else if (SwapBudget > 0)
+			{
+				SetUsingVAT(Proxy, Enemy, bWantsVAT);
+				--SwapBudget;
+			}
+		}
+	}
+
+	// rebuild the instances
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+
+	for (int32 BatchIndex = 0; BatchIndex < Batches.Num(); ++BatchIndex)
+	{
+		UpdateBatch(BatchIndex, TimeSeconds);
+	}
+}
+
+void UCombatVATSubsystem::SetUsingVAT(FProxy& Proxy, ACombatEnemy* Enemy, bool bUseVAT)
+{
+	USkeletalMeshComponent* Mesh = Enemy->GetMesh();
+
+	if (bUseVAT)
+	{
+		// hide the skeletal mesh and skip the anim graph, but keep montages running so attack notifies still fire
+		Proxy.SavedTickOption = Mesh->VisibilityBasedAnimTickOption;
+		Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+		Mesh->SetVisibility(false);
+
+		// force the clip to restart
+		Proxy.ClipStartTime = -1.0f;
+
+		INC_DWORD_STAT(STAT_CombatVATDrawn);
+	}
+	else
+	{
+		// restore the skeletal mesh
+		Mesh->VisibilityBasedAnimTickOption = Proxy.SavedTickOption;
+		Mesh->SetVisibility(true);
+
+		DEC_DWORD_STAT(STAT_CombatVATDrawn);
+	}
+
+	Proxy.bUsingVAT = bUseVAT;
+
+	INC_DWORD_STAT(STAT_CombatVATSwaps);
+}
+
+void UCombatVATSubsystem::UpdateBatch(int32 BatchIndex, float TimeSeconds)
+{
+	FBatch& Batch = Batches[BatchIndex];
+	const UCombatVATAsset* Asset = BatchAssets[BatchIndex];
+	UInstancedStaticMeshComponent* Instances = BatchComponents[BatchIndex];
+
+	if (!Asset || !Instances)
+	{
+		return;
+	}
+
+	Batch.Transforms.Reset();
+
+	TArray<float, TInlineAllocator<ECombatVATCustomData::Count>> InstanceData;
+	InstanceData.SetNumZeroed(ECombatVATCustomData::Count);
+
+	bool bCustomDataDirty = false;
+
+	for (FProxy& Proxy : Proxies)
+	{
+		if (!Proxy.bUsingVAT || Proxy.BatchIndex != BatchIndex)
+		{
+			continue;
+		}
+
+		const ACombatEnemy* Enemy = Proxy.Enemy.Get();
+		const int32 InstanceIndex = Batch.Transforms.Num();
+
+		// draw the instance where the skeletal mesh would be
+		Batch.Transforms.Add(Enemy->GetMesh()->GetComponentTransform());
+
+		// pick the clip to play
+		const float Speed = Enemy->GetVelocity().Size2D();
+		const ECombatVATClip Clip = Enemy->IsAttacking() ? ECombatVATClip::Attack : (Speed > Asset->RunSpeedThreshold ? ECombatVATClip::Run : ECombatVATClip::Walk);
+
+		if (Clip != Proxy.Clip || Proxy.ClipStartTime < 0.0f)
+		{
+			Proxy.Clip = Clip;
+			Proxy.ClipStartTime = TimeSeconds;
+		}
+
+		const bool bAnimated = Clip == ECombatVATClip::Attack || Speed > CombatVAT::MinAnimatedSpeed;
+		Asset->MakeCustomData(Proxy.Clip, Proxy.ClipStartTime, bAnimated ? 1.0f : 0.0f, InstanceData);
+
+		// only send custom data that changed
+		const int32 DataOffset = InstanceIndex * ECombatVATCustomData::Count;
+
+		if (!Batch.CustomData.IsValidIndex(DataOffset) || FMemory::Memcmp(&Batch.CustomData[DataOffset], InstanceData.GetData(), sizeof(float) * ECombatVATCustomData::Count) != 0)
+		{
+			if (!Batch.CustomData.IsValidIndex(DataOffset))
+			{
+				Batch.CustomData.SetNumUninitialized(DataOffset + ECombatVATCustomData::Count);
+			}
+
+			FMemory::Memcpy(&Batch.CustomData[DataOffset], InstanceData.GetData(), sizeof(float) * ECombatVATCustomData::Count);
+			bCustomDataDirty = true;
+		}
+	}
+
+	const int32 NumInstances = Batch.Transforms.Num();
+
+	// match the instance count, adding and removing from the end so instance indices stay stable
+	while (Instances->GetInstanceCount() < NumInstances)
+	{
+		Instances->AddInstance(FTransform::Identity, true);
+	}
+
+	while (Instances->GetInstanceCount() > NumInstances)
+	{
+		Instances->RemoveInstance(Instances->GetInstanceCount() - 1);
+	}
+
+	Batch.CustomData.SetNum(NumInstances * ECombatVATCustomData::Count, EAllowShrinking::No);
+
+	if (NumInstances == 0)
+	{
+		return;
+	}
+
+	Instances->BatchUpdateInstancesTransforms(0, Batch.Transforms, true, !bCustomDataDirty, true);
+
+	// push the custom data
+	if (bCustomDataDirty)
+	{
+		for (int32 InstanceIndex = 0; InstanceIndex < NumInstances; ++InstanceIndex)
+		{
+			Instances->SetCustomData(InstanceIndex, MakeArrayView(&Batch.CustomData[InstanceIndex * ECombatVATCustomData::Count], ECombatVATCustomData::Count), false);
+		}
+
+		Instances->MarkRenderStateDirty();
+	}
+}
@@ -0,0 +1,114 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Stats/Stats.h"
+#include "CombatVATAsset.h"
+#include "CombatVATSubsystem.generated.h"
+
+class ACombatEnemy;
+class UInstancedStaticMeshComponent;
+enum class EVisibilityBasedAnimTickOption : uint8;
+
+DECLARE_STATS_GROUP(TEXT("Combat Rendering"), STATGROUP_CombatRender, STATCAT_Advanced);
+
+/**
+ *  Draws low significance enemies through vertex animation textures.
+ *  Enemies further than Combat.Render.VATDistance from every local viewpoint have their skeletal mesh hidden
+ *  and are drawn as an instance of their VAT asset's static mesh instead, playing the baked walk, run or attack clip.
+ *  Hidden skeletal meshes only tick montages, so attack notifies still fire but the anim graph isn't evaluated.
+ *  Enemies swap back to their skeletal mesh when they come close, die or start simulating physics.
+ */
+UCLASS()
+class UCombatVATSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** An enemy that can be drawn through a VAT batch */
+	struct FProxy
+	{
+		/** Enemy drawn by this proxy */
+		TWeakObjectPtr<ACombatEnemy> Enemy;
+
+		/** Batch drawing this enemy's VAT asset */
+		int32 BatchIndex = INDEX_NONE;
+
+		/** If true, the enemy is currently drawn as a VAT instance */
+		bool bUsingVAT = false;
+
+		/** Clip currently playing */
+		ECombatVATClip Clip = ECombatVATClip::Walk;
+
+		/** Game time the current clip started at */
+		float ClipStartTime = 0.0f;
+
+		/** Anim tick option to restore when swapping back to the skeletal mesh */
+		EVisibilityBasedAnimTickOption SavedTickOption;
+	};
+
+	/** Per-frame instance data for a single VAT asset */
+	struct FBatch
+	{
+		/** Instance transforms for this frame */
+		TArray<FTransform> Transforms;
+
+		/** Custom data last sent to each instance */
+		TArray<float> CustomData;
+	};
+
+	/** Registered enemies */
+	TArray<FProxy> Proxies;
+
+	/** Instance data for each VAT asset in use */
+	TArray<FBatch> Batches;
+
+	/** VAT asset drawn by each batch */
+	UPROPERTY()
+	TArray<UCombatVATAsset*> BatchAssets;
+
+	/** Instanced mesh drawing each batch */
+	UPROPERTY()
+	TArray<UInstancedStaticMeshComponent*> BatchComponents;
+
+	/** Actor owning the batch components */
+	UPROPERTY()
+	AActor* BatchActor = nullptr;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Swaps enemies in and out of their VAT batches and updates the instances */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Adds an enemy that will be drawn with the provided VAT asset while far away */
+	void RegisterEnemy(ACombatEnemy* Enemy, UCombatVATAsset* Asset);
+
+	/** Removes an enemy, restoring its skeletal mesh if needed */
+	void UnregisterEnemy(ACombatEnemy* Enemy);
+
+	/** Returns true if VAT rendering is enabled */
+	static bool IsEnabled();
+
+protected:
+
+	/** Returns the batch index for a VAT asset, creating the batch if needed */
+	int32 FindOrAddBatch(UCombatVATAsset* Asset);
+
+	/** Swaps an enemy between its skeletal mesh and its VAT instance */
+	void SetUsingVAT(FProxy& Proxy, ACombatEnemy* Enemy, bool bUseVAT);
+
+	/** Rebuilds the instances for a batch */
+	void UpdateBatch(int32 BatchIndex, float TimeSeconds);
+};
@@ -10,7 +10,7 @@
 #include "Camera/CameraComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "EnhancedInputComponent.h"
-#include "TimerManager.h"
+#include "GameplayTimerSubsystem.h"
 #include "Engine/LocalPlayer.h"
 
 APlatformingCharacter::APlatformingCharacter()
@@ -143,7 +143,10 @@ void APlatformingCharacter::MultiJump()
 				// raise the wall jump flag to prevent an immediate second wall jump
 				bHasWallJumped = true;
 
-				GetWorld()->GetTimerManager().SetTimer(WallJumpTimer, this, &APlatformingCharacter::ResetWallJump, DelayBetweenWallJumps, false);
+				if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+				{
+					Timers->Reschedule<&APlatformingCharacter::ResetWallJump>(this, DelayBetweenWallJumps);
+				}
 			}
 			// no wall jump, try a double jump next
 			else
@@ -299,8 +302,11 @@ void APlatformingCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the wall jump reset timer
-	GetWorld()->GetTimerManager().ClearTimer(WallJumpTimer);
+	// cancel the wall jump reset
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->CancelAll(this);
+	}
 }
 
 void APlatformingCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
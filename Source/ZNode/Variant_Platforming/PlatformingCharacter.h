@@ -144,9 +144,6 @@ protected:
 	uint8 bHasDashed : 1;
 	uint8 bIsDashing : 1;
 
-	/** timer for wall jump input reset */
-	FTimerHandle WallJumpTimer;
-
 	/** Dash montage ended delegate */
 	FOnMontageEnded OnDashMontageEnded;
 
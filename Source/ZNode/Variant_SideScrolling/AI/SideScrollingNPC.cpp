@@ -3,21 +3,62 @@
 
 #include "SideScrollingNPC.h"
 #include "GameFramework/CharacterMovementComponent.h"
-#include "TimerManager.h"
+#include "GameplayTimerSubsystem.h"
+#include "SideScrollingInteractionSubsystem.h"
+#include "SideScrollingPlatformSubsystem.h"
+#include "Engine/World.h"
 
 ASideScrollingNPC::ASideScrollingNPC()
 {
- 	PrimaryActorTick.bCanEverTick = true;
+	// nothing to do per frame, so don't register a tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	GetCharacterMovement()->MaxWalkSpeed = 150.0f;
 }
 
+void ASideScrollingNPC::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// make the NPC available to interaction queries
+	if (USideScrollingInteractionSubsystem* Interactions = GetWorld()->GetSubsystem<USideScrollingInteractionSubsystem>())
+	{
+		Interactions->RegisterInteractable(this);
+	}
+}
+
 void ASideScrollingNPC::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the deactivation timer
-	GetWorld()->GetTimerManager().ClearTimer(DeactivationTimer);
+	// cancel the pending reactivation
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->CancelAll(this);
+	}
+
+	// remove the NPC from interaction queries
+	if (USideScrollingInteractionSubsystem* Interactions = GetWorld()->GetSubsystem<USideScrollingInteractionSubsystem>())
+	{
+		Interactions->UnregisterInteractable(this);
+	}
+
+	// stop riding moving platforms
+	if (USideScrollingPlatformSubsystem* Platforms = GetWorld()->GetSubsystem<USideScrollingPlatformSubsystem>())
+	{
+		Platforms->RemoveRider(this);
+	}
+}
+
+void ASideScrollingNPC::BaseChange()
+{
+	Super::BaseChange();
+
+	// let moving platforms know whether we're riding them
+	if (USideScrollingPlatformSubsystem* Platforms = GetWorld()->GetSubsystem<USideScrollingPlatformSubsystem>())
+	{
+		Platforms->NotifyBaseChanged(this);
+	}
 }
 
 void ASideScrollingNPC::Interaction(AActor* Interactor)
@@ -42,7 +83,10 @@ void ASideScrollingNPC::Interaction(AActor* Interactor)
 	LaunchCharacter(LaunchVector, true, true);
 
 	// set up a timer to schedule reactivation
-	GetWorld()->GetTimerManager().SetTimer(DeactivationTimer, this, &ASideScrollingNPC::ResetDeactivation, DeactivationTime, false);
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->Reschedule<&ASideScrollingNPC::ResetDeactivation>(this, DeactivationTime);
+	}
 }
 
 void ASideScrollingNPC::ResetDeactivation()
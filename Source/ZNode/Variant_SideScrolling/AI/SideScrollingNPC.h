@@ -37,9 +37,6 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="NPC")
 	bool bDeactivated = false;
 
-	/** Timer to reactivate the NPC */
-	FTimerHandle DeactivationTimer;
-
 public:
 
 	/** Constructor */
@@ -47,9 +44,15 @@ public:
 
 public:
 
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
 	/** Cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/** Reports the new movement base to the moving platforms */
+	virtual void BaseChange() override;
+
 public:
 
 //	~begin IInteractable interface 
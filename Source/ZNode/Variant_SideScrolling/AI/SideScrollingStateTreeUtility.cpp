@@ -6,6 +6,9 @@
 #include "StateTreeExecutionTypes.h"
 #include "AIController.h"
 #include "Kismet/GameplayStatics.h"
+#include "StateTreeAsyncExecutionContext.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
 
 EStateTreeRunStatus FStateTreeGetPlayerTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
 {
@@ -29,4 +32,87 @@ FText FStateTreeGetPlayerTask::GetDescription(const FGuid& ID, FStateTreeDataVie
 {
 	return FText::FromString("<b>Get Player</b>");
 }
-#endif // WITH_EDITOR
\ No newline at end of file
+#endif // WITH_EDITOR
+
+FStateTreeGetPlayerIntervalTask::FStateTreeGetPlayerIntervalTask()
+{
+	// this task is driven by a timer, so it doesn't need to tick
+	bShouldCallTick = false;
+}
+
+EStateTreeRunStatus FStateTreeGetPlayerIntervalTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// have we transitioned from another state?
+	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
+	{
+		// get the instance data
+		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+		// check the target right away so the outputs are valid
+		InstanceData.bValidTarget = false;
+
+		const FStateTreeWeakExecutionContext WeakContext = Context.MakeWeakExecutionContext();
+		UpdateTarget(InstanceData, WeakContext);
+
+		// keep checking on a looping timer
+		Context.GetWorld()->GetTimerManager().SetTimer(InstanceData.UpdateTimer, FTimerDelegate::CreateLambda(
+			[WeakContext]()
+			{
+				// the instance data is only valid while the state is still active
+				const FStateTreeStrongExecutionContext StrongContext = WeakContext.MakeStrongExecutionContext();
+
+				if (FInstanceDataType* InstanceDataPtr = StrongContext.GetInstanceDataPtr<FInstanceDataType>())
+				{
+					UpdateTarget(*InstanceDataPtr, WeakContext);
+				}
+			}
+		), InstanceData.UpdateInterval, true);
+	}
+
+	return EStateTreeRunStatus::Running;
+}
+
+void FStateTreeGetPlayerIntervalTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// have we transitioned to another state?
+	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
+	{
+		// stop the check timer
+		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+		Context.GetWorld()->GetTimerManager().ClearTimer(InstanceData.UpdateTimer);
+	}
+}
+
+void FStateTreeGetPlayerIntervalTask::UpdateTarget(FInstanceDataType& InstanceData, const FStateTreeWeakExecutionContext& WeakContext)
+{
+	// set the player pawn as the target
+	InstanceData.TargetPlayer = UGameplayStatics::GetPlayerPawn(InstanceData.Controller.Get(), 0);
+
+	// are the NPC and target valid?
+	bool bValidTarget = false;
+
+	if (IsValid(InstanceData.TargetPlayer) && IsValid(InstanceData.NPC))
+	{
+		bValidTarget = FVector::DistSquared(InstanceData.NPC->GetActorLocation(), InstanceData.TargetPlayer->GetActorLocation()) < FMath::Square(InstanceData.RangeMax);
+	}
+
+	// only send an event if the target state has changed
+	if (bValidTarget != InstanceData.bValidTarget)
+	{
+		InstanceData.bValidTarget = bValidTarget;
+
+		const FGameplayTag& Event = bValidTarget ? InstanceData.TargetFoundEvent : InstanceData.TargetLostEvent;
+
+		if (Event.IsValid())
+		{
+			WeakContext.SendEvent(Event);
+		}
+	}
+}
+
+#if WITH_EDITOR
+FText FStateTreeGetPlayerIntervalTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Get Player</b> (Interval)");
+}
+#endif // WITH_EDITOR
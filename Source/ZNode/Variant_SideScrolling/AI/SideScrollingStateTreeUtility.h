@@ -4,10 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "StateTreeTaskBase.h"
+#include "GameplayTagContainer.h"
+#include "Engine/TimerHandle.h"
 
 #include "SideScrollingStateTreeUtility.generated.h"
 
 class AAIController;
+struct FStateTreeWeakExecutionContext;
 
 /**
  *  Instance data for the FStateTreeGetPlayerTask task
@@ -56,4 +59,80 @@ struct FStateTreeGetPlayerTask : public FStateTreeTaskCommonBase
 #if WITH_EDITOR
 	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
 #endif // WITH_EDITOR
-};
\ No newline at end of file
+};
+
+/**
+ *  Instance data for the FStateTreeGetPlayerIntervalTask task
+ */
+USTRUCT()
+struct FStateTreeGetPlayerIntervalInstanceData
+{
+	GENERATED_BODY()
+
+	/** NPC owning this task */
+	UPROPERTY(VisibleAnywhere, Category = Context)
+	TObjectPtr<APawn> NPC;
+
+	/** Controller owning this task */
+	UPROPERTY(VisibleAnywhere, Category = Context)
+	TObjectPtr<AAIController> Controller;
+
+	/** Holds the found player pawn */
+	UPROPERTY(VisibleAnywhere)
+	TObjectPtr<APawn> TargetPlayer;
+
+	/** Is the pawn close enough to be considered a valid target? */
+	UPROPERTY(VisibleAnywhere)
+	bool bValidTarget = false;
+
+	/** Max distance to be considered a valid target */
+	UPROPERTY(EditAnywhere, Category = Parameter, meta=(ClampMin = 0, Units = "cm"))
+	float RangeMax = 1000.0f;
+
+	/** Time between target checks */
+	UPROPERTY(EditAnywhere, Category = Parameter, meta=(ClampMin = 0.05, Units = "s"))
+	float UpdateInterval = 0.25f;
+
+	/** Event sent when the player becomes a valid target */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	FGameplayTag TargetFoundEvent;
+
+	/** Event sent when the player stops being a valid target */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	FGameplayTag TargetLostEvent;
+
+	/** Target check timer */
+	FTimerHandle UpdateTimer;
+};
+
+/**
+ *  Event-driven version of the Get Player task.
+ *  Checks the player on a timer instead of ticking, and sends StateTree events when the target is found or lost
+ */
+USTRUCT(meta=(DisplayName="Get Player (Interval)", Category="Side Scrolling"))
+struct FStateTreeGetPlayerIntervalTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeGetPlayerIntervalInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Constructor */
+	FStateTreeGetPlayerIntervalTask();
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs when the owning state is ended */
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+
+protected:
+
+	/** Checks the player and sends the found or lost events */
+	static void UpdateTarget(FInstanceDataType& InstanceData, const FStateTreeWeakExecutionContext& WeakContext);
+};
@@ -3,6 +3,10 @@
 
 #include "SideScrollingMovingPlatform.h"
 #include "Components/SceneComponent.h"
+#include "Components/SplineComponent.h"
+#include "SideScrollingInteractionSubsystem.h"
+#include "SideScrollingPlatformSubsystem.h"
+#include "Engine/World.h"
 
 ASideScrollingMovingPlatform::ASideScrollingMovingPlatform()
 {
@@ -10,6 +14,96 @@ ASideScrollingMovingPlatform::ASideScrollingMovingPlatform()
 
 	// create the root comp
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+#if WITH_EDITORONLY_DATA
+	// create the path spline. It's only used to author the path, which is baked on construction
+	PlatformPath = CreateEditorOnlyDefaultSubobject<USplineComponent>(TEXT("Path"));
+
+	if (PlatformPath)
+	{
+		PlatformPath->SetupAttachment(RootComponent);
+	}
+#endif
+}
+
+void ASideScrollingMovingPlatform::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+#if WITH_EDITORONLY_DATA
+	// keep the baked path if the spline was stripped
+	if (!PlatformPath)
+	{
+		return;
+	}
+
+	BakedPath.Reset();
+
+	// only bake the spline if native movement follows it
+	if (!bNativeMovement || !bFollowPath || PlatformPath->GetNumberOfSplinePoints() < 2)
+	{
+		return;
+	}
+
+	// sample the spline at regular intervals, relative to its start
+	const float PathLength = PlatformPath->GetSplineLength();
+	const int32 NumSamples = FMath::Max(1, FMath::CeilToInt32(PathLength / PathSampleSpacing));
+	const FVector PathStart = PlatformPath->GetLocationAtDistanceAlongSpline(0.0f, ESplineCoordinateSpace::World);
+
+	BakedPath.Reserve(NumSamples);
+
+	for (int32 SampleIndex = 1; SampleIndex <= NumSamples; ++SampleIndex)
+	{
+		const float Distance = PathLength * SampleIndex / NumSamples;
+
+		BakedPath.Add(PlatformPath->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World) - PathStart);
+	}
+#endif
+}
+
+void ASideScrollingMovingPlatform::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// make the platform available to interaction queries
+	if (USideScrollingInteractionSubsystem* Interactions = GetWorld()->GetSubsystem<USideScrollingInteractionSubsystem>())
+	{
+		Interactions->RegisterInteractable(this);
+	}
+
+	// hand the movement to the platform subsystem
+	if (bNativeMovement)
+	{
+		if (USideScrollingPlatformSubsystem* Platforms = GetWorld()->GetSubsystem<USideScrollingPlatformSubsystem>())
+		{
+			TArray<FVector> Points;
+			BuildPath(Points);
+
+			PlatformHandle = Platforms->RegisterPlatform(this, MoveTemp(Points), MoveDuration, EaseExponent, bReturnToStart, ReturnDelay);
+		}
+	}
+}
+
+void ASideScrollingMovingPlatform::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// remove the platform from interaction queries
+	if (USideScrollingInteractionSubsystem* Interactions = GetWorld()->GetSubsystem<USideScrollingInteractionSubsystem>())
+	{
+		Interactions->UnregisterInteractable(this);
+	}
+
+	// stop the native movement
+	if (PlatformHandle != INDEX_NONE)
+	{
+		if (USideScrollingPlatformSubsystem* Platforms = GetWorld()->GetSubsystem<USideScrollingPlatformSubsystem>())
+		{
+			Platforms->UnregisterPlatform(PlatformHandle);
+		}
+
+		PlatformHandle = INDEX_NONE;
+	}
 }
 
 void ASideScrollingMovingPlatform::Interaction(AActor* Interactor)
@@ -23,6 +117,17 @@ void ASideScrollingMovingPlatform::Interaction(AActor* Interactor)
 	// raise the movement flag
 	bMoving = true;
 
+	// let the platform subsystem do the movement natively
+	if (PlatformHandle != INDEX_NONE)
+	{
+		if (USideScrollingPlatformSubsystem* Platforms = GetWorld()->GetSubsystem<USideScrollingPlatformSubsystem>())
+		{
+			bMoving = Platforms->StartMove(PlatformHandle);
+		}
+
+		return;
+	}
+
 	// pass control to BP for the actual movement
 	BP_MoveToTarget();
 }
@@ -38,3 +143,36 @@ void ASideScrollingMovingPlatform::ResetInteraction()
 	// reset the movement flag
 	bMoving = false;
 }
+
+void ASideScrollingMovingPlatform::NotifyMoveFinished(bool bAtTarget)
+{
+	// the platform stays busy until it's back at the start, unless the next interaction has to move it back
+	if (!bAtTarget || !bReturnToStart)
+	{
+		ResetInteraction();
+	}
+
+	BP_MoveFinished(bAtTarget);
+}
+
+void ASideScrollingMovingPlatform::BuildPath(TArray<FVector>& OutPoints) const
+{
+	const FVector StartLocation = GetActorLocation();
+
+	OutPoints.Add(StartLocation);
+
+	// move straight to the target if we're not following the spline
+	if (!bFollowPath || BakedPath.IsEmpty())
+	{
+		OutPoints.Add(PlatformTarget);
+		return;
+	}
+
+	// offset the baked samples so the path starts at the platform location
+	OutPoints.Reserve(BakedPath.Num() + 1);
+
+	for (const FVector& Sample : BakedPath)
+	{
+		OutPoints.Add(StartLocation + Sample);
+	}
+}
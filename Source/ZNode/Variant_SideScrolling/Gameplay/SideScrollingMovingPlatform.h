@@ -7,15 +7,26 @@
 #include "SideScrollingInteractable.h"
 #include "SideScrollingMovingPlatform.generated.h"
 
+class USplineComponent;
+
 /**
  *  Simple moving platform that can be triggered through interactions by other actors.
- *  The actual movement is performed by Blueprint code through latent execution nodes.
+ *  By default, the actual movement is performed by Blueprint code through latent execution nodes.
+ *  Platforms with native movement enabled are moved instead by the platform subsystem, along a straight line
+ *  to the target or along the path spline.
+ *  The path spline is editor only. It's baked into a list of points on construction, and only when native movement follows it.
  */
 UCLASS(abstract)
 class ASideScrollingMovingPlatform : public AActor, public ISideScrollingInteractable
 {
 	GENERATED_BODY()
 	
+#if WITH_EDITORONLY_DATA
+	/** Path followed by the platform when native movement follows a spline */
+	UPROPERTY(VisibleAnywhere, Category="Components")
+	USplineComponent* PlatformPath = nullptr;
+#endif
+
 public:	
 	
 	/** Constructor */
@@ -38,6 +49,45 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Moving Platform")
 	bool bOneShot = false;
 
+	/** If this is true, the platform is moved natively by the platform subsystem instead of BP_MoveToTarget */
+	UPROPERTY(EditAnywhere, Category="Moving Platform|Native")
+	bool bNativeMovement = false;
+
+	/** If this is true, native movement follows the shape of the path spline from the platform location, instead of moving straight to the target */
+	UPROPERTY(EditAnywhere, Category="Moving Platform|Native", meta=(EditCondition="bNativeMovement"))
+	bool bFollowPath = false;
+
+	/** Ease in/out exponent for native movement. 1 is linear */
+	UPROPERTY(EditAnywhere, Category="Moving Platform|Native", meta=(ClampMin=1, EditCondition="bNativeMovement"))
+	float EaseExponent = 2.0f;
+
+	/** If this is true, native movement returns to the start on its own after reaching the target. Otherwise, the next interaction moves it back */
+	UPROPERTY(EditAnywhere, Category="Moving Platform|Native", meta=(EditCondition="bNativeMovement"))
+	bool bReturnToStart = true;
+
+	/** Time the platform waits at the target before returning */
+	UPROPERTY(EditAnywhere, Category="Moving Platform|Native", meta=(ClampMin=0, Units="s", EditCondition="bNativeMovement && bReturnToStart"))
+	float ReturnDelay = 1.0f;
+
+	/** Path spline samples, relative to the spline start. Baked on construction, and empty unless native movement follows the path */
+	UPROPERTY()
+	TArray<FVector> BakedPath;
+
+	/** Handle for the platform subsystem, if using native movement */
+	int32 PlatformHandle = INDEX_NONE;
+
+	/** Distance between the samples taken from the path spline */
+	static constexpr float PathSampleSpacing = 25.0f;
+
+	/** Bakes the path spline, if native movement follows it */
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
+	/** Cleanup */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
 public:
 
 // ~begin IInteractable interface 
@@ -51,10 +101,23 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Moving Platform")
 	virtual void ResetInteraction();
 
+	/** Called by the platform subsystem when native movement reaches either end of the path */
+	void NotifyMoveFinished(bool bAtTarget);
+
+	/** Returns the handle for the platform subsystem, or INDEX_NONE if not using native movement */
+	int32 GetPlatformHandle() const { return PlatformHandle; }
+
 protected:
 
+	/** Builds the world space path for native movement, starting at the platform location */
+	void BuildPath(TArray<FVector>& OutPoints) const;
+
 	/** Allows Blueprint code to do the actual platform movement */
 	UFUNCTION(BlueprintImplementableEvent, BlueprintCallable, Category="Moving Platform", meta=(DisplayName="Move to Target"))
 	void BP_MoveToTarget();
 
+	/** Allows Blueprint code to react to native movement reaching either end of the path */
+	UFUNCTION(BlueprintImplementableEvent, Category="Moving Platform", meta=(DisplayName="Move Finished"))
+	void BP_MoveFinished(bool bAtTarget);
+
 };
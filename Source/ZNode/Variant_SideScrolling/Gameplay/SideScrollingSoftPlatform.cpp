@@ -9,7 +9,8 @@
 
 ASideScrollingSoftPlatform::ASideScrollingSoftPlatform()
 {
- 	PrimaryActorTick.bCanEverTick = true;
+	// nothing to do per frame, so don't register a tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// create the root component
 	RootComponent = Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
@@ -2,11 +2,30 @@
 
 
 #include "SideScrollingCameraManager.h"
+#include "SideScrollingGroundSubsystem.h"
 #include "GameFramework/Pawn.h"
-#include "Engine/HitResult.h"
-#include "CollisionQueryParams.h"
+#include "GameFramework/PawnMovementComponent.h"
 #include "Engine/World.h"
 
+namespace SideScrollingCamera
+{
+	/** Time step used to walk the predicted jump arc */
+	constexpr float PredictionStep = 1.0f / 30.0f;
+
+	/** Moves a value towards its goal through a critically damped spring. This is the exact solution, so it's frame rate independent */
+	static double CriticallyDampedSpring(double Value, double& Velocity, double Goal, float DeltaTime, float SmoothingTime)
+	{
+		const double Omega = 2.0 / SmoothingTime;
+		const double Offset = Value - Goal;
+		const double Slope = Velocity + Omega * Offset;
+		const double Decay = FMath::Exp(-Omega * DeltaTime);
+
+		Velocity = (Velocity - Slope * Omega * DeltaTime) * Decay;
+
+		return Goal + (Offset + Slope * DeltaTime) * Decay;
+	}
+}
+
 void ASideScrollingCameraManager::UpdateViewTarget(FTViewTarget& OutVT, float DeltaTime)
 {
 	// ensure the view target is a pawn
@@ -41,65 +60,78 @@ void ASideScrollingCameraManager::UpdateViewTarget(FTViewTarget& OutVT, float De
 
 			// save the current camera height
 			CurrentZ = OutVT.POV.Location.Z;
+			CameraVelocity = FVector::ZeroVector;
 
 			// skip the rest of the calculations
 			return;
 		}
 
-		// check if the camera needs to update its height
-		bool bZUpdate = false;
-
 		// is the character moving vertically?
 		if (FMath::IsNearlyZero(TargetPawn->GetVelocity().Z))
 		{
-			// determine if we need to do a height update
-			bZUpdate = FMath::IsNearlyEqual(CurrentZ, CurrentCameraLocation.Z, 25.0f);
+			// set the height goal from the actor location
+			CurrentZ = CurrentActorLocation.Z;
 
 		} else {
 
-			// run a trace below the character to determine if we need to do a height update
-			FHitResult OutHit;
-
-			const FVector End = CurrentActorLocation + FVector(0.0f, 0.0f, -1000.0f);
-
-			FCollisionQueryParams QueryParams;
-			QueryParams.AddIgnoredActor(TargetPawn);
+			// aim for the height the jump will land at, or follow the actor if we're falling into the void
+			float LandingZ;
 
-			// only update height if we're not about to hit ground
-			bZUpdate = !GetWorld()->LineTraceSingleByChannel(OutHit, CurrentActorLocation, End, ECC_Visibility, QueryParams);
+			CurrentZ = PredictLandingZ(TargetPawn, LandingZ) ? LandingZ : CurrentActorLocation.Z;
 
 		}
 
-		// do we need to do a height update?
-		if (bZUpdate)
+		// don't let the target leave the frame while it's jumping high above or falling far below the goal
+		if (!FMath::IsNearlyEqual(CurrentZ, CurrentActorLocation.Z, MaxHeightDeviation))
 		{
-
-			// set the height goal from the actor location
 			CurrentZ = CurrentActorLocation.Z;
+		}
 
-		} else {
+		// clamp the X axis to the min and max camera bounds
+		float CurrentX = FMath::Clamp(CurrentActorLocation.X, CameraXMinBounds, CameraXMaxBounds);
 
-			// are we close enough to the target height?
-			if (FMath::IsNearlyEqual(CurrentZ, CurrentActorLocation.Z, 100.0f))
-			{
-				// set the height goal from the actor location
-				CurrentZ = CurrentActorLocation.Z;
+		// spring towards the new camera location and update the output
+		OutVT.POV.Location.X = SideScrollingCamera::CriticallyDampedSpring(CurrentCameraLocation.X, CameraVelocity.X, CurrentX, DeltaTime, HorizontalSmoothingTime);
+		OutVT.POV.Location.Y = SideScrollingCamera::CriticallyDampedSpring(CurrentCameraLocation.Y, CameraVelocity.Y, CurrentY, DeltaTime, HorizontalSmoothingTime);
+		OutVT.POV.Location.Z = SideScrollingCamera::CriticallyDampedSpring(CurrentCameraLocation.Z, CameraVelocity.Z, CurrentZ, DeltaTime, VerticalSmoothingTime);
+	}
+}
 
-			} else {
+bool ASideScrollingCameraManager::PredictLandingZ(const APawn* TargetPawn, float& OutLandingZ) const
+{
+	const USideScrollingGroundSubsystem* Ground = GetWorld()->GetSubsystem<USideScrollingGroundSubsystem>();
 
-				// blend the height towards the actor location
-				CurrentZ = FMath::FInterpTo(CurrentZ, CurrentActorLocation.Z, DeltaTime, 2.0f);
-				
-			}
+	if (!Ground || !Ground->HasStrip())
+	{
+		return false;
+	}
 
-		}
+	// get the starting point of the arc at the target's feet
+	const float HalfHeight = TargetPawn->GetSimpleCollisionHalfHeight();
+	const FVector Velocity = TargetPawn->GetVelocity();
+	const float GravityZ = TargetPawn->GetMovementComponent() ? TargetPawn->GetMovementComponent()->GetGravityZ() : GetWorld()->GetGravityZ();
 
-		// clamp the X axis to the min and max camera bounds
-		float CurrentX = FMath::Clamp(CurrentActorLocation.X, CameraXMinBounds, CameraXMaxBounds);
+	FVector Feet = TargetPawn->GetActorLocation() - FVector(0.0f, 0.0f, HalfHeight);
+	float VelocityZ = Velocity.Z;
+
+	// walk the ballistic arc until it crosses the ground while falling
+	for (float Time = 0.0f; Time < LandingPredictionTime; Time += SideScrollingCamera::PredictionStep)
+	{
+		const float PrevZ = Feet.Z;
+
+		Feet.X += Velocity.X * SideScrollingCamera::PredictionStep;
+		Feet.Z += (VelocityZ + 0.5f * GravityZ * SideScrollingCamera::PredictionStep) * SideScrollingCamera::PredictionStep;
+		VelocityZ += GravityZ * SideScrollingCamera::PredictionStep;
 
-		// blend towards the new camera location and update the output
-		FVector TargetCameraLocation(CurrentX, CurrentY, CurrentZ);
+		float GroundZ;
 
-		OutVT.POV.Location = FMath::VInterpTo(CurrentCameraLocation, TargetCameraLocation, DeltaTime, 2.0f);
+		if (VelocityZ < 0.0f && Ground->FindGroundBelow(Feet.X, PrevZ, GroundZ) && Feet.Z <= GroundZ)
+		{
+			// return the actor height once it lands
+			OutLandingZ = GroundZ + HalfHeight;
+			return true;
+		}
 	}
-}
\ No newline at end of file
+
+	return false;
+}
@@ -8,6 +8,9 @@
 
 /**
  *  Simple side scrolling camera with smooth scrolling and horizontal bounds
+ *  While the target is in the air, the camera height aims for where the target's jump arc is predicted to land,
+ *  using the precomputed ground strip instead of tracing every frame.
+ *  The camera follows its goal through critically damped springs, so its motion doesn't depend on the frame rate.
  */
 UCLASS()
 class ASideScrollingCameraManager : public APlayerCameraManager
@@ -37,11 +40,33 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Side Scrolling Camera", meta=(ClampMin=0, ClampMax=10000, Units="cm"))
 	float CameraXMaxBounds = 10000.0f;
 
+	/** Time for the camera to catch up with the target along the scrolling axis */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Side Scrolling Camera", meta=(ClampMin=0.01, ClampMax=5, Units="s"))
+	float HorizontalSmoothingTime = 0.5f;
+
+	/** Time for the camera to catch up with its height goal */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Side Scrolling Camera", meta=(ClampMin=0.01, ClampMax=5, Units="s"))
+	float VerticalSmoothingTime = 0.5f;
+
+	/** How far ahead in time to predict the target's jump arc when looking for its landing height */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Side Scrolling Camera", meta=(ClampMin=0, ClampMax=5, Units="s"))
+	float LandingPredictionTime = 1.5f;
+
+	/** If the target strays further than this from the camera height goal, the camera will follow it instead */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Side Scrolling Camera", meta=(ClampMin=0, ClampMax=10000, Units="cm"))
+	float MaxHeightDeviation = 400.0f;
+
 protected:
 
-	/** Last cached camera vertical location. The camera only adjusts its height if necessary. */
+	/** Camera height goal. Aims for the predicted landing height while the target is airborne, and the camera height springs towards it */
 	float CurrentZ = 0.0f;
 
+	/** Current camera spring velocity */
+	FVector CameraVelocity = FVector::ZeroVector;
+
+	/** Predicts where the target's jump arc will land. Returns false if no landing was found within the prediction time */
+	bool PredictLandingZ(const APawn* TargetPawn, float& OutLandingZ) const;
+
 	/** First-time update camera setup flag */
 	bool bSetup = true;
 };
@@ -12,7 +12,23 @@
 #include "Engine/World.h"
 #include "SideScrollingInteractable.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "TimerManager.h"
+#include "GameplayTimerSubsystem.h"
+#include "SideScrollingInteractionSubsystem.h"
+#include "SideScrollingGroundSubsystem.h"
+#include "SideScrollingCollisionStrip.h"
+#include "SideScrollingPlatformSubsystem.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSideScrollingCharacter, Log, All);
+
+namespace SideScrollingCollision
+{
+	static bool bVerifyStrip = false;
+	static FAutoConsoleVariableRef CVarVerifyStrip(
+		TEXT("SideScrolling.CollisionStrip.Verify"),
+		bVerifyStrip,
+		TEXT("If true, collision strip queries will be cross-checked against physics queries, logging any mismatch. Debug only"));
+}
 
 ASideScrollingCharacter::ASideScrollingCharacter()
 {
@@ -63,8 +79,49 @@ void ASideScrollingCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the wall jump timer
-	GetWorld()->GetTimerManager().ClearTimer(WallJumpTimer);
+	// cancel the wall jump lockout reset
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->CancelAll(this);
+	}
+
+	// stop highlighting interactables
+	if (USideScrollingInteractionSubsystem* Interactions = GetWorld()->GetSubsystem<USideScrollingInteractionSubsystem>())
+	{
+		Interactions->UnregisterViewer(this);
+	}
+
+	// stop riding moving platforms
+	if (USideScrollingPlatformSubsystem* Platforms = GetWorld()->GetSubsystem<USideScrollingPlatformSubsystem>())
+	{
+		Platforms->RemoveRider(this);
+	}
+}
+
+void ASideScrollingCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	// highlight the nearest interactable. Pawns prewarmed for a respawn aren't possessed yet, so they don't highlight anything
+	if (bHighlightInteractables)
+	{
+		if (USideScrollingInteractionSubsystem* Interactions = GetWorld()->GetSubsystem<USideScrollingInteractionSubsystem>())
+		{
+			Interactions->UnregisterViewer(this);
+			Interactions->RegisterViewer(this, InteractionRadius);
+		}
+	}
+}
+
+void ASideScrollingCharacter::UnPossessed()
+{
+	Super::UnPossessed();
+
+	// stop highlighting interactables
+	if (USideScrollingInteractionSubsystem* Interactions = GetWorld()->GetSubsystem<USideScrollingInteractionSubsystem>())
+	{
+		Interactions->UnregisterViewer(this);
+	}
 }
 
 void ASideScrollingCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent)
@@ -121,6 +178,17 @@ void ASideScrollingCharacter::Landed(const FHitResult& Hit)
 	bHasDoubleJumped = false;
 }
 
+void ASideScrollingCharacter::BaseChange()
+{
+	Super::BaseChange();
+
+	// let moving platforms know whether we're riding them
+	if (USideScrollingPlatformSubsystem* Platforms = GetWorld()->GetSubsystem<USideScrollingPlatformSubsystem>())
+	{
+		Platforms->NotifyBaseChanged(this);
+	}
+}
+
 void ASideScrollingCharacter::Move(const FInputActionValue& Value)
 {
 	FVector2D MoveVector = Value.Get<FVector2D>();
@@ -176,26 +244,11 @@ void ASideScrollingCharacter::DoJumpEnd()
 
 void ASideScrollingCharacter::DoInteract()
 {
-	// do a sphere trace to look for interactive objects
-	FHitResult OutHit;
-
-	const FVector Start = GetActorLocation();
-	const FVector End = Start + FVector(100.0f, 0.0f, 0.0f);
-
-	FCollisionShape ColSphere;
-	ColSphere.SetSphere(InteractionRadius);
-
-	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
-	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
-
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
-
-	if (GetWorld()->SweepSingleByObjectType(OutHit, Start, End, FQuat::Identity, ObjectParams, ColSphere, QueryParams))
+	// look up the nearest interactive object
+	if (USideScrollingInteractionSubsystem* Interactions = GetWorld()->GetSubsystem<USideScrollingInteractionSubsystem>())
 	{
-		// have we hit an interactable?
-		if (ISideScrollingInteractable* Interactable = Cast<ISideScrollingInteractable>(OutHit.GetActor()))
+		// have we found an interactable?
+		if (ISideScrollingInteractable* Interactable = Cast<ISideScrollingInteractable>(Interactions->FindNearestInteractable(GetActorLocation(), InteractionRadius, this)))
 		{
 			// interact
 			Interactable->Interaction(this);
@@ -225,25 +278,17 @@ void ASideScrollingCharacter::MultiJump()
 	// if we have a horizontal input, try for wall jump first
 	if (!bHasWallJumped && !FMath::IsNearlyZero(ActionValueY))
 	{
-		// trace ahead of the character for walls
-		FHitResult OutHit;
+		// look ahead of the character for walls
+		FVector WallNormal;
 
-		const FVector Start = GetActorLocation();
-		const FVector End = Start + (FVector(ActionValueY > 0.0f ? 1.0f : -1.0f, 0.0f, 0.0f) * WallJumpTraceDistance);
-
-		FCollisionQueryParams QueryParams;
-		QueryParams.AddIgnoredActor(this);
-
-		GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams);
-
-		if (OutHit.bBlockingHit)
+		if (FindWallAhead(ActionValueY, WallNormal))
 		{
 			// rotate to the bounce direction
-			const FRotator BounceRot = UKismetMathLibrary::MakeRotFromX(OutHit.ImpactNormal);
+			const FRotator BounceRot = UKismetMathLibrary::MakeRotFromX(WallNormal);
 			SetActorRotation(FRotator(0.0f, BounceRot.Yaw, 0.0f));
 
 			// calculate the impulse vector
-			FVector WallJumpImpulse = OutHit.ImpactNormal * WallJumpHorizontalImpulse;
+			FVector WallJumpImpulse = WallNormal * WallJumpHorizontalImpulse;
 			WallJumpImpulse.Z = GetCharacterMovement()->JumpZVelocity * WallJumpVerticalMultiplier;
 
 			// launch the character away from the wall
@@ -253,7 +298,10 @@ void ASideScrollingCharacter::MultiJump()
 			bHasWallJumped = true;
 
 			// schedule wall jump lockout reset
-			GetWorld()->GetTimerManager().SetTimer(WallJumpTimer, this, &ASideScrollingCharacter::ResetWallJump, DelayBetweenWallJumps, false);
+			if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+			{
+				Timers->Reschedule<&ASideScrollingCharacter::ResetWallJump>(this, DelayBetweenWallJumps);
+			}
 
 			return;
 		}
@@ -279,6 +327,89 @@ void ASideScrollingCharacter::CheckForSoftCollision()
 	// reset the drop value
 	DropValue = 0.0f;
 
+	// are we standing over a soft floor?
+	if (FindSoftFloorBelow())
+	{
+		// drop through the floor
+		SetSoftCollision(true);
+	}
+}
+
+bool ASideScrollingCharacter::FindWallAhead(float Direction, FVector& OutNormal) const
+{
+	const USideScrollingGroundSubsystem* Ground = GetWorld()->GetSubsystem<USideScrollingGroundSubsystem>();
+	const USideScrollingCollisionStrip* Strip = Ground ? Ground->GetCollisionStrip() : nullptr;
+
+	// fall back to physics if the level has no strip
+	if (!Strip)
+	{
+		return TraceWallAhead(Direction, OutNormal);
+	}
+
+	const FVector Location = GetActorLocation();
+	float WallX;
+
+	const bool bFound = Strip->FindWall(Location.X, Location.Z, Direction, WallJumpTraceDistance, WallX, OutNormal);
+
+	// cross-check against physics
+	if (SideScrollingCollision::bVerifyStrip)
+	{
+		FVector TraceNormal;
+
+		if (TraceWallAhead(Direction, TraceNormal) != bFound)
+		{
+			UE_LOG(LogSideScrollingCharacter, Warning, TEXT("Collision strip wall test mismatch at %s: strip %d, physics %d"), *Location.ToString(), bFound, !bFound);
+		}
+	}
+
+	return bFound;
+}
+
+bool ASideScrollingCharacter::FindSoftFloorBelow() const
+{
+	const USideScrollingGroundSubsystem* Ground = GetWorld()->GetSubsystem<USideScrollingGroundSubsystem>();
+	const USideScrollingCollisionStrip* Strip = Ground ? Ground->GetCollisionStrip() : nullptr;
+
+	// fall back to physics if the level has no strip
+	if (!Strip)
+	{
+		return TraceSoftFloorBelow();
+	}
+
+	const FVector Location = GetActorLocation();
+	float FloorZ;
+
+	const bool bFound = Strip->FindGround(Location.X, Location.Z, SoftCollisionTraceDistance, FloorZ, true);
+
+	// cross-check against physics
+	if (SideScrollingCollision::bVerifyStrip && TraceSoftFloorBelow() != bFound)
+	{
+		UE_LOG(LogSideScrollingCharacter, Warning, TEXT("Collision strip soft floor test mismatch at %s: strip %d, physics %d"), *Location.ToString(), bFound, !bFound);
+	}
+
+	return bFound;
+}
+
+bool ASideScrollingCharacter::TraceWallAhead(float Direction, FVector& OutNormal) const
+{
+	// trace ahead of the character for walls
+	FHitResult OutHit;
+
+	const FVector Start = GetActorLocation();
+	const FVector End = Start + (FVector(Direction > 0.0f ? 1.0f : -1.0f, 0.0f, 0.0f) * WallJumpTraceDistance);
+
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(this);
+
+	GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams);
+
+	OutNormal = OutHit.ImpactNormal;
+
+	return OutHit.bBlockingHit;
+}
+
+bool ASideScrollingCharacter::TraceSoftFloorBelow() const
+{
 	// trace down 
 	FHitResult OutHit;
 
@@ -294,11 +425,7 @@ void ASideScrollingCharacter::CheckForSoftCollision()
 	GetWorld()->LineTraceSingleByObjectType(OutHit, Start, End, ObjectParams, QueryParams);
 
 	// did we hit a soft floor?
-	if (OutHit.GetActor())
-	{
-		// drop through the floor
-		SetSoftCollision(true);
-	}
+	return OutHit.GetActor() != nullptr;
 }
 
 void ASideScrollingCharacter::ResetWallJump()
@@ -44,6 +44,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Side Scrolling")
 	float InteractionRadius = 200.0f;
 
+	/** If true, the nearest interactable within the interaction radius will be highlighted. Needs an outline post process material that reads custom depth */
+	UPROPERTY(EditAnywhere, Category="Side Scrolling")
+	bool bHighlightInteractables = false;
+
 	/** Time to disable input after a wall jump to preserve momentum */
 	UPROPERTY(EditAnywhere, Category="Side Scrolling")
 	float DelayBetweenWallJumps = 0.3f;
@@ -72,9 +76,6 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Side Scrolling")
 	float SoftCollisionTraceDistance = 1000.0f;
 
-	/** Wall jump lockout timer */
-	FTimerHandle WallJumpTimer;
-
 	/** Last captured horizontal movement input value */
 	float ActionValueY = 0.0f;
 
@@ -100,6 +101,12 @@ protected:
 	/** Gameplay cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/** Starts highlighting interactables once a controller takes over */
+	virtual void PossessedBy(AController* NewController) override;
+
+	/** Stops highlighting interactables */
+	virtual void UnPossessed() override;
+
 	/** Initialize input action bindings */
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
@@ -109,6 +116,9 @@ protected:
 	/** Landing handling */
 	virtual void Landed(const FHitResult& Hit) override;
 
+	/** Reports the new movement base to the moving platforms */
+	virtual void BaseChange() override;
+
 protected:
 
 	/** Called for movement input */
@@ -150,6 +160,16 @@ protected:
 	/** Checks for soft collision with platforms */
 	void CheckForSoftCollision();
 
+	/** Looks for a wall within wall jump distance along the provided direction. Uses the collision strip if the level has one */
+	bool FindWallAhead(float Direction, FVector& OutNormal) const;
+
+	/** Looks for a soft floor within soft collision trace distance below us. Uses the collision strip if the level has one */
+	bool FindSoftFloorBelow() const;
+
+	/** Physics versions of the wall and soft floor tests */
+	bool TraceWallAhead(float Direction, FVector& OutNormal) const;
+	bool TraceSoftFloorBelow() const;
+
 	/** Resets wall jump lockout. Called from timer after a wall jump */
 	void ResetWallJump();
 
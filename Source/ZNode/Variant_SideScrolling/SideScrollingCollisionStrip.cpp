@@ -0,0 +1,274 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingCollisionStrip.h"
+#include "Engine/World.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#include "EngineUtils.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Pawn.h"
+#include "SideScrollingSoftPlatform.h"
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogSideScrollingStrip, Log, All);
+
+bool USideScrollingCollisionStrip::GetBucketRange(float MinX, float MaxX, int32& OutFirst, int32& OutLast) const
+{
+	const int32 NumBuckets = BucketStarts.Num() - 1;
+
+	OutFirst = FMath::Max(0, FMath::FloorToInt32((MinX - IndexMinX) / BucketSize));
+	OutLast = FMath::Min(NumBuckets - 1, FMath::FloorToInt32((MaxX - IndexMinX) / BucketSize));
+
+	return OutFirst <= OutLast;
+}
+
+bool USideScrollingCollisionStrip::WasBakedFor(const UWorld* World) const
+{
+	if (!World || BakedWorld.IsNull())
+	{
+		return false;
+	}
+
+	// PIE worlds live in a prefixed copy of the level package
+	const FString WorldPackage = UWorld::RemovePIEPrefix(World->GetOutermost()->GetName());
+
+	return BakedWorld.ToSoftObjectPath().GetLongPackageName() == WorldPackage;
+}
+
+bool USideScrollingCollisionStrip::FindGround(float X, float Z, float MaxDistance, float& OutGroundZ, bool bSoftOnly, bool* bOutSoft) const
+{
+	int32 FirstBucket, LastBucket;
+
+	if (!IsBaked() || !GetBucketRange(X, X, FirstBucket, LastBucket))
+	{
+		return false;
+	}
+
+	bool bFound = false;
+	float BestZ = Z - MaxDistance;
+
+	for (int32 Index = BucketStarts[FirstBucket]; Index < BucketStarts[FirstBucket + 1]; ++Index)
+	{
+		const FSideScrollingCollisionSegment& Segment = Segments[BucketSegments[Index]];
+
+		// skip walls, and solid floors if we only want soft ones
+		if (Segment.Type != ESideScrollingSegmentType::Floor || (bSoftOnly && !Segment.bSoft))
+		{
+			continue;
+		}
+
+		if (X < Segment.Start.X || X > Segment.End.X)
+		{
+			continue;
+		}
+
+		// get the floor height under the point
+		const float Alpha = Segment.End.X > Segment.Start.X ? (X - Segment.Start.X) / (Segment.End.X - Segment.Start.X) : 0.0f;
+		const float FloorZ = FMath::Lerp(Segment.Start.Y, Segment.End.Y, Alpha);
+
+		// keep the highest floor under Z
+		if (FloorZ <= Z && FloorZ >= BestZ)
+		{
+			BestZ = FloorZ;
+			bFound = true;
+
+			if (bOutSoft)
+			{
+				*bOutSoft = Segment.bSoft;
+			}
+		}
+	}
+
+	if (bFound)
+	{
+		OutGroundZ = BestZ;
+	}
+
+	return bFound;
+}
+
+bool USideScrollingCollisionStrip::FindWall(float X, float Z, float Direction, float MaxDistance, float& OutWallX, FVector& OutNormal) const
+{
+	const float Sign = Direction > 0.0f ? 1.0f : -1.0f;
+	const float EndX = X + Sign * MaxDistance;
+
+	int32 FirstBucket, LastBucket;
+
+	if (!IsBaked() || !GetBucketRange(FMath::Min(X, EndX), FMath::Max(X, EndX), FirstBucket, LastBucket))
+	{
+		return false;
+	}
+
+	bool bFound = false;
+	float BestDistance = MaxDistance;
+
+	for (int32 Bucket = FirstBucket; Bucket <= LastBucket; ++Bucket)
+	{
+		for (int32 Index = BucketStarts[Bucket]; Index < BucketStarts[Bucket + 1]; ++Index)
+		{
+			const FSideScrollingCollisionSegment& Segment = Segments[BucketSegments[Index]];
+
+			// we only care about walls facing us
+			if (Segment.Type != ESideScrollingSegmentType::Wall || Segment.FacingX != -Sign)
+			{
+				continue;
+			}
+
+			if (Z < Segment.Start.Y || Z > Segment.End.Y)
+			{
+				continue;
+			}
+
+			// keep the nearest wall ahead
+			const float Distance = (Segment.Start.X - X) * Sign;
+
+			if (Distance >= 0.0f && Distance <= BestDistance)
+			{
+				BestDistance = Distance;
+				OutWallX = Segment.Start.X;
+				bFound = true;
+			}
+		}
+	}
+
+	if (bFound)
+	{
+		OutNormal = FVector(-Sign, 0.0f, 0.0f);
+	}
+
+	return bFound;
+}
+
+void USideScrollingCollisionStrip::BuildIndex()
+{
+	BucketStarts.Reset();
+	BucketSegments.Reset();
+
+	if (Segments.IsEmpty())
+	{
+		return;
+	}
+
+	// find the X range covered by the segments
+	float MinX = TNumericLimits<float>::Max();
+	float MaxX = TNumericLimits<float>::Lowest();
+
+	for (const FSideScrollingCollisionSegment& Segment : Segments)
+	{
+		MinX = FMath::Min3(MinX, Segment.Start.X, Segment.End.X);
+		MaxX = FMath::Max3(MaxX, Segment.Start.X, Segment.End.X);
+	}
+
+	IndexMinX = MinX;
+
+	const int32 NumBuckets = FMath::FloorToInt32((MaxX - MinX) / BucketSize) + 1;
+
+	// add each segment to every bucket it touches
+	TArray<TArray<int32>> Buckets;
+	Buckets.SetNum(NumBuckets);
+
+	for (int32 SegmentIndex = 0; SegmentIndex < Segments.Num(); ++SegmentIndex)
+	{
+		const FSideScrollingCollisionSegment& Segment = Segments[SegmentIndex];
+
+		int32 FirstBucket = FMath::FloorToInt32((FMath::Min(Segment.Start.X, Segment.End.X) - MinX) / BucketSize);
+		int32 LastBucket = FMath::FloorToInt32((FMath::Max(Segment.Start.X, Segment.End.X) - MinX) / BucketSize);
+
+		for (int32 Bucket = FirstBucket; Bucket <= LastBucket; ++Bucket)
+		{
+			Buckets[Bucket].Add(SegmentIndex);
+		}
+	}
+
+	// flatten the buckets
+	BucketStarts.Reserve(NumBuckets + 1);
+
+	for (const TArray<int32>& Bucket : Buckets)
+	{
+		BucketStarts.Add(BucketSegments.Num());
+		BucketSegments.Append(Bucket);
+	}
+
+	BucketStarts.Add(BucketSegments.Num());
+}
+
+#if WITH_EDITOR
+
+void USideScrollingCollisionStrip::Bake()
+{
+	UWorld* World = GEditor ? GEditor->GetEditorWorldContext().World() : nullptr;
+
+	if (!World)
+	{
+		UE_LOG(LogSideScrollingStrip, Error, TEXT("%s: can't bake without an open editor level"), *GetName());
+		return;
+	}
+
+	Modify();
+
+	BakedWorld = World;
+	Segments.Reset();
+
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		// pawns are not part of the level layout
+		if (It->IsA<APawn>())
+		{
+			continue;
+		}
+
+		const bool bSoft = It->IsA<ASideScrollingSoftPlatform>();
+
+		It->ForEachComponent<UPrimitiveComponent>(false, [this, bSoft](const UPrimitiveComponent* Primitive)
+		{
+			// only slice non-movable geometry that blocks the player
+			if (Primitive->Mobility == EComponentMobility::Movable || !Primitive->IsCollisionEnabled() || Primitive->GetCollisionResponseToChannel(ECC_Pawn) != ECR_Block)
+			{
+				return;
+			}
+
+			// does the primitive cross the plane?
+			const FBox Bounds = Primitive->Bounds.GetBox();
+
+			if (PlaneY < Bounds.Min.Y || PlaneY > Bounds.Max.Y)
+			{
+				return;
+			}
+
+			// top floor
+			FSideScrollingCollisionSegment& Floor = Segments.AddDefaulted_GetRef();
+			Floor.Start = FVector2f(Bounds.Min.X, Bounds.Max.Z);
+			Floor.End = FVector2f(Bounds.Max.X, Bounds.Max.Z);
+			Floor.Type = ESideScrollingSegmentType::Floor;
+			Floor.bSoft = bSoft;
+
+			// soft platforms can be passed through from the sides
+			if (bSoft)
+			{
+				return;
+			}
+
+			// side walls
+			for (const int8 Facing : { int8(-1), int8(1) })
+			{
+				const float WallX = Facing < 0 ? Bounds.Min.X : Bounds.Max.X;
+
+				FSideScrollingCollisionSegment& Wall = Segments.AddDefaulted_GetRef();
+				Wall.Start = FVector2f(WallX, Bounds.Min.Z);
+				Wall.End = FVector2f(WallX, Bounds.Max.Z);
+				Wall.Type = ESideScrollingSegmentType::Wall;
+				Wall.FacingX = Facing;
+			}
+		});
+	}
+
+	BuildIndex();
+
+	MarkPackageDirty();
+
+	UE_LOG(LogSideScrollingStrip, Log, TEXT("%s: baked %d segments into %d buckets from %s"), *GetName(), Segments.Num(), BucketStarts.Num() - 1, *World->GetMapName());
+}
+
+#endif // WITH_EDITOR
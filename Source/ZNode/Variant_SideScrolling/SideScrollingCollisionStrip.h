@@ -0,0 +1,124 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SideScrollingCollisionStrip.generated.h"
+
+class UWorld;
+
+/**
+ *  Kind of surface a collision strip segment represents
+ */
+UENUM(BlueprintType)
+enum class ESideScrollingSegmentType : uint8
+{
+	Floor,
+	Wall
+};
+
+/**
+ *  A single collision segment on the side scrolling plane, in world X and Z
+ */
+USTRUCT(BlueprintType)
+struct FSideScrollingCollisionSegment
+{
+	GENERATED_BODY()
+
+	/** Start point. Floors go from left to right, walls from bottom to top */
+	UPROPERTY(VisibleAnywhere, Category="Collision Strip")
+	FVector2f Start = FVector2f::ZeroVector;
+
+	/** End point */
+	UPROPERTY(VisibleAnywhere, Category="Collision Strip")
+	FVector2f End = FVector2f::ZeroVector;
+
+	/** Surface type */
+	UPROPERTY(VisibleAnywhere, Category="Collision Strip")
+	ESideScrollingSegmentType Type = ESideScrollingSegmentType::Floor;
+
+	/** For walls, the side the wall faces along X: -1 or 1 */
+	UPROPERTY(VisibleAnywhere, Category="Collision Strip")
+	int8 FacingX = 0;
+
+	/** If true, this floor belongs to a soft platform that can be dropped through */
+	UPROPERTY(VisibleAnywhere, Category="Collision Strip")
+	bool bSoft = false;
+};
+
+/**
+ *  A side scrolling level sliced into 2D collision along its gameplay plane.
+ *  Stores floor and wall segments, with soft platform flags, plus a bucket index along X
+ *  so wall, ground and soft floor tests only look at a handful of segments and never touch physics.
+ *
+ *  The bake is editor only. It slices the bounds of every blocking, non-movable primitive in the open editor level
+ *  that crosses the plane, so it assumes the level is built from axis aligned blocks.
+ *  Use the Bake button on the asset with the level open, and re-bake whenever the level layout changes.
+ *  A strip describes a single level. Reference it from an ASideScrollingLevelCollision actor placed in that level.
+ */
+UCLASS(BlueprintType)
+class USideScrollingCollisionStrip : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	/** World Y of the gameplay plane to slice the level at */
+	UPROPERTY(EditAnywhere, Category="Bake", meta = (Units = "cm"))
+	float PlaneY = 0.0f;
+
+	/** Size of the index buckets along X */
+	UPROPERTY(EditAnywhere, Category="Bake", meta = (ClampMin = 10, ClampMax = 10000, Units = "cm"))
+	float BucketSize = 200.0f;
+
+	/** Level the strip was baked from */
+	UPROPERTY(VisibleAnywhere, Category="Bake")
+	TSoftObjectPtr<UWorld> BakedWorld;
+
+	/** Baked segments */
+	UPROPERTY(VisibleAnywhere, Category="Bake")
+	TArray<FSideScrollingCollisionSegment> Segments;
+
+	/** World X of the first bucket */
+	UPROPERTY()
+	float IndexMinX = 0.0f;
+
+	/** Index of the first entry of each bucket in BucketSegments. Has one extra element at the end */
+	UPROPERTY()
+	TArray<int32> BucketStarts;
+
+	/** Segment indices for every bucket */
+	UPROPERTY()
+	TArray<int32> BucketSegments;
+
+public:
+
+	/** Returns true if the asset has been baked */
+	bool IsBaked() const { return BucketStarts.Num() > 1; }
+
+	/** Returns true if the strip was baked from the provided world's level */
+	bool WasBakedFor(const UWorld* World) const;
+
+	/** Finds the highest floor at or below Z at the provided X, within MaxDistance. Can be restricted to soft floors */
+	bool FindGround(float X, float Z, float MaxDistance, float& OutGroundZ, bool bSoftOnly = false, bool* bOutSoft = nullptr) const;
+
+	/** Finds the nearest wall ahead of the provided point along X, within MaxDistance. Direction is the sign of the test direction */
+	bool FindWall(float X, float Z, float Direction, float MaxDistance, float& OutWallX, FVector& OutNormal) const;
+
+#if WITH_EDITOR
+
+	/** Slices the open editor level into the strip */
+	UFUNCTION(CallInEditor, Category="Bake")
+	void Bake();
+
+#endif // WITH_EDITOR
+
+protected:
+
+	/** Returns the range of buckets covering the provided X range, clamped to the index */
+	bool GetBucketRange(float MinX, float MaxX, int32& OutFirst, int32& OutLast) const;
+
+	/** Rebuilds the bucket index from the segments */
+	void BuildIndex();
+};
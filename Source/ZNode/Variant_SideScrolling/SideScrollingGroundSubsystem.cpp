@@ -0,0 +1,220 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingGroundSubsystem.h"
+#include "SideScrollingCollisionStrip.h"
+#include "SideScrollingLevelCollision.h"
+#include "GameFramework/PlayerStart.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/HitResult.h"
+#include "CollisionQueryParams.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("Ground Strip Build"), STAT_SideScrollingGroundBuild, STATGROUP_Game);
+
+DEFINE_LOG_CATEGORY_STATIC(LogSideScrollingGround, Log, All);
+
+namespace SideScrollingGround
+{
+	/** Surfaces with a flatter normal than this are treated as walls and skipped */
+	constexpr float MinWalkableNormalZ = 0.7f;
+
+	/** Distance to move past a surface before looking for the next one below it */
+	constexpr float SurfaceSkipDistance = 1.0f;
+
+	/** Max number of traces for a column, including the ones that hit walls or start inside geometry */
+	constexpr int32 MaxTracesPerColumn = 32;
+
+	/** Max distance from the play plane for geometry to count towards the level bounds */
+	constexpr float PlaneTolerance = 100.0f;
+}
+
+bool USideScrollingGroundSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USideScrollingGroundSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// prefer the baked collision strip if the level has one
+	for (TActorIterator<ASideScrollingLevelCollision> It(&InWorld); It; ++It)
+	{
+		USideScrollingCollisionStrip* Strip = It->GetCollisionStrip();
+
+		if (!Strip || !Strip->IsBaked())
+		{
+			continue;
+		}
+
+		// a strip baked from another level would give wrong collision everywhere
+		if (!Strip->WasBakedFor(&InWorld))
+		{
+			UE_LOG(LogSideScrollingGround, Error, TEXT("%s: collision strip %s was baked from %s, not from this level. Re-bake it with this level open. Falling back to physics queries"),
+				*It->GetName(), *Strip->GetName(), Strip->BakedWorld.IsNull() ? TEXT("an unknown level") : *Strip->BakedWorld.ToString());
+
+			ensureMsgf(false, TEXT("Collision strip %s doesn't match level %s"), *Strip->GetName(), *InWorld.GetMapName());
+			continue;
+		}
+
+		CollisionStrip = Strip;
+		return;
+	}
+
+	BuildStrip();
+}
+
+void USideScrollingGroundSubsystem::Deinitialize()
+{
+	ColumnStarts.Empty();
+	SurfaceHeights.Empty();
+	CollisionStrip = nullptr;
+
+	Super::Deinitialize();
+}
+
+void USideScrollingGroundSubsystem::BuildStrip()
+{
+	SCOPE_CYCLE_COUNTER(STAT_SideScrollingGroundBuild);
+
+	ColumnStarts.Reset();
+	SurfaceHeights.Reset();
+
+	// sample along the plane the player plays on
+	float PlaneY = 0.0f;
+
+	for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
+	{
+		PlaneY = It->GetActorLocation().Y;
+		break;
+	}
+
+	// find the extent of the static geometry the player can stand on.
+	// Sky and background meshes are left out, since they would stretch the strip far past the playable area
+	FBox LevelBounds(ForceInit);
+
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		It->ForEachComponent<UPrimitiveComponent>(false, [&LevelBounds, PlaneY](const UPrimitiveComponent* Primitive)
+		{
+			if (Primitive->Mobility != EComponentMobility::Static || !Primitive->IsCollisionEnabled())
+			{
+				return;
+			}
+
+			// only geometry that blocks both the player and the ground traces
+			if (Primitive->GetCollisionResponseToChannel(ECC_Pawn) != ECR_Block || Primitive->GetCollisionResponseToChannel(ECC_Visibility) != ECR_Block)
+			{
+				return;
+			}
+
+			// only geometry crossing the play plane
+			const FBox Box = Primitive->Bounds.GetBox();
+
+			if (Box.Min.Y - SideScrollingGround::PlaneTolerance <= PlaneY && Box.Max.Y + SideScrollingGround::PlaneTolerance >= PlaneY)
+			{
+				LevelBounds += Box;
+			}
+		});
+	}
+
+	if (!LevelBounds.IsValid)
+	{
+		return;
+	}
+
+	const int32 NumColumns = FMath::Min(MaxColumns, FMath::CeilToInt32((LevelBounds.Max.X - LevelBounds.Min.X) / ColumnSpacing) + 1);
+
+	StripMinX = LevelBounds.Min.X;
+	ColumnStarts.Reserve(NumColumns + 1);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SideScrollingGroundStrip));
+	FHitResult OutHit;
+
+	for (int32 Column = 0; Column < NumColumns; ++Column)
+	{
+		ColumnStarts.Add(SurfaceHeights.Num());
+
+		const float X = StripMinX + Column * ColumnSpacing;
+
+		FVector Start(X, PlaneY, LevelBounds.Max.Z + 1.0f);
+		const FVector End(X, PlaneY, LevelBounds.Min.Z - 1.0f);
+
+		// each trace ignores the components already hit in this column, so the next one doesn't start inside them
+		QueryParams.ClearIgnoredComponents();
+
+		// walk down the column, one surface at a time
+		for (int32 NumSurfaces = 0, NumTraces = 0; NumSurfaces < MaxSurfacesPerColumn && NumTraces < SideScrollingGround::MaxTracesPerColumn && GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams); ++NumTraces)
+		{
+			const UPrimitiveComponent* HitComponent = OutHit.GetComponent();
+
+			if (HitComponent)
+			{
+				QueryParams.AddIgnoredComponent(HitComponent);
+			}
+
+			// started inside another solid. Its top is above us, so it isn't a surface we can reach from here
+			if (OutHit.bStartPenetrating)
+			{
+				continue;
+			}
+
+			// only keep walkable static surfaces
+			if (HitComponent && HitComponent->Mobility == EComponentMobility::Static && OutHit.ImpactNormal.Z >= SideScrollingGround::MinWalkableNormalZ)
+			{
+				SurfaceHeights.Add(OutHit.ImpactPoint.Z);
+				++NumSurfaces;
+			}
+
+			Start.Z = OutHit.ImpactPoint.Z - SideScrollingGround::SurfaceSkipDistance;
+
+			if (Start.Z <= End.Z)
+			{
+				break;
+			}
+		}
+	}
+
+	ColumnStarts.Add(SurfaceHeights.Num());
+}
+
+bool USideScrollingGroundSubsystem::HasStrip() const
+{
+	return CollisionStrip || ColumnStarts.Num() > 1;
+}
+
+bool USideScrollingGroundSubsystem::FindGroundBelow(float X, float Z, float& OutGroundZ) const
+{
+	// use the baked strip if we have one
+	if (CollisionStrip)
+	{
+		return CollisionStrip->FindGround(X, Z, TNumericLimits<float>::Max(), OutGroundZ);
+	}
+
+	if (!HasStrip())
+	{
+		return false;
+	}
+
+	// find the nearest column
+	const int32 Column = FMath::RoundToInt32((X - StripMinX) / ColumnSpacing);
+
+	if (Column < 0 || Column >= ColumnStarts.Num() - 1)
+	{
+		return false;
+	}
+
+	// surfaces are stored top to bottom, so the first one under Z is the ground
+	for (int32 Index = ColumnStarts[Column]; Index < ColumnStarts[Column + 1]; ++Index)
+	{
+		if (SurfaceHeights[Index] <= Z)
+		{
+			OutGroundZ = SurfaceHeights[Index];
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,73 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SideScrollingGroundSubsystem.generated.h"
+
+class USideScrollingCollisionStrip;
+
+/**
+ *  Precomputed ground heights for a side scrolling level.
+ *  When the level begins play, the static geometry is sampled along the side scrolling axis at a fixed spacing.
+ *  Each column stores the heights of every walkable surface found under it, from top to bottom,
+ *  so finding the ground below a point is an array lookup instead of a physics trace.
+ *  Only static geometry that blocks the player and crosses the play plane is sampled. Moving platforms are not part of the strip.
+ *  Each component contributes its topmost surface to a column, so floors nested under an overhang of the same mesh are not stored.
+ *  If the level has an ASideScrollingLevelCollision actor with a strip baked from it, the strip is used instead of sampling the level.
+ */
+UCLASS()
+class USideScrollingGroundSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Distance between columns along the side scrolling axis */
+	static constexpr float ColumnSpacing = 50.0f;
+
+	/** Max number of surfaces stored for a column */
+	static constexpr int32 MaxSurfacesPerColumn = 8;
+
+	/** Max number of columns, to keep very large levels bounded */
+	static constexpr int32 MaxColumns = 16384;
+
+	/** World X of the first column */
+	float StripMinX = 0.0f;
+
+	/** Index of the first surface of each column in SurfaceHeights. Has one extra element at the end */
+	TArray<int32> ColumnStarts;
+
+	/** Surface heights for every column, from top to bottom */
+	TArray<float> SurfaceHeights;
+
+	/** Baked collision strip provided by the level */
+	UPROPERTY()
+	USideScrollingCollisionStrip* CollisionStrip = nullptr;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Samples the level geometry */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Finds the highest surface at or below Z at the provided X. Returns false if there's no ground there */
+	bool FindGroundBelow(float X, float Z, float& OutGroundZ) const;
+
+	/** Returns true if the strip has been built */
+	bool HasStrip() const;
+
+	/** Returns the baked collision strip for the level, or nullptr if there's none */
+	const USideScrollingCollisionStrip* GetCollisionStrip() const { return CollisionStrip; }
+
+protected:
+
+	/** Samples the static geometry of the level into the strip */
+	void BuildStrip();
+};
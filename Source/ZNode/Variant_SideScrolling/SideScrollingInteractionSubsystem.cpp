@@ -0,0 +1,252 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingInteractionSubsystem.h"
+#include "GameFramework/Actor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "Algo/BinarySearch.h"
+
+DECLARE_CYCLE_STAT(TEXT("Interaction Index Refresh"), STAT_SideScrollingInteractionRefresh, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("Interaction Query"), STAT_SideScrollingInteractionQuery, STATGROUP_Game);
+
+bool USideScrollingInteractionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USideScrollingInteractionSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	Viewers.Empty();
+	Highlights.Empty();
+	MaxExtentX = 0.0;
+
+	Super::Deinitialize();
+}
+
+TStatId USideScrollingInteractionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USideScrollingInteractionSubsystem, STATGROUP_Tickables);
+}
+
+void USideScrollingInteractionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// only refresh at a low frequency
+	TimeSinceRefresh += DeltaTime;
+
+	if (TimeSinceRefresh < RefreshInterval)
+	{
+		return;
+	}
+
+	TimeSinceRefresh = 0.0f;
+
+	RefreshIndex();
+	UpdateHighlights();
+}
+
+void USideScrollingInteractionSubsystem::RegisterInteractable(AActor* Interactable)
+{
+	if (!Interactable)
+	{
+		return;
+	}
+
+	// cache the bounds relative to the actor, so we only need the actor location to follow it
+	FVector Origin, Extent;
+	Interactable->GetActorBounds(true, Origin, Extent);
+
+	FInteractableEntry NewEntry;
+	NewEntry.Actor = Interactable;
+	NewEntry.BoundsOffset = Origin - Interactable->GetActorLocation();
+	NewEntry.Extent = Extent;
+	NewEntry.MinX = Origin.X - Extent.X;
+
+	MaxExtentX = FMath::Max(MaxExtentX, Extent.X);
+
+	// insert the entry in sorted order
+	const int32 InsertIndex = Algo::LowerBoundBy(Entries, NewEntry.MinX, &FInteractableEntry::MinX);
+	Entries.Insert(NewEntry, InsertIndex);
+}
+
+void USideScrollingInteractionSubsystem::UnregisterInteractable(AActor* Interactable)
+{
+	// keep the order. Removals are rare
+	Entries.RemoveAll([Interactable](const FInteractableEntry& Entry) { return Entry.Actor.Get() == Interactable; });
+
+	// drop the highlight if it was on this interactable
+	for (FHighlightViewer& Viewer : Viewers)
+	{
+		if (Viewer.Highlighted.Get() == Interactable)
+		{
+			RemoveHighlight(Interactable);
+			Viewer.Highlighted = nullptr;
+		}
+	}
+}
+
+AActor* USideScrollingInteractionSubsystem::FindNearestInteractable(const FVector& Location, float Radius, const AActor* IgnoredActor) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_SideScrollingInteractionQuery);
+
+	// any entry overlapping the query range starts at most one full extent before it
+	const double RangeMin = Location.X - Radius - RefreshSlack - 2.0 * MaxExtentX;
+	const double RangeMax = Location.X + Radius + RefreshSlack;
+
+	AActor* Nearest = nullptr;
+	double NearestDistSquared = FMath::Square(static_cast<double>(Radius));
+
+	for (int32 Index = Algo::LowerBoundBy(Entries, RangeMin, &FInteractableEntry::MinX); Index < Entries.Num() && Entries[Index].MinX <= RangeMax; ++Index)
+	{
+		const FInteractableEntry& Entry = Entries[Index];
+		AActor* Actor = Entry.Actor.Get();
+
+		if (!Actor || Actor == IgnoredActor)
+		{
+			continue;
+		}
+
+		// test against the live bounds
+		const FVector Center = Actor->GetActorLocation() + Entry.BoundsOffset;
+		const FBox Bounds(Center - Entry.Extent, Center + Entry.Extent);
+		const double DistSquared = Bounds.ComputeSquaredDistanceToPoint(Location);
+
+		if (DistSquared <= NearestDistSquared)
+		{
+			Nearest = Actor;
+			NearestDistSquared = DistSquared;
+		}
+	}
+
+	return Nearest;
+}
+
+void USideScrollingInteractionSubsystem::RegisterViewer(AActor* Viewer, float Radius)
+{
+	if (!Viewer)
+	{
+		return;
+	}
+
+	FHighlightViewer& NewViewer = Viewers.AddDefaulted_GetRef();
+	NewViewer.Viewer = Viewer;
+	NewViewer.Radius = Radius;
+}
+
+void USideScrollingInteractionSubsystem::UnregisterViewer(AActor* Viewer)
+{
+	for (int32 Index = Viewers.Num() - 1; Index >= 0; --Index)
+	{
+		if (Viewers[Index].Viewer.Get() == Viewer)
+		{
+			// clear the highlight
+			RemoveHighlight(Viewers[Index].Highlighted.Get());
+
+			Viewers.RemoveAtSwap(Index);
+		}
+	}
+}
+
+void USideScrollingInteractionSubsystem::RefreshIndex()
+{
+	SCOPE_CYCLE_COUNTER(STAT_SideScrollingInteractionRefresh);
+
+	// drop destroyed interactables
+	Entries.RemoveAll([](const FInteractableEntry& Entry) { return !Entry.Actor.IsValid(); });
+
+	for (TMap<TWeakObjectPtr<AActor>, FHighlight>::TIterator It = Highlights.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (FInteractableEntry& Entry : Entries)
+	{
+		Entry.MinX = Entry.Actor->GetActorLocation().X + Entry.BoundsOffset.X - Entry.Extent.X;
+	}
+
+	// interactables move slowly compared to the refresh rate, so the array is nearly sorted and insertion sort is close to linear
+	for (int32 Index = 1; Index < Entries.Num(); ++Index)
+	{
+		for (int32 SwapIndex = Index; SwapIndex > 0 && Entries[SwapIndex - 1].MinX > Entries[SwapIndex].MinX; --SwapIndex)
+		{
+			Entries.Swap(SwapIndex - 1, SwapIndex);
+		}
+	}
+}
+
+void USideScrollingInteractionSubsystem::UpdateHighlights()
+{
+	for (int32 Index = Viewers.Num() - 1; Index >= 0; --Index)
+	{
+		FHighlightViewer& Viewer = Viewers[Index];
+
+		// drop destroyed viewers
+		if (!Viewer.Viewer.IsValid())
+		{
+			RemoveHighlight(Viewer.Highlighted.Get());
+			Viewers.RemoveAtSwap(Index);
+			continue;
+		}
+
+		AActor* Nearest = FindNearestInteractable(Viewer.Viewer->GetActorLocation(), Viewer.Radius, Viewer.Viewer.Get());
+
+		// only touch the render state when the highlight changes
+		if (Nearest != Viewer.Highlighted.Get())
+		{
+			RemoveHighlight(Viewer.Highlighted.Get());
+			AddHighlight(Nearest);
+
+			Viewer.Highlighted = Nearest;
+		}
+	}
+}
+
+void USideScrollingInteractionSubsystem::AddHighlight(AActor* Interactable)
+{
+	if (!Interactable)
+	{
+		return;
+	}
+
+	FHighlight& Highlight = Highlights.FindOrAdd(Interactable);
+
+	// only the first viewer touches the render state
+	if (Highlight.NumViewers++ > 0)
+	{
+		return;
+	}
+
+	Interactable->ForEachComponent<UPrimitiveComponent>(false, [&Highlight](UPrimitiveComponent* Primitive)
+	{
+		// remember the previous setting so we don't clobber custom depth used for something else
+		Highlight.PreviousStates.Emplace(Primitive, Primitive->bRenderCustomDepth);
+		Primitive->SetRenderCustomDepth(true);
+	});
+}
+
+void USideScrollingInteractionSubsystem::RemoveHighlight(AActor* Interactable)
+{
+	FHighlight* Highlight = Interactable ? Highlights.Find(Interactable) : nullptr;
+
+	// keep the highlight while other viewers still want it
+	if (!Highlight || --Highlight->NumViewers > 0)
+	{
+		return;
+	}
+
+	for (const TPair<TWeakObjectPtr<UPrimitiveComponent>, bool>& PreviousState : Highlight->PreviousStates)
+	{
+		if (UPrimitiveComponent* Primitive = PreviousState.Key.Get())
+		{
+			Primitive->SetRenderCustomDepth(PreviousState.Value);
+		}
+	}
+
+	Highlights.Remove(Interactable);
+}
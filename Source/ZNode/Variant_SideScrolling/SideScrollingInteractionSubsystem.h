@@ -0,0 +1,130 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SideScrollingInteractionSubsystem.generated.h"
+
+class UPrimitiveComponent;
+
+/**
+ *  Registry of the interactable actors in a side scrolling level.
+ *  Interactables are kept sorted by the start of their bounds along the side scrolling axis, so finding
+ *  the ones in range of a point is a binary search plus a short scan, with no physics queries involved.
+ *  The index is refreshed at a low frequency to follow moving interactables, and queries are padded to cover
+ *  the movement since the last refresh before testing against the live actor bounds.
+ *  Can optionally highlight the nearest interactable for registered viewers by enabling custom depth on it,
+ *  so it can be picked up by an outline post process material. Highlights are counted per viewer, and each
+ *  component's previous custom depth setting is restored once no viewer highlights it anymore.
+ */
+UCLASS()
+class USideScrollingInteractionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** An indexed interactable */
+	struct FInteractableEntry
+	{
+		/** Interactable actor */
+		TWeakObjectPtr<AActor> Actor;
+
+		/** Offset from the actor location to the center of its bounds */
+		FVector BoundsOffset = FVector::ZeroVector;
+
+		/** Half size of the actor bounds */
+		FVector Extent = FVector::ZeroVector;
+
+		/** Start of the bounds along the side scrolling axis at the last refresh. Entries are sorted by this */
+		double MinX = 0.0;
+	};
+
+	/** An actor that wants the nearest interactable highlighted */
+	struct FHighlightViewer
+	{
+		/** Viewing actor */
+		TWeakObjectPtr<AActor> Viewer;
+
+		/** Max distance to highlight interactables at */
+		float Radius = 0.0f;
+
+		/** Interactable currently highlighted for this viewer */
+		TWeakObjectPtr<AActor> Highlighted;
+	};
+
+	/** An interactable highlighted by one or more viewers */
+	struct FHighlight
+	{
+		/** Number of viewers highlighting the interactable */
+		int32 NumViewers = 0;
+
+		/** Components whose custom depth we changed, along with their previous setting */
+		TArray<TPair<TWeakObjectPtr<UPrimitiveComponent>, bool>> PreviousStates;
+	};
+
+	/** Interactables, sorted by MinX */
+	TArray<FInteractableEntry> Entries;
+
+	/** Largest interactable extent along the side scrolling axis */
+	double MaxExtentX = 0.0;
+
+	/** Viewers that want the nearest interactable highlighted */
+	TArray<FHighlightViewer> Viewers;
+
+	/** Interactables currently highlighted */
+	TMap<TWeakObjectPtr<AActor>, FHighlight> Highlights;
+
+	/** Time accumulated since the last refresh */
+	float TimeSinceRefresh = 0.0f;
+
+	/** Time between index refreshes and highlight updates */
+	static constexpr float RefreshInterval = 0.1f;
+
+	/** Slack added to queries to cover interactables that moved since the last refresh */
+	static constexpr double RefreshSlack = 100.0;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Refreshes the index and the highlights at a low frequency */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Adds an interactable actor to the index */
+	void RegisterInteractable(AActor* Interactable);
+
+	/** Removes an interactable actor from the index */
+	void UnregisterInteractable(AActor* Interactable);
+
+	/** Returns the interactable whose bounds are nearest to the provided location, within the radius. Returns nullptr if there's none */
+	AActor* FindNearestInteractable(const FVector& Location, float Radius, const AActor* IgnoredActor = nullptr) const;
+
+	/** Starts highlighting the nearest interactable within the radius of the viewer */
+	void RegisterViewer(AActor* Viewer, float Radius);
+
+	/** Stops highlighting for the viewer */
+	void UnregisterViewer(AActor* Viewer);
+
+protected:
+
+	/** Updates the entry bounds and restores the sort order */
+	void RefreshIndex();
+
+	/** Moves each viewer's highlight to its nearest interactable */
+	void UpdateHighlights();
+
+	/** Adds a viewer to an interactable's highlight, enabling it for the first viewer */
+	void AddHighlight(AActor* Interactable);
+
+	/** Removes a viewer from an interactable's highlight, restoring the previous custom depth setting after the last viewer */
+	void RemoveHighlight(AActor* Interactable);
+};
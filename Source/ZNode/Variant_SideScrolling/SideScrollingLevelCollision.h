@@ -0,0 +1,31 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "SideScrollingLevelCollision.generated.h"
+
+class USideScrollingCollisionStrip;
+
+/**
+ *  Provides the baked collision strip for the level it's placed in.
+ *  Place one in each side scrolling level that has a strip. The strip is only used if it was baked from this level,
+ *  so levels sharing a game mode never test against each other's geometry.
+ */
+UCLASS()
+class ASideScrollingLevelCollision : public AInfo
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Baked 2D collision for this level. Used for wall, ground and soft floor tests instead of physics queries */
+	UPROPERTY(EditAnywhere, Category="Collision")
+	USideScrollingCollisionStrip* CollisionStrip = nullptr;
+
+public:
+
+	/** Returns the baked collision strip, if any */
+	USideScrollingCollisionStrip* GetCollisionStrip() const { return CollisionStrip; }
+};
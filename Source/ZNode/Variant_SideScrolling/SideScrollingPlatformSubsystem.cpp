@@ -0,0 +1,273 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingPlatformSubsystem.h"
+#include "SideScrollingMovingPlatform.h"
+#include "GameFramework/Character.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "Algo/BinarySearch.h"
+
+DECLARE_CYCLE_STAT(TEXT("Platform Update"), STAT_MovingPlatformUpdate, STATGROUP_MovingPlatforms);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Registered Platforms"), STAT_MovingPlatformsRegistered, STATGROUP_MovingPlatforms);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Platforms"), STAT_MovingPlatformsActive, STATGROUP_MovingPlatforms);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Platform Moves With Riders"), STAT_MovingPlatformRiderMoves, STATGROUP_MovingPlatforms);
+
+bool USideScrollingPlatformSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USideScrollingPlatformSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_MovingPlatformsRegistered, Entries.Num() - FreeEntries.Num());
+	DEC_DWORD_STAT_BY(STAT_MovingPlatformsActive, ActiveEntries.Num());
+
+	Entries.Empty();
+	FreeEntries.Empty();
+	ActiveEntries.Empty();
+	FinishedEntries.Empty();
+	RiderPlatforms.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId USideScrollingPlatformSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USideScrollingPlatformSubsystem, STATGROUP_Tickables);
+}
+
+int32 USideScrollingPlatformSubsystem::RegisterPlatform(ASideScrollingMovingPlatform* Platform, TArray<FVector>&& Points, float Duration, float EaseExponent, bool bReturnToStart, float ReturnDelay)
+{
+	check(Platform);
+
+	// reuse a free slot if we have one
+	const int32 Handle = FreeEntries.Num() > 0 ? FreeEntries.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+
+	FPlatformEntry& Entry = Entries[Handle];
+	Entry.Platform = Platform;
+	Entry.Points = MoveTemp(Points);
+	Entry.Duration = FMath::Max(Duration, UE_KINDA_SMALL_NUMBER);
+	Entry.EaseExponent = FMath::Max(EaseExponent, 1.0f);
+	Entry.bReturnToStart = bReturnToStart;
+	Entry.ReturnDelay = ReturnDelay;
+	Entry.bActive = true;
+
+	// a path needs two ends
+	if (Entry.Points.Num() < 2)
+	{
+		Entry.Points.Add(Entry.Points.Num() > 0 ? Entry.Points[0] : Platform->GetActorLocation());
+	}
+
+	// measure the path
+	Entry.Distances.SetNumUninitialized(Entry.Points.Num());
+	Entry.Distances[0] = 0.0f;
+
+	for (int32 PointIndex = 1; PointIndex < Entry.Points.Num(); ++PointIndex)
+	{
+		Entry.Distances[PointIndex] = Entry.Distances[PointIndex - 1] + FVector::Dist(Entry.Points[PointIndex - 1], Entry.Points[PointIndex]);
+	}
+
+	INC_DWORD_STAT(STAT_MovingPlatformsRegistered);
+
+	return Handle;
+}
+
+void USideScrollingPlatformSubsystem::UnregisterPlatform(int32 Handle)
+{
+	if (!Entries.IsValidIndex(Handle) || !Entries[Handle].bActive)
+	{
+		return;
+	}
+
+	if (ActiveEntries.RemoveSingleSwap(Handle, EAllowShrinking::No) > 0)
+	{
+		DEC_DWORD_STAT(STAT_MovingPlatformsActive);
+	}
+
+	// forget the riders, so they aren't counted on whatever platform reuses the slot
+	if (Entries[Handle].NumRiders > 0)
+	{
+		for (auto It = RiderPlatforms.CreateIterator(); It; ++It)
+		{
+			if (It.Value() == Handle)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	Entries[Handle] = FPlatformEntry();
+	FreeEntries.Add(Handle);
+
+	DEC_DWORD_STAT(STAT_MovingPlatformsRegistered);
+}
+
+bool USideScrollingPlatformSubsystem::StartMove(int32 Handle)
+{
+	if (!Entries.IsValidIndex(Handle) || !Entries[Handle].bActive)
+	{
+		return false;
+	}
+
+	FPlatformEntry& Entry = Entries[Handle];
+
+	// only platforms resting at either end can start a move.
+	// Platforms that return on their own are still active while they wait at the target
+	if (Entry.State == EPlatformState::AtStart)
+	{
+		Entry.State = EPlatformState::MovingToTarget;
+	}
+	else if (Entry.State == EPlatformState::AtTarget && !ActiveEntries.Contains(Handle))
+	{
+		Entry.State = EPlatformState::MovingToStart;
+	}
+	else
+	{
+		return false;
+	}
+
+	Entry.Elapsed = 0.0f;
+
+	ActiveEntries.Add(Handle);
+	INC_DWORD_STAT(STAT_MovingPlatformsActive);
+
+	return true;
+}
+
+void USideScrollingPlatformSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_MovingPlatformUpdate);
+
+	if (ActiveEntries.IsEmpty())
+	{
+		return;
+	}
+
+	// iterate backwards so finished platforms can be swapped out
+	for (int32 ActiveIndex = ActiveEntries.Num() - 1; ActiveIndex >= 0; --ActiveIndex)
+	{
+		const int32 Handle = ActiveEntries[ActiveIndex];
+		FPlatformEntry& Entry = Entries[Handle];
+
+		ASideScrollingMovingPlatform* Platform = Entry.Platform.Get();
+
+		if (!Platform)
+		{
+			UnregisterPlatform(Handle);
+			continue;
+		}
+
+		Entry.Elapsed += DeltaTime;
+
+		// wait at the target before returning
+		if (Entry.State == EPlatformState::AtTarget)
+		{
+			if (Entry.Elapsed >= Entry.ReturnDelay)
+			{
+				Entry.State = EPlatformState::MovingToStart;
+				Entry.Elapsed = 0.0f;
+			}
+
+			continue;
+		}
+
+		// ease from the time since the move started, so the curve doesn't depend on the frame rate
+		const float Alpha = FMath::Min(Entry.Elapsed / Entry.Duration, 1.0f);
+		const float Eased = FMath::InterpEaseInOut(0.0f, 1.0f, Alpha, Entry.EaseExponent);
+		const bool bMovingToTarget = Entry.State == EPlatformState::MovingToTarget;
+
+		const FVector NewLocation = EvaluatePath(Entry, bMovingToTarget ? Eased : 1.0f - Eased);
+
+		// only pay for velocity updates on kinematic bodies when something is riding the platform
+		const bool bHasRiders = Entry.NumRiders > 0;
+
+		if (bHasRiders)
+		{
+			INC_DWORD_STAT(STAT_MovingPlatformRiderMoves);
+		}
+
+		Platform->SetActorLocation(NewLocation, false, nullptr, bHasRiders ? ETeleportType::None : ETeleportType::TeleportPhysics);
+
+		// overlap events raised by the move can remove the platform
+		if (Alpha < 1.0f || !ActiveEntries.IsValidIndex(ActiveIndex) || ActiveEntries[ActiveIndex] != Handle)
+		{
+			continue;
+		}
+
+		// reached the end of the path
+		FPlatformEntry& FinishedEntry = Entries[Handle];
+		FinishedEntry.State = bMovingToTarget ? EPlatformState::AtTarget : EPlatformState::AtStart;
+		FinishedEntry.Elapsed = 0.0f;
+
+		FinishedEntries.Add(Handle);
+
+		// platforms that return on their own stay active while they wait
+		if (!bMovingToTarget || !FinishedEntry.bReturnToStart)
+		{
+			ActiveEntries.RemoveAtSwap(ActiveIndex, EAllowShrinking::No);
+			DEC_DWORD_STAT(STAT_MovingPlatformsActive);
+		}
+	}
+
+	// notify after the update, since the notifications can start new moves or remove platforms
+	for (int32 FinishedIndex = 0; FinishedIndex < FinishedEntries.Num(); ++FinishedIndex)
+	{
+		const FPlatformEntry& Entry = Entries[FinishedEntries[FinishedIndex]];
+
+		if (ASideScrollingMovingPlatform* Platform = Entry.bActive ? Entry.Platform.Get() : nullptr)
+		{
+			Platform->NotifyMoveFinished(Entry.State == EPlatformState::AtTarget);
+		}
+	}
+
+	FinishedEntries.Reset();
+}
+
+void USideScrollingPlatformSubsystem::NotifyBaseChanged(ACharacter* Character)
+{
+	if (!Character)
+	{
+		return;
+	}
+
+	// leave the previous platform
+	RemoveRider(Character);
+
+	// characters track the component they're standing on
+	const UPrimitiveComponent* Base = Character->GetMovementBase();
+	const ASideScrollingMovingPlatform* Platform = Base ? Cast<ASideScrollingMovingPlatform>(Base->GetOwner()) : nullptr;
+	const int32 Handle = Platform ? Platform->GetPlatformHandle() : INDEX_NONE;
+
+	if (Entries.IsValidIndex(Handle) && Entries[Handle].bActive && Entries[Handle].Platform.Get() == Platform)
+	{
+		++Entries[Handle].NumRiders;
+		RiderPlatforms.Add(Character, Handle);
+	}
+}
+
+void USideScrollingPlatformSubsystem::RemoveRider(ACharacter* Character)
+{
+	int32 Handle;
+
+	if (RiderPlatforms.RemoveAndCopyValue(Character, Handle) && Entries.IsValidIndex(Handle))
+	{
+		Entries[Handle].NumRiders = FMath::Max(Entries[Handle].NumRiders - 1, 0);
+	}
+}
+
+FVector USideScrollingPlatformSubsystem::EvaluatePath(const FPlatformEntry& Entry, float Fraction)
+{
+	const float Distance = Fraction * Entry.Distances.Last();
+
+	// find the segment containing the distance
+	const int32 Segment = FMath::Clamp(Algo::UpperBound(Entry.Distances, Distance), 1, Entry.Points.Num() - 1);
+
+	const float SegmentStart = Entry.Distances[Segment - 1];
+	const float SegmentLength = Entry.Distances[Segment] - SegmentStart;
+	const float SegmentAlpha = SegmentLength > 0.0f ? FMath::Clamp((Distance - SegmentStart) / SegmentLength, 0.0f, 1.0f) : 1.0f;
+
+	return FMath::Lerp(Entry.Points[Segment - 1], Entry.Points[Segment], SegmentAlpha);
+}
@@ -0,0 +1,128 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Stats/Stats.h"
+#include "SideScrollingPlatformSubsystem.generated.h"
+
+class ASideScrollingMovingPlatform;
+class ACharacter;
+
+DECLARE_STATS_GROUP(TEXT("Moving Platforms"), STATGROUP_MovingPlatforms, STATCAT_Advanced);
+
+/**
+ *  Moves every native moving platform in a single batched update.
+ *  Each platform's path is baked into a polyline when it registers, so evaluating a position is a binary search on the path distances.
+ *  Easing is evaluated from the time since the move started instead of being accumulated per frame,
+ *  so platforms follow the same curve at any frame rate. Only moving platforms are visited.
+ *  Platforms carrying characters move their kinematic bodies without teleporting, so physics and based movement
+ *  pick up their velocity. Platforms with nothing on them just teleport to their new location.
+ *  Characters report their movement base changes, so riders are counted per platform without scanning the characters every frame.
+ */
+UCLASS()
+class USideScrollingPlatformSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Movement state of a platform */
+	enum class EPlatformState : uint8
+	{
+		AtStart,
+		MovingToTarget,
+		AtTarget,
+		MovingToStart
+	};
+
+	/** A registered platform */
+	struct FPlatformEntry
+	{
+		/** Platform actor */
+		TWeakObjectPtr<ASideScrollingMovingPlatform> Platform;
+
+		/** Path points in world space, from the start location to the target */
+		TArray<FVector> Points;
+
+		/** Distance along the path at each point */
+		TArray<float> Distances;
+
+		/** Time to move along the whole path */
+		float Duration = 1.0f;
+
+		/** Ease in/out exponent. 1 is linear */
+		float EaseExponent = 1.0f;
+
+		/** If true, the platform returns to the start on its own after reaching the target */
+		bool bReturnToStart = false;
+
+		/** Time to wait at the target before returning */
+		float ReturnDelay = 0.0f;
+
+		/** Current movement state */
+		EPlatformState State = EPlatformState::AtStart;
+
+		/** Time since the current move or wait started */
+		float Elapsed = 0.0f;
+
+		/** Number of characters based on the platform */
+		int32 NumRiders = 0;
+
+		/** If false, the entry slot is free */
+		bool bActive = false;
+	};
+
+	/** Registered platforms */
+	TArray<FPlatformEntry> Entries;
+
+	/** Entry slots that have been released and can be reused */
+	TArray<int32> FreeEntries;
+
+	/** Entries that are moving or waiting to return */
+	TArray<int32> ActiveEntries;
+
+	/** Entries that finished a move this frame, notified after the update */
+	TArray<int32> FinishedEntries;
+
+	/** Platform handle each riding character is based on */
+	TMap<TObjectKey<ACharacter>, int32> RiderPlatforms;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Moves all the active platforms */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Adds a platform that moves along the provided world space path. Returns a handle used to move and remove it */
+	int32 RegisterPlatform(ASideScrollingMovingPlatform* Platform, TArray<FVector>&& Points, float Duration, float EaseExponent, bool bReturnToStart, float ReturnDelay);
+
+	/** Removes a platform */
+	void UnregisterPlatform(int32 Handle);
+
+	/** Moves a resting platform to the other end of its path. Returns false if the platform is already moving */
+	bool StartMove(int32 Handle);
+
+	/** Returns the number of platforms moving or waiting to return */
+	int32 GetNumActive() const { return ActiveEntries.Num(); }
+
+	/** Updates the rider counts after a character's movement base changed. Call from ACharacter::BaseChange */
+	void NotifyBaseChanged(ACharacter* Character);
+
+	/** Stops counting the character as a rider. Call from EndPlay */
+	void RemoveRider(ACharacter* Character);
+
+protected:
+
+	/** Returns the location at a fraction of the entry's path */
+	static FVector EvaluatePath(const FPlatformEntry& Entry, float Fraction);
+};
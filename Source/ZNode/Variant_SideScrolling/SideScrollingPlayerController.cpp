@@ -4,9 +4,8 @@
 #include "SideScrollingPlayerController.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputMappingContext.h"
-#include "Kismet/GameplayStatics.h"
-#include "GameFramework/PlayerStart.h"
 #include "SideScrollingCharacter.h"
+#include "RespawnSubsystem.h"
 #include "Engine/LocalPlayer.h"
 #include "Engine/World.h"
 
@@ -30,21 +29,31 @@ void ASideScrollingPlayerController::OnPossess(APawn* InPawn)
 	InPawn->OnDestroyed.AddDynamic(this, &ASideScrollingPlayerController::OnPawnDestroyed);
 }
 
-void ASideScrollingPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
+void ASideScrollingPlayerController::PrepareRespawn()
 {
-	// find the player start
-	TArray<AActor*> ActorList;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), APlayerStart::StaticClass(), ActorList);
-
-	if (ActorList.Num() > 0)
+	if (URespawnSubsystem* Respawns = GetWorld()->GetSubsystem<URespawnSubsystem>())
 	{
-		// spawn a character at the player start
-		const FTransform SpawnTransform = ActorList[0]->GetActorTransform();
+		// prewarm the next pawn at the player start
+		FTransform SpawnTransform;
 
-		if (ASideScrollingCharacter* RespawnedCharacter = GetWorld()->SpawnActor<ASideScrollingCharacter>(CharacterClass, SpawnTransform))
+		if (Respawns->GetPlayerStartTransform(SpawnTransform))
 		{
-			// possess the character
-			Possess(RespawnedCharacter);
+			Respawns->PrepareRespawn(this, CharacterClass, SpawnTransform);
 		}
 	}
 }
+
+void ASideScrollingPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
+{
+	if (URespawnSubsystem* Respawns = GetWorld()->GetSubsystem<URespawnSubsystem>())
+	{
+		// find the player start
+		FTransform SpawnTransform;
+
+		if (Respawns->GetPlayerStartTransform(SpawnTransform))
+		{
+			// respawn the character at the player start. It will be possessed by the respawn service
+			Respawns->Respawn(this, CharacterClass, SpawnTransform);
+		}
+	}
+}
\ No newline at end of file
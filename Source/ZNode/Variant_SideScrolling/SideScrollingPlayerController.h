@@ -14,6 +14,7 @@ class UInputMappingContext;
  *  A simple Side Scrolling Player Controller
  *  Manages input mappings
  *  Respawns the player pawn at the player start if it is destroyed
+ *  The respawn can be prepared ahead of time so the new pawn is ready when the old one is destroyed
  */
 UCLASS(abstract)
 class ASideScrollingPlayerController : public APlayerController
@@ -38,6 +39,14 @@ protected:
 	/** Pawn initialization */
 	virtual void OnPossess(APawn* InPawn) override;
 
+public:
+
+	/** Streams in the player start area and prewarms the next pawn there. Call when the death sequence starts */
+	UFUNCTION(BlueprintCallable, Category="Respawn")
+	void PrepareRespawn();
+
+protected:
+
 	/** Called if the possessed pawn is destroyed */
 	UFUNCTION()
 	void OnPawnDestroyed(AActor* DestroyedActor);
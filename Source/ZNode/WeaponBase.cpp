@@ -6,6 +6,12 @@
 #include "Components/CapsuleComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "ZNodeCharacter.h"
+#include "GameplayTimerSubsystem.h"
+#include "FrameScratchAllocator.h"
+#include "ZombieHitboxSubsystem.h"
+#include "ZombieHitboxComponent.h"
+#include "GameplayRandomSubsystem.h"
+#include "BoneTransformCacheComponent.h"
 
 AWeaponBase::AWeaponBase()
 {
@@ -16,6 +22,12 @@ void AWeaponBase::BeginPlay()
 {
 	Super::BeginPlay();
 	AmmoInMag = MagazineSize;
+
+	// Stream prprio p/ a disperso dos pellets (reprodutvel com a seed da sesso)
+	if (UGameplayRandomSubsystem* Random = GetWorld()->GetSubsystem<UGameplayRandomSubsystem>())
+	{
+		SpreadStream = Random->MakeActorStream(this);
+	}
 }
 
 bool AWeaponBase::CanFire() const
@@ -38,23 +50,283 @@ bool AWeaponBase::TryFire(const FVector& MuzzleWorld, const FVector& DesiredTarg
 	UWorld* World = GetWorld();
 	if (!World) return false;
 
+	// Garante que vamos at TraceRange (caso DesiredTarget esteja mais perto)
+	const FVector Dir = (DesiredTarget - MuzzleWorld).GetSafeNormal();
+	const FVector End = MuzzleWorld + Dir * TraceRange;
+
+	// Espingarda: vrios pellets num cone, com uma nica broad phase
+	if (PelletsPerShot > 1)
+	{
+		FirePellets(MuzzleWorld, Dir, Shooter);
+		ConsumeShot(Shooter);
+		return true;
+	}
+
+	/* ---------------------------------------------------------
+	   1-3) Resolve o hit efetivo
+		  - Hitboxes analticas dos zumbis, se houver
+		  - Seno, MultiTrace complexo (tringulos)
+	----------------------------------------------------------*/
+	FHitResult Hit; bool bHit = false;
+
+	UZombieHitboxSubsystem* Hitboxes = bUseAnalyticHitboxes ? World->GetSubsystem<UZombieHitboxSubsystem>() : nullptr;
+	if (Hitboxes && Hitboxes->HasHitboxes())
+	{
+		bHit = TraceHitboxes(*Hitboxes, MuzzleWorld, End, Shooter, Hit);
+	}
+	else
+	{
+		bHit = TraceComplex(MuzzleWorld, End, Shooter, Hit);
+	}
+
+	/* ---------------------------------------------------------
+	   4) Fallback: sem BoneName? Marca "head" por proximidade do socket
+	----------------------------------------------------------*/
+	if (bHit)
+	{
+		ApplyHeadFallback(Hit);
+	}
+
+	/* ---------------------------------------------------------
+	   5) Debug visual (linha/ponto + texto no ponto final)
+	----------------------------------------------------------*/
+	const FVector EndPoint = bHit ? Hit.ImpactPoint : End;
+
+	if (bDebugTrace)
+	{
+		DrawDebugLine(World, MuzzleWorld, EndPoint, bHit ? FColor::Red : FColor::Green, false, 1.5f, 0, 2.5f);
+		DrawDebugPoint(World, EndPoint, 12.f, bHit ? FColor::Red : FColor::Green, false, 1.5f);
+
+		const FString Bone = Hit.BoneName.IsNone() ? TEXT("None") : Hit.BoneName.ToString();
+		const FString Comp = Hit.Component.IsValid() ? Hit.Component->GetName() : TEXT("None");
+		const FString Act = Hit.GetActor() ? Hit.GetActor()->GetName() : TEXT("None");
+		const float   Dist = FVector::Distance(MuzzleWorld, EndPoint);
+
+		const FString Msg = FString::Printf(TEXT("Hit: %s\nComp: %s\nBone: %s\nDist: %.0f\nBlocking:%d"),
+			*Act, *Comp, *Bone, Dist, bHit && Hit.bBlockingHit ? 1 : 0);
+
+		DrawDebugString(World, EndPoint + FVector(0, 0, 18), Msg, nullptr, FColor::White, 1.5f, true);
+	}
+
+	/* ---------------------------------------------------------
+	   6) Aplicar dano (BoneName pode ter sido ajustado pelo fallback)
+	----------------------------------------------------------*/
+	if (bHit && Hit.GetActor())
+	{
+		const float Mult = GetBoneMultiplier(Hit.BoneName);
+		const float FinalDamage = BaseDamage * Mult;
+		const FVector ShotDir = Dir; // direo do disparo
+
+		UGameplayStatics::ApplyPointDamage(
+			Hit.GetActor(), FinalDamage, ShotDir, Hit,
+			Shooter->GetController(), this, UDamageType::StaticClass());
+	}
+
+	/* ---------------------------------------------------------
+	   7) Consumo de munio e controle de cadncia
+	----------------------------------------------------------*/
+	ConsumeShot(Shooter);
+
+	return true;
+}
+
+void AWeaponBase::ConsumeShot(AZNodeCharacter* Shooter)
+{
+	AmmoInMag = FMath::Max(AmmoInMag - 1, 0);
+	LastFireTime = FPlatformTime::Seconds();
+
+	if (AmmoInMag == 0 && ReserveAmmo > 0)
+	{
+		StartReload(Shooter);
+	}
+}
+
+void AWeaponBase::FirePellets(const FVector& MuzzleWorld, const FVector& Dir, AZNodeCharacter* Shooter)
+{
+	UWorld* World = GetWorld();
+	const float HalfAngle = FMath::DegreesToRadians(SpreadAngle * 0.5f);
+
+	/* ---------------------------------------------------------
+	   1) Broad phase nica: zumbis cujo bounds toca o cone
+	----------------------------------------------------------*/
+	TArray<UZombieHitboxComponent*, FFrameScratchAllocator> Candidates;
+
+	UZombieHitboxSubsystem* Hitboxes = bUseAnalyticHitboxes ? World->GetSubsystem<UZombieHitboxSubsystem>() : nullptr;
+	if (Hitboxes)
+	{
+		Hitboxes->GatherConeCandidates(MuzzleWorld, Dir, HalfAngle, TraceRange, Candidates, Shooter);
+	}
+
+	// Ocluso com trace simples; os candidatos j so resolvidos pelas hitboxes
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(WeaponPellets), /*bTraceComplex*/ false, Shooter);
+	Params.bReturnPhysicalMaterial = false;
+	Params.TraceTag = TEXT("WeaponFire");
+	for (const UZombieHitboxComponent* Candidate : Candidates)
+	{
+		Params.AddIgnoredActor(Candidate->GetOwner());
+	}
+
+	// Ocluso compartilhada: 1 trace por zumbi atingido (at o centro dele), no 1 por pellet.
+	// Trade-off: cobertura parcial vira tudo-ou-nada (se o centro est coberto, todos os pellets nele batem no obstculo).
+	// Pellets que no acertam zumbi nenhum ainda fazem o prprio trace, p/ achar o ponto de impacto no cenrio.
+	struct FCandidateOcclusion
+	{
+		bool bTraced = false;
+		bool bBlocked = false;
+		FHitResult Hit;
+	};
+	TArray<FCandidateOcclusion, FFrameScratchAllocator> Occlusion;
+	Occlusion.SetNum(Candidates.Num());
+
+	/* ---------------------------------------------------------
+	   2) Todos os pellets contra os mesmos candidatos,
+		  acumulando o dano por alvo
+	----------------------------------------------------------*/
+	struct FPelletTarget
+	{
+		AActor* Actor = nullptr;
+		float Damage = 0.f;
+		float BestMultiplier = 0.f;
+		FHitResult Hit;
+		int32 Pellets = 0;
+	};
+	TArray<FPelletTarget, FFrameScratchAllocator> Targets;
+
+	for (int32 Pellet = 0; Pellet < PelletsPerShot; ++Pellet)
+	{
+		const FVector PelletDir = SpreadStream.VRandCone(Dir, HalfAngle);
+
+		FZombieHitboxHit ZombieHit;
+		const bool bZombieHit = Hitboxes && Hitboxes->RaycastCandidates(Candidates, MuzzleWorld, PelletDir, TraceRange, ZombieHit);
+
+		FHitResult Hit;
+		if (bZombieHit)
+		{
+			FCandidateOcclusion& CandidateOcclusion = Occlusion[Candidates.IndexOfByKey(ZombieHit.Component)];
+			if (!CandidateOcclusion.bTraced)
+			{
+				CandidateOcclusion.bTraced = true;
+				const FVector Center = ZombieHit.Component->GetBoundingSphere().Center;
+				CandidateOcclusion.bBlocked = World->LineTraceSingleByChannel(CandidateOcclusion.Hit, MuzzleWorld, Center, ECC_Visibility, Params);
+			}
+
+			// Obstculo antes do zumbi (no raio do centro)? O pellet para nele
+			Hit = CandidateOcclusion.bBlocked && CandidateOcclusion.Hit.Distance < ZombieHit.Distance
+				? CandidateOcclusion.Hit
+				: MakeHitboxHit(ZombieHit, MuzzleWorld, PelletDir);
+		}
+		else
+		{
+			const FVector PelletEnd = MuzzleWorld + PelletDir * TraceRange;
+			if (!World->LineTraceSingleByChannel(Hit, MuzzleWorld, PelletEnd, ECC_Visibility, Params))
+			{
+				if (bDebugTrace)
+				{
+					DrawDebugLine(World, MuzzleWorld, PelletEnd, FColor::Green, false, 1.5f, 0, 1.0f);
+				}
+				continue;
+			}
+
+			// Sem hitboxes analticas o trace simples s acha a cpsula: mesmo fallback de headshot do tiro nico
+			ApplyHeadFallback(Hit);
+		}
+
+		if (bDebugTrace)
+		{
+			DrawDebugLine(World, MuzzleWorld, Hit.ImpactPoint, FColor::Red, false, 1.5f, 0, 1.0f);
+		}
+
+		if (!Hit.GetActor()) continue;
+
+		// Um alvo por ator; guarda o hit da zona mais forte (headshot continua valendo)
+		FPelletTarget* Target = Targets.FindByPredicate([&Hit](const FPelletTarget& T) { return T.Actor == Hit.GetActor(); });
+		if (!Target)
+		{
+			Target = &Targets.AddDefaulted_GetRef();
+			Target->Actor = Hit.GetActor();
+		}
+
+		const float Mult = GetBoneMultiplier(Hit.BoneName);
+		Target->Damage += BaseDamage * Mult;
+		++Target->Pellets;
+
+		if (Mult > Target->BestMultiplier)
+		{
+			Target->BestMultiplier = Mult;
+			Target->Hit = Hit;
+		}
+	}
+
+	/* ---------------------------------------------------------
+	   3) Um nico evento de dano por alvo
+	----------------------------------------------------------*/
+	for (const FPelletTarget& Target : Targets)
+	{
+		if (bDebugTrace)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[Pellets] Act=%s  Pellets=%d  Dano=%.1f  Bone=%s"),
+				*Target.Actor->GetName(), Target.Pellets, Target.Damage, *Target.Hit.BoneName.ToString());
+		}
+
+		UGameplayStatics::ApplyPointDamage(
+			Target.Actor, Target.Damage, Dir, Target.Hit,
+			Shooter->GetController(), this, UDamageType::StaticClass());
+	}
+}
+
+void AWeaponBase::ApplyHeadFallback(FHitResult& Hit)
+{
+	if (!Hit.BoneName.IsNone())
+	{
+		return;
+	}
+
+	// Usa o cache de transforms do alvo (socket resolvido uma vez, lido 1x por frame)
+	static const FName HeadName(TEXT("head"));
+	FVector HeadLocation;
+	if (UBoneTransformCacheComponent::FindSocketLocation(Hit.GetActor(), HeadName, HeadLocation))
+	{
+		const float DistToHead = FVector::Distance(HeadLocation, Hit.ImpactPoint);
+		// Ajuste conforme o seu esqueleto (2035 uu  um bom ponto de partida)
+		if (DistToHead <= 30.f)
+		{
+			Hit.BoneName = HeadName;
+		}
+	}
+}
+
+FHitResult AWeaponBase::MakeHitboxHit(const FZombieHitboxHit& ZombieHit, const FVector& MuzzleWorld, const FVector& Dir) const
+{
+	const FVector Location = MuzzleWorld + Dir * ZombieHit.Distance;
+	const FVector Normal = ZombieHit.Component->GetHitNormal(ZombieHit.HitboxIndex, Location);
+
+	FHitResult Hit(ZombieHit.Component->GetOwner(), ZombieHit.Component->GetMesh(), Location, Normal);
+	Hit.bBlockingHit = true;
+	Hit.TraceStart = MuzzleWorld;
+	Hit.TraceEnd = MuzzleWorld + Dir * TraceRange;
+	Hit.Distance = ZombieHit.Distance;
+	Hit.Time = ZombieHit.Distance / TraceRange;
+	Hit.BoneName = ZombieHit.Component->GetHitZone(ZombieHit.HitboxIndex);
+
+	return Hit;
+}
+
+bool AWeaponBase::TraceComplex(const FVector& MuzzleWorld, const FVector& End, AZNodeCharacter* Shooter, FHitResult& OutHit) const
+{
 	/* ---------------------------------------------------------
 	   1) MultiTrace complexo (tringulos) no canal Visibility
 	----------------------------------------------------------*/
-	TArray<FHitResult> Hits;
+	FScopedHitResults ScopedHits;
+	TArray<FHitResult>& Hits = ScopedHits.Get();
 
 	FCollisionQueryParams Params(SCENE_QUERY_STAT(WeaponFire), /*bTraceComplex*/ true, Shooter);
 	Params.bReturnPhysicalMaterial = false;
 	Params.AddIgnoredActor(Shooter);
 	Params.TraceTag = TEXT("WeaponFire");
 
-	// Garante que vamos at TraceRange (caso DesiredTarget esteja mais perto)
-	const FVector Dir = (DesiredTarget - MuzzleWorld).GetSafeNormal();
-	const FVector End = MuzzleWorld + Dir * TraceRange;
-
 	const ECollisionChannel Channel = ECC_Visibility;
 
-	World->LineTraceMultiByChannel(Hits, MuzzleWorld, End, Channel, Params);
+	GetWorld()->LineTraceMultiByChannel(Hits, MuzzleWorld, End, Channel, Params);
 
 	/* ---------------------------------------------------------
 	   2) Log detalhado do caminho (ordem dos acertos)
@@ -79,100 +351,84 @@ bool AWeaponBase::TryFire(const FVector& MuzzleWorld, const FVector& DesiredTarg
 		  - Primeiro blocking
 		  - Se for Capsule de Character, tenta o SkeletalMesh do mesmo ator
 	----------------------------------------------------------*/
-	FHitResult Hit; bool bHit = false;
+	bool bHit = false;
 
 	// 3.1: primeiro blocking encontrado
 	for (const FHitResult& H : Hits)
 	{
 		if (H.bBlockingHit)
 		{
-			Hit = H; bHit = true;
+			OutHit = H; bHit = true;
 			break;
 		}
 	}
 
 	// 3.2: furar a cpsula  trocar por SkeletalMesh do mesmo ator, se existir logo depois
-	if (bHit && Hit.Component.IsValid() && Hit.Component->IsA<UCapsuleComponent>() && Hit.GetActor())
+	if (bHit && OutHit.Component.IsValid() && OutHit.Component->IsA<UCapsuleComponent>() && OutHit.GetActor())
 	{
 		for (const FHitResult& H : Hits)
 		{
-			if (H.GetActor() == Hit.GetActor() &&
+			if (H.GetActor() == OutHit.GetActor() &&
 				H.Component.IsValid() && H.Component->IsA<USkeletalMeshComponent>() &&
 				H.bBlockingHit)
 			{
-				Hit = H; // agora temos o mesh (e possivelmente BoneName)
+				OutHit = H; // agora temos o mesh (e possivelmente BoneName)
 				break;
 			}
 		}
 	}
 
+	return bHit;
+}
+
+bool AWeaponBase::TraceHitboxes(const UZombieHitboxSubsystem& Hitboxes, const FVector& MuzzleWorld, const FVector& End, AZNodeCharacter* Shooter, FHitResult& OutHit) const
+{
 	/* ---------------------------------------------------------
-	   4) Fallback: sem BoneName? Marca "head" por proximidade do socket
+	   1) Hitboxes analticas (esfera da cabea + cpsulas)
 	----------------------------------------------------------*/
-	if (bHit && Hit.BoneName.IsNone())
-	{
-		if (ACharacter* Char = Cast<ACharacter>(Hit.GetActor()))
-		{
-			if (USkeletalMeshComponent* Skel = Char->GetMesh())
-			{
-				static const FName HeadName(TEXT("head"));
-				if (Skel->DoesSocketExist(HeadName))
-				{
-					const float DistToHead = FVector::Distance(Skel->GetSocketLocation(HeadName), Hit.ImpactPoint);
-					// Ajuste conforme o seu esqueleto (2035 uu  um bom ponto de partida)
-					if (DistToHead <= 30.f)
-					{
-						Hit.BoneName = HeadName;
-					}
-				}
-			}
-		}
-	}
+	const FVector Dir = (End - MuzzleWorld).GetSafeNormal();
+
+	FZombieHitboxHit ZombieHit;
+	TArray<AActor*, FFrameScratchAllocator> Candidates;
+	const bool bZombieHit = Hitboxes.Raycast(MuzzleWorld, Dir, TraceRange, ZombieHit, Shooter, &Candidates);
 
 	/* ---------------------------------------------------------
-	   5) Debug visual (linha/ponto + texto no ponto final)
+	   2) Ocluso: trace simples at o zumbi (ou at o fim),
+		  ignorando os zumbis candidatos (j resolvidos acima)
 	----------------------------------------------------------*/
-	const FVector EndPoint = bHit ? Hit.ImpactPoint : End;
+	const FVector OcclusionEnd = bZombieHit ? MuzzleWorld + Dir * ZombieHit.Distance : End;
 
-	if (bDebugTrace)
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(WeaponFireOcclusion), /*bTraceComplex*/ false, Shooter);
+	Params.bReturnPhysicalMaterial = false;
+	Params.TraceTag = TEXT("WeaponFire");
+	for (AActor* Candidate : Candidates)
 	{
-		DrawDebugLine(World, MuzzleWorld, EndPoint, bHit ? FColor::Red : FColor::Green, false, 1.5f, 0, 2.5f);
-		DrawDebugPoint(World, EndPoint, 12.f, bHit ? FColor::Red : FColor::Green, false, 1.5f);
-
-		const FString Bone = Hit.BoneName.IsNone() ? TEXT("None") : Hit.BoneName.ToString();
-		const FString Comp = Hit.Component.IsValid() ? Hit.Component->GetName() : TEXT("None");
-		const FString Act = Hit.GetActor() ? Hit.GetActor()->GetName() : TEXT("None");
-		const float   Dist = FVector::Distance(MuzzleWorld, EndPoint);
-
-		const FString Msg = FString::Printf(TEXT("Hit: %s\nComp: %s\nBone: %s\nDist: %.0f\nBlocking:%d"),
-			*Act, *Comp, *Bone, Dist, bHit && Hit.bBlockingHit ? 1 : 0);
-
-		DrawDebugString(World, EndPoint + FVector(0, 0, 18), Msg, nullptr, FColor::White, 1.5f, true);
+		Params.AddIgnoredActor(Candidate);
 	}
 
-	/* ---------------------------------------------------------
-	   6) Aplicar dano (BoneName pode ter sido ajustado pelo fallback)
-	----------------------------------------------------------*/
-	if (bHit && Hit.GetActor())
+	if (GetWorld()->LineTraceSingleByChannel(OutHit, MuzzleWorld, OcclusionEnd, ECC_Visibility, Params))
 	{
-		const float Mult = GetBoneMultiplier(Hit.BoneName);
-		const float FinalDamage = BaseDamage * Mult;
-		const FVector ShotDir = Dir; // direo do disparo
+		if (bDebugTrace)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[Hitbox] Bloqueado por %s antes do zumbi"), OutHit.GetActor() ? *OutHit.GetActor()->GetName() : TEXT("None"));
+		}
+		return true;
+	}
 
-		UGameplayStatics::ApplyPointDamage(
-			Hit.GetActor(), FinalDamage, ShotDir, Hit,
-			Shooter->GetController(), this, UDamageType::StaticClass());
+	if (!bZombieHit)
+	{
+		return false;
 	}
 
 	/* ---------------------------------------------------------
-	   7) Consumo de munio e controle de cadncia
+	   3) Monta o FHitResult a partir da hitbox
 	----------------------------------------------------------*/
-	AmmoInMag = FMath::Max(AmmoInMag - 1, 0);
-	LastFireTime = FPlatformTime::Seconds();
+	OutHit = MakeHitboxHit(ZombieHit, MuzzleWorld, Dir);
 
-	if (AmmoInMag == 0 && ReserveAmmo > 0)
+	if (bDebugTrace)
 	{
-		StartReload(Shooter);
+		UE_LOG(LogTemp, Warning, TEXT("[Hitbox] Act=%s  Zona=%s  Dist=%.0f  Candidatos=%d"),
+			*OutHit.GetActor()->GetName(), *OutHit.BoneName.ToString(), ZombieHit.Distance, Candidates.Num());
 	}
 
 	return true;
@@ -186,9 +442,18 @@ void AWeaponBase::StartReload(AZNodeCharacter* Shooter)
 
 	bIsReloading = true;
 
-	FTimerDelegate Del;
-	Del.BindUObject(this, &AWeaponBase::FinishReload);
-	GetWorldTimerManager().SetTimer(TH_Reload, Del, ReloadTime, false);
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->Schedule<&AWeaponBase::FinishReload>(this, ReloadTime);
+	}
+}
+
+bool AWeaponBase::AddReserveAmmo(int32 Amount)
+{
+	if (Amount <= 0 || ReserveAmmo >= MaxReserveAmmo) return false;
+
+	ReserveAmmo = FMath::Min(ReserveAmmo + Amount, MaxReserveAmmo);
+	return true;
 }
 
 void AWeaponBase::FinishReload()
@@ -2,9 +2,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "GameplayRandomSubsystem.h"
 #include "WeaponBase.generated.h"
 
 class AZNodeCharacter;
+class UZombieHitboxSubsystem;
+struct FZombieHitboxHit;
 
 UCLASS(Blueprintable)
 class ZNODE_API AWeaponBase : public AActor
@@ -26,6 +29,18 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Fire", meta = (ClampMin = "1000"))
 	float TraceRange = 1000000.0f;
 
+	/** Usa as hitboxes analíticas dos zumbis (esfera/cápsulas) em vez do trace complexo nos triângulos do mesh */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Fire")
+	bool bUseAnalyticHitboxes = true;
+
+	/** Pellets por disparo (> 1 = espingarda). BaseDamage vale por pellet; o dano é somado por alvo num único evento */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Spread", meta = (ClampMin = "1"))
+	int32 PelletsPerShot = 1;
+
+	/** Abertura total do cone dos pellets, em graus */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Spread", meta = (ClampMin = "0", ClampMax = "90", EditCondition = "PelletsPerShot > 1"))
+	float SpreadAngle = 10.f;
+
 	/* ------------------- Munição ------------------- */
 	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Ammo", meta = (ClampMin = "1"))
 	int32 MagazineSize = 12;
@@ -36,6 +51,10 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Ammo", meta = (ClampMin = "0"))
 	int32 ReserveAmmo = 60;
 
+	/** Limite da reserva ao coletar munição dos drops */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Ammo", meta = (ClampMin = "0"))
+	int32 MaxReserveAmmo = 240;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Ammo", meta = (ClampMin = "0.1"))
 	float ReloadTime = 1.6f;
 
@@ -49,6 +68,9 @@ public:
 	bool TryFire(const FVector& MuzzleWorld, const FVector& DesiredTarget, AZNodeCharacter* Shooter);
 
 	void StartReload(AZNodeCharacter* Shooter);
+
+	/** Soma munição na reserva (até MaxReserveAmmo); false se já estava cheia */
+	bool AddReserveAmmo(int32 Amount);
 	bool IsReloading() const { return bIsReloading; }
 
 protected:
@@ -58,11 +80,31 @@ private:
 	bool CanFire() const;
 	void FinishReload();
 
+	/** Trace complexo (triângulos) no canal Visibility; troca a cápsula pelo mesh do mesmo ator */
+	bool TraceComplex(const FVector& MuzzleWorld, const FVector& End, AZNodeCharacter* Shooter, FHitResult& OutHit) const;
+
+	/** Raio contra as hitboxes analíticas + trace simples de oclusão até o zumbi */
+	bool TraceHitboxes(const UZombieHitboxSubsystem& Hitboxes, const FVector& MuzzleWorld, const FVector& End, AZNodeCharacter* Shooter, FHitResult& OutHit) const;
+
+	/** Dispara PelletsPerShot raios no cone, com uma broad phase só p/ todos */
+	void FirePellets(const FVector& MuzzleWorld, const FVector& Dir, AZNodeCharacter* Shooter);
+
+	/** Monta um FHitResult a partir de um hit nas hitboxes analíticas */
+	FHitResult MakeHitboxHit(const FZombieHitboxHit& ZombieHit, const FVector& MuzzleWorld, const FVector& Dir) const;
+
+	/** Hit sem BoneName (cápsula/trace simples): marca "head" se o impacto estiver perto do socket da cabeça */
+	static void ApplyHeadFallback(FHitResult& Hit);
+
+	/** Munição e cadência depois de um disparo */
+	void ConsumeShot(AZNodeCharacter* Shooter);
+
 	/** Multiplicador por osso (head = 2.0, etc.) */
 	float GetBoneMultiplier(const FName& Bone) const;
 
 private:
-	FTimerHandle TH_Reload;
 	double LastFireTime = -BIG_NUMBER;
 	bool bIsReloading = false;
+
+	/** Dispersão dos pellets */
+	FGameplayRandomStream SpreadStream;
 };
@@ -17,11 +17,19 @@ public class ZNode : ModuleRules
 			"AIModule",
 			"StateTreeModule",
 			"GameplayStateTreeModule",
+			"GameplayTags",
+			"NavigationSystem",
 			"UMG"
 		});
 
 		PrivateDependencyModuleNames.AddRange(new string[] { });
 
+		// editor only bakes
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("UnrealEd");
+		}
+
 		PublicIncludePaths.AddRange(new string[] {
 			"ZNode",
 			"ZNode/Variant_Platforming",
@@ -7,6 +7,9 @@
 #include "Components/PrimitiveComponent.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "WeaponBase.h" // <--- include da arma
+#include "FrameScratchAllocator.h"
+#include "BoneTransformCacheComponent.h"
+#include "GameplayTimerSubsystem.h"
 
 /* ---------------- Constructor ---------------- */
 AZNodeCharacter::AZNodeCharacter()
@@ -25,6 +28,8 @@ AZNodeCharacter::AZNodeCharacter()
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName);
 	FollowCamera->bUsePawnControlRotation = false;
 
+	BoneCache = CreateDefaultSubobject<UBoneTransformCacheComponent>(TEXT("BoneCache"));
+
 	bUseControllerRotationYaw = false;
 	GetCharacterMovement()->bOrientRotationToMovement = true;
 }
@@ -37,6 +42,9 @@ void AZNodeCharacter::BeginPlay()
 	if (AController* C = GetController())
 		C->SetControlRotation(FRotator(0.f, 45.f, 0.f));
 
+	// Resolve o socket do tiro uma vez só
+	MuzzleSlot = BoneCache->FindSlot(TEXT("head"));
+
 	if (APlayerController* PC = Cast<APlayerController>(Controller))
 	{
 		if (auto* SubSys =
@@ -46,6 +54,9 @@ void AZNodeCharacter::BeginPlay()
 		}
 	}
 
+	// Tick volta a rodar quando o personagem se mexe
+	OnCharacterMovementUpdated.AddDynamic(this, &AZNodeCharacter::HandleMovementUpdated);
+
 	// ------- Spawn da arma padrão (DENTRO DE UMA FUNÇÃO MEMBRO) -------
 	if (DefaultWeaponClass)
 	{
@@ -57,8 +68,10 @@ void AZNodeCharacter::BeginPlay()
 /* ---------------- Tick ---------------- */
 void AZNodeCharacter::Tick(float DeltaTime)
 {
+	FTickAuditScope AuditScope(this);
+
 	Super::Tick(DeltaTime);
-	UpdateObstacleFade();
+	const bool bFadeChanged = UpdateObstacleFade();
 
 	if (bIsAiming)
 	{
@@ -79,6 +92,46 @@ void AZNodeCharacter::Tick(float DeltaTime)
 	{
 		AimYaw = 0.f;
 	}
+
+	// Ocioso = sem mirar, câmera parada e nada entrou/saiu do fade
+	const FVector CameraLocation = FollowCamera->GetComponentLocation();
+	const bool bDidWork = bIsAiming || bFadeChanged || !CameraLocation.Equals(LastCameraLocation, 0.1f);
+	LastCameraLocation = CameraLocation;
+
+	AuditScope.SetDidWork(bDidWork);
+	if (TickDormancy.Update(this, DeltaTime, bDidWork))
+	{
+		// Dormindo: o fade segue num timer de baixa frequência
+		if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+		{
+			Timers->Reschedule<&AZNodeCharacter::CheckFadeWhileDormant>(this, DormantFadeInterval);
+		}
+	}
+}
+
+void AZNodeCharacter::CheckFadeWhileDormant()
+{
+	if (!TickDormancy.IsDormant()) return;
+
+	// Algo entrou/saiu da linha da câmera: volta a tickar
+	if (UpdateObstacleFade())
+	{
+		TickDormancy.Wake(this);
+		return;
+	}
+
+	if (UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>())
+	{
+		Timers->Schedule<&AZNodeCharacter::CheckFadeWhileDormant>(this, DormantFadeInterval);
+	}
+}
+
+void AZNodeCharacter::HandleMovementUpdated(float DeltaSeconds, FVector OldLocation, FVector OldVelocity)
+{
+	if (TickDormancy.IsDormant() && !GetActorLocation().Equals(OldLocation, 0.1f))
+	{
+		TickDormancy.Wake(this);
+	}
 }
 
 /* ---------------- Setup Input ---------------- */
@@ -109,14 +162,16 @@ void AZNodeCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComp
 void AZNodeCharacter::Move(const FInputActionValue& V)
 {
 	const FVector2D Axis = V.Get<FVector2D>(); if (Axis.IsNearlyZero()) return;
+	TickDormancy.Wake(this);
 	const FRotator YawRot(0.f, Controller->GetControlRotation().Yaw, 0.f);
 	const FVector Fwd = FRotationMatrix(YawRot).GetUnitAxis(EAxis::X);
 	const FVector Rgt = FRotationMatrix(YawRot).GetUnitAxis(EAxis::Y);
 	AddMovementInput(Fwd, Axis.Y); AddMovementInput(Rgt, Axis.X);
 }
-void AZNodeCharacter::Look(const FInputActionValue& V) { if (bIsAiming) return; AddControllerYawInput(V.Get<FVector2D>().X); }
+void AZNodeCharacter::Look(const FInputActionValue& V) { if (bIsAiming) return; TickDormancy.Wake(this); AddControllerYawInput(V.Get<FVector2D>().X); }
 void AZNodeCharacter::Zoom(const FInputActionValue& V) {
 	const float D = V.Get<float>(); if (FMath::IsNearlyZero(D)) return;
+	TickDormancy.Wake(this);
 	const float T = FMath::Clamp(CameraBoom->TargetArmLength - D * 150.f, MinZoom, MaxZoom);
 	CameraBoom->TargetArmLength = FMath::FInterpTo(CameraBoom->TargetArmLength, T,
 		GetWorld()->GetDeltaSeconds(), ZoomInterpSpeed);
@@ -126,6 +181,7 @@ void AZNodeCharacter::Zoom(const FInputActionValue& V) {
 void AZNodeCharacter::StartAim()
 {
 	bIsAiming = true;
+	TickDormancy.Wake(this);
 	if (APlayerController* PC = Cast<APlayerController>(Controller))
 	{
 		PC->bShowMouseCursor = true;
@@ -135,6 +191,7 @@ void AZNodeCharacter::StartAim()
 void AZNodeCharacter::StopAim()
 {
 	bIsAiming = false;
+	TickDormancy.Wake(this);
 	if (APlayerController* PC = Cast<APlayerController>(Controller))
 	{
 		PC->bShowMouseCursor = false;
@@ -149,9 +206,7 @@ void AZNodeCharacter::Fire()
 
 	// Ponto inicial: cabeça (socket "head") ou olhos
 	FVector Muzzle = GetActorLocation() + FVector(0.f, 0.f, BaseEyeHeight);
-	if (USkeletalMeshComponent* MeshComp = GetMesh())
-		if (MeshComp->DoesSocketExist(TEXT("head")))
-			Muzzle = MeshComp->GetSocketLocation(TEXT("head"));
+	BoneCache->GetSocketLocation(MuzzleSlot, Muzzle); // mantém os olhos se não tiver o socket
 
 	const FVector Target = GetAimTargetPoint();
 
@@ -184,28 +239,41 @@ FVector AZNodeCharacter::GetAimTargetPoint() const
 }
 
 /* -------- esconde obstáculos -------- */
-void AZNodeCharacter::UpdateObstacleFade()
+bool AZNodeCharacter::UpdateObstacleFade()
 {
 	const FVector Cam = FollowCamera->GetComponentLocation();
 	const FVector Target = GetActorLocation();
 
-	TArray<FHitResult> Hits;
+	FScopedHitResults ScopedHits;
+	TArray<FHitResult>& Hits = ScopedHits.Get();
 	FCollisionQueryParams P(SCENE_QUERY_STAT(ObsFade), true, this);
 	GetWorld()->LineTraceMultiByChannel(Hits, Cam, Target, ECC_Visibility, P);
 
-	TSet<TWeakObjectPtr<UPrimitiveComponent>> Current;
+	// poucos hits por frame: array linear no scratch em vez de TSet
+	TArray<TWeakObjectPtr<UPrimitiveComponent>, FFrameScratchAllocator> Current;
 	for (const FHitResult& H : Hits)
 	{
 		if (UPrimitiveComponent* C = H.GetComponent())
 		{
 			if (C->GetOwner() == this) continue;
 			C->SetVisibility(false, true);
-			Current.Add(C);
+			Current.AddUnique(C);
 		}
 	}
-	for (auto Old : FadedComponents)
-		if (Old.IsValid() && !Current.Contains(Old))
-			Old->SetVisibility(true, true);
+	bool bChanged = Current.Num() != FadedComponents.Num();
+	for (const TWeakObjectPtr<UPrimitiveComponent>& Old : FadedComponents)
+	{
+		if (!Current.Contains(Old))
+		{
+			bChanged = true;
+			if (Old.IsValid())
+				Old->SetVisibility(true, true);
+		}
+	}
+
+	// reaproveita a capacidade de FadedComponents
+	FadedComponents.Reset();
+	FadedComponents.Append(Current);
 
-	FadedComponents = Current.Array();
+	return bChanged;
 }
@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "InputActionValue.h"
+#include "TickAuditSubsystem.h"
 #include "ZNodeCharacter.generated.h"
 
 class UCameraComponent;
@@ -11,6 +12,7 @@ class UInputMappingContext;
 class UInputAction;
 class UPrimitiveComponent;
 class AWeaponBase; // <- forward declaration da arma
+class UBoneTransformCacheComponent;
 
 UCLASS()
 class ZNODE_API AZNodeCharacter : public ACharacter
@@ -24,6 +26,8 @@ public:
 	virtual void Tick(float DeltaTime) override;
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
+	AWeaponBase* GetCurrentWeapon() const { return CurrentWeapon; } // usado pelos drops de munição
+
 protected:
 	// Input
 	void Move(const FInputActionValue& Value);
@@ -37,7 +41,12 @@ protected:
 
 	// Helpers
 	FVector GetAimTargetPoint() const; // cursor → mundo
-	void    UpdateObstacleFade();      // oculta obstáculos
+	bool    UpdateObstacleFade();      // oculta obstáculos; true se o conjunto ocultado mudou
+	void    CheckFadeWhileDormant();   // fade em baixa frequência enquanto o tick dorme
+
+	// Acorda o tick quando o movimento (inclusive externo: knockback, plataformas) mexe no personagem
+	UFUNCTION()
+	void HandleMovementUpdated(float DeltaSeconds, FVector OldLocation, FVector OldVelocity);
 
 private:
 	// Componentes de câmera
@@ -47,6 +56,12 @@ private:
 	UPROPERTY(VisibleAnywhere, Category = "Camera")
 	UCameraComponent* FollowCamera = nullptr;
 
+	// Cache de sockets/ossos do mesh (muzzle do tiro, head dos hits)
+	UPROPERTY(VisibleAnywhere, Category = "Components")
+	UBoneTransformCacheComponent* BoneCache = nullptr;
+
+	int32 MuzzleSlot = INDEX_NONE; // slot do socket "head", resolvido no BeginPlay
+
 	// Enhanced Input
 	UPROPERTY(EditDefaultsOnly, Category = "Input")
 	TObjectPtr<UInputMappingContext> DefaultMappingContext = nullptr;
@@ -97,6 +112,14 @@ private:
 	// Fade runtime
 	TArray<TWeakObjectPtr<UPrimitiveComponent>> FadedComponents;
 
+	// Tick dormente: parado, sem mirar, câmera parada e fade estável não precisa de tick
+	FTickDormancy TickDormancy;
+	FVector LastCameraLocation = FVector::ZeroVector;
+
+	// Zumbis podem entrar/sair da linha câmera→personagem com a câmera parada: o fade continua rodando nesse intervalo
+	UPROPERTY(EditDefaultsOnly, Category = "Camera|Fade", meta = (ClampMin = "0.05"))
+	float DormantFadeInterval = 0.2f;
+
 	// Arma
 	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
 	TSubclassOf<AWeaponBase> DefaultWeaponClass;   // <--- NOVO: classe da arma
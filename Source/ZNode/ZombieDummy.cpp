@@ -1,5 +1,8 @@
 #include "ZombieDummy.h"
 #include "HealthComponent.h"
+#include "ZombieHitboxComponent.h"
+#include "BoneTransformCacheComponent.h"
+#include "LootDropSubsystem.h"
 #include "Components/SkeletalMeshComponent.h"
 
 AZombieDummy::AZombieDummy()
@@ -7,6 +10,8 @@ AZombieDummy::AZombieDummy()
     PrimaryActorTick.bCanEverTick = false;
 
     HealthComponent = CreateDefaultSubobject<UHealthComponent>(TEXT("HealthComponent"));
+    HitboxComponent = CreateDefaultSubobject<UZombieHitboxComponent>(TEXT("HitboxComponent"));
+    BoneCache = CreateDefaultSubobject<UBoneTransformCacheComponent>(TEXT("BoneCache"));
 
     // Recomendaes de coliso pro tiro pegar no Mesh
     if (USkeletalMeshComponent* MeshComp = GetMesh())
@@ -16,3 +21,24 @@ AZombieDummy::AZombieDummy()
         MeshComp->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
     }
 }
+
+void AZombieDummy::BeginPlay()
+{
+    Super::BeginPlay();
+
+    // Drops vm do pool; deixa alguns prontos antes da primeira morte
+    if (ULootDropSubsystem* Loot = GetWorld()->GetSubsystem<ULootDropSubsystem>())
+    {
+        Loot->Prewarm(LootTable.DropClass, LootTable.PrewarmedDrops);
+    }
+
+    HealthComponent->OnDeath.AddDynamic(this, &AZombieDummy::HandleDeath);
+}
+
+void AZombieDummy::HandleDeath(AActor* OwnerActor)
+{
+    if (ULootDropSubsystem* Loot = GetWorld()->GetSubsystem<ULootDropSubsystem>())
+    {
+        Loot->SpawnDrops(GetActorLocation(), LootTable);
+    }
+}
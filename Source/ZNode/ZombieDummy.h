@@ -1,9 +1,12 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "LootDrop.h"
 #include "ZombieDummy.generated.h"
 
 class UHealthComponent;
+class UZombieHitboxComponent;
+class UBoneTransformCacheComponent;
 
 UCLASS()
 class ZNODE_API AZombieDummy : public ACharacter
@@ -13,6 +16,22 @@ public:
     AZombieDummy();
 
 protected:
+    virtual void BeginPlay() override;
+
+    /** Rola a tabela de loot no subsystem de drops quando morre */
+    UFUNCTION()
+    void HandleDeath(AActor* OwnerActor);
+
+    /** O que cai quando o zumbi morre (munio/vida, do pool de drops) */
+    UPROPERTY(EditAnywhere, Category = "Loot")
+    FLootDropTable LootTable;
+
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
     UHealthComponent* HealthComponent; // aparece no Details
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+    UZombieHitboxComponent* HitboxComponent; // hitboxes analticas p/ os tiros
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+    UBoneTransformCacheComponent* BoneCache; // socket "head" p/ headshot por proximidade
 };
@@ -0,0 +1,369 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ZombieHitboxComponent.h"
+#include "ZombieHitboxSubsystem.h"
+#include "ServerAnimation.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Character.h"
+#include "Engine/World.h"
+
+namespace ZombieHitbox
+{
+	/** Distance returned for lanes that missed */
+	static constexpr float NoHit = UE_BIG_NUMBER;
+
+	/** Offsets of each stream inside a block */
+	enum EStream
+	{
+		StartX = 0,
+		StartY = LanesPerBlock,
+		StartZ = LanesPerBlock * 2,
+		EndX = LanesPerBlock * 3,
+		EndY = LanesPerBlock * 4,
+		EndZ = LanesPerBlock * 5,
+		Radius = LanesPerBlock * 6
+	};
+
+	/** Dot product of two vectors split across registers */
+	FORCEINLINE VectorRegister4Float Dot3(const VectorRegister4Float& AX, const VectorRegister4Float& AY, const VectorRegister4Float& AZ, const VectorRegister4Float& BX, const VectorRegister4Float& BY, const VectorRegister4Float& BZ)
+	{
+		return VectorMultiplyAdd(AX, BX, VectorMultiplyAdd(AY, BY, VectorMultiply(AZ, BZ)));
+	}
+
+	/** Entry distance of the ray into a sphere for every lane, or NoHit */
+	FORCEINLINE VectorRegister4Float RaySpheres(const VectorRegister4Float& B, const VectorRegister4Float& C, const VectorRegister4Float& Zero, const VectorRegister4Float& Miss)
+	{
+		// B is the dot of the direction and the vector from the center to the origin, C is the origin's squared distance minus the squared radius
+		const VectorRegister4Float H = VectorSubtract(VectorMultiply(B, B), C);
+		const VectorRegister4Float T = VectorSubtract(VectorNegate(B), VectorSqrt(VectorMax(H, Zero)));
+		const VectorRegister4Float Valid = VectorBitwiseAnd(VectorCompareGE(H, Zero), VectorCompareGE(T, Zero));
+
+		return VectorSelect(Valid, T, Miss);
+	}
+
+	int32 RaycastBlocks(const float* Blocks, int32 NumBlocks, const FVector3f& Origin, const FVector3f& Direction, float MaxDistance, float& OutDistance)
+	{
+		const VectorRegister4Float OX = VectorSetFloat1(Origin.X);
+		const VectorRegister4Float OY = VectorSetFloat1(Origin.Y);
+		const VectorRegister4Float OZ = VectorSetFloat1(Origin.Z);
+		const VectorRegister4Float DX = VectorSetFloat1(Direction.X);
+		const VectorRegister4Float DY = VectorSetFloat1(Direction.Y);
+		const VectorRegister4Float DZ = VectorSetFloat1(Direction.Z);
+		const VectorRegister4Float Zero = VectorZeroFloat();
+		const VectorRegister4Float Miss = VectorSetFloat1(NoHit);
+		const VectorRegister4Float Epsilon = VectorSetFloat1(UE_KINDA_SMALL_NUMBER);
+
+		VectorRegister4Float Best = VectorSetFloat1(MaxDistance);
+		VectorRegister4Float BestIndex = VectorSetFloat1(-1.0f);
+		VectorRegister4Float LaneIndex = MakeVectorRegisterFloat(0.0f, 1.0f, 2.0f, 3.0f);
+		const VectorRegister4Float LaneStep = VectorSetFloat1(static_cast<float>(LanesPerBlock));
+
+		for (int32 BlockIndex = 0; BlockIndex < NumBlocks; ++BlockIndex)
+		{
+			const float* Block = Blocks + BlockIndex * FloatsPerBlock;
+
+			const VectorRegister4Float AX = VectorLoadAligned(Block + StartX);
+			const VectorRegister4Float AY = VectorLoadAligned(Block + StartY);
+			const VectorRegister4Float AZ = VectorLoadAligned(Block + StartZ);
+			const VectorRegister4Float BX = VectorLoadAligned(Block + EndX);
+			const VectorRegister4Float BY = VectorLoadAligned(Block + EndY);
+			const VectorRegister4Float BZ = VectorLoadAligned(Block + EndZ);
+			const VectorRegister4Float R = VectorLoadAligned(Block + Radius);
+			const VectorRegister4Float RR = VectorMultiply(R, R);
+
+			// capsule axis, and the origin relative to both ends
+			const VectorRegister4Float BAX = VectorSubtract(BX, AX);
+			const VectorRegister4Float BAY = VectorSubtract(BY, AY);
+			const VectorRegister4Float BAZ = VectorSubtract(BZ, AZ);
+			const VectorRegister4Float OAX = VectorSubtract(OX, AX);
+			const VectorRegister4Float OAY = VectorSubtract(OY, AY);
+			const VectorRegister4Float OAZ = VectorSubtract(OZ, AZ);
+			const VectorRegister4Float OBX = VectorSubtract(OX, BX);
+			const VectorRegister4Float OBY = VectorSubtract(OY, BY);
+			const VectorRegister4Float OBZ = VectorSubtract(OZ, BZ);
+
+			const VectorRegister4Float BaBa = Dot3(BAX, BAY, BAZ, BAX, BAY, BAZ);
+			const VectorRegister4Float BaRd = Dot3(BAX, BAY, BAZ, DX, DY, DZ);
+			const VectorRegister4Float BaOa = Dot3(BAX, BAY, BAZ, OAX, OAY, OAZ);
+			const VectorRegister4Float RdOa = Dot3(DX, DY, DZ, OAX, OAY, OAZ);
+			const VectorRegister4Float OaOa = Dot3(OAX, OAY, OAZ, OAX, OAY, OAZ);
+			const VectorRegister4Float RdOb = Dot3(DX, DY, DZ, OBX, OBY, OBZ);
+			const VectorRegister4Float ObOb = Dot3(OBX, OBY, OBZ, OBX, OBY, OBZ);
+
+			// entry into the infinite cylinder around the axis
+			const VectorRegister4Float A = VectorNegateMultiplyAdd(BaRd, BaRd, BaBa);
+			const VectorRegister4Float B = VectorNegateMultiplyAdd(BaOa, BaRd, VectorMultiply(BaBa, RdOa));
+			const VectorRegister4Float C = VectorSubtract(VectorNegateMultiplyAdd(BaOa, BaOa, VectorMultiply(BaBa, OaOa)), VectorMultiply(RR, BaBa));
+			const VectorRegister4Float H = VectorNegateMultiplyAdd(A, C, VectorMultiply(B, B));
+			const VectorRegister4Float SafeA = VectorMax(A, Epsilon);
+			const VectorRegister4Float CylinderT = VectorDivide(VectorSubtract(VectorNegate(B), VectorSqrt(VectorMax(H, Zero))), SafeA);
+			const VectorRegister4Float Y = VectorMultiplyAdd(CylinderT, BaRd, BaOa);
+
+			// the cylinder entry only counts if it lands between the two ends
+			VectorRegister4Float CylinderValid = VectorBitwiseAnd(VectorCompareGE(H, Zero), VectorCompareGT(A, Epsilon));
+			CylinderValid = VectorBitwiseAnd(CylinderValid, VectorBitwiseAnd(VectorCompareGT(Y, Zero), VectorCompareLT(Y, BaBa)));
+			CylinderValid = VectorBitwiseAnd(CylinderValid, VectorCompareGE(CylinderT, Zero));
+
+			// otherwise the ray enters through one of the end spheres
+			const VectorRegister4Float CapA = RaySpheres(RdOa, VectorSubtract(OaOa, RR), Zero, Miss);
+			const VectorRegister4Float CapB = RaySpheres(RdOb, VectorSubtract(ObOb, RR), Zero, Miss);
+
+			VectorRegister4Float T = VectorMin(VectorSelect(CylinderValid, CylinderT, Miss), VectorMin(CapA, CapB));
+
+			// unused lanes have no radius
+			T = VectorSelect(VectorCompareGT(R, Zero), T, Miss);
+
+			// keep the nearest hit for each lane
+			const VectorRegister4Float Closer = VectorCompareLT(T, Best);
+			Best = VectorSelect(Closer, T, Best);
+			BestIndex = VectorSelect(Closer, LaneIndex, BestIndex);
+			LaneIndex = VectorAdd(LaneIndex, LaneStep);
+		}
+
+		// reduce the four lanes
+		alignas(16) float BestLanes[LanesPerBlock];
+		alignas(16) float IndexLanes[LanesPerBlock];
+		VectorStoreAligned(Best, BestLanes);
+		VectorStoreAligned(BestIndex, IndexLanes);
+
+		int32 HitIndex = INDEX_NONE;
+		OutDistance = MaxDistance;
+
+		for (int32 Lane = 0; Lane < LanesPerBlock; ++Lane)
+		{
+			if (IndexLanes[Lane] >= 0.0f && BestLanes[Lane] < OutDistance)
+			{
+				OutDistance = BestLanes[Lane];
+				HitIndex = static_cast<int32>(IndexLanes[Lane]);
+			}
+		}
+
+		return HitIndex;
+	}
+
+	/** Entry distance of a ray into a sphere, or NoHit */
+	static float RaySphere(float B, float C)
+	{
+		const float H = B * B - C;
+		const float T = -B - FMath::Sqrt(FMath::Max(H, 0.0f));
+
+		return H >= 0.0f && T >= 0.0f ? T : NoHit;
+	}
+
+	int32 RaycastBlocksScalar(const float* Blocks, int32 NumBlocks, const FVector3f& Origin, const FVector3f& Direction, float MaxDistance, float& OutDistance)
+	{
+		int32 HitIndex = INDEX_NONE;
+		OutDistance = MaxDistance;
+
+		for (int32 BlockIndex = 0; BlockIndex < NumBlocks; ++BlockIndex)
+		{
+			const float* Block = Blocks + BlockIndex * FloatsPerBlock;
+
+			for (int32 Lane = 0; Lane < LanesPerBlock; ++Lane)
+			{
+				const float R = Block[Radius + Lane];
+
+				if (R <= 0.0f)
+				{
+					continue;
+				}
+
+				const FVector3f Start(Block[StartX + Lane], Block[StartY + Lane], Block[StartZ + Lane]);
+				const FVector3f End(Block[EndX + Lane], Block[EndY + Lane], Block[EndZ + Lane]);
+				const FVector3f BA = End - Start;
+				const FVector3f OA = Origin - Start;
+				const FVector3f OB = Origin - End;
+
+				const float BaBa = BA | BA;
+				const float BaRd = BA | Direction;
+				const float BaOa = BA | OA;
+				const float RdOa = Direction | OA;
+				const float OaOa = OA | OA;
+
+				float T = NoHit;
+
+				// entry into the cylinder between the two ends
+				const float A = BaBa - BaRd * BaRd;
+
+				if (A > UE_KINDA_SMALL_NUMBER)
+				{
+					const float B = BaBa * RdOa - BaOa * BaRd;
+					const float C = BaBa * OaOa - BaOa * BaOa - R * R * BaBa;
+					const float H = B * B - A * C;
+
+					if (H >= 0.0f)
+					{
+						const float CylinderT = (-B - FMath::Sqrt(H)) / A;
+						const float Y = BaOa + CylinderT * BaRd;
+
+						if (Y > 0.0f && Y < BaBa && CylinderT >= 0.0f)
+						{
+							T = CylinderT;
+						}
+					}
+				}
+
+				// entry through the end spheres
+				T = FMath::Min3(T, RaySphere(RdOa, OaOa - R * R), RaySphere(Direction | OB, (OB | OB) - R * R));
+
+				if (T < OutDistance)
+				{
+					OutDistance = T;
+					HitIndex = BlockIndex * LanesPerBlock + Lane;
+				}
+			}
+		}
+
+		return HitIndex;
+	}
+}
+
+UZombieHitboxComponent::UZombieHitboxComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// default hitboxes for the mannequin skeleton
+	auto AddHitbox = [this](const TCHAR* HitZone, const TCHAR* StartBone, const TCHAR* EndBone, float Radius)
+	{
+		FZombieHitboxShape& Shape = Hitboxes.AddDefaulted_GetRef();
+		Shape.HitZone = HitZone;
+		Shape.StartBone = StartBone;
+		Shape.EndBone = EndBone ? FName(EndBone) : NAME_None;
+		Shape.Radius = Radius;
+	};
+
+	AddHitbox(TEXT("head"), TEXT("head"), nullptr, 13.0f);
+	AddHitbox(TEXT("neck_01"), TEXT("neck_01"), TEXT("head"), 7.0f);
+	AddHitbox(TEXT("spine_03"), TEXT("pelvis"), TEXT("neck_01"), 18.0f);
+	AddHitbox(TEXT("upperarm_l"), TEXT("upperarm_l"), TEXT("lowerarm_l"), 6.0f);
+	AddHitbox(TEXT("lowerarm_l"), TEXT("lowerarm_l"), TEXT("hand_l"), 5.0f);
+	AddHitbox(TEXT("upperarm_r"), TEXT("upperarm_r"), TEXT("lowerarm_r"), 6.0f);
+	AddHitbox(TEXT("lowerarm_r"), TEXT("lowerarm_r"), TEXT("hand_r"), 5.0f);
+	AddHitbox(TEXT("thigh_l"), TEXT("thigh_l"), TEXT("calf_l"), 9.0f);
+	AddHitbox(TEXT("calf_l"), TEXT("calf_l"), TEXT("foot_l"), 7.0f);
+	AddHitbox(TEXT("thigh_r"), TEXT("thigh_r"), TEXT("calf_r"), 9.0f);
+	AddHitbox(TEXT("calf_r"), TEXT("calf_r"), TEXT("foot_r"), 7.0f);
+}
+
+void UZombieHitboxComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// follow the character's mesh
+	if (const ACharacter* Character = Cast<ACharacter>(GetOwner()))
+	{
+		Mesh = Character->GetMesh();
+	}
+	else
+	{
+		Mesh = GetOwner()->FindComponentByClass<USkeletalMeshComponent>();
+	}
+
+	if (!Mesh)
+	{
+		return;
+	}
+
+	// let the server skip the pose until a shot needs it
+	if (bSkipServerAnimation)
+	{
+		ServerAnimation::ApplySkipping(Mesh);
+	}
+
+	// cache the bone indices so updates don't look up names
+	StartBoneIndices.Reset(Hitboxes.Num());
+	EndBoneIndices.Reset(Hitboxes.Num());
+
+	for (const FZombieHitboxShape& Shape : Hitboxes)
+	{
+		StartBoneIndices.Add(Mesh->GetBoneIndex(Shape.StartBone));
+		EndBoneIndices.Add(Shape.EndBone.IsNone() ? INDEX_NONE : Mesh->GetBoneIndex(Shape.EndBone));
+	}
+
+	// allocate the blocks, padded with empty lanes
+	const int32 NumBlocks = FMath::DivideAndRoundUp(Hitboxes.Num(), ZombieHitbox::LanesPerBlock);
+	Blocks.SetNumZeroed(NumBlocks * ZombieHitbox::FloatsPerBlock);
+
+	if (UZombieHitboxSubsystem* HitboxSubsystem = GetWorld()->GetSubsystem<UZombieHitboxSubsystem>())
+	{
+		HitboxSubsystem->RegisterHitboxes(this);
+	}
+}
+
+void UZombieHitboxComponent::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	// stop counting the mesh as skipped
+	if (Mesh)
+	{
+		ServerAnimation::RemoveSkipping(Mesh);
+	}
+
+	if (UZombieHitboxSubsystem* HitboxSubsystem = GetWorld()->GetSubsystem<UZombieHitboxSubsystem>())
+	{
+		HitboxSubsystem->UnregisterHitboxes(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+FSphere UZombieHitboxComponent::GetBoundingSphere() const
+{
+	return Mesh ? Mesh->Bounds.GetSphere() : FSphere(GetOwner()->GetActorLocation(), 0.0f);
+}
+
+void UZombieHitboxComponent::UpdateHitboxes()
+{
+	if (!Mesh || LastUpdateFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	LastUpdateFrame = GFrameCounter;
+
+	// evaluate the pose if the mesh is skipping it
+	ServerAnimation::EnsurePose(Mesh);
+
+	for (int32 Index = 0; Index < Hitboxes.Num(); ++Index)
+	{
+		float* Block = Blocks.GetData() + (Index / ZombieHitbox::LanesPerBlock) * ZombieHitbox::FloatsPerBlock;
+		const int32 Lane = Index % ZombieHitbox::LanesPerBlock;
+
+		// skip hitboxes for bones missing from the skeleton
+		if (StartBoneIndices[Index] == INDEX_NONE)
+		{
+			Block[ZombieHitbox::Radius + Lane] = 0.0f;
+			continue;
+		}
+
+		const FVector3f Start(Mesh->GetBoneTransform(StartBoneIndices[Index]).GetLocation());
+		const FVector3f End = EndBoneIndices[Index] != INDEX_NONE ? FVector3f(Mesh->GetBoneTransform(EndBoneIndices[Index]).GetLocation()) : Start;
+
+		Block[ZombieHitbox::StartX + Lane] = Start.X;
+		Block[ZombieHitbox::StartY + Lane] = Start.Y;
+		Block[ZombieHitbox::StartZ + Lane] = Start.Z;
+		Block[ZombieHitbox::EndX + Lane] = End.X;
+		Block[ZombieHitbox::EndY + Lane] = End.Y;
+		Block[ZombieHitbox::EndZ + Lane] = End.Z;
+		Block[ZombieHitbox::Radius + Lane] = Hitboxes[Index].Radius;
+	}
+}
+
+int32 UZombieHitboxComponent::Raycast(const FVector3f& Origin, const FVector3f& Direction, float MaxDistance, float& OutDistance)
+{
+	UpdateHitboxes();
+
+	return ZombieHitbox::RaycastBlocks(Blocks.GetData(), Blocks.Num() / ZombieHitbox::FloatsPerBlock, Origin, Direction, MaxDistance, OutDistance);
+}
+
+FVector UZombieHitboxComponent::GetHitNormal(int32 HitboxIndex, const FVector& Point) const
+{
+	const float* Block = Blocks.GetData() + (HitboxIndex / ZombieHitbox::LanesPerBlock) * ZombieHitbox::FloatsPerBlock;
+	const int32 Lane = HitboxIndex % ZombieHitbox::LanesPerBlock;
+
+	const FVector Start(Block[ZombieHitbox::StartX + Lane], Block[ZombieHitbox::StartY + Lane], Block[ZombieHitbox::StartZ + Lane]);
+	const FVector End(Block[ZombieHitbox::EndX + Lane], Block[ZombieHitbox::EndY + Lane], Block[ZombieHitbox::EndZ + Lane]);
+
+	// the normal points away from the closest point on the capsule axis
+	return (Point - FMath::ClosestPointOnSegment(Point, Start, End)).GetSafeNormal();
+}
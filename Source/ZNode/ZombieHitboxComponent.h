@@ -0,0 +1,121 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ZombieHitboxComponent.generated.h"
+
+class USkeletalMeshComponent;
+
+/**
+ *  A single analytic hitbox, attached to one or two bones.
+ *  With only a start bone it's a sphere around that bone. With an end bone it's a capsule between both bones.
+ */
+USTRUCT(BlueprintType)
+struct FZombieHitboxShape
+{
+	GENERATED_BODY()
+
+	/** Name reported as the hit bone, used by the damage multipliers and headshot checks */
+	UPROPERTY(EditAnywhere, Category="Hitbox")
+	FName HitZone;
+
+	/** Bone at the start of the capsule, or at the center of the sphere */
+	UPROPERTY(EditAnywhere, Category="Hitbox")
+	FName StartBone;
+
+	/** Bone at the end of the capsule. Leave empty for a sphere */
+	UPROPERTY(EditAnywhere, Category="Hitbox")
+	FName EndBone;
+
+	/** Radius of the sphere or capsule */
+	UPROPERTY(EditAnywhere, Category="Hitbox", meta = (ClampMin = 0, Units = "cm"))
+	float Radius = 10.0f;
+};
+
+/**
+ *  SIMD kernels for rays against analytic hitboxes.
+ *  Hitboxes are packed in blocks of four, in structure of arrays order: the start X, Y, Z, end X, Y, Z and radius of all four lanes.
+ *  Spheres are capsules with the same start and end. Unused lanes have a zero radius and are never hit.
+ */
+namespace ZombieHitbox
+{
+	/** Number of hitboxes in a block */
+	static constexpr int32 LanesPerBlock = 4;
+
+	/** Number of floats in a block */
+	static constexpr int32 FloatsPerBlock = LanesPerBlock * 7;
+
+	/** Tests a ray against the hitbox blocks four lanes at a time. Returns the index of the nearest hitbox within MaxDistance, or INDEX_NONE */
+	int32 RaycastBlocks(const float* Blocks, int32 NumBlocks, const FVector3f& Origin, const FVector3f& Direction, float MaxDistance, float& OutDistance);
+
+	/** Scalar reference version of RaycastBlocks, used to validate and benchmark the SIMD kernel */
+	int32 RaycastBlocksScalar(const float* Blocks, int32 NumBlocks, const FVector3f& Origin, const FVector3f& Direction, float MaxDistance, float& OutDistance);
+}
+
+/**
+ *  Compact set of analytic hitboxes for a zombie: a head sphere and capsules for the neck, torso and limbs.
+ *  The hitboxes follow a few bone transforms, refreshed at most once per frame and only when a shot could reach the zombie,
+ *  so bullets can be resolved against exact hit zones without tracing the skeletal mesh triangles.
+ *  On servers, the mesh can skip its pose evaluation entirely, and the pose is evaluated on demand before refreshing the hitboxes.
+ *  The defaults match the UE5 mannequin skeleton.
+ */
+UCLASS(ClassGroup = (Combat), meta = (BlueprintSpawnableComponent))
+class UZombieHitboxComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Hitboxes for this zombie */
+	UPROPERTY(EditAnywhere, Category="Hitboxes")
+	TArray<FZombieHitboxShape> Hitboxes;
+
+	/** Mesh the hitboxes follow */
+	UPROPERTY(Transient)
+	USkeletalMeshComponent* Mesh = nullptr;
+
+	/** Cached bone indices for the start and end of each hitbox */
+	TArray<int32> StartBoneIndices;
+	TArray<int32> EndBoneIndices;
+
+	/** Hitboxes packed for the ray kernel */
+	TArray<float, TAlignedHeapAllocator<16>> Blocks;
+
+	/** Frame the blocks were last refreshed on */
+	uint64 LastUpdateFrame = MAX_uint64;
+
+	/** If true, server meshes skip pose evaluation and the pose is only evaluated when a shot could reach the hitboxes */
+	UPROPERTY(EditAnywhere, Category="Hitboxes")
+	bool bSkipServerAnimation = true;
+
+public:
+
+	/** Constructor */
+	UZombieHitboxComponent();
+
+	/** Finds the mesh, caches the bones and registers with the hitbox subsystem */
+	virtual void BeginPlay() override;
+
+	/** Unregisters from the hitbox subsystem */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+	/** Returns the skeletal mesh the hitboxes follow */
+	USkeletalMeshComponent* GetMesh() const { return Mesh; }
+
+	/** Returns a conservative bounding sphere for all hitboxes, taken from the mesh bounds */
+	FSphere GetBoundingSphere() const;
+
+	/** Refreshes the hitbox blocks from the bone transforms, if they haven't been already this frame */
+	void UpdateHitboxes();
+
+	/** Tests a ray against the hitboxes. Returns the index of the nearest hitbox hit within MaxDistance, or INDEX_NONE */
+	int32 Raycast(const FVector3f& Origin, const FVector3f& Direction, float MaxDistance, float& OutDistance);
+
+	/** Returns the hit zone name for a hitbox */
+	FName GetHitZone(int32 HitboxIndex) const { return Hitboxes[HitboxIndex].HitZone; }
+
+	/** Returns the surface normal of a hitbox at the provided point */
+	FVector GetHitNormal(int32 HitboxIndex, const FVector& Point) const;
+};
@@ -0,0 +1,325 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ZombieHitboxSubsystem.h"
+#include "ZombieHitboxComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogZombieHitboxes, Log, All);
+
+DECLARE_CYCLE_STAT(TEXT("Zombie Hitbox Raycast"), STAT_ZombieHitboxRaycast, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("Zombie Hitbox Cone Query"), STAT_ZombieHitboxCone, STATGROUP_Game);
+
+namespace ZombieHitboxBenchmark
+{
+	/** Number of synthetic hitbox sets used to time the kernels */
+	constexpr int32 SyntheticZombies = 256;
+
+	/** Number of hitbox blocks in each synthetic set */
+	constexpr int32 SyntheticBlocksPerZombie = 3;
+
+	/** Handles the benchmark console command */
+	static void RunCommand(const TArray<FString>& Args, UWorld* World)
+	{
+		const UZombieHitboxSubsystem* Hitboxes = World ? World->GetSubsystem<UZombieHitboxSubsystem>() : nullptr;
+
+		if (!Hitboxes)
+		{
+			UE_LOG(LogZombieHitboxes, Warning, TEXT("The hitbox benchmark can only run in a game world"));
+			return;
+		}
+
+		const int32 NumRays = Args.Num() > 0 && Args[0].IsNumeric() ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000;
+
+		Hitboxes->RunBenchmark(NumRays);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("ZNode.Hitboxes.Benchmark"),
+		TEXT("Times the analytic hitbox ray kernels and compares them against complex traces. Usage: ZNode.Hitboxes.Benchmark [Rays]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunCommand));
+}
+
+bool UZombieHitboxSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UZombieHitboxSubsystem::Deinitialize()
+{
+	Components.Empty();
+
+	Super::Deinitialize();
+}
+
+void UZombieHitboxSubsystem::RegisterHitboxes(UZombieHitboxComponent* Component)
+{
+	Components.AddUnique(Component);
+}
+
+void UZombieHitboxSubsystem::UnregisterHitboxes(UZombieHitboxComponent* Component)
+{
+	Components.RemoveSwap(Component);
+}
+
+bool UZombieHitboxSubsystem::Raycast(const FVector& Origin, const FVector& Direction, float MaxDistance, FZombieHitboxHit& OutHit, const AActor* IgnoredActor, TArray<AActor*, FFrameScratchAllocator>* OutCandidates) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZombieHitboxRaycast);
+
+	bool bHit = false;
+	OutHit.Distance = MaxDistance;
+
+	for (UZombieHitboxComponent* Component : Components)
+	{
+		if (Component->GetOwner() == IgnoredActor)
+		{
+			continue;
+		}
+
+		bool bInBounds;
+		bHit |= RaycastComponent(Component, Origin, Direction, OutHit, bInBounds);
+
+		if (bInBounds && OutCandidates)
+		{
+			OutCandidates->Add(Component->GetOwner());
+		}
+	}
+
+	return bHit;
+}
+
+void UZombieHitboxSubsystem::GatherConeCandidates(const FVector& Origin, const FVector& Direction, float HalfAngle, float MaxDistance, TArray<UZombieHitboxComponent*, FFrameScratchAllocator>& OutCandidates, const AActor* IgnoredActor) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZombieHitboxCone);
+
+	float SinHalfAngle, CosHalfAngle;
+	FMath::SinCos(&SinHalfAngle, &CosHalfAngle, HalfAngle);
+
+	for (UZombieHitboxComponent* Component : Components)
+	{
+		if (Component->GetOwner() == IgnoredActor)
+		{
+			continue;
+		}
+
+		const FSphere Bounds = Component->GetBoundingSphere();
+		const FVector ToCenter = Bounds.Center - Origin;
+		const double Along = FVector::DotProduct(ToCenter, Direction);
+
+		// skip zombies behind the muzzle or out of range
+		if (Along < -Bounds.W || Along > MaxDistance + Bounds.W)
+		{
+			continue;
+		}
+
+		// the sphere touches the cone if its center is within a radius of the cone's surface
+		const double Across = (ToCenter - Direction * Along).Size();
+
+		if (Across * CosHalfAngle - Along * SinHalfAngle <= Bounds.W || ToCenter.SizeSquared() <= FMath::Square(Bounds.W))
+		{
+			OutCandidates.Add(Component);
+		}
+	}
+}
+
+bool UZombieHitboxSubsystem::RaycastCandidates(TConstArrayView<UZombieHitboxComponent*> Candidates, const FVector& Origin, const FVector& Direction, float MaxDistance, FZombieHitboxHit& OutHit) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZombieHitboxRaycast);
+
+	bool bHit = false;
+	OutHit.Distance = MaxDistance;
+
+	for (UZombieHitboxComponent* Component : Candidates)
+	{
+		bool bInBounds;
+		bHit |= RaycastComponent(Component, Origin, Direction, OutHit, bInBounds);
+	}
+
+	return bHit;
+}
+
+bool UZombieHitboxSubsystem::RaycastComponent(UZombieHitboxComponent* Component, const FVector& Origin, const FVector& Direction, FZombieHitboxHit& InOutHit, bool& bOutInBounds)
+{
+	// cull the zombie with its bounding sphere
+	const FSphere Bounds = Component->GetBoundingSphere();
+	const FVector ToCenter = Bounds.Center - Origin;
+	const double Along = FVector::DotProduct(ToCenter, Direction);
+
+	bOutInBounds = Along >= -Bounds.W && Along <= InOutHit.Distance + Bounds.W && (ToCenter - Direction * Along).SizeSquared() <= FMath::Square(Bounds.W);
+
+	if (!bOutInBounds)
+	{
+		return false;
+	}
+
+	// test the hitboxes
+	float Distance;
+	const int32 HitboxIndex = Component->Raycast(FVector3f(Origin), FVector3f(Direction), InOutHit.Distance, Distance);
+
+	if (HitboxIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	InOutHit.Component = Component;
+	InOutHit.HitboxIndex = HitboxIndex;
+	InOutHit.Distance = Distance;
+
+	return true;
+}
+
+void UZombieHitboxSubsystem::RunBenchmark(int32 NumRays) const
+{
+	FRandomStream Random(0);
+
+	// build random hitbox sets around the origin
+	TArray<float, TAlignedHeapAllocator<16>> Blocks;
+	Blocks.SetNumZeroed(ZombieHitboxBenchmark::SyntheticZombies * ZombieHitboxBenchmark::SyntheticBlocksPerZombie * ZombieHitbox::FloatsPerBlock);
+
+	for (int32 Block = 0; Block < Blocks.Num() / ZombieHitbox::FloatsPerBlock; ++Block)
+	{
+		float* Data = Blocks.GetData() + Block * ZombieHitbox::FloatsPerBlock;
+
+		for (int32 Lane = 0; Lane < ZombieHitbox::LanesPerBlock; ++Lane)
+		{
+			const FVector3f Start = FVector3f(Random.VRand()) * Random.FRandRange(0.0f, 2000.0f);
+			const FVector3f End = Start + FVector3f(Random.VRand()) * Random.FRandRange(0.0f, 50.0f);
+
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				Data[Axis * ZombieHitbox::LanesPerBlock + Lane] = Start[Axis];
+				Data[(Axis + 3) * ZombieHitbox::LanesPerBlock + Lane] = End[Axis];
+			}
+
+			Data[6 * ZombieHitbox::LanesPerBlock + Lane] = Random.FRandRange(5.0f, 15.0f);
+		}
+	}
+
+	// random rays through the cloud
+	TArray<FVector3f> Origins;
+	TArray<FVector3f> Directions;
+
+	for (int32 Ray = 0; Ray < NumRays; ++Ray)
+	{
+		Origins.Add(FVector3f(Random.VRand()) * 3000.0f);
+		Directions.Add((FVector3f(Random.VRand()) * 500.0f - Origins.Last()).GetSafeNormal());
+	}
+
+	const int32 NumBlocks = Blocks.Num() / ZombieHitbox::FloatsPerBlock;
+	int32 ScalarHits = 0;
+	int32 SimdHits = 0;
+	int32 Mismatches = 0;
+	float Distance;
+
+	const uint64 ScalarStart = FPlatformTime::Cycles64();
+
+	for (int32 Ray = 0; Ray < NumRays; ++Ray)
+	{
+		ScalarHits += ZombieHitbox::RaycastBlocksScalar(Blocks.GetData(), NumBlocks, Origins[Ray], Directions[Ray], 10000.0f, Distance) != INDEX_NONE;
+	}
+
+	const uint64 SimdStart = FPlatformTime::Cycles64();
+
+	for (int32 Ray = 0; Ray < NumRays; ++Ray)
+	{
+		SimdHits += ZombieHitbox::RaycastBlocks(Blocks.GetData(), NumBlocks, Origins[Ray], Directions[Ray], 10000.0f, Distance) != INDEX_NONE;
+	}
+
+	const uint64 SimdEnd = FPlatformTime::Cycles64();
+
+	// validate the SIMD kernel against the scalar one
+	for (int32 Ray = 0; Ray < NumRays; ++Ray)
+	{
+		float ScalarDistance, SimdDistance;
+		const int32 ScalarIndex = ZombieHitbox::RaycastBlocksScalar(Blocks.GetData(), NumBlocks, Origins[Ray], Directions[Ray], 10000.0f, ScalarDistance);
+		const int32 SimdIndex = ZombieHitbox::RaycastBlocks(Blocks.GetData(), NumBlocks, Origins[Ray], Directions[Ray], 10000.0f, SimdDistance);
+
+		if ((ScalarIndex == INDEX_NONE) != (SimdIndex == INDEX_NONE) || !FMath::IsNearlyEqual(ScalarDistance, SimdDistance, 0.01f))
+		{
+			++Mismatches;
+		}
+	}
+
+	const double ScalarMicroseconds = FPlatformTime::ToMilliseconds64(SimdStart - ScalarStart) * 1000.0 / NumRays;
+	const double SimdMicroseconds = FPlatformTime::ToMilliseconds64(SimdEnd - SimdStart) * 1000.0 / NumRays;
+
+	UE_LOG(LogZombieHitboxes, Log, TEXT("Kernel, %d rays against %d hitboxes: scalar %.3f us/ray, SIMD %.3f us/ray (%.1fx), hits %d/%d, mismatches %d"),
+		NumRays, NumBlocks * ZombieHitbox::LanesPerBlock, ScalarMicroseconds, SimdMicroseconds, SimdMicroseconds > 0.0 ? ScalarMicroseconds / SimdMicroseconds : 0.0, ScalarHits, SimdHits, Mismatches);
+
+	// compare against complex traces on the zombies in the level
+	if (Components.IsEmpty())
+	{
+		UE_LOG(LogZombieHitboxes, Log, TEXT("No zombies with hitboxes in the level, skipping the trace comparison"));
+		return;
+	}
+
+	TArray<FVector> TraceOrigins;
+	TArray<FVector> TraceDirections;
+
+	for (int32 Ray = 0; Ray < NumRays; ++Ray)
+	{
+		// aim at a random zombie from a random nearby point
+		const FSphere Bounds = Components[Random.RandHelper(Components.Num())]->GetBoundingSphere();
+		const FVector Target = Bounds.Center + Random.VRand() * Bounds.W * 0.5;
+
+		TraceOrigins.Add(Target + Random.VRand() * 1000.0);
+		TraceDirections.Add((Target - TraceOrigins.Last()).GetSafeNormal());
+	}
+
+	const float TraceDistance = 2000.0f;
+	int32 AnalyticHits = 0;
+	int32 TraceHits = 0;
+	int32 ActorMismatches = 0;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(HitboxBenchmark), true);
+	TArray<FHitResult> TraceResults;
+	TArray<AActor*> AnalyticActors;
+	AnalyticActors.SetNumZeroed(NumRays);
+
+	const uint64 AnalyticStart = FPlatformTime::Cycles64();
+
+	for (int32 Ray = 0; Ray < NumRays; ++Ray)
+	{
+		FZombieHitboxHit Hit;
+
+		if (Raycast(TraceOrigins[Ray], TraceDirections[Ray], TraceDistance, Hit))
+		{
+			AnalyticActors[Ray] = Hit.Component->GetOwner();
+			++AnalyticHits;
+		}
+	}
+
+	const uint64 TraceStart = FPlatformTime::Cycles64();
+
+	for (int32 Ray = 0; Ray < NumRays; ++Ray)
+	{
+		GetWorld()->LineTraceMultiByChannel(TraceResults, TraceOrigins[Ray], TraceOrigins[Ray] + TraceDirections[Ray] * TraceDistance, ECC_Visibility, QueryParams);
+
+		// find the first skeletal mesh we went through
+		AActor* TraceActor = nullptr;
+
+		for (const FHitResult& Result : TraceResults)
+		{
+			if (Result.GetComponent() && Result.GetComponent()->IsA<USkeletalMeshComponent>())
+			{
+				TraceActor = Result.GetActor();
+				break;
+			}
+		}
+
+		TraceHits += TraceActor != nullptr;
+		ActorMismatches += TraceActor != AnalyticActors[Ray];
+	}
+
+	const uint64 TraceEnd = FPlatformTime::Cycles64();
+
+	const double AnalyticMicroseconds = FPlatformTime::ToMilliseconds64(TraceStart - AnalyticStart) * 1000.0 / NumRays;
+	const double TraceMicroseconds = FPlatformTime::ToMilliseconds64(TraceEnd - TraceStart) * 1000.0 / NumRays;
+
+	UE_LOG(LogZombieHitboxes, Log, TEXT("Level, %d rays against %d zombies: analytic %.3f us/ray, complex trace %.3f us/ray (%.1fx), hits %d/%d, different actors %d"),
+		NumRays, Components.Num(), AnalyticMicroseconds, TraceMicroseconds, AnalyticMicroseconds > 0.0 ? TraceMicroseconds / AnalyticMicroseconds : 0.0, AnalyticHits, TraceHits, ActorMismatches);
+}
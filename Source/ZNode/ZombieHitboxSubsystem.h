@@ -0,0 +1,80 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FrameScratchAllocator.h"
+#include "ZombieHitboxSubsystem.generated.h"
+
+class UZombieHitboxComponent;
+
+/** Result of a ray against the zombie hitboxes */
+struct FZombieHitboxHit
+{
+	/** Hitbox set that was hit */
+	UZombieHitboxComponent* Component = nullptr;
+
+	/** Index of the hitbox that was hit */
+	int32 HitboxIndex = INDEX_NONE;
+
+	/** Distance from the ray origin to the hit */
+	float Distance = 0.0f;
+};
+
+/**
+ *  Keeps track of every zombie with analytic hitboxes and resolves rays against them.
+ *  Zombies are culled against the ray with their bounding spheres first,
+ *  then the hitboxes of the remaining candidates are tested with the SIMD ray kernel.
+ *  Spread weapons can gather the zombies inside their cone once and test every pellet against that list.
+ *  The ZNode.Hitboxes.Benchmark console command compares the scalar and SIMD kernels,
+ *  and the analytic hitboxes against complex traces on the zombies in the level.
+ */
+UCLASS()
+class UZombieHitboxSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Registered hitbox sets */
+	UPROPERTY()
+	TArray<UZombieHitboxComponent*> Components;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Adds a hitbox set */
+	void RegisterHitboxes(UZombieHitboxComponent* Component);
+
+	/** Removes a hitbox set */
+	void UnregisterHitboxes(UZombieHitboxComponent* Component);
+
+	/** Returns true if any hitbox sets are registered */
+	bool HasHitboxes() const { return !Components.IsEmpty(); }
+
+	/**
+	 *  Finds the nearest hitbox along a ray. Direction must be normalized.
+	 *  Optionally returns the actors whose bounds the ray went through, so world traces can skip them.
+	 */
+	bool Raycast(const FVector& Origin, const FVector& Direction, float MaxDistance, FZombieHitboxHit& OutHit, const AActor* IgnoredActor = nullptr, TArray<AActor*, FFrameScratchAllocator>* OutCandidates = nullptr) const;
+
+	/** Collects the zombies whose bounds touch a cone, so several rays inside it can share one broad phase query */
+	void GatherConeCandidates(const FVector& Origin, const FVector& Direction, float HalfAngle, float MaxDistance, TArray<UZombieHitboxComponent*, FFrameScratchAllocator>& OutCandidates, const AActor* IgnoredActor = nullptr) const;
+
+	/** Finds the nearest hitbox along a ray, only testing the provided zombies. Direction must be normalized */
+	bool RaycastCandidates(TConstArrayView<UZombieHitboxComponent*> Candidates, const FVector& Origin, const FVector& Direction, float MaxDistance, FZombieHitboxHit& OutHit) const;
+
+	/** Times the ray kernels and compares them against complex traces */
+	void RunBenchmark(int32 NumRays) const;
+
+protected:
+
+	/** Tests a ray against a zombie's bounds and then its hitboxes, keeping the hit if it's nearer than InOutHit */
+	static bool RaycastComponent(UZombieHitboxComponent* Component, const FVector& Origin, const FVector& Direction, FZombieHitboxHit& InOutHit, bool& bOutInBounds);
+};